@@ -396,6 +396,20 @@ def cmd_compile_native(args: argparse.Namespace) -> int:
     return compile_native(args.output_dir)
 
 
+def cmd_cache_export(args: argparse.Namespace) -> int:
+    """Pack launcher/compile caches into a single bundle for CI cache seeding."""
+    from .commands.cache_bundle import run_export
+
+    return run_export(args.bundle, args.root, args.dir, args.level)
+
+
+def cmd_cache_import(args: argparse.Namespace) -> int:
+    """Restore a cache bundle, merging into the existing cache state."""
+    from .commands.cache_bundle import run_import
+
+    return run_import(args.bundle, args.dir, args.on_conflict, args.force, args.dry_run)
+
+
 def cmd_purge(args: argparse.Namespace) -> int:
     """Remove all downloaded toolchains and cached data."""
     from . import component_db, downloader
@@ -1291,6 +1305,64 @@ def main() -> int:
     )
     parser_purge.set_defaults(func=cmd_purge)
 
+    # cache command with subcommands
+    parser_cache = subparsers.add_parser(
+        "cache",
+        help="Export/import launcher and compile caches as a single bundle (CI cache seeding)",
+    )
+    cache_subparsers = parser_cache.add_subparsers(dest="cache_command", help="Cache bundle operation")
+
+    parser_cache_export = cache_subparsers.add_parser(
+        "export",
+        help="Pack selected cache roots into a deduplicated, zstd-compressed bundle",
+    )
+    parser_cache_export.add_argument("bundle", help="Output bundle path (e.g. ctc-cache.tar.zst)")
+    parser_cache_export.add_argument(
+        "--root",
+        action="append",
+        choices=["paths", "emcc-args", "zccache"],
+        help="Cache root to include (repeatable; default: paths and emcc-args)",
+    )
+    parser_cache_export.add_argument(
+        "--dir",
+        action="append",
+        default=[],
+        metavar="NAME=PATH",
+        help="Extra cache directory to include, e.g. thinlto=build/.thinlto-cache (repeatable)",
+    )
+    parser_cache_export.add_argument("--level", type=int, default=3, help="zstd compression level (default: 3)")
+    parser_cache_export.set_defaults(func=cmd_cache_export)
+
+    parser_cache_import = cache_subparsers.add_parser(
+        "import",
+        help="Restore a cache bundle after validating the toolchain fingerprint",
+    )
+    parser_cache_import.add_argument("bundle", help="Bundle produced by 'cache export'")
+    parser_cache_import.add_argument(
+        "--dir",
+        action="append",
+        default=[],
+        metavar="NAME=PATH",
+        help="Restore extra root NAME into PATH instead of its exported location (repeatable)",
+    )
+    parser_cache_import.add_argument(
+        "--on-conflict",
+        choices=["keep", "newer", "overwrite"],
+        default="keep",
+        help="What to do when a file already exists (default: keep)",
+    )
+    parser_cache_import.add_argument(
+        "--force",
+        action="store_true",
+        help="Restore even when the toolchain fingerprint does not match",
+    )
+    parser_cache_import.add_argument(
+        "--dry-run",
+        action="store_true",
+        help="Report what would be restored without writing anything",
+    )
+    parser_cache_import.set_defaults(func=cmd_cache_import)
+
     # compile-native command
     parser_compile_native = subparsers.add_parser(
         "compile-native",
@@ -1334,6 +1406,16 @@ def main() -> int:
         print("For more information: clang-tool-chain uninstall --help")
         return 1
 
+    if args.command == "cache" and not hasattr(args, "func"):
+        print("Error: Please specify a cache operation")
+        print()
+        print("Available options:")
+        print("  clang-tool-chain cache export BUNDLE  - Pack caches into a bundle")
+        print("  clang-tool-chain cache import BUNDLE  - Restore caches from a bundle")
+        print()
+        print("For more information: clang-tool-chain cache --help")
+        return 1
+
     # Execute command
     return args.func(args)
 
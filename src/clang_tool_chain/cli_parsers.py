@@ -89,12 +89,13 @@ Behavior:
 
 Caching (--cached flag):
   - Computes SHA256 hash of source file
-  - Stores hash in src.hash file
-  - Skips compilation if hash matches and executable exists
+  - Records compiler flags, directives and every included header (-MD) in src.hash
+  - Skips compilation if nothing changed and executable exists
+  - Headers are checked by (mtime, size) first, then by hash if touched
   - Useful for quick development iterations
 
 Arguments:
-  --cached        - Enable hash-based compilation caching
+  --cached        - Enable hash-based compilation caching (source + headers + flags)
   source_file     - C/C++ source file to compile (.c, .cpp, .cc, .cxx)
   compiler_flags  - Optional compiler flags (before '--')
   program_args    - Optional arguments to pass to the program (after '--')
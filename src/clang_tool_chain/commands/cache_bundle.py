@@ -0,0 +1,496 @@
+"""
+Cache bundles for ``clang-tool-chain cache export`` / ``cache import``.
+
+CI runners start from an empty ``~/.clang-tool-chain`` cache state, so the
+first build on every runner re-runs the Python path discovery for each native
+launcher, re-captures every ``.ctc-emcc-args`` entry and starts the compile /
+ThinLTO caches cold. A cache bundle packs those roots into ONE artifact that
+CI can save and restore instead of thousands of small files.
+
+Bundle layout (a zstd-compressed tar stream, written in this order)::
+
+    index.json          format version, toolchain fingerprint, file list
+    objects/<sha256>    one member per unique file content (deduplicated)
+
+Roots:
+
+* ``paths``     — per-tool launcher path caches (``.ctc-cache``,
+                  ``.ctc-emcc-paths``, ``.ctc-wasmld-cache``,
+                  ``.ctc-<tool>-cache``) in ``<home>/<tool>/<plat>/<arch>/``
+* ``emcc-args`` — the ``.ctc-emcc-args/`` fast-path capture directories
+* ``zccache``   — the compile cache at ``$ZCCACHE_DIR`` (only when set)
+* ``NAME=PATH`` — any extra directory, e.g. a ThinLTO cache
+
+The ``paths`` and ``emcc-args`` entries embed absolute paths into the
+toolchain home, so their contents are rewritten to a ``${CTC_HOME}`` token on
+export and expanded again on import. That keeps bundles portable between
+runners whose home directories differ.
+
+The fingerprint is taken from each installed component's ``done.txt`` (which
+records the archive SHA256). On import, files that belong to a component are
+only restored when the local install carries the same fingerprint; extra
+roots are restored only when no installed component disagrees. ``--force``
+bypasses both checks.
+"""
+
+from __future__ import annotations
+
+import hashlib
+import io
+import json
+import os
+import tarfile
+import tempfile
+from dataclasses import dataclass
+from pathlib import Path
+
+from clang_tool_chain.path_utils import get_home_toolchain_dir
+
+BUNDLE_FORMAT = 1
+HOME_TOKEN = "${CTC_HOME}"
+INDEX_NAME = "index.json"
+OBJECTS_PREFIX = "objects/"
+
+# Roots stored relative to the toolchain home (and path-rewritten).
+HOME_ROOTS = ("paths", "emcc-args")
+DEFAULT_ROOTS = HOME_ROOTS
+
+_EMCC_ARGS_DIR = ".ctc-emcc-args"
+_CONFLICT_POLICIES = ("keep", "newer", "overwrite")
+
+
+@dataclass
+class BundleEntry:
+    """One file inside a bundle."""
+
+    root: str
+    rel: str
+    sha256: str
+    size: int
+    mode: int
+    mtime: float
+
+    def to_json(self) -> dict[str, object]:
+        return {
+            "root": self.root,
+            "rel": self.rel,
+            "sha256": self.sha256,
+            "size": self.size,
+            "mode": self.mode,
+            "mtime": self.mtime,
+        }
+
+
+# ============================================================================
+# Fingerprint
+# ============================================================================
+
+
+def _component_of(rel: str) -> str:
+    """Map a home-relative path (``tool/plat/arch/...``) to its component key."""
+    parts = rel.split("/")
+    return "/".join(parts[:3]) if len(parts) >= 4 else ""
+
+
+def _install_dirs(home: Path) -> list[Path]:
+    """Return every ``<home>/<tool>/<plat>/<arch>`` directory that exists."""
+    if not home.is_dir():
+        return []
+    return sorted(p for p in home.glob("*/*/*") if p.is_dir())
+
+
+def toolchain_fingerprint(home: Path) -> dict[str, str]:
+    """Return ``{"tool/plat/arch": sha256(done.txt)}`` for every installed component."""
+    components: dict[str, str] = {}
+    for install_dir in _install_dirs(home):
+        done = install_dir / "done.txt"
+        if not done.is_file():
+            continue
+        key = install_dir.relative_to(home).as_posix()
+        components[key] = hashlib.sha256(done.read_bytes().strip()).hexdigest()
+    return components
+
+
+# ============================================================================
+# Root collection
+# ============================================================================
+
+
+def _rewrite_to_token(data: bytes, home: Path) -> bytes:
+    """Replace absolute toolchain-home prefixes with ``${CTC_HOME}``."""
+    raw = str(home)
+    token = HOME_TOKEN.encode()
+    # JSON-escaped form first (Windows paths in .ctc-emcc-args are escaped).
+    escaped = raw.replace("\\", "\\\\")
+    if escaped != raw:
+        data = data.replace(escaped.encode(), token)
+    return data.replace(raw.encode(), token)
+
+
+def _expand_token(data: bytes, home: Path, rel: str) -> bytes:
+    raw = str(home)
+    if rel.endswith(".args") or rel.endswith(".json"):
+        raw = raw.replace("\\", "\\\\")
+    return data.replace(HOME_TOKEN.encode(), raw.encode())
+
+
+def _collect_home_root(root: str, home: Path) -> list[tuple[str, Path]]:
+    """Return ``(rel, path)`` pairs for a home-relative root."""
+    files: list[tuple[str, Path]] = []
+    for install_dir in _install_dirs(home):
+        if root == "paths":
+            for p in sorted(install_dir.glob(".ctc-*")):
+                if p.is_file() and not p.is_symlink():
+                    files.append((p.relative_to(home).as_posix(), p))
+        elif root == "emcc-args":
+            args_dir = install_dir / _EMCC_ARGS_DIR
+            if args_dir.is_dir():
+                files.extend(_collect_dir(args_dir, home))
+    return files
+
+
+def _collect_dir(directory: Path, base: Path) -> list[tuple[str, Path]]:
+    files: list[tuple[str, Path]] = []
+    for dirpath, dirnames, filenames in os.walk(directory):
+        dirnames.sort()
+        for name in sorted(filenames):
+            p = Path(dirpath) / name
+            if p.is_file() and not p.is_symlink():
+                files.append((p.relative_to(base).as_posix(), p))
+    return files
+
+
+def resolve_roots(names: list[str], extra_dirs: list[str]) -> dict[str, Path | None]:
+    """
+    Resolve root selections into ``{name: directory}``.
+
+    Home roots map to ``None`` (they live under the toolchain home). Raises
+    ValueError for unknown names or malformed ``NAME=PATH`` specs.
+    """
+    roots: dict[str, Path | None] = {}
+    for name in names:
+        if name in HOME_ROOTS:
+            roots[name] = None
+        elif name == "zccache":
+            zdir = os.environ.get("ZCCACHE_DIR")
+            if not zdir:
+                raise ValueError("root 'zccache' requested but ZCCACHE_DIR is not set")
+            roots[name] = Path(zdir)
+        else:
+            raise ValueError(f"unknown cache root '{name}' (expected one of: paths, emcc-args, zccache)")
+    for spec in extra_dirs:
+        name, sep, path = spec.partition("=")
+        if not sep or not name or not path:
+            raise ValueError(f"invalid --dir '{spec}' (expected NAME=PATH)")
+        if name in HOME_ROOTS:
+            raise ValueError(f"--dir name '{name}' collides with a built-in root")
+        roots[name] = Path(path)
+    return roots
+
+
+# ============================================================================
+# Export
+# ============================================================================
+
+
+def _open_zstd(path: Path, mode: str, level: int = 3):  # type: ignore[no-untyped-def]
+    import pyzstd
+
+    if mode == "wb":
+        return pyzstd.ZstdFile(path, mode, level_or_option=level)
+    return pyzstd.ZstdFile(path, mode)
+
+
+def _add_bytes(tar: tarfile.TarFile, name: str, data: bytes, mode: int = 0o644) -> None:
+    info = tarfile.TarInfo(name)
+    info.size = len(data)
+    info.mode = mode
+    tar.addfile(info, io.BytesIO(data))
+
+
+def export_bundle(
+    bundle: Path,
+    roots: dict[str, Path | None],
+    home: Path | None = None,
+    level: int = 3,
+) -> dict[str, object]:
+    """
+    Write a cache bundle and return its index.
+
+    Identical file contents are stored once; the index references them by
+    SHA256. The bundle is written to a temp file and renamed into place so a
+    failed export never leaves a truncated artifact behind.
+    """
+    home = home or get_home_toolchain_dir()
+    entries: list[BundleEntry] = []
+    objects: dict[str, bytes | Path] = {}
+    root_paths: dict[str, str | None] = {}
+
+    for root, directory in roots.items():
+        root_paths[root] = None if directory is None else str(directory)
+        if directory is None:
+            pairs = _collect_home_root(root, home)
+        elif directory.is_dir():
+            pairs = _collect_dir(directory, directory)
+        else:
+            pairs = []
+
+        for rel, path in pairs:
+            st = path.stat()
+            if directory is None:
+                # Launcher caches are tiny text files: rewrite and hold in memory.
+                data = _rewrite_to_token(path.read_bytes(), home)
+                digest = hashlib.sha256(data).hexdigest()
+                objects.setdefault(digest, data)
+                size = len(data)
+            else:
+                h = hashlib.sha256()
+                with path.open("rb") as f:
+                    for chunk in iter(lambda f=f: f.read(1024 * 1024), b""):  # type: ignore[misc]
+                        h.update(chunk)
+                digest = h.hexdigest()
+                objects.setdefault(digest, path)
+                size = st.st_size
+            entries.append(BundleEntry(root, rel, digest, size, st.st_mode & 0o777, st.st_mtime))
+
+    index: dict[str, object] = {
+        "format": BUNDLE_FORMAT,
+        "home_token": HOME_TOKEN,
+        "fingerprint": toolchain_fingerprint(home),
+        "roots": root_paths,
+        "files": [e.to_json() for e in entries],
+        "objects": len(objects),
+        "bytes": sum(e.size for e in entries),
+    }
+
+    bundle.parent.mkdir(parents=True, exist_ok=True)
+    fd, tmp_name = tempfile.mkstemp(prefix=bundle.name + ".", suffix=".tmp", dir=bundle.parent)
+    os.close(fd)
+    tmp = Path(tmp_name)
+    try:
+        with _open_zstd(tmp, "wb", level) as zf, tarfile.open(fileobj=zf, mode="w|") as tar:
+            _add_bytes(tar, INDEX_NAME, json.dumps(index, indent=1).encode())
+            for digest in sorted(objects):
+                src = objects[digest]
+                if isinstance(src, bytes):
+                    _add_bytes(tar, OBJECTS_PREFIX + digest, src)
+                else:
+                    info = tarfile.TarInfo(OBJECTS_PREFIX + digest)
+                    info.size = src.stat().st_size
+                    info.mode = 0o644
+                    with src.open("rb") as f:
+                        tar.addfile(info, f)
+        os.replace(tmp, bundle)
+    except BaseException:
+        tmp.unlink(missing_ok=True)
+        raise
+    return index
+
+
+# ============================================================================
+# Import
+# ============================================================================
+
+
+@dataclass
+class ImportStats:
+    written: int = 0
+    kept: int = 0
+    skipped_fingerprint: int = 0
+    skipped_root: int = 0
+
+
+def _destination(
+    entry: dict[str, object],
+    home: Path,
+    bundle_roots: dict[str, str | None],
+    dir_overrides: dict[str, Path],
+) -> Path | None:
+    root = str(entry["root"])
+    rel = str(entry["rel"])
+    if root in HOME_ROOTS:
+        base = home
+    elif root in dir_overrides:
+        base = dir_overrides[root]
+    elif root == "zccache" and os.environ.get("ZCCACHE_DIR"):
+        base = Path(os.environ["ZCCACHE_DIR"])
+    elif bundle_roots.get(root):
+        base = Path(str(bundle_roots[root]))
+    else:
+        return None
+    dest = (base / rel).resolve()
+    # Never let a crafted index escape its root.
+    if not dest.is_relative_to(base.resolve()):
+        return None
+    return dest
+
+
+def _entry_allowed(
+    entry: dict[str, object],
+    bundle_fp: dict[str, str],
+    local_fp: dict[str, str],
+    force: bool,
+) -> bool:
+    if force:
+        return True
+    if str(entry["root"]) in HOME_ROOTS:
+        component = _component_of(str(entry["rel"]))
+        expected = bundle_fp.get(component)
+        return expected is not None and local_fp.get(component) == expected
+    # Extra roots: every component installed on both sides must agree.
+    return all(local_fp[k] == v for k, v in bundle_fp.items() if k in local_fp)
+
+
+def _write_atomic(dest: Path, data: bytes, mode: int) -> None:
+    dest.parent.mkdir(parents=True, exist_ok=True)
+    fd, tmp_name = tempfile.mkstemp(prefix=dest.name + ".", suffix=".tmp", dir=dest.parent)
+    try:
+        with os.fdopen(fd, "wb") as out:
+            out.write(data)
+        os.chmod(tmp_name, mode or 0o644)
+        os.replace(tmp_name, dest)
+    except BaseException:
+        Path(tmp_name).unlink(missing_ok=True)
+        raise
+
+
+def import_bundle(
+    bundle: Path,
+    home: Path | None = None,
+    dir_overrides: dict[str, Path] | None = None,
+    on_conflict: str = "keep",
+    force: bool = False,
+    dry_run: bool = False,
+) -> tuple[dict[str, object], ImportStats]:
+    """
+    Restore a cache bundle, merging into whatever cache state already exists.
+
+    ``on_conflict`` decides what happens when a destination file exists:
+    ``keep`` leaves it alone, ``newer`` replaces it only when the bundled copy
+    has a later mtime, ``overwrite`` always replaces it.
+    """
+    if on_conflict not in _CONFLICT_POLICIES:
+        raise ValueError(f"invalid conflict policy '{on_conflict}'")
+    home = home or get_home_toolchain_dir()
+    dir_overrides = dir_overrides or {}
+    stats = ImportStats()
+    local_fp = toolchain_fingerprint(home)
+
+    with _open_zstd(bundle, "rb") as zf, tarfile.open(fileobj=zf, mode="r|") as tar:
+        first = tar.next()
+        if first is None or first.name != INDEX_NAME:
+            raise ValueError(f"{bundle}: not a clang-tool-chain cache bundle (missing {INDEX_NAME})")
+        index_file = tar.extractfile(first)
+        assert index_file is not None
+        index = json.loads(index_file.read())
+        if index.get("format") != BUNDLE_FORMAT:
+            raise ValueError(f"{bundle}: unsupported bundle format {index.get('format')}")
+
+        bundle_fp: dict[str, str] = index.get("fingerprint", {})
+        bundle_roots: dict[str, str | None] = index.get("roots", {})
+
+        # Plan: digest -> destinations. Objects arrive in digest order after the index.
+        plan: dict[str, list[tuple[Path, dict[str, object]]]] = {}
+        for entry in index.get("files", []):
+            if not _entry_allowed(entry, bundle_fp, local_fp, force):
+                stats.skipped_fingerprint += 1
+                continue
+            dest = _destination(entry, home, bundle_roots, dir_overrides)
+            if dest is None:
+                stats.skipped_root += 1
+                continue
+            if dest.exists():
+                if on_conflict == "keep" or (
+                    on_conflict == "newer" and dest.stat().st_mtime >= float(entry["mtime"])  # type: ignore[arg-type]
+                ):
+                    stats.kept += 1
+                    continue
+            plan.setdefault(str(entry["sha256"]), []).append((dest, entry))
+
+        if dry_run:
+            stats.written = sum(len(v) for v in plan.values())
+            return index, stats
+
+        for member in tar:
+            if not member.name.startswith(OBJECTS_PREFIX):
+                continue
+            targets = plan.get(member.name[len(OBJECTS_PREFIX) :])
+            if not targets:
+                continue
+            src = tar.extractfile(member)
+            if src is None:
+                continue
+            data = src.read()
+            for dest, entry in targets:
+                out = data
+                if str(entry["root"]) in HOME_ROOTS:
+                    out = _expand_token(data, home, str(entry["rel"]))
+                _write_atomic(dest, out, int(entry["mode"]))  # type: ignore[call-overload]
+                os.utime(dest, (float(entry["mtime"]), float(entry["mtime"])))  # type: ignore[arg-type]
+                stats.written += 1
+
+    return index, stats
+
+
+# ============================================================================
+# CLI glue
+# ============================================================================
+
+
+def _format_size(n: int) -> str:
+    size = float(n)
+    for unit in ("B", "KB", "MB", "GB"):
+        if size < 1024 or unit == "GB":
+            return f"{size:.0f} {unit}" if unit == "B" else f"{size:.1f} {unit}"
+        size /= 1024
+    return f"{n} B"
+
+
+def _parse_overrides(specs: list[str]) -> dict[str, Path]:
+    overrides: dict[str, Path] = {}
+    for spec in specs:
+        name, sep, path = spec.partition("=")
+        if not sep or not name or not path:
+            raise ValueError(f"invalid --dir '{spec}' (expected NAME=PATH)")
+        overrides[name] = Path(path)
+    return overrides
+
+
+def run_export(bundle: str, root_names: list[str] | None, extra_dirs: list[str], level: int) -> int:
+    try:
+        roots = resolve_roots(root_names or list(DEFAULT_ROOTS), extra_dirs)
+        index = export_bundle(Path(bundle), roots, level=level)
+    except (ValueError, OSError) as e:
+        print(f"Error: {e}")
+        return 1
+    files = index["files"]
+    assert isinstance(files, list)
+    print(f"Exported {len(files)} files ({index['objects']} unique objects, {_format_size(int(index['bytes']))})")  # type: ignore[call-overload]
+    print(f"  roots:      {', '.join(roots)}")
+    print(f"  components: {len(index['fingerprint'])}")  # type: ignore[arg-type]
+    print(f"  bundle:     {bundle} ({_format_size(Path(bundle).stat().st_size)})")
+    return 0
+
+
+def run_import(bundle: str, extra_dirs: list[str], on_conflict: str, force: bool, dry_run: bool) -> int:
+    try:
+        _, stats = import_bundle(
+            Path(bundle),
+            dir_overrides=_parse_overrides(extra_dirs),
+            on_conflict=on_conflict,
+            force=force,
+            dry_run=dry_run,
+        )
+    except (ValueError, OSError, tarfile.TarError) as e:
+        print(f"Error: {e}")
+        return 1
+    verb = "Would restore" if dry_run else "Restored"
+    print(f"{verb} {stats.written} files, kept {stats.kept} existing")
+    if stats.skipped_fingerprint:
+        print(
+            f"  skipped {stats.skipped_fingerprint} files: toolchain fingerprint mismatch "
+            "(install the same toolchain versions, or pass --force)"
+        )
+    if stats.skipped_root:
+        print(f"  skipped {stats.skipped_root} files: no destination for root (pass --dir NAME=PATH)")
+    return 0
@@ -123,6 +123,13 @@ def _platform_compile_flags(clang_bin_dir: Path, platform_name: str) -> list[str
 # ------------------------------------------------------------------
 
 
+def _output_suffix(tool: NativeTool, platform_name: str) -> str:
+    """File suffix for *tool*'s primary output on *platform_name*."""
+    if tool.shared:
+        return {"win": ".dll", "darwin": ".dylib"}.get(platform_name, ".so")
+    return ".exe" if platform_name == "win" else ""
+
+
 def _compile_tool(
     tool: NativeTool,
     source_path: Path,
@@ -132,12 +139,19 @@ def _compile_tool(
     platform_name: str,
 ) -> int:
     """Compile one tool and create its aliases.  Returns 0 on success."""
-    exe_suffix = ".exe" if platform_name == "win" else ""
+    exe_suffix = _output_suffix(tool, platform_name)
     output_binary = output_dir / f"{tool.output}{exe_suffix}"
 
     cmd = [str(clang_exe), "-O3", f"-std={tool.std}"]
     cmd.extend(platform_flags)
+    if tool.shared:
+        # Only symbols marked for export (C API / interposers) are visible.
+        cmd.extend(["-shared", "-fPIC", "-fvisibility=hidden"])
+    cmd.extend(tool.extra_flags)
     cmd.extend(["-o", str(output_binary), str(source_path)])
+    if tool.shared and platform_name == "linux":
+        # Keep the statically linked C++ runtime out of the dynamic symbol table.
+        cmd.extend(["-ldl", "-Wl,--exclude-libs,ALL"])
 
     print(f"Compiling: {shlex.join(cmd)}")
     result = subprocess.run(cmd)
@@ -205,7 +219,10 @@ def compile_native(output_dir: str) -> int:
 
     # Compile each registered tool
     compiled: list[str] = []
+    built = 0
     for tool_id, tool in TOOL_REGISTRY.items():
+        if tool.platforms and platform_name not in tool.platforms:
+            continue
         source = _find_tool_source(tool)
         if source is None:
             print(f"Error: source not found for tool '{tool_id}' ({tool.source})", file=sys.stderr)
@@ -215,13 +232,14 @@ def compile_native(output_dir: str) -> int:
         rc = _compile_tool(tool, source, output_path, clang_exe, platform_flags, platform_name)
         if rc != 0:
             return rc
+        built += 1
 
         exe_suffix = ".exe" if platform_name == "win" else ""
-        compiled.append(f"  {output_path / (tool.output + exe_suffix)}")
+        compiled.append(f"  {output_path / (tool.output + _output_suffix(tool, platform_name))}")
         for alias in tool.aliases:
             compiled.append(f"  {output_path / (alias + exe_suffix)}")
 
-    print(f"\nNative tools built successfully ({len(TOOL_REGISTRY)} tool(s)):")
+    print(f"\nNative tools built successfully ({built} tool(s)):")
     for line in compiled:
         print(line)
     return 0
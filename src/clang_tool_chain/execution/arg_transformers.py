@@ -674,8 +674,8 @@ class ASANRuntimeTransformer(ArgumentTransformer):
         if context.platform_name not in ("linux", "win") or context.tool_name not in ("clang", "clang++"):
             return args
 
-        # Check if ASAN is enabled
-        has_asan = any("-fsanitize=address" in arg for arg in args)
+        # Check if ASAN is enabled (also as part of a list, e.g. -fsanitize=fuzzer,address)
+        has_asan = any(arg.startswith("-fsanitize=") and "address" in arg[11:].split(",") for arg in args)
         if not has_asan:
             return args
 
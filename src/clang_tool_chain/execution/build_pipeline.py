@@ -7,7 +7,7 @@ duplication between different build commands (build-run, run, etc.).
 The pipeline supports:
 - Clang/LLVM compilation (GNU and MSVC ABI)
 - Cosmopolitan Libc compilation (Actually Portable Executables)
-- Hash-based caching for incremental builds
+- Hash-based caching for incremental builds (source, flags and header closure)
 - Shebang stripping from source files
 - Inlined build directives parsing
 - Automatic execution after compilation
@@ -47,6 +47,53 @@ def _compute_file_hash(file_path: Path) -> str:
     return sha256_hash.hexdigest()
 
 
+def _parse_depfile(text: str) -> list[str]:
+    """
+    Parse a Make-syntax dependency file as written by clang/gcc -MD.
+
+    Handles line continuations, backslash-escaped spaces and ``$$``. The
+    target and any phony targets (``-MP``) are dropped.
+
+    Args:
+        text: Contents of the .d file
+
+    Returns:
+        Prerequisite paths in the order they appear, without duplicates
+    """
+    deps: list[str] = []
+    seen: set[str] = set()
+    text = text.replace("\\\r\n", " ").replace("\\\n", " ")
+    for line in text.splitlines():
+        # Split off the target. "C:\\x.o: ..." has a drive-letter colon first.
+        colon = line.find(": ")
+        if colon < 0 and line.rstrip().endswith(":"):
+            colon = len(line.rstrip()) - 1
+        if colon < 0:
+            continue
+        rest = line[colon + 1 :]
+        token = ""
+        i = 0
+        while i <= len(rest):
+            c = rest[i] if i < len(rest) else " "
+            if c == "\\" and i + 1 < len(rest) and rest[i + 1] in " #":
+                token += rest[i + 1]
+                i += 2
+                continue
+            if c == "$" and i + 1 < len(rest) and rest[i + 1] == "$":
+                token += "$"
+                i += 2
+                continue
+            if c in " \t":
+                if token and token not in seen:
+                    seen.add(token)
+                    deps.append(token)
+                token = ""
+            else:
+                token += c
+            i += 1
+    return deps
+
+
 def _strip_shebang(source_path: Path) -> tuple[Path, bool]:
     """
     Check if source file has a shebang and create a temporary file without it.
@@ -186,11 +233,99 @@ class BuildPipeline(ABC):
         self.source_path = Path(config.source_file)
         self.output_path = Path(config.output_file)
         self.hash_file = self.source_path.with_suffix(".hash")
+        # Dependency file written by the compiler when caching is enabled, and
+        # the path actually compiled (a temp copy when a shebang was stripped)
+        self.dep_file: Path | None = None
+        self.compile_source: Path | None = None
+
+    def _flags_signature(self) -> str:
+        """
+        Hash of everything besides file contents that shapes the binary:
+        the directive-derived args and the user's compiler flags.
+        """
+        parts = ["directives", *_get_directive_args(self.source_path), "flags", *self.config.compiler_flags]
+        return hashlib.sha256("\0".join(parts).encode("utf-8")).hexdigest()
+
+    def _depfile_args(self) -> list[str]:
+        """
+        Extra compiler args that record the header closure for --cached.
+
+        Returns an empty list when caching is off or the user already controls
+        dependency output (any -M flag).
+        """
+        if not self.config.use_cache or any(f.startswith("-M") for f in self.config.compiler_flags):
+            return []
+        fd, name = tempfile.mkstemp(prefix="ctc-build-run-", suffix=".d")
+        os.close(fd)
+        self.dep_file = Path(name)
+        return ["-MD", "-MF", name]
+
+    def _read_cache_record(self) -> tuple[str, str | None, list[tuple[int, int, str, str]] | None]:
+        """
+        Parse the hash file.
+
+        Format (first line is the source hash, as written by older versions):
+            <sha256 of source>
+            flags <sha256 of directive args + compiler flags>
+            dep <size> <mtime_ns> <sha256> <path>
+            ...
+
+        Returns:
+            (source hash, flags signature or None, dependency list or None).
+            None means the record predates dependency tracking.
+        """
+        lines = self.hash_file.read_text(encoding="utf-8").splitlines()
+        source_hash = lines[0].strip() if lines else ""
+        flags: str | None = None
+        deps: list[tuple[int, int, str, str]] | None = None
+        for line in lines[1:]:
+            if line.startswith("flags "):
+                flags = line[6:].strip()
+                deps = deps if deps is not None else []
+            elif line.startswith("dep "):
+                size, mtime_ns, digest, path = line[4:].split(" ", 3)
+                deps = deps if deps is not None else []
+                deps.append((int(size), int(mtime_ns), digest, path))
+        return source_hash, flags, deps
+
+    def _write_cache_record(self, source_hash: str, flags: str, deps: list[tuple[int, int, str, str]]) -> None:
+        lines = [source_hash, f"flags {flags}"]
+        lines += [f"dep {size} {mtime_ns} {digest} {path}" for size, mtime_ns, digest, path in deps]
+        self.hash_file.write_text("\n".join(lines) + "\n", encoding="utf-8")
+
+    def _check_dependencies(self, deps: list[tuple[int, int, str, str]]) -> tuple[str | None, bool]:
+        """
+        Revalidate the recorded header closure.
+
+        Each dependency is checked with one stat(); only files whose
+        (size, mtime) changed are re-hashed, so touching a header without
+        editing it does not force a rebuild.
+
+        Returns:
+            (path of the first changed dependency or None, whether any
+            stat stamps were refreshed and the record should be rewritten)
+        """
+        refreshed = False
+        for i, (size, mtime_ns, digest, path) in enumerate(deps):
+            try:
+                st = os.stat(path)
+            except OSError:
+                return path, refreshed
+            if st.st_size == size and st.st_mtime_ns == mtime_ns:
+                continue
+            if st.st_size != size or _compute_file_hash(Path(path)) != digest:
+                return path, refreshed
+            deps[i] = (size, st.st_mtime_ns, digest, path)
+            refreshed = True
+        return None, refreshed
 
     def _check_cache(self) -> bool:
         """
         Check if cached executable is valid.
 
+        The binary is reused only when the source hash, the flags signature
+        and every recorded dependency still match.
+
         Returns:
             True if cache is valid and compilation can be skipped, False otherwise
         """
@@ -205,13 +340,23 @@ class BuildPipeline(ABC):
         # Check if hash file exists and matches
         if self.hash_file.exists() and self.output_path.exists():
             try:
-                stored_hash = self.hash_file.read_text().strip()
-                if stored_hash == current_hash:
-                    print("Cache hit! Hash matches, skipping compilation.", file=sys.stderr)
-                    print(f"Using cached executable: {self.config.output_file}", file=sys.stderr)
-                    return True
-                else:
+                stored_hash, stored_flags, deps = self._read_cache_record()
+                if stored_hash != current_hash:
                     print("Cache miss: Hash mismatch, recompiling...", file=sys.stderr)
+                elif stored_flags is None or deps is None:
+                    print("Cache miss: No dependency record, recompiling...", file=sys.stderr)
+                elif stored_flags != self._flags_signature():
+                    print("Cache miss: Compiler flags or directives changed, recompiling...", file=sys.stderr)
+                else:
+                    changed, refreshed = self._check_dependencies(deps)
+                    if changed is not None:
+                        print(f"Cache miss: Dependency changed: {changed}, recompiling...", file=sys.stderr)
+                    else:
+                        if refreshed:
+                            self._write_cache_record(stored_hash, stored_flags, deps)
+                        print("Cache hit! Hash matches, skipping compilation.", file=sys.stderr)
+                        print(f"Using cached executable: {self.config.output_file}", file=sys.stderr)
+                        return True
             except KeyboardInterrupt as ke:
                 handle_keyboard_interrupt_properly(ke)
             except Exception as e:
@@ -226,18 +371,38 @@ class BuildPipeline(ABC):
         return False
 
     def _update_cache(self) -> None:
-        """Update the cache hash file after successful compilation."""
+        """
+        Update the cache hash file after successful compilation.
+
+        Records the source hash, the flags signature and (size, mtime, hash)
+        for every header in the compiler's dependency file.
+        """
         if not self.config.use_cache:
             return
 
         try:
+            deps: list[tuple[int, int, str, str]] = []
+            if self.dep_file is not None and self.dep_file.exists():
+                skip = {os.path.abspath(self.source_path)}
+                if self.compile_source is not None:
+                    skip.add(os.path.abspath(self.compile_source))
+                for dep in _parse_depfile(self.dep_file.read_text(encoding="utf-8", errors="replace")):
+                    path = os.path.abspath(dep)
+                    if path in skip or not os.path.isfile(path):
+                        continue
+                    skip.add(path)
+                    st = os.stat(path)
+                    deps.append((st.st_size, st.st_mtime_ns, _compute_file_hash(Path(path)), path))
             current_hash = _compute_file_hash(self.source_path)
-            self.hash_file.write_text(current_hash)
-            print(f"Updated cache hash: {self.hash_file}", file=sys.stderr)
+            self._write_cache_record(current_hash, self._flags_signature(), deps)
+            print(f"Updated cache hash: {self.hash_file} ({len(deps)} dependencies)", file=sys.stderr)
         except KeyboardInterrupt as ke:
             handle_keyboard_interrupt_properly(ke)
         except Exception as e:
             print(f"Warning: Could not write hash file: {e}", file=sys.stderr)
+        finally:
+            if self.dep_file is not None:
+                self.dep_file.unlink(missing_ok=True)
 
     @abstractmethod
     def _compile(self) -> int:
@@ -320,6 +485,8 @@ class BuildPipeline(ABC):
         exit_code = self._compile()
 
         if exit_code != 0:
+            if self.dep_file is not None:
+                self.dep_file.unlink(missing_ok=True)
             print(f"\n{'=' * 60}", file=sys.stderr)
             print("Compilation failed", file=sys.stderr)
             print(f"{'=' * 60}\n", file=sys.stderr)
@@ -342,6 +509,7 @@ class ClangBuildPipeline(BuildPipeline):
         """Compile using Clang/LLVM toolchain."""
         # Check for shebang and strip if present
         compile_source, temp_created = _strip_shebang(self.source_path)
+        self.compile_source = compile_source
 
         try:
             # Determine if this is C or C++ based on file extension
@@ -355,9 +523,13 @@ class ClangBuildPipeline(BuildPipeline):
             directive_args = _get_directive_args(self.source_path)
 
             # Build the compiler command
-            # Directive args come before user-specified flags so user can override
+            # Directive args come before user-specified flags so user can override;
+            # with --cached, -MD -MF records the header closure last
             compiler_args = (
-                directive_args + [str(compile_source), "-o", self.config.output_file] + self.config.compiler_flags
+                directive_args
+                + [str(compile_source), "-o", self.config.output_file]
+                + self.config.compiler_flags
+                + self._depfile_args()
             )
 
             print(f"Compiling: {self.config.source_file} -> {self.config.output_file}", file=sys.stderr)
@@ -378,6 +550,7 @@ class CosmoccBuildPipeline(BuildPipeline):
         """Compile using Cosmopolitan CC toolchain."""
         # Check for shebang and strip if present
         compile_source, temp_created = _strip_shebang(self.source_path)
+        self.compile_source = compile_source
 
         try:
             # Determine if this is C or C++ based on file extension
@@ -394,9 +567,13 @@ class CosmoccBuildPipeline(BuildPipeline):
             directive_args = _get_directive_args(self.source_path)
 
             # Build the compiler command
-            # Directive args come before user-specified flags so user can override
+            # Directive args come before user-specified flags so user can override;
+            # with --cached, -MD -MF records the header closure last
             compiler_args = (
-                directive_args + [str(compile_source), "-o", self.config.output_file] + self.config.compiler_flags
+                directive_args
+                + [str(compile_source), "-o", self.config.output_file]
+                + self.config.compiler_flags
+                + self._depfile_args()
             )
 
             print(
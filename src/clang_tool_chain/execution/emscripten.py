@@ -456,6 +456,8 @@ def execute_emscripten_tool(tool_name: str, args: list[str] | None = None) -> No
     env["EMSCRIPTEN"] = str(install_dir / "emscripten")
     env["EMSCRIPTEN_ROOT"] = str(install_dir / "emscripten")
     env["EM_CONFIG"] = str(config_path)
+    # Per-library cache locks (cache.py patch applied at install); "global" opts out.
+    env.setdefault("CTC_EMCC_CACHE_LOCK", "library")
 
     # Add Node.js and Emscripten bin directories to PATH
     # Include Emscripten bin for consistency and to ensure tools can find LLVM binaries if needed
@@ -563,6 +565,8 @@ def execute_emscripten_py_tool(tool_name: str, args: list[str] | None = None) ->
     env["EMSCRIPTEN"] = str(install_dir / "emscripten")
     env["EMSCRIPTEN_ROOT"] = env["EMSCRIPTEN"]
     env["EM_CONFIG"] = str(config_path)
+    # Per-library cache locks, as for emcc (emcmake/emmake builds run emcc).
+    env.setdefault("CTC_EMCC_CACHE_LOCK", "library")
     # Prepend emscripten bin/ so the underlying llvm-ar/llvm-ranlib/etc are
     # discoverable without requiring the user to mutate PATH themselves.
     env["PATH"] = f"{emscripten_bin_dir}{os.pathsep}{env.get('PATH', '')}"
@@ -802,6 +806,8 @@ def execute_emscripten_tool_with_sccache(tool_name: str, args: list[str] | None
     env["EMSCRIPTEN"] = str(install_dir / "emscripten")
     env["EMSCRIPTEN_ROOT"] = str(install_dir / "emscripten")
     env["EM_CONFIG"] = str(config_path)
+    # Per-library cache locks (cache.py patch applied at install); "global" opts out.
+    env.setdefault("CTC_EMCC_CACHE_LOCK", "library")
 
     # Create a trampoline wrapper for clang++ to fix sccache compiler detection
     # sccache runs various compiler detection commands (-E, -dumpmachine, etc.) without the
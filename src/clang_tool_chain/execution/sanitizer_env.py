@@ -15,6 +15,9 @@ configuration.
 On Windows with shared ASAN runtime (-shared-libasan), the clang runtime
 DLL directory is automatically added to PATH to ensure the ASAN DLL can
 be found at runtime.
+
+Executables built with XRay (-fxray-instrument) get XRAY_OPTIONS that patch
+the instrumentation before main and write a basic-mode log for ctc-xray.
 """
 
 import logging
@@ -40,6 +43,17 @@ logger = logging.getLogger(__name__)
 _BASE_ASAN_OPTIONS = "fast_unwind_on_malloc=0:symbolize=1"
 DEFAULT_LSAN_OPTIONS = "fast_unwind_on_malloc=0:symbolize=1"
 
+# Set (to the toolchain fingerprint) by `ctc-sanitizer-env` output. When a test
+# harness has loaded that environment, the runtime library directories are
+# already on PATH / LD_LIBRARY_PATH and are not discovered or prepended again.
+# Only a marker matching the installed toolchain counts (see
+# _sanitizer_env_is_current), as on the native side.
+SANITIZER_ENV_MARKER = "CTC_SANITIZER_ENV"
+
+# XRay: patch sleds before main, log every entry/exit in basic (naive) mode.
+# Matches XRAY_DEFAULT_OPTIONS in native_tools/clang_launcher.cpp.
+DEFAULT_XRAY_OPTIONS = "patch_premain=true xray_mode=xray-basic"
+
 
 def get_default_asan_options() -> str:
     """
@@ -426,6 +440,59 @@ def detect_sanitizers_from_flags(compiler_flags: list[str]) -> tuple[bool, bool]
     return asan_enabled, lsan_enabled
 
 
+def detect_xray_from_flags(compiler_flags: list[str]) -> bool:
+    """
+    Detect whether XRay instrumentation is enabled from compiler flags.
+
+    The last -fxray-instrument / -fno-xray-instrument wins, like in clang.
+
+    Example:
+        >>> detect_xray_from_flags(["-O2", "-fxray-instrument"])
+        True
+        >>> detect_xray_from_flags(["-fxray-instrument", "-fno-xray-instrument"])
+        False
+    """
+    enabled = False
+    for flag in compiler_flags:
+        if flag == "-fxray-instrument":
+            enabled = True
+        elif flag == "-fno-xray-instrument":
+            enabled = False
+    return enabled
+
+
+def _sanitizer_env_is_current(marker: str | None) -> bool:
+    """
+    Check a CTC_SANITIZER_ENV value against the installed toolchain.
+
+    ctc-clang records the fingerprint it resolved the sanitizer runtime for as
+    ``sanitizer_fingerprint`` in the install's ``.ctc-cache``; ctc-sanitizer-env
+    exports that same value. A marker left over from another toolchain, or one
+    with no cache to compare against, does not count.
+
+    Args:
+        marker: Value of CTC_SANITIZER_ENV, if set.
+
+    Returns:
+        True if the marker matches the current toolchain fingerprint.
+    """
+    if not marker:
+        return False
+    try:
+        from clang_tool_chain.path_utils import get_install_dir
+        from clang_tool_chain.platform.detection import get_platform_info
+
+        platform_name, arch = get_platform_info()
+        cache = get_install_dir(platform_name, arch) / ".ctc-cache"
+        for line in cache.read_text(encoding="utf-8").splitlines():
+            key, sep, value = line.partition("=")
+            if sep and key == "sanitizer_fingerprint":
+                return value == marker
+    except (ImportError, RuntimeError, OSError) as e:
+        logger.debug(f"Could not read sanitizer fingerprint: {e}")
+    return False
+
+
 def _get_builtin_suppression_file() -> Path | None:
     """
     Get path to built-in LSan suppression file for current platform.
@@ -493,6 +560,10 @@ def prepare_sanitizer_environment(
         ASAN_OPTIONS: If already set, preserved as-is (user config takes priority).
         LSAN_OPTIONS: If already set, preserved as-is (user config takes priority).
         ASAN_SYMBOLIZER_PATH: If already set, preserved as-is (user config takes priority).
+        XRAY_OPTIONS: If already set, preserved as-is (user config takes priority).
+        CTC_SANITIZER_ENV: Set by ``ctc-sanitizer-env``; when it matches the
+            installed toolchain's fingerprint, runtime library paths are
+            assumed present and not prepended again.
 
     Example:
         >>> env = prepare_sanitizer_environment(compiler_flags=["-fsanitize=address"])
@@ -518,6 +589,7 @@ def prepare_sanitizer_environment(
 
     # Detect which sanitizers are enabled
     asan_enabled, lsan_enabled = detect_sanitizers_from_flags(compiler_flags)
+    runtime_paths_loaded = _sanitizer_env_is_current(env.get(SANITIZER_ENV_MARKER))
 
     # Inject ASAN_OPTIONS if ASAN is enabled and not already set by user
     if asan_enabled and "ASAN_OPTIONS" not in env:
@@ -530,6 +602,11 @@ def prepare_sanitizer_environment(
         env["LSAN_OPTIONS"] = DEFAULT_LSAN_OPTIONS
         logger.info(f"Injecting LSAN_OPTIONS={DEFAULT_LSAN_OPTIONS}")
 
+    # Inject XRAY_OPTIONS if XRay instrumentation is enabled and not already set
+    if detect_xray_from_flags(compiler_flags) and "XRAY_OPTIONS" not in env:
+        env["XRAY_OPTIONS"] = DEFAULT_XRAY_OPTIONS
+        logger.info(f"Injecting XRAY_OPTIONS={DEFAULT_XRAY_OPTIONS}")
+
     # Inject ASAN_SYMBOLIZER_PATH if any sanitizer is enabled and not already set
     if (asan_enabled or lsan_enabled) and "ASAN_SYMBOLIZER_PATH" not in env:
         symbolizer_path = get_symbolizer_path()
@@ -545,7 +622,7 @@ def prepare_sanitizer_environment(
 
     # On Windows, add runtime DLL paths to PATH for shared ASAN runtime
     # This ensures libclang_rt.asan_dynamic-x86_64.dll can be found at runtime
-    if asan_enabled and platform.system() == "Windows":
+    if asan_enabled and not runtime_paths_loaded and platform.system() == "Windows":
         dll_paths = get_runtime_dll_paths()
         if dll_paths:
             current_path = env.get("PATH", "")
@@ -560,7 +637,7 @@ def prepare_sanitizer_environment(
     # On Linux, add runtime library paths to LD_LIBRARY_PATH for shared ASAN runtime
     # This ensures libclang_rt.asan.so can be found at runtime when libraries
     # aren't deployed via rpath/$ORIGIN (mirrors the Windows PATH logic above)
-    if asan_enabled and platform.system() == "Linux":
+    if asan_enabled and not runtime_paths_loaded and platform.system() == "Linux":
         lib_paths = get_runtime_lib_paths()
         if lib_paths:
             current_ld_path = env.get("LD_LIBRARY_PATH", "")
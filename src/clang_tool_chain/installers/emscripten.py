@@ -119,12 +119,158 @@ class EmscriptenInstaller(BaseToolchainInstaller):
     # falsely advertise the new patch as applied.
     _WASM_LD_PATCH_MARKER_FILE = ".ctc-wasm-ld-patched.v1"
 
+    # Same scheme for the per-library cache lock patch appended to cache.py.
+    # The block's first line carries the version so an install patched with
+    # an older block gets it replaced rather than kept.
+    _CACHE_LOCK_PATCH_MARKER = "# CTC_EMCC_CACHE_LOCK_PATCH"
+    _CACHE_LOCK_PATCH_VERSION = "v3"
+    _CACHE_LOCK_PATCH_MARKER_FILE = ".ctc-cache-lock-patched.v3"
+
+    # Names the patch re-binds or relies on in emscripten/tools/cache.py. If any
+    # is missing the layout is unknown and the patch is skipped.
+    _CACHE_LOCK_PATCH_REQUIRES = ("def get(", "def lock(", "acquired_count", "cachedir", "cachelock", "filelock")
+
+    # Appended verbatim to cache.py (2-space indent to match emscripten). Inert
+    # unless CTC_EMCC_CACHE_LOCK=library, which ctc-emcc / ctc-em++ / the
+    # emtool launchers and the Python wrappers set by default. Then:
+    #   - get() stats the artifact first and returns it without any lock when
+    #     it exists (the common "is libc built?" check during every link);
+    #   - a missing system library (sysroot/lib/...) is built under its own
+    #     lock file in cache/locks/, so workers needing different libraries no
+    #     longer queue behind one another. A cache.lock holder takes it too,
+    #     so it never builds a library another worker is building;
+    #   - every other lock() reason (ports, headers, erase) takes the global
+    #     cache.lock. Lock order is global -> library. A global request nested
+    #     in a library build (where upstream's lock() is a no-op, since
+    #     acquired_count > 0) takes cache.lock only if it is free; otherwise
+    #     the build unwinds to the outermost get() and restarts with cache.lock
+    #     taken first, so it can't deadlock with a cache.lock holder waiting
+    #     for that library.
+    # Under CTC_DEBUG each acquisition reports how long it waited.
+    _CACHE_LOCK_PATCH_SOURCE = """
+
+# CTC_EMCC_CACHE_LOCK_PATCH v3: per-library cache locks (CTC_EMCC_CACHE_LOCK=library)
+def _ctc_fine_grained_locks():
+  import contextlib as _contextlib
+  import os as _os
+  import sys as _sys
+  import time as _time
+
+  if _os.environ.get('CTC_EMCC_CACHE_LOCK') != 'library':
+    return
+  global get, lock
+  global_get = get
+  global_lock = lock
+  debug = _os.environ.get('CTC_DEBUG', '') not in ('', '0')
+  building = []  # shortnames being fetched through get(), innermost last
+  libs = []  # library locks held, innermost last
+  state = {'global': 0}  # depth of global-lock holds made through this block
+
+  class NeedGlobalLock(BaseException):
+    # A global request inside a library build found cache.lock taken. Unwinds
+    # (past any `except Exception` in the build) to the outermost get().
+    pass
+
+  def report(what, t0):
+    if debug:
+      _sys.stderr.write('[ctc-emcc-debug] cache lock %s: waited %.3fs\\n' % (what, _time.monotonic() - t0))
+
+  def enter():
+    global acquired_count
+    if acquired_count == 0:
+      _os.environ['EM_CACHE_IS_LOCKED'] = '1'
+    acquired_count += 1
+
+  def leave():
+    global acquired_count
+    acquired_count -= 1
+    if acquired_count == 0:
+      _os.environ.pop('EM_CACHE_IS_LOCKED', None)
+
+  @_contextlib.contextmanager
+  def hold_global(reason, t0):
+    first = state['global'] == 0
+    state['global'] += 1
+    try:
+      with global_lock(reason):
+        if first:
+          report('(global) for ' + str(reason).replace('\\\\', '/'), t0)
+        yield
+    finally:
+      state['global'] -= 1
+
+  def fine_get(shortname, creator, *args, **kwargs):
+    force = kwargs.get('force', args[1] if len(args) > 1 else False)
+    cachename = _os.path.join(str(cachedir), str(shortname))
+    if not force and _os.path.exists(cachename):
+      return cachename
+    outermost = not libs and state['global'] == 0
+    building.append(str(shortname).replace('\\\\', '/'))
+    try:
+      return global_get(shortname, creator, *args, **kwargs)
+    except NeedGlobalLock:
+      if not outermost:
+        raise
+    finally:
+      building.pop()
+    # Restart with cache.lock held first; the library lock is then taken under
+    # it, and the artifact may meanwhile have been built by the lock holder.
+    with hold_global(shortname, _time.monotonic()):
+      return fine_get(shortname, creator, *args, **kwargs)
+
+  @_contextlib.contextmanager
+  def fine_lock(reason):
+    name = str(reason).replace('\\\\', '/')
+    is_library = bool(building) and building[-1] == name and name.startswith('sysroot/lib/')
+    t0 = _time.monotonic()
+    if not is_library and (state['global'] or not libs):
+      # Nothing held, or already under the global lock: upstream behaviour
+      with hold_global(reason, t0):
+        yield
+      return
+    if is_library:
+      lock_dir = _os.path.join(str(cachedir), 'locks')
+      _os.makedirs(lock_dir, exist_ok=True)
+      held = filelock.FileLock(_os.path.join(lock_dir, name.replace('/', '_') + '.lock'))
+      held.acquire()
+      report(name, t0)
+    else:
+      # Global request inside a library build: blocking on cache.lock here
+      # would invert the lock order, so only take it if it is free.
+      held = cachelock
+      try:
+        held.acquire(timeout=0)
+      except filelock.Timeout:
+        report('(global, nested) busy for ' + name + ', restarting under it', t0)
+        raise NeedGlobalLock()
+      report('(global, nested) for ' + name, t0)
+      state['global'] += 1
+    enter()
+    if is_library:
+      libs.append(name)
+    try:
+      yield
+    finally:
+      if is_library:
+        libs.pop()
+      else:
+        state['global'] -= 1
+      leave()
+      held.release()
+
+  get = fine_get
+  lock = fine_lock
+
+
+_ctc_fine_grained_locks()
+"""
+
     def post_extract_hook(self, install_dir: Path, platform: str, arch: str) -> None:
         """
         Custom post-extraction steps for Emscripten.
 
-        Creates clang++ on Windows, patches shared.py to honor EMCC_WASM_LD,
-        creates config file, and removes cache.
+        Creates clang++ on Windows, patches shared.py to honor EMCC_WASM_LD and
+        cache.py for per-library locks, creates config file, and removes cache.
         """
         exe_ext = ".exe" if platform == "win" else ""
         bin_dir = install_dir / "bin"
@@ -178,6 +324,10 @@ class EmscriptenInstaller(BaseToolchainInstaller):
         # without symlinking or shipping their own emscripten fork.
         self._apply_wasm_ld_patch(install_dir)
 
+        # Patch cache.py so parallel builds lock per system library instead of
+        # serializing every worker on the global cache lock.
+        self._apply_cache_lock_patch(install_dir)
+
         # CRITICAL: Remove entire cache directory to force proper header installation on first compile
         # The extracted archive may contain an incomplete or corrupted cache from the build process.
         # By removing it entirely, we ensure Emscripten's install_system_headers() runs on first use,
@@ -423,7 +573,7 @@ NODE_JS = '{node_js}'
             # Patch already present in shared.py — likely from a pre-1.5.5
             # install that pre-dates the sidecar marker. Drop the marker so the
             # next call takes the hot path and skip the (already-applied) patch.
-            self._write_marker_quietly(marker_path)
+            self._write_marker_quietly(marker_path, "EMCC_WASM_LD", "shared.py")
             logger.debug(f"shared.py already patched for EMCC_WASM_LD: {shared_py}")
             return
 
@@ -447,18 +597,71 @@ NODE_JS = '{node_js}'
         try:
             shared_py.write_text(patched, encoding="utf-8")
             logger.info(f"Applied EMCC_WASM_LD patch to {shared_py}")
-            self._write_marker_quietly(marker_path)
+            self._write_marker_quietly(marker_path, "EMCC_WASM_LD", "shared.py")
         except OSError as e:
             logger.warning(f"EMCC_WASM_LD patch skipped — could not write {shared_py}: {e}")
 
+    def _apply_cache_lock_patch(self, install_dir: Path) -> None:
+        """
+        Append the per-library lock block to emscripten/tools/cache.py.
+        Idempotent, with the same sidecar-marker hot path as _apply_wasm_ld_patch.
+
+        Background:
+          Every cache.get() upstream runs under one cache-wide file lock, so with
+          -j32 a single worker building libc++ blocks every other worker that
+          needs any system library. The appended block re-binds get() and lock()
+          at import time rather than editing their bodies, which keeps the patch
+          valid across emscripten versions whose get() signature differs.
+        """
+        marker_path = install_dir / self._CACHE_LOCK_PATCH_MARKER_FILE
+        if marker_path.exists():
+            return
+
+        cache_py = install_dir / "emscripten" / "tools" / "cache.py"
+        if not cache_py.exists():
+            logger.warning(f"Cache lock patch skipped — {cache_py} not found. emcc keeps its global cache lock.")
+            return
+
+        try:
+            content = cache_py.read_text(encoding="utf-8")
+        except OSError as e:
+            logger.warning(f"Cache lock patch skipped — could not read {cache_py}: {e}")
+            return
+
+        marker_at = content.find(self._CACHE_LOCK_PATCH_MARKER)
+        if marker_at != -1:
+            versioned = f"{self._CACHE_LOCK_PATCH_MARKER} {self._CACHE_LOCK_PATCH_VERSION}:"
+            if content.startswith(versioned, marker_at):
+                self._write_marker_quietly(marker_path, "per-library cache lock", "cache.py")
+                logger.debug(f"cache.py already patched for per-library locks: {cache_py}")
+                return
+            # An older block: it was appended last, so drop it and append this one
+            content = content[:marker_at]
+
+        missing = [name for name in self._CACHE_LOCK_PATCH_REQUIRES if name not in content]
+        if missing:
+            logger.warning(
+                f"Cache lock patch skipped — {cache_py} lacks {', '.join(missing)}. "
+                f"This usually means an unknown emscripten version. "
+                f"emcc keeps its global cache lock for this install."
+            )
+            return
+
+        try:
+            cache_py.write_text(content.rstrip("\n") + "\n" + self._CACHE_LOCK_PATCH_SOURCE, encoding="utf-8")
+            logger.info(f"Applied per-library cache lock patch to {cache_py}")
+            self._write_marker_quietly(marker_path, "per-library cache lock", "cache.py")
+        except OSError as e:
+            logger.warning(f"Cache lock patch skipped — could not write {cache_py}: {e}")
+
     @staticmethod
-    def _write_marker_quietly(marker_path: Path) -> None:
+    def _write_marker_quietly(marker_path: Path, patch: str, target: str) -> None:
         """Drop the sidecar marker. Best-effort — failures aren't fatal since
         the next call just takes the cold path and re-detects the patch."""
         try:
             marker_path.write_text(
-                "# Sidecar marker — clang-tool-chain has applied the EMCC_WASM_LD\n"
-                "# patch to emscripten/tools/shared.py. Delete this file to force a\n"
+                f"# Sidecar marker — clang-tool-chain has applied the {patch}\n"
+                f"# patch to emscripten/tools/{target}. Delete this file to force a\n"
                 "# re-check on the next ensure_emscripten_available() call.\n",
                 encoding="utf-8",
             )
@@ -620,6 +823,7 @@ def ensure_emscripten_available(platform: str, arch: str) -> None:
             # Apply the EMCC_WASM_LD patch on existing installs (idempotent — no-op once applied).
             # Covers users who installed before the patch was added to clang-tool-chain.
             _installer._apply_wasm_ld_patch(install_dir)
+            _installer._apply_cache_lock_patch(install_dir)
 
             # Emscripten is already installed and configured
             logger.info(f"Emscripten already installed and configured for {platform}/{arch}")
@@ -674,8 +878,9 @@ def ensure_emscripten_available(platform: str, arch: str) -> None:
                     f"Filesystem sync delay detected. File should be accessible when needed."
                 )
 
-            # Apply the EMCC_WASM_LD patch (idempotent) — covers existing installs.
+            # Apply the EMCC_WASM_LD and cache lock patches (idempotent) — covers existing installs.
             _installer._apply_wasm_ld_patch(install_dir)
+            _installer._apply_cache_lock_patch(install_dir)
 
             logger.info(f"Emscripten setup complete and verified for {platform}/{arch}")
             _ensure_memo.add(memo_key)
@@ -19,6 +19,9 @@ class NativeTool:
     output: str  # Primary output binary name WITHOUT extension (e.g. "ctc-clang")
     aliases: list[str] = field(default_factory=list)  # Extra names (symlinks/copies)
     std: str = "c++17"  # C++ standard
+    shared: bool = False  # Build a shared library (<output>.so/.dylib/.dll) instead of an executable
+    platforms: tuple[str, ...] = ()  # Platform names to build on ("linux", "win", "darwin"); empty = all
+    extra_flags: list[str] = field(default_factory=list)  # Extra compile/link flags for this tool
 
 
 TOOL_REGISTRY: dict[str, NativeTool] = {
@@ -108,4 +111,111 @@ TOOL_REGISTRY: dict[str, NativeTool] = {
             "ctc-emscan-deps",
         ],
     ),
+    # Build analysis: ranks headers by incremental rebuild cost from the .d
+    # files (and optional clang -H traces / .ninja_log) under a build dir.
+    "include_impact": NativeTool(
+        source="launcher_include_impact.cpp",
+        output="ctc-include-impact",
+    ),
+    # Critical path, parallelism over time and launcher-vs-compiler time of
+    # a build, from .ninja_log plus CTC_TIMING_LOG records; Perfetto trace.
+    "critical_path": NativeTool(
+        source="launcher_critical_path.cpp",
+        output="ctc-critical-path",
+    ),
+    # Parallel include-what-you-use over a compilation database with per-TU
+    # result caching; one merged report for fix_includes.py.
+    "iwyu_tool": NativeTool(
+        source="launcher_iwyu_tool.cpp",
+        output="ctc-iwyu-tool",
+    ),
+    # Size breakdown of .wasm outputs: sections, functions (name section),
+    # compile units (DWARF), data segments, imports; diffs two modules.
+    "wasm_size": NativeTool(
+        source="launcher_wasm_size.cpp",
+        output="ctc-wasm-size",
+    ),
+    # Live dashboard over the shared-memory slot table every launcher
+    # registers its in-flight invocation in (ctc_common.h Section 11).
+    "top": NativeTool(
+        source="launcher_top.cpp",
+        output="ctc-top",
+    ),
+    # Digests files/strings with the 128-bit cache-key hash (ctc_common.h
+    # Section 14) and benchmarks it against the legacy FNV-1a loop.
+    "hash": NativeTool(
+        source="launcher_hash.cpp",
+        output="ctc-hash",
+    ),
+    # Process start latency of binaries linked under each runtime profile
+    # (CLANG_TOOL_CHAIN_RUNTIME=copy / runtime-dir / static).
+    "startbench": NativeTool(
+        source="launcher_startbench.cpp",
+        output="ctc-startbench",
+        platforms=("linux",),
+    ),
+    # Build-wide optimization-remark report (opt-viewer replacement) over the
+    # records ctc-clang saves under CLANG_TOOL_CHAIN_OPT_RECORD.
+    "opt_report": NativeTool(
+        source="launcher_opt_report.cpp",
+        output="ctc-opt-report",
+    ),
+    # XRay basic-mode log converter: per-function latency histograms and
+    # trace-event JSON for CLANG_TOOL_CHAIN_XRAY=1 builds.
+    "xray": NativeTool(
+        source="launcher_xray.cpp",
+        output="ctc-xray",
+    ),
+    # Compiler-flag A/B benchmark: builds a program once per flag profile
+    # through ctc-clang++ and compares build cost and benchmark run time.
+    "flagbench": NativeTool(
+        source="launcher_flagbench.cpp",
+        output="ctc-flagbench",
+        platforms=("linux", "darwin"),
+    ),
+    # libFuzzer campaigns: builds fuzz targets through ctc-clang++ and runs
+    # parallel workers with periodic corpus merge and crash reporting.
+    "fuzz": NativeTool(
+        source="launcher_fuzz.cpp",
+        output="ctc-fuzz",
+        platforms=("linux", "darwin"),
+    ),
+    # End-to-end build benchmark: generates a synthetic C++ project and builds
+    # it through ctc-clang++ in each launcher mode (plain, deploy, directives,
+    # zccache), reporting TUs/s, link times and the launcher's share.
+    "buildbench": NativeTool(
+        source="launcher_buildbench.cpp",
+        output="ctc-buildbench",
+        platforms=("linux", "darwin"),
+    ),
+    # Compile-once runner for single-file programs and shebang scripts;
+    # the native counterpart of `clang-tool-chain-build-run --cached`.
+    "run": NativeTool(
+        source="launcher_run.cpp",
+        output="ctc-run",
+    ),
+    # Prints the sanitizer runtime environment (options, symbolizer, runtime
+    # library path) cached per toolchain, for test harnesses to load once.
+    "sanitizer_env": NativeTool(
+        source="launcher_sanitizer_env.cpp",
+        output="ctc-sanitizer-env",
+    ),
+    # LD_PRELOAD shim that turns the bundled clang into a fork server
+    # (CLANG_TOOL_CHAIN_ZYGOTE=1). ctc-clang looks for it next to itself.
+    "zygote": NativeTool(
+        source="ctc_zygote.cpp",
+        output="libctc_zygote",
+        shared=True,
+        platforms=("linux",),
+        extra_flags=["-fno-exceptions", "-fno-rtti", "-Wl,--as-needed"],
+    ),
+    # Embeddable C API (libctc.h) over clang_launcher.cpp's command
+    # computation, for build systems that would otherwise spawn ctc-clang
+    # --dry-run per file.
+    "libctc": NativeTool(
+        source="libctc.cpp",
+        output="libctc",
+        shared=True,
+        extra_flags=["-fvisibility-inlines-hidden"],
+    ),
 }
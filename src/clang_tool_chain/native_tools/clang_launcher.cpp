@@ -11,6 +11,7 @@
 #include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <climits>
 #include <functional>
 #include <mutex>
 #include <thread>
@@ -91,41 +92,11 @@ static const char* platform_directive_str(Platform p) {
 // ============================================================================
 // Section 1: Tool-specific platform helpers
 // ============================================================================
-// (path_sep, path_join, path_exists, is_directory — see ctc_common.h.)
+// (path_sep, path_join, path_exists, is_directory, list_directory — see
+//  ctc_common.h.)
 
-static std::vector<std::string> list_directory(const std::string& path) {
-    std::vector<std::string> entries;
-#ifdef _WIN32
-    std::string pattern = path + "\\*";
-    WIN32_FIND_DATAA fd;
-    HANDLE h = FindFirstFileA(pattern.c_str(), &fd);
-    if (h == INVALID_HANDLE_VALUE) return entries;
-    do {
-        std::string name = fd.cFileName;
-        if (name != "." && name != "..") entries.push_back(name);
-    } while (FindNextFileA(h, &fd));
-    FindClose(h);
-#else
-    DIR* dir = opendir(path.c_str());
-    if (!dir) return entries;
-    struct dirent* ent;
-    while ((ent = readdir(dir)) != nullptr) {
-        std::string name = ent->d_name;
-        if (name != "." && name != "..") entries.push_back(name);
-    }
-    closedir(dir);
-#endif
-    return entries;
-}
-
-// Resolves the base clang-tool-chain directory. Mirrors Python's
-// path_utils.get_home_toolchain_dir — honors CLANG_TOOL_CHAIN_DOWNLOAD_PATH
-// (the var Python actually reads) and falls back to ~/.clang-tool-chain.
-static std::string get_ctc_home_dir() {
-    const char* override_path = getenv("CLANG_TOOL_CHAIN_DOWNLOAD_PATH");
-    if (override_path && override_path[0]) return override_path;
-    return path_join(get_home_dir(), ".clang-tool-chain");
-}
+// (get_ctc_home_dir — the CLANG_TOOL_CHAIN_DOWNLOAD_PATH-aware base dir —
+//  lives in ctc_common.h.)
 
 static std::string get_dir_name(const std::string& path) {
     size_t pos = path.find_last_of("/\\");
@@ -158,21 +129,19 @@ static bool is_note_suppressed(const char* name, const char* category = nullptr)
     return env_is_truthy(env.c_str());
 }
 
+// Set by batch/in-process callers (--ctc-translate, libctc): notes describe a
+// single invocation and would just repeat per computed command.
+static std::atomic<bool> g_notes_muted{false};
+
 static void print_note(const char* name, const char* category, const char* message) {
-    if (is_note_suppressed(name, category)) return;
+    if (g_notes_muted.load(std::memory_order_relaxed) || is_note_suppressed(name, category)) return;
     fprintf(stderr, "[clang-tool-chain] %s\n", message);
 }
 
 // (read_file, write_file_atomic live in ctc_common.h.)
 
 static bool copy_file_atomic(const std::string& src, const std::string& dst) {
-    std::string tmp = dst + ".tmp." + std::to_string(
-#ifdef _WIN32
-        (int)GetCurrentProcessId()
-#else
-        (int)getpid()
-#endif
-    );
+    std::string tmp = unique_tmp_path(dst);
 #ifdef _WIN32
     if (!CopyFileA(src.c_str(), tmp.c_str(), FALSE)) return false;
     if (!MoveFileExA(tmp.c_str(), dst.c_str(), MOVEFILE_REPLACE_EXISTING)) {
@@ -335,6 +304,12 @@ struct CtcCache {
     // Cached --version output (avoids spawning clang for version queries)
     std::string version_output;
 
+    // Resolved sanitizer runtime environment (Section 8b), valid while
+    // sanitizer_fingerprint matches toolchain_fingerprint()
+    std::string sanitizer_fingerprint;
+    std::string sanitizer_lib_path;  // runtime dirs, PATH-list separated
+    std::string sanitizer_symbolizer;
+
     bool is_valid() const {
         return !clang_bin.empty() && path_exists(clang_bin);
     }
@@ -370,6 +345,9 @@ static CtcCache read_cache(const std::string& cache_path) {
         else if (key == "libunwind_lib") cache.libunwind_lib = val;
         else if (key == "macos_sdk_path") cache.macos_sdk_path = val;
         else if (key == "version_output") cache.version_output = unescape_newlines(val);
+        else if (key == "sanitizer_fingerprint") cache.sanitizer_fingerprint = val;
+        else if (key == "sanitizer_lib_path") cache.sanitizer_lib_path = val;
+        else if (key == "sanitizer_symbolizer") cache.sanitizer_symbolizer = val;
     }
     return cache;
 }
@@ -424,6 +402,11 @@ static void write_cache(const CtcCache& cache, const std::string& cache_path) {
     if (!cache.libunwind_lib.empty()) ss << "libunwind_lib=" << cache.libunwind_lib << "\n";
     if (!cache.macos_sdk_path.empty()) ss << "macos_sdk_path=" << cache.macos_sdk_path << "\n";
     if (!cache.version_output.empty()) ss << "version_output=" << escape_newlines(cache.version_output) << "\n";
+    if (!cache.sanitizer_fingerprint.empty()) {
+        ss << "sanitizer_fingerprint=" << cache.sanitizer_fingerprint << "\n";
+        ss << "sanitizer_lib_path=" << cache.sanitizer_lib_path << "\n";
+        ss << "sanitizer_symbolizer=" << cache.sanitizer_symbolizer << "\n";
+    }
     write_file_atomic(cache_path, ss.str());
 }
 
@@ -433,6 +416,16 @@ static CtcCache discover_and_write_cache(const std::string& install_dir,
     CtcCache cache;
     cache.clang_root = install_dir;
 
+    // The only slow probe is `xcrun --show-sdk-path` (a subprocess, tens of
+    // ms); overlap it with the stat() probes below. Elsewhere every probe is
+    // a single stat, cheaper than waking a thread, so they stay serial.
+    Executor probes(2);
+#ifdef __APPLE__
+    if (platform == Platform::Darwin) {
+        probes.async([&cache] { cache.macos_sdk_path = discover_macos_sdk_path(); });
+    }
+#endif
+
     std::string bin_dir = path_join(install_dir, "bin");
 #ifdef _WIN32
     cache.clang_bin = path_join(bin_dir, "clang.exe");
@@ -486,10 +479,7 @@ static CtcCache discover_and_write_cache(const std::string& install_dir,
             cache.libunwind_lib = path_join(install_dir, "lib");
         }
     } else if (platform == Platform::Darwin) {
-#ifdef __APPLE__
-        cache.macos_sdk_path = discover_macos_sdk_path();
-#endif
-        // Bundled sysroot fallback
+        // Bundled sysroot fallback (macos_sdk_path is filled in by `probes`)
         std::string sysroot_inc = path_join(install_dir, "sysroot");
         sysroot_inc = path_join(sysroot_inc, "usr");
         sysroot_inc = path_join(sysroot_inc, "include");
@@ -499,6 +489,7 @@ static CtcCache discover_and_write_cache(const std::string& install_dir,
         }
     }
 
+    probes.wait();
     write_cache(cache, cache_path);
     return cache;
 }
@@ -507,6 +498,13 @@ static CtcCache discover_and_write_cache(const std::string& install_dir,
 // Section 3: argv[0] Dispatch
 // ============================================================================
 
+// <ctc_home>/clang/<platform>/<arch> (honors CLANG_TOOL_CHAIN_DOWNLOAD_PATH)
+static std::string default_install_dir(Platform platform, Arch arch) {
+    std::string dir = path_join(get_ctc_home_dir(), "clang");
+    dir = path_join(dir, platform_str(platform));
+    return path_join(dir, arch_str(arch));
+}
+
 static CompilerMode detect_mode(const char* argv0) {
     std::string name = get_exe_basename(argv0);
     // Convert to lowercase for matching
@@ -527,6 +525,7 @@ struct ParsedArgs {
     bool no_print = false;
     bool deploy_dependencies = false;
     bool has_fsanitize_address = false;
+    bool has_fsanitize_fuzzer = false;
     bool has_shared_flag = false;
     bool user_specified_target = false;
     bool user_specified_fuse_ld = false;
@@ -551,6 +550,18 @@ static bool starts_with(const std::string& s, const std::string& prefix) {
     return s.compare(0, prefix.size(), prefix) == 0;
 }
 
+// True if `arg` is -fsanitize=<list> and the list names `name` ("address"
+// matches -fsanitize=fuzzer,address but not kernel-address).
+static bool sanitizer_list_has(const std::string& arg, const char* name) {
+    if (!starts_with(arg, "-fsanitize=")) return false;
+    std::istringstream list(arg.substr(11));
+    std::string item;
+    while (std::getline(list, item, ',')) {
+        if (item == name) return true;
+    }
+    return false;
+}
+
 static ParsedArgs parse_user_args(int argc, char* argv[]) {
     ParsedArgs p;
 
@@ -590,7 +601,8 @@ static ParsedArgs parse_user_args(int argc, char* argv[]) {
             }
         }
         if (arg == "-shared") p.has_shared_flag = true;
-        if (str_contains(arg, "-fsanitize=address")) p.has_fsanitize_address = true;
+        if (sanitizer_list_has(arg, "address")) p.has_fsanitize_address = true;
+        if (sanitizer_list_has(arg, "fuzzer")) p.has_fsanitize_fuzzer = true;
         if (starts_with(arg, "--target=")) {
             p.user_specified_target = true;
             p.target_value = arg.substr(9);  // after "--target="
@@ -639,6 +651,7 @@ static ParsedArgs parse_user_args(int argc, char* argv[]) {
 struct DirectiveResult {
     std::vector<std::string> compiler_args;
     std::vector<std::string> linker_args;
+    std::vector<std::string> pkg_config;  // @pkg-config packages, resolved by Section 5a
 };
 
 static std::string trim(const std::string& s) {
@@ -680,9 +693,16 @@ static DirectiveResult parse_directives_from_file(const std::string& filepath, P
     bool in_platform_block = false;
 
     std::string line;
+    bool first_line = true;
     while (std::getline(f, line)) {
         std::string stripped = trim(line);
 
+        // A `#!` first line (ctc-run scripts) precedes the directive block
+        if (first_line) {
+            first_line = false;
+            if (starts_with(line, "#!")) continue;
+        }
+
         // Stop at first non-comment, non-empty line
         if (!stripped.empty() && !starts_with(stripped, "//")) break;
         if (stripped.empty()) continue;
@@ -756,6 +776,12 @@ static DirectiveResult parse_directives_from_file(const std::string& filepath, P
             for (const auto& v : values) {
                 result.compiler_args.push_back("-I" + v);
             }
+        } else if (name == "pkg-config") {
+            for (const auto& v : values) {
+                std::istringstream ss(v);
+                std::string pkg;
+                while (ss >> pkg) result.pkg_config.push_back(pkg);
+            }
         }
     }
     return result;
@@ -771,10 +797,502 @@ static DirectiveResult parse_all_directives(const std::vector<std::string>& sour
                                      r.compiler_args.begin(), r.compiler_args.end());
         merged.linker_args.insert(merged.linker_args.end(),
                                    r.linker_args.begin(), r.linker_args.end());
+        merged.pkg_config.insert(merged.pkg_config.end(), r.pkg_config.begin(), r.pkg_config.end());
     }
     return merged;
 }
 
+// ============================================================================
+// Section 5a: @pkg-config Resolution
+// ============================================================================
+// `// @pkg-config: [openssl, zlib]` adds the packages' Cflags to the compile
+// and their Libs to the link. The .pc files are read directly (variables,
+// ${pcfiledir}, Requires / Requires.private closure, PKG_CONFIG_SYSROOT_DIR)
+// so a compile spawns nothing. Packages the .pc reader can't find fall back
+// to one `pkg-config` call.
+//
+// Either way the result is cached in <ctc_home>/pkg-config-cache/<key>, key =
+// (package list, PKG_CONFIG_* environment), and reused while every .pc file
+// read and every search directory keeps its size/mtime: a hit costs a few
+// stat() calls. Search directories are stamped too, so a newly installed .pc
+// that shadows a cached one is noticed.
+
+static constexpr const char* PKG_CACHE_VERSION = "pkg1";
+
+// Package names reach a shell in the fallback, so only pkg-config's own
+// alphabet is accepted.
+static bool is_pkg_name(const std::string& name) {
+    if (name.empty()) return false;
+    for (char c : name) {
+        if (!isalnum((unsigned char)c) && c != '-' && c != '_' && c != '.' && c != '+') return false;
+    }
+    return true;
+}
+
+// "size:mtime_ns" for files, "d:mtime_ns" for directories, "-" if missing.
+static std::string pkg_path_stamp(const std::string& path) {
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA fa;
+    if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &fa)) return "-";
+    uint64_t ticks = ((uint64_t)fa.ftLastWriteTime.dwHighDateTime << 32) | fa.ftLastWriteTime.dwLowDateTime;
+    if (fa.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) return "d:" + std::to_string(ticks * 100);
+    uint64_t size = ((uint64_t)fa.nFileSizeHigh << 32) | fa.nFileSizeLow;
+    return std::to_string(size) + ":" + std::to_string(ticks * 100);
+#else
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return "-";
+#ifdef __APPLE__
+    uint64_t mtime = (uint64_t)st.st_mtimespec.tv_sec * 1000000000ULL + (uint64_t)st.st_mtimespec.tv_nsec;
+#else
+    uint64_t mtime = (uint64_t)st.st_mtim.tv_sec * 1000000000ULL + (uint64_t)st.st_mtim.tv_nsec;
+#endif
+    if (S_ISDIR(st.st_mode)) return "d:" + std::to_string(mtime);
+    return std::to_string((uint64_t)st.st_size) + ":" + std::to_string(mtime);
+#endif
+}
+
+// PKG_CONFIG_PATH, then PKG_CONFIG_LIBDIR or the usual system directories.
+static std::vector<std::string> pkg_search_dirs(Platform platform, Arch arch) {
+    std::vector<std::string> dirs;
+    auto add_list = [&](const std::string& list) {
+        std::istringstream ss(list);
+        std::string dir;
+        while (std::getline(ss, dir, PATH_LIST_SEP)) {
+            if (!dir.empty()) dirs.push_back(dir);
+        }
+    };
+    add_list(get_env("PKG_CONFIG_PATH"));
+    const char* libdir = getenv("PKG_CONFIG_LIBDIR");
+    if (libdir) {
+        add_list(libdir);
+    } else if (platform == Platform::Linux) {
+        std::string multiarch = std::string("/usr/lib/") + arch_target_str(arch) + "-linux-gnu/pkgconfig";
+        for (const char* d : {"/usr/local/lib/pkgconfig", "/usr/local/share/pkgconfig"}) dirs.push_back(d);
+        dirs.push_back(multiarch);
+        for (const char* d : {"/usr/lib64/pkgconfig", "/usr/lib/pkgconfig", "/usr/share/pkgconfig"}) {
+            dirs.push_back(d);
+        }
+    } else if (platform == Platform::Darwin) {
+        for (const char* d : {"/opt/homebrew/lib/pkgconfig", "/opt/homebrew/share/pkgconfig",
+                              "/usr/local/lib/pkgconfig", "/usr/local/share/pkgconfig", "/usr/lib/pkgconfig"}) {
+            dirs.push_back(d);
+        }
+    }
+    return dirs;
+}
+
+// Package names from a Requires value: "glib-2.0 >= 2.56, zlib" -> glib-2.0, zlib
+static std::vector<std::string> parse_pc_requires(const std::string& value) {
+    std::string v = value;
+    std::replace(v.begin(), v.end(), ',', ' ');
+    std::vector<std::string> names;
+    std::istringstream ss(v);
+    std::string tok;
+    bool skip_version = false;
+    while (ss >> tok) {
+        if (tok == "=" || tok == "!=" || tok == "<" || tok == "<=" || tok == ">" || tok == ">=") {
+            skip_version = true;
+            continue;
+        }
+        if (skip_version) { skip_version = false; continue; }
+        names.push_back(tok);
+    }
+    return names;
+}
+
+struct PcFile {
+    std::string cflags, libs;
+    std::vector<std::string> requires_public, requires_private;
+};
+
+static std::string pc_expand(const std::string& s, const std::unordered_map<std::string, std::string>& vars) {
+    std::string out;
+    for (size_t i = 0; i < s.size(); i++) {
+        if (s[i] == '$' && i + 1 < s.size() && s[i + 1] == '$') {
+            out += '$';
+            i++;
+        } else if (s[i] == '$' && i + 1 < s.size() && s[i + 1] == '{') {
+            size_t end = s.find('}', i + 2);
+            if (end == std::string::npos) { out += s.substr(i); break; }
+            auto it = vars.find(s.substr(i + 2, end - i - 2));
+            if (it != vars.end()) out += it->second;
+            i = end;
+        } else {
+            out += s[i];
+        }
+    }
+    return out;
+}
+
+static PcFile parse_pc_file(const std::string& path) {
+    PcFile pc;
+    std::unordered_map<std::string, std::string> vars;
+    size_t slash = path.find_last_of("/\\");
+    vars["pcfiledir"] = slash == std::string::npos ? "." : path.substr(0, slash);
+    std::istringstream ss(read_file(path));
+    std::string line;
+    while (std::getline(ss, line)) {
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.resize(hash);
+        line = trim(line);
+        size_t i = 0;
+        while (i < line.size() && (isalnum((unsigned char)line[i]) || line[i] == '_' || line[i] == '.')) i++;
+        if (i == 0 || i >= line.size()) continue;
+        size_t sep = line.find_first_not_of(" \t", i);
+        if (sep == std::string::npos || (line[sep] != '=' && line[sep] != ':')) continue;
+        std::string key = line.substr(0, i);
+        std::string value = pc_expand(trim(line.substr(sep + 1)), vars);
+        if (line[sep] == '=') {
+            vars[key] = value;
+            continue;
+        }
+        key = to_lower(key);
+        if (key == "cflags") pc.cflags = value;
+        else if (key == "libs") pc.libs = value;
+        else if (key == "requires") pc.requires_public = parse_pc_requires(value);
+        else if (key == "requires.private") pc.requires_private = parse_pc_requires(value);
+    }
+    return pc;
+}
+
+// Flags whose value is the next token: `-framework Security` is one unit.
+static bool pkg_flag_takes_value(const std::string& flag) {
+    static const char* with_value[] = {"-framework", "-weak_framework", "-isystem", "-idirafter", "-iquote",
+                                       "-include", "-imacros", "-isysroot", "-Xlinker", "-Xclang",
+                                       "-Xpreprocessor", "-arch", "-target", "-rpath", "-u", "-I", "-L", "-D"};
+    return std::find_if(std::begin(with_value), std::end(with_value),
+                        [&](const char* f) { return flag == f; }) != std::end(with_value);
+}
+
+// Like pkgconf: drop the compiler's default -I/-L directories (which would
+// also outrank the toolchain's own headers), prefix the rest with
+// PKG_CONFIG_SYSROOT_DIR, keep the last of repeated -l so dependencies stay
+// behind their users and the first of repeated -I/-L/-D and, in Cflags, of
+// any other one-token flag. Two-token flags like `-framework X`, and other
+// Libs flags whose order can matter to the linker, are kept as written.
+static void pkg_append_flags(const std::string& value, bool libs, std::vector<std::string>& out) {
+    static const char* system_flags[] = {"-I/usr/include", "-L/usr/lib", "-L/usr/lib64", "-L/lib", "-L/lib64"};
+    bool allow_system = env_is_truthy(libs ? "PKG_CONFIG_ALLOW_SYSTEM_LIBS" : "PKG_CONFIG_ALLOW_SYSTEM_CFLAGS");
+    std::string sysroot = get_env("PKG_CONFIG_SYSROOT_DIR");
+    auto with_sysroot = [&](const std::string& path) { return path.empty() || path[0] != '/' ? path : sysroot + path; };
+    // Standalone occurrences only, never the value half of a two-token flag
+    auto standalone = [&](size_t i) { return i == 0 || !pkg_flag_takes_value(out[i - 1]); };
+
+    std::vector<std::string> tokens = split_shell(value);
+    for (size_t t = 0; t < tokens.size(); t++) {
+        std::string flag = tokens[t];
+        if (pkg_flag_takes_value(flag) && t + 1 < tokens.size()) {
+            std::string arg = tokens[++t];
+            if (flag == "-isystem" || flag == "-idirafter" || flag == "-iquote" || flag == "-I" || flag == "-L") {
+                arg = with_sysroot(arg);
+            }
+            out.push_back(flag);
+            out.push_back(arg);
+            continue;
+        }
+        if (!allow_system && std::find(std::begin(system_flags), std::end(system_flags), flag) !=
+                                 std::end(system_flags)) {
+            continue;
+        }
+        if (flag.size() > 2 && (starts_with(flag, "-I") || starts_with(flag, "-L"))) {
+            flag = flag.substr(0, 2) + with_sysroot(flag.substr(2));
+        }
+        if (libs && starts_with(flag, "-l")) {
+            for (size_t i = out.size(); i-- > 0;) {
+                if (out[i] == flag && standalone(i)) out.erase(out.begin() + (std::ptrdiff_t)i);
+            }
+        } else if (!libs || starts_with(flag, "-I") || starts_with(flag, "-L") || starts_with(flag, "-D")) {
+            bool seen = false;
+            for (size_t i = 0; i < out.size() && !seen; i++) seen = out[i] == flag && standalone(i);
+            if (seen) continue;
+        }
+        out.push_back(flag);
+    }
+}
+
+struct PkgConfigFlags {
+    std::vector<std::string> cflags, libs;
+    std::vector<std::pair<std::string, std::string>> stamps;  // path -> pkg_path_stamp
+};
+
+// Reads the packages' .pc closure. Public Requires contribute Cflags and Libs,
+// Requires.private only Cflags (no --static). A package first reached through
+// Requires.private and later publicly adds only its Libs the second time.
+// Sets `missing` to the first package with no .pc file.
+static bool resolve_pc_files(const std::vector<std::string>& packages, const std::vector<std::string>& dirs,
+                             PkgConfigFlags& out, std::string& missing) {
+    std::unordered_map<std::string, bool> visited;  // package -> libs wanted
+    std::function<bool(const std::string&, bool)> visit = [&](const std::string& pkg, bool want_libs) {
+        auto it = visited.find(pkg);
+        if (it != visited.end() && (it->second || !want_libs)) return true;
+        bool cflags_done = it != visited.end();
+        visited[pkg] = want_libs;
+        std::string pc_path;
+        for (const auto& dir : dirs) {
+            std::string candidate = path_join(dir, pkg + ".pc");
+            if (path_exists(candidate)) { pc_path = candidate; break; }
+        }
+        if (pc_path.empty()) {
+            missing = pkg;
+            return false;
+        }
+        if (!cflags_done) out.stamps.push_back({pc_path, pkg_path_stamp(pc_path)});
+        PcFile pc = parse_pc_file(pc_path);
+        if (!cflags_done) pkg_append_flags(pc.cflags, false, out.cflags);
+        if (want_libs) pkg_append_flags(pc.libs, true, out.libs);
+        for (const auto& dep : pc.requires_public) {
+            if (!visit(dep, want_libs)) return false;
+        }
+        for (const auto& dep : pc.requires_private) {
+            if (!visit(dep, false)) return false;
+        }
+        return true;
+    };
+    for (const auto& pkg : packages) {
+        if (!visit(pkg, true)) return false;
+    }
+    return true;
+}
+
+static std::string find_pkg_config_tool() {
+#ifdef _WIN32
+    std::string tool = find_in_path("pkg-config.exe");
+    if (tool.empty()) tool = find_in_path("pkgconf.exe");
+#else
+    std::string tool = find_in_path("pkg-config");
+    if (tool.empty()) tool = find_in_path("pkgconf");
+#endif
+    return tool;
+}
+
+// One `pkg-config` run per flag kind, for packages the .pc reader can't find.
+static bool resolve_pkg_config_tool(const std::vector<std::string>& packages, PkgConfigFlags& out) {
+    std::string tool = find_pkg_config_tool();
+    if (tool.empty()) return false;
+    std::string cmd = "\"" + tool + "\"";
+    for (const auto& pkg : packages) cmd += " " + pkg;
+    std::string cflags = run_capture(cmd + " --cflags");
+    std::string libs = run_capture(cmd + " --libs");
+    if (cflags.empty() && libs.empty()) return false;
+    // pkg-config already filtered system dirs and applied the sysroot
+    for (const auto& f : split_shell(trim(cflags))) out.cflags.push_back(f);
+    for (const auto& f : split_shell(trim(libs))) out.libs.push_back(f);
+    out.stamps.push_back({tool, pkg_path_stamp(tool)});
+    return true;
+}
+
+static std::string pkg_join(const std::vector<std::string>& v) {
+    std::string out;
+    for (size_t i = 0; i < v.size(); i++) out += (i ? "\t" : "") + v[i];
+    return out;
+}
+
+static std::vector<std::string> pkg_split(const std::string& s) {
+    std::vector<std::string> out;
+    std::istringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, '\t')) {
+        if (!item.empty()) out.push_back(item);
+    }
+    return out;
+}
+
+// Appends the @pkg-config packages' flags to `directives`. Unknown packages
+// are reported as a note (muted for libctc / --ctc-translate) and skipped, and
+// clang's own error names the missing header. Misses are cached too, under
+// the same stamps plus PATH (a pkg-config installed later must be found), so
+// a build full of TUs naming an absent package pays for one lookup. Safe to
+// call from several threads: cache entries are written through unique temp
+// files.
+static void resolve_pkg_config_directives(DirectiveResult& directives, Platform platform, Arch arch) {
+    if (directives.pkg_config.empty()) return;
+    std::vector<std::string> packages;
+    for (const auto& pkg : directives.pkg_config) {
+        if (!is_pkg_name(pkg)) {
+            print_note("PKG_CONFIG", "DIRECTIVE", ("@pkg-config: invalid package name '" + pkg + "'").c_str());
+            continue;
+        }
+        if (std::find(packages.begin(), packages.end(), pkg) == packages.end()) packages.push_back(pkg);
+    }
+    directives.pkg_config.clear();
+    if (packages.empty()) return;
+    bool verbose = env_is_truthy("CLANG_TOOL_CHAIN_DIRECTIVE_VERBOSE") &&
+                   !g_notes_muted.load(std::memory_order_relaxed);
+    std::string names = pkg_join(packages);
+    std::replace(names.begin(), names.end(), '\t', ' ');
+
+    std::vector<std::string> dirs = pkg_search_dirs(platform, arch);
+    std::vector<std::string> key_parts = {PKG_CACHE_VERSION, platform_str(platform), arch_str(arch)};
+    key_parts.insert(key_parts.end(), packages.begin(), packages.end());
+    for (const char* var : {"PKG_CONFIG_PATH", "PKG_CONFIG_LIBDIR", "PKG_CONFIG_SYSROOT_DIR",
+                            "PKG_CONFIG_ALLOW_SYSTEM_CFLAGS", "PKG_CONFIG_ALLOW_SYSTEM_LIBS"}) {
+        const char* v = getenv(var);
+        key_parts.push_back(v ? std::string("=") + v : "unset");
+    }
+    std::string cache_dir = path_join(get_ctc_home_dir(), "pkg-config-cache");
+    std::string entry_path = path_join(cache_dir, hash128_parts(key_parts).hex());
+
+    PkgConfigFlags flags;
+    auto apply = [&](const char* how) {
+        if (verbose) fprintf(stderr, "[clang-tool-chain] @pkg-config %s: %s\n", names.c_str(), how);
+        directives.compiler_args.insert(directives.compiler_args.end(), flags.cflags.begin(), flags.cflags.end());
+        directives.linker_args.insert(directives.linker_args.end(), flags.libs.begin(), flags.libs.end());
+    };
+    auto note_missing = [&](const std::string& missing) {
+        std::string msg = "@pkg-config: package '" + missing + "' not found (searched PKG_CONFIG_PATH and " +
+                          (getenv("PKG_CONFIG_LIBDIR") ? "PKG_CONFIG_LIBDIR" : "the system .pc directories") + ")";
+        print_note("PKG_CONFIG", "DIRECTIVE", msg.c_str());
+    };
+    auto store = [&](std::string content) {
+        for (const auto& dir : dirs) flags.stamps.push_back({dir, pkg_path_stamp(dir)});
+        content += "stamps=" + std::to_string(flags.stamps.size()) + "\n";
+        for (size_t i = 0; i < flags.stamps.size(); i++) {
+            content += "stamp." + std::to_string(i) + "=" + flags.stamps[i].second + "\t" + flags.stamps[i].first +
+                       "\n";
+        }
+        make_directory(get_ctc_home_dir());
+        make_directory(cache_dir);
+        write_file_atomic(entry_path, content);
+    };
+
+    // 1. Cached result, valid while every stamped path is unchanged
+    auto entry = parse_kv_cache(read_file(entry_path));
+    auto stamp_count = entry.find("stamps");
+    if (stamp_count != entry.end()) {
+        bool fresh = true;
+        int n = atoi(stamp_count->second.c_str());
+        for (int i = 0; i < n && fresh; i++) {
+            auto it = entry.find("stamp." + std::to_string(i));
+            size_t tab = it == entry.end() ? std::string::npos : it->second.find('\t');
+            fresh = tab != std::string::npos && pkg_path_stamp(it->second.substr(tab + 1)) == it->second.substr(0, tab);
+        }
+        auto missing = entry.find("missing");
+        if (fresh && missing != entry.end() && entry["path"] == get_env("PATH")) {
+            note_missing(missing->second);
+            return;
+        }
+        if (fresh && missing == entry.end()) {
+            flags.cflags = pkg_split(entry["cflags"]);
+            flags.libs = pkg_split(entry["libs"]);
+            apply("cached");
+            return;
+        }
+    }
+
+    // 2. .pc files, else one pkg-config run
+    const char* how = "read .pc files";
+    std::string missing;
+    if (!resolve_pc_files(packages, dirs, flags, missing)) {
+        // The .pc files found so far stay stamped: editing one can drop the
+        // Requires that named the missing package.
+        std::vector<std::pair<std::string, std::string>> pc_stamps = std::move(flags.stamps);
+        flags = PkgConfigFlags();
+        how = "pkg-config";
+        if (!resolve_pkg_config_tool(packages, flags)) {
+            flags.stamps = std::move(pc_stamps);
+            std::string tool = find_pkg_config_tool();
+            if (!tool.empty()) flags.stamps.push_back({tool, pkg_path_stamp(tool)});
+            store("packages=" + names + "\nmissing=" + missing + "\npath=" + get_env("PATH") + "\n");
+            note_missing(missing);
+            return;
+        }
+    }
+    store("packages=" + names + "\ncflags=" + pkg_join(flags.cflags) + "\nlibs=" + pkg_join(flags.libs) + "\n");
+    apply(how);
+}
+
+// ============================================================================
+// Section 5b: Runtime Profile (CLANG_TOOL_CHAIN_RUNTIME)
+// ============================================================================
+//   copy         (default) --deploy-dependencies copies the runtimes an
+//                output needs next to it (Section 8)
+//   runtime-dir  Linux: runtimes are published once into a versioned
+//                directory per toolchain and every link gets an rpath to it
+//                (then $ORIGIN), so repeated links copy nothing (Section 8c)
+//   static       Linux: libc++/libc++abi/libunwind and the sanitizer runtimes
+//                are linked statically (6.10); outputs need no deployment and
+//                skip the dynamic loader's search for them at every start
+
+enum class RuntimeMode { Copy, RuntimeDir, Static };
+
+static RuntimeMode runtime_mode() {
+    std::string v = to_lower(get_env("CLANG_TOOL_CHAIN_RUNTIME"));
+    if (v == "runtime-dir") return RuntimeMode::RuntimeDir;
+    if (v == "static") return RuntimeMode::Static;
+    return RuntimeMode::Copy;
+}
+
+// Static archive `name` (e.g. "libunwind.a") in the toolchain's lib dir or its
+// per-target runtime subdirectory; empty when the install doesn't ship one.
+static std::string find_static_runtime(const CtcCache& cache, Arch arch, const char* name) {
+    std::string lib_dir = path_join(cache.clang_root, "lib");
+    std::string target_dir = path_join(lib_dir, std::string(arch_target_str(arch)) + "-unknown-linux-gnu");
+    for (const auto& dir : {target_dir, lib_dir}) {
+        std::string p = path_join(dir, name);
+        if (path_exists(p)) return p;
+    }
+    return "";
+}
+
+// Identity of the installed toolchain: the install path and the clang
+// binary's size and mtime, so an upgrade in place changes it.
+static std::string toolchain_fingerprint(const CtcCache& cache) {
+    std::vector<std::string> parts = {cache.clang_root, cache.resource_dir};
+#ifndef _WIN32
+    struct stat st;
+    if (stat(cache.clang_bin.c_str(), &st) == 0) {
+        parts.push_back(std::to_string((long long)st.st_size));
+        parts.push_back(std::to_string((long long)st.st_mtime));
+    }
+#endif
+    return hash128_parts(parts).hex().substr(0, 16);
+}
+
+// <ctc_home>/runtime/<platform>-<arch>-<fingerprint> (base overridable with
+// CLANG_TOOL_CHAIN_RUNTIME_DIR). A toolchain upgrade gets a fresh directory
+// and binaries linked against the old one keep working.
+static std::string versioned_runtime_dir(const CtcCache& cache, Platform platform, Arch arch) {
+    std::string base = get_env("CLANG_TOOL_CHAIN_RUNTIME_DIR");
+    if (base.empty()) base = path_join(get_ctc_home_dir(), "runtime");
+    std::string name = std::string(platform_str(platform)) + "-" + arch_str(arch) + "-" + toolchain_fingerprint(cache);
+    return path_join(base, name);
+}
+
+// ============================================================================
+// Section 5c: XRay Function Tracing (CLANG_TOOL_CHAIN_XRAY=1)
+// ============================================================================
+// Compiles get -fxray-instrument (plus -fxray-instruction-threshold from
+// CLANG_TOOL_CHAIN_XRAY_THRESHOLD), links get it too so the driver pulls in the
+// bundled runtime. compiler-rt ships XRay as static archives only, so there is
+// nothing to deploy; a toolchain without them links uninstrumented (6.12).
+// Programs run through ctc-run or build-run get XRAY_OPTIONS for basic-mode
+// logs that ctc-xray converts.
+
+// XRAY_OPTIONS for running an instrumented program: patch the sleds before
+// main and write a basic-mode log (xray-log.<program>.<suffix> in the working
+// directory). Matches DEFAULT_XRAY_OPTIONS in execution/sanitizer_env.py.
+static constexpr const char* XRAY_DEFAULT_OPTIONS = "patch_premain=true xray_mode=xray-basic";
+
+// libclang_rt.xray.a in the per-target runtime dir, or the older
+// lib/linux/libclang_rt.xray-<arch>.a layout; empty when not installed.
+static std::string find_xray_runtime(const CtcCache& cache, Arch arch) {
+    if (cache.resource_dir.empty()) return "";
+    std::string rt_lib = path_join(cache.resource_dir, "lib");
+    std::string target = arch_target_str(arch);
+    for (const auto& p : {path_join(path_join(rt_lib, target + "-unknown-linux-gnu"), "libclang_rt.xray.a"),
+                          path_join(path_join(rt_lib, "linux"), "libclang_rt.xray-" + target + ".a")}) {
+        if (path_exists(p)) return p;
+    }
+    return "";
+}
+
+static bool has_xray_flag(const std::vector<std::string>& args) {
+    for (const auto& arg : args) {
+        if (arg == "-fxray-instrument" || arg == "-fno-xray-instrument") return true;
+    }
+    return false;
+}
+
 // ============================================================================
 // Section 6: Platform-Specific Flag Injection
 // ============================================================================
@@ -834,7 +1352,9 @@ static std::vector<std::string> build_platform_flags(
             flags.push_back("-I" + cache.libunwind_include);
             if (!compile_only && !cache.libunwind_lib.empty()) {
                 flags.push_back("-L" + cache.libunwind_lib);
-                flags.push_back("-Wl,-rpath," + cache.libunwind_lib);
+                if (runtime_mode() != RuntimeMode::Static) {
+                    flags.push_back("-Wl,-rpath," + cache.libunwind_lib);
+                }
             }
         }
     }
@@ -958,8 +1478,10 @@ static std::vector<std::string> build_platform_flags(
         args = std::move(new_args);
     }
 
+    bool static_runtime = platform == Platform::Linux && runtime_mode() == RuntimeMode::Static;
+
     // --- 6.7: ASAN runtime injection (priority 250) ---
-    if (parsed.has_fsanitize_address && !is_feature_disabled("SHARED_ASAN") &&
+    if (parsed.has_fsanitize_address && !is_feature_disabled("SHARED_ASAN") && !static_runtime &&
         (platform == Platform::Linux || platform == Platform::Windows)) {
         flags.push_back("-shared-libasan");
         print_note("SHARED_ASAN", "SANITIZER",
@@ -971,10 +1493,14 @@ static std::vector<std::string> build_platform_flags(
         }
     }
 
-    // --- 6.8: RPath for --deploy-dependencies (priority 275) ---
-    if (platform == Platform::Linux && parsed.deploy_dependencies &&
-        !compile_only && !is_feature_disabled("RPATH")) {
-        flags.push_back("-Wl,-rpath,$ORIGIN");
+    // --- 6.8: RPath for --deploy-dependencies / runtime-dir profile (priority 275) ---
+    if (platform == Platform::Linux && !compile_only && !static_runtime && !is_feature_disabled("RPATH")) {
+        bool runtime_dir = runtime_mode() == RuntimeMode::RuntimeDir;
+        if (runtime_dir) {
+            flags.push_back("-Wl,-rpath," + versioned_runtime_dir(cache, platform, arch));
+        }
+        // $ORIGIN last: a fallback for binaries moved off this machine
+        if (runtime_dir || parsed.deploy_dependencies) flags.push_back("-Wl,-rpath,$ORIGIN");
     }
 
     // --- 6.9: Windows GNU ABI (priority 300) ---
@@ -1025,6 +1551,85 @@ static std::vector<std::string> build_platform_flags(
         }
     }
 
+    // --- 6.10: Static runtime profile (priority 310) ---
+    // -static-libstdc++ / -static-libgcc make the driver pick libc++.a (with
+    // libc++abi) and libunwind.a (or libgcc_eh) itself; explicit -l flags for
+    // the same runtimes are replaced by the archive paths so the linker cannot
+    // prefer the .so next to them. Sanitizers: static is the Linux default
+    // once 6.7 stays out of the way; -static-libsan makes it explicit.
+    if (static_runtime && !compile_only) {
+        flags.push_back("-static-libstdc++");
+        flags.push_back("-static-libgcc");
+        static const char* pinned[] = {"c++", "c++abi", "unwind"};
+        for (auto& arg : parsed.filtered_args) {
+            for (const char* lib : pinned) {
+                if (arg != std::string("-l") + lib) continue;
+                std::string archive = find_static_runtime(cache, arch, (std::string("lib") + lib + ".a").c_str());
+                if (!archive.empty()) arg = archive;
+                break;
+            }
+        }
+        bool has_sanitizer = false, user_libsan = false;
+        for (const auto& arg : parsed.filtered_args) {
+            if (starts_with(arg, "-fsanitize=")) has_sanitizer = true;
+            if (arg == "-shared-libsan" || arg == "-shared-libasan" || arg == "-static-libsan") user_libsan = true;
+        }
+        if (has_sanitizer && !user_libsan) flags.push_back("-static-libsan");
+    }
+
+    // --- 6.11: Optimization records for ctc-opt-report (priority 320) ---
+    // CLANG_TOOL_CHAIN_OPT_RECORD=yaml|bitstream (1 = yaml): compiles save their
+    // remarks next to their object (<obj>.opt.yaml, clang's default), or in
+    // CLANG_TOOL_CHAIN_OPT_RECORD_DIR under the output path as written, with
+    // separators flattened (no getcwd: --ctc-translate shares this code). PGO
+    // builds also record hotness.
+    std::string opt_record = get_env("CLANG_TOOL_CHAIN_OPT_RECORD");
+    if (!opt_record.empty() && opt_record != "0" && compile_only && !parsed.source_files.empty()) {
+        bool emits_code = false, user_record = false, pgo = false;
+        for (const auto& arg : parsed.filtered_args) {
+            if (arg == "-c" || arg == "-S") emits_code = true;
+            if (arg == "-E" || arg == "-M" || arg == "-MM" || arg == "-fsyntax-only") user_record = true;
+            if (starts_with(arg, "-fsave-optimization-record") || starts_with(arg, "-foptimization-record-file")) {
+                user_record = true;
+            }
+            if (starts_with(arg, "-fprofile-use") || starts_with(arg, "-fprofile-instr-use") ||
+                starts_with(arg, "-fprofile-sample-use")) {
+                pgo = true;
+            }
+        }
+        if (emits_code && !user_record) {
+            std::string format = opt_record == "bitstream" ? "bitstream" : "yaml";
+            flags.push_back("-fsave-optimization-record=" + format);
+            std::string dir = get_env("CLANG_TOOL_CHAIN_OPT_RECORD_DIR");
+            if (!dir.empty() && parsed.source_files.size() == 1) {
+                const std::string& target = !parsed.output_path.empty() ? parsed.output_path : parsed.source_files[0];
+                std::string name;
+                for (char c : target) name += (c == '/' || c == '\\' || c == ':') ? '_' : c;
+                while (!name.empty() && name[0] == '_') name.erase(0, 1);
+                make_directory(dir);
+                flags.push_back("-foptimization-record-file=" + path_join(dir, name + ".opt." + format));
+            }
+            if (pgo) flags.push_back("-fdiagnostics-show-hotness");
+        }
+    }
+
+    // --- 6.12: XRay function tracing (priority 330) ---
+    // Explicit -f[no-]xray-instrument from the user wins. The driver links the
+    // runtime for executables only; shared libraries just carry their sleds.
+    if (platform == Platform::Linux && env_is_truthy("CLANG_TOOL_CHAIN_XRAY") &&
+        !has_xray_flag(parsed.filtered_args)) {
+        if (compile_only || !find_xray_runtime(cache, arch).empty()) {
+            flags.push_back("-fxray-instrument");
+            std::string threshold = get_env("CLANG_TOOL_CHAIN_XRAY_THRESHOLD");
+            if (!threshold.empty() && !parsed.source_files.empty()) {
+                flags.push_back("-fxray-instruction-threshold=" + threshold);
+            }
+        } else {
+            print_note("XRAY_RUNTIME", "XRAY",
+                       "XRay runtime (libclang_rt.xray) not found in this toolchain; linking without it");
+        }
+    }
+
     return flags;
 }
 
@@ -1116,6 +1721,104 @@ static void normalize_windows_paths(std::vector<std::string>& cmd) {
 }
 #endif
 
+// ============================================================================
+// Section 7c: Batch Translation (--ctc-translate)
+// ============================================================================
+// `ctc-clang --ctc-translate compile_commands.json [-o out.json]` rewrites a
+// whole compilation database to the commands ctc-clang would exec, in one
+// process: each entry goes through the same parse_user_args /
+// directives / build_platform_flags / build_final_command path as a
+// --dry-run. Entries are translated in parallel and written in input order.
+
+static constexpr size_t TRANSLATE_BATCH = 64;  // entries per executor task
+
+// (is_absolute_path lives in ctc_common.h.)
+
+// The command ctc-clang would exec for `args` (args[0] picks clang vs
+// clang++ like argv[0] does), run from `directory`. Pure function of its
+// inputs and the environment: safe to call from several threads at once.
+static std::vector<std::string> compute_final_command(const CtcCache& cache, std::vector<std::string> args,
+                                                      const std::string& directory, Platform platform,
+                                                      Arch arch) {
+    CompilerMode mode = detect_mode(args[0].c_str());
+    std::vector<char*> argv;
+    for (auto& a : args) argv.push_back(&a[0]);
+    ParsedArgs parsed = parse_user_args((int)argv.size(), argv.data());
+
+    // Directive sources are relative to `directory`, not our cwd. Parsed
+    // serially: batch callers already spread commands over threads.
+    DirectiveResult directives;
+    if (!is_feature_disabled("DIRECTIVES")) {
+        for (const auto& src : parsed.source_files) {
+            std::string path = is_absolute_path(src) || directory.empty() ? src : path_join(directory, src);
+            if (!path_exists(path)) continue;
+            DirectiveResult r = parse_directives_from_file(path, platform);
+            directives.compiler_args.insert(directives.compiler_args.end(),
+                                            r.compiler_args.begin(), r.compiler_args.end());
+            directives.linker_args.insert(directives.linker_args.end(),
+                                          r.linker_args.begin(), r.linker_args.end());
+            directives.pkg_config.insert(directives.pkg_config.end(), r.pkg_config.begin(), r.pkg_config.end());
+        }
+        resolve_pkg_config_directives(directives, platform, arch);
+    }
+
+    auto platform_flags = build_platform_flags(cache, parsed, mode, platform, arch);
+    const std::string& clang_bin = (mode == CompilerMode::CXX) ? cache.clangpp_bin : cache.clang_bin;
+    auto cmd = build_final_command(clang_bin, platform_flags, directives, parsed.filtered_args);
+#ifdef _WIN32
+    normalize_windows_paths(cmd);
+#endif
+    return cmd;
+}
+
+static int run_translate(const std::string& input, const std::string& output, const CtcCache& cache,
+                         Platform platform, Arch arch, bool debug) {
+    auto t0 = std::chrono::steady_clock::now();
+    MappedFile db;
+    if (!db.open(input)) {
+        fprintf(stderr, "%sCannot read compilation database: %s\n", CTC_TAG, input.c_str());
+        return 1;
+    }
+    std::vector<CompileCommand> entries;
+    CompileDbReader reader(reinterpret_cast<const char*>(db.data()), db.size());
+    CompileCommand entry;
+    while (reader.next(entry)) entries.push_back(std::move(entry));
+    if (!reader.error().empty()) {
+        fprintf(stderr, "%s%s: %s\n", CTC_TAG, input.c_str(), reader.error().c_str());
+        return 1;
+    }
+
+    g_notes_muted = true;
+    std::vector<std::string> json(entries.size());
+    size_t batches = (entries.size() + TRANSLATE_BATCH - 1) / TRANSLATE_BATCH;
+    parallel_for(batches, [&](size_t b) {
+        size_t end = std::min(entries.size(), (b + 1) * TRANSLATE_BATCH);
+        for (size_t i = b * TRANSLATE_BATCH; i < end; i++) {
+            entries[i].arguments = compute_final_command(cache, std::move(entries[i].arguments),
+                                                         entries[i].directory, platform, arch);
+            json[i] = compile_command_json(entries[i]);
+        }
+    });
+
+    std::string out = "[\n";
+    for (size_t i = 0; i < json.size(); i++) {
+        out += json[i];
+        out += i + 1 < json.size() ? ",\n" : "\n";
+    }
+    out += "]\n";
+    if (output.empty() || output == "-") {
+        fwrite(out.data(), 1, out.size(), stdout);
+    } else if (!write_file_atomic(output, out)) {
+        fprintf(stderr, "%sCannot write %s\n", CTC_TAG, output.c_str());
+        return 1;
+    }
+    if (debug) {
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        fprintf(stderr, "[ctc-debug] translated %zu entries in %.1f ms\n", entries.size(), ms);
+    }
+    return 0;
+}
+
 // ============================================================================
 // Section 8: Shared Library Deployment
 // ============================================================================
@@ -1462,90 +2165,484 @@ static void deploy_shared_libs(const CtcCache& cache, const std::string& output_
 // Section 8b: Sanitizer Environment Setup
 // ============================================================================
 
-// Set up ASAN_OPTIONS, LSAN_OPTIONS, ASAN_SYMBOLIZER_PATH, and PATH (Windows)
-// to ensure ASAN-instrumented executables run correctly with good stack traces.
+// Runtime defaults, matching execution/sanitizer_env.py. LeakSanitizer is
+// not supported on Windows, so detect_leaks (and LSAN_OPTIONS) stay off there.
+#ifdef _WIN32
+static constexpr const char* SANITIZER_ASAN_OPTIONS = "fast_unwind_on_malloc=0:symbolize=1";
+static constexpr const char* RUNTIME_PATH_VAR = "PATH";
+#else
+static constexpr const char* SANITIZER_ASAN_OPTIONS = "fast_unwind_on_malloc=0:symbolize=1:detect_leaks=1";
+static constexpr const char* RUNTIME_PATH_VAR = "LD_LIBRARY_PATH";
+#endif
+static constexpr const char* SANITIZER_LSAN_OPTIONS = "fast_unwind_on_malloc=0:symbolize=1";
+static constexpr const char* SANITIZER_UBSAN_OPTIONS = "print_stacktrace=1:symbolize=1";
+
+// Exported by ctc-sanitizer-env (value: the toolchain fingerprint) so later
+// processes know the runtime path is already in the environment.
+static constexpr const char* SANITIZER_ENV_MARKER = "CTC_SANITIZER_ENV";
+
+// Fills cache.sanitizer_* (runtime dirs for PATH / LD_LIBRARY_PATH and the
+// bundled llvm-symbolizer) once per toolchain fingerprint and persists them
+// in the launcher cache, so an ASAN link costs one stat() instead of a walk
+// over the compiler-rt directories. `cache_path` empty = don't persist.
+static void resolve_sanitizer_env(CtcCache& cache, const std::string& cache_path, Platform platform,
+                                  bool refresh = false) {
+    std::string fingerprint = toolchain_fingerprint(cache);
+    if (!refresh && cache.sanitizer_fingerprint == fingerprint) return;
+
+    std::vector<std::string> dirs;
+    if (platform == Platform::Windows) {
+        std::string clang_bin_dir = path_join(cache.clang_root, "bin");
+        if (is_directory(clang_bin_dir)) dirs.push_back(clang_bin_dir);
+        if (!cache.sysroot_bin.empty() && is_directory(cache.sysroot_bin)) dirs.push_back(cache.sysroot_bin);
+    } else {
+        dirs = build_lib_search_dirs(path_join(cache.clang_root, "lib"), cache.resource_dir, platform);
+    }
+    cache.sanitizer_lib_path.clear();
+    for (const auto& dir : dirs) {
+        if (!cache.sanitizer_lib_path.empty()) cache.sanitizer_lib_path += PATH_LIST_SEP;
+        cache.sanitizer_lib_path += dir;
+    }
+#ifdef _WIN32
+    std::string symbolizer = path_join(path_join(cache.clang_root, "bin"), "llvm-symbolizer.exe");
+#else
+    std::string symbolizer = path_join(path_join(cache.clang_root, "bin"), "llvm-symbolizer");
+#endif
+    cache.sanitizer_symbolizer = path_exists(symbolizer) ? symbolizer : "";
+    cache.sanitizer_fingerprint = fingerprint;
+    if (!cache_path.empty()) write_cache(cache, cache_path);
+}
+
+// Set up ASAN_OPTIONS, LSAN_OPTIONS, ASAN/UBSAN_SYMBOLIZER_PATH, and PATH
+// (Windows) to ensure ASAN-instrumented executables run correctly with good
+// stack traces. libFuzzer targets without ASAN (-fsanitize=fuzzer alone, or
+// with UBSAN) still symbolize their crash stacks, so they get the symbolizer
+// only; UBSAN reads UBSAN_SYMBOLIZER_PATH, not the ASAN one.
 // Only modifies env vars that are not already set (user config takes priority).
-static void setup_sanitizer_environment(const CtcCache& cache, bool has_asan,
-                                         [[maybe_unused]] Platform platform) {
+static void setup_sanitizer_environment(CtcCache& cache, const std::string& cache_path, bool has_asan,
+                                        bool has_fuzzer, Platform platform) {
     if (is_feature_disabled("SANITIZER_ENV")) return;
-    if (!has_asan) return;
+    if (!has_asan && !has_fuzzer) return;
+    resolve_sanitizer_env(cache, cache_path, platform);
 
     // ASAN_OPTIONS: improve stack traces from dlopen'd shared libraries
-    if (get_env("ASAN_OPTIONS").empty()) {
-#ifdef _WIN32
-        // LeakSanitizer is NOT supported on Windows
-        set_env("ASAN_OPTIONS", "fast_unwind_on_malloc=0:symbolize=1");
-#else
-        set_env("ASAN_OPTIONS", "fast_unwind_on_malloc=0:symbolize=1:detect_leaks=1");
-#endif
+    if (has_asan && get_env("ASAN_OPTIONS").empty()) {
+        set_env("ASAN_OPTIONS", SANITIZER_ASAN_OPTIONS);
         print_note("ASAN_OPTIONS", "SANITIZER",
                    "Injected ASAN_OPTIONS for better stack traces "
                    "(suppress: CLANG_TOOL_CHAIN_NO_SANITIZER_ENV=1)");
     }
 
     // LSAN_OPTIONS: improve leak sanitizer stack traces
-    if (get_env("LSAN_OPTIONS").empty()) {
 #ifndef _WIN32
-        // LSAN only supported on Linux/macOS
-        set_env("LSAN_OPTIONS", "fast_unwind_on_malloc=0:symbolize=1");
+    if (has_asan && get_env("LSAN_OPTIONS").empty()) set_env("LSAN_OPTIONS", SANITIZER_LSAN_OPTIONS);
 #endif
+
+    // ASAN_SYMBOLIZER_PATH / UBSAN_SYMBOLIZER_PATH: point to bundled llvm-symbolizer
+    for (const char* var : {"ASAN_SYMBOLIZER_PATH", "UBSAN_SYMBOLIZER_PATH"}) {
+        if (get_env(var).empty() && !cache.sanitizer_symbolizer.empty()) set_env(var, cache.sanitizer_symbolizer);
     }
+    if (!has_asan) return;  // no shared sanitizer runtime to locate
 
-    // ASAN_SYMBOLIZER_PATH: point to bundled llvm-symbolizer
-    if (get_env("ASAN_SYMBOLIZER_PATH").empty()) {
-        std::string bin_dir = path_join(cache.clang_root, "bin");
-#ifdef _WIN32
-        std::string symbolizer = path_join(bin_dir, "llvm-symbolizer.exe");
-#else
-        std::string symbolizer = path_join(bin_dir, "llvm-symbolizer");
+    // Runtime dirs on PATH (Windows: ASAN DLLs) or LD_LIBRARY_PATH (the
+    // shared ASAN .so) as a fallback when rpath/$ORIGIN deployment isn't
+    // available. Skipped when ctc-sanitizer-env already put them there.
+    if (cache.sanitizer_lib_path.empty() || get_env(SANITIZER_ENV_MARKER) == cache.sanitizer_fingerprint) return;
+    std::string current = get_env(RUNTIME_PATH_VAR);
+    set_env(RUNTIME_PATH_VAR, current.empty() ? cache.sanitizer_lib_path
+                                              : cache.sanitizer_lib_path + PATH_LIST_SEP + current);
+}
+
+// ============================================================================
+// Section 8c: Versioned Runtime Directory (CLANG_TOOL_CHAIN_RUNTIME=runtime-dir)
+// ============================================================================
+// Publishes every toolchain runtime an output might load (libc++, libc++abi,
+// libunwind, compiler-rt sanitizer .so's) into versioned_runtime_dir() once.
+// The directory is assembled under a temporary name and renamed into place
+// only when every runtime made it in, so concurrent first links race
+// harmlessly and a present directory is always complete: after the first link
+// this costs one stat(). When it can't be published the link falls back to
+// the copy profile (Section 8).
+
+#ifndef _WIN32
+static bool is_published_runtime(const std::string& name) {
+    if (!str_contains(name, ".so")) return false;
+    return starts_with(name, "libc++") || starts_with(name, "libunwind") ||
+           starts_with(name, "libclang_rt.");
+}
+
+// The temp dir only ever holds files and symlinks.
+static void remove_runtime_tmp(const std::string& tmp) {
+    for (const auto& name : list_directory(tmp)) std::remove(path_join(tmp, name).c_str());
+    rmdir(tmp.c_str());
+}
+
+// True when the runtime dir exists (already, or published now).
+static bool publish_runtime_dir(const CtcCache& cache, Platform platform, Arch arch, bool debug) {
+    std::string dir = versioned_runtime_dir(cache, platform, arch);
+    if (is_directory(dir)) return true;
+
+    std::string parent = get_dir_name(dir);
+    std::string base = get_dir_name(parent);
+    if (!base.empty()) mkdir(base.c_str(), 0755);
+    mkdir(parent.c_str(), 0755);
+    std::string tmp = dir + ".tmp." + std::to_string((int)getpid());
+    if (!is_directory(parent) || mkdir(tmp.c_str(), 0755) != 0) {
+        fprintf(stderr, "%sWarning: cannot create runtime dir %s (%s); deploying by copy\n", CTC_TAG,
+                dir.c_str(), strerror(errno));
+        return false;
+    }
+
+    auto search_dirs = build_lib_search_dirs(path_join(cache.clang_root, "lib"), cache.resource_dir, platform);
+    size_t published = 0;
+    std::string failed;
+    for (const auto& src_dir : search_dirs) {
+        for (const auto& name : list_directory(src_dir)) {
+            if (!is_published_runtime(name)) continue;
+            std::string src = path_join(src_dir, name);
+            std::string dst = path_join(tmp, name);
+            if (path_exists(dst)) continue;  // first search dir wins, as in deploy_shared_libs
+            // Keep soname symlinks as symlinks; hardlink files when the
+            // runtime dir shares a filesystem with the toolchain, else copy.
+            struct stat st;
+            bool found = lstat(src.c_str(), &st) == 0;
+            bool ok = false;
+            if (found && S_ISLNK(st.st_mode)) {
+                char target[4096];
+                ssize_t n = readlink(src.c_str(), target, sizeof(target) - 1);
+                if (n > 0) {
+                    target[n] = '\0';
+                    ok = symlink(target, dst.c_str()) == 0;
+                }
+            } else if (found && S_ISREG(st.st_mode)) {
+                ok = link(src.c_str(), dst.c_str()) == 0 || copy_file_atomic(src, dst);
+            }
+            if (ok) {
+                published++;
+            } else if (failed.empty()) {
+                failed = src;
+            }
+        }
+    }
+
+    if (published == 0 || !failed.empty()) {
+        remove_runtime_tmp(tmp);
+        fprintf(stderr, "%sWarning: runtime dir %s not published (%s); deploying by copy\n", CTC_TAG, dir.c_str(),
+                failed.empty() ? "no runtimes found" : ("cannot copy " + failed).c_str());
+        return false;
+    }
+    if (rename(tmp.c_str(), dir.c_str()) != 0) {
+        // Another link published it first; ours is redundant.
+        remove_runtime_tmp(tmp);
+        return is_directory(dir);
+    }
+    if (debug) fprintf(stderr, "[ctc-debug] published %zu runtime file(s) to %s\n", published, dir.c_str());
+    return true;
+}
 #endif
-        if (path_exists(symbolizer)) {
-            set_env("ASAN_SYMBOLIZER_PATH", symbolizer);
+
+// ============================================================================
+// Section 8d: Hierarchical Pre-linking (CLANG_TOOL_CHAIN_PRELINK=1)
+// ============================================================================
+// Large links re-read and re-resolve every object on every relink, even when
+// most of them sit in directories nobody touched. With CLANG_TOOL_CHAIN_PRELINK
+// a Linux lld link groups its .o inputs by directory, and each group holding
+// at least CLANG_TOOL_CHAIN_PRELINK_MIN members (default 8) that was unchanged
+// since the previous link of the same output is replaced by one relocatable
+// object made with `ld.lld -r`. A group's key hashes its members' paths and
+// contents (digests are memoized by stamp), so editing one member puts that
+// group back on its loose objects for the next link, and it is pre-linked
+// again once it stops changing. Relink cost then follows what changed.
+//
+// Blobs, the key list and the digest memo live in <output>.ctc-prelink/, and
+// blobs for keys no longer linked are removed. `ld -r` keeps COMDAT groups, so
+// inline functions still dedupe. Sections with the same name merge, which only
+// coarsens --gc-sections for code built without -ffunction-sections. Each blob
+// takes its group's first position on the command line, which is harmless
+// under lld's order-independent archive resolution. Archives, LTO bitcode and
+// links with -r, -x or -flto are passed through unchanged.
+
+#ifndef _WIN32
+static constexpr const char* PRELINK_VERSION = "ctc-prelink/1";
+
+// Options whose value is the next argument (so "-o foo.o" is not an input).
+static bool takes_separate_value(const std::string& a) {
+    static const char* opts[] = {
+        "-o", "-Xlinker", "-Xclang", "-Xassembler", "-Xpreprocessor", "-mllvm", "-include", "-imacros",
+        "-I", "-L", "-isystem", "-idirafter", "-iquote", "-isysroot", "--sysroot", "-MF", "-MT", "-MQ",
+        "-T", "-target", "--target", "-l", "-u", "-e", "-z", "-rpath", "-arch", "-framework",
+    };
+    for (const char* o : opts) {
+        if (a == o) return true;
+    }
+    return false;
+}
+
+// GNU response-file tokenization: whitespace separates, quotes group,
+// backslash escapes the next character.
+static std::vector<std::string> tokenize_response_file(const std::string& text) {
+    std::vector<std::string> out;
+    std::string cur;
+    bool have = false;
+    char quote = 0;
+    for (size_t i = 0; i < text.size(); i++) {
+        char c = text[i];
+        if (c == '\\' && i + 1 < text.size()) {
+            cur += text[++i];
+            have = true;
+        } else if (quote) {
+            if (c == quote) quote = 0;
+            else cur += c;
+        } else if (c == '"' || c == '\'') {
+            quote = c;
+            have = true;
+        } else if (isspace((unsigned char)c)) {
+            if (have) out.push_back(cur);
+            cur.clear();
+            have = false;
+        } else {
+            cur += c;
+            have = true;
         }
     }
+    if (have) out.push_back(cur);
+    return out;
+}
 
-#ifdef _WIN32
-    // Windows: add runtime DLL directories to PATH so ASAN DLLs are found at runtime
-    std::string current_path = get_env("PATH");
-    std::string prepend;
-    std::string clang_bin_dir = path_join(cache.clang_root, "bin");
-    if (is_directory(clang_bin_dir)) {
-        prepend = clang_bin_dir;
+static std::string quote_response_arg(const std::string& a) {
+    if (!a.empty() && a.find_first_of(" \t\r\n\"'\\") == std::string::npos) return a;
+    std::string q = "\"";
+    for (char c : a) {
+        if (c == '"' || c == '\\') q += '\\';
+        q += c;
+    }
+    return q + "\"";
+}
+
+static int run_and_wait(const std::vector<std::string>& cmd) {
+    std::vector<const char*> argv_ptrs;
+    for (const auto& s : cmd) argv_ptrs.push_back(s.c_str());
+    argv_ptrs.push_back(nullptr);
+    pid_t pid = fork();
+    if (pid == 0) {
+        execv(cmd[0].c_str(), const_cast<char**>(argv_ptrs.data()));
+        _exit(127);
     }
-    if (!cache.sysroot_bin.empty() && is_directory(cache.sysroot_bin)) {
-        if (!prepend.empty()) prepend += ";";
-        prepend += cache.sysroot_bin;
+    if (pid < 0) return -1;
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
     }
-    if (!prepend.empty()) {
-        if (!current_path.empty()) {
-            set_env("PATH", prepend + ";" + current_path);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+}
+
+struct PrelinkMember {
+    FileStamp stamp;
+    std::string digest;  // "-" when the file is not ELF (e.g. LTO bitcode)
+};
+
+struct PrelinkGroup {
+    std::vector<size_t> positions;  // indices into the expanded argument list
+    std::string key;
+    bool eligible = true;
+};
+
+// Rewrites `cmd` in place; false (and `cmd` untouched) when nothing applies.
+static bool prelink_object_groups(std::vector<std::string>& cmd, const CtcCache& cache,
+                                  const std::string& output_path, bool debug) {
+    if (output_path.empty()) return false;
+    bool uses_lld = false;
+    for (size_t i = 1; i < cmd.size(); i++) {
+        const std::string& a = cmd[i];
+        if (a == "-r" || a == "-x" || starts_with(a, "-flto") || a == "-Wl,-r") return false;
+        if (starts_with(a, "-fuse-ld=")) uses_lld = a == "-fuse-ld=lld";
+    }
+    std::string ld = path_join(path_join(cache.clang_root, "bin"), "ld.lld");
+    FileStamp ld_stamp;
+    if (!uses_lld || !file_stamp(ld, ld_stamp)) return false;
+
+    // 1. Expand response files so their objects can be grouped too
+    std::vector<std::string> args;
+    bool used_rsp = false;
+    for (size_t i = 1; i < cmd.size(); i++) {
+        if (cmd[i].size() > 1 && cmd[i][0] == '@' && path_exists(cmd[i].substr(1))) {
+            for (auto& t : tokenize_response_file(read_file(cmd[i].substr(1)))) args.push_back(std::move(t));
+            used_rsp = true;
         } else {
-            set_env("PATH", prepend);
+            args.push_back(cmd[i]);
         }
     }
-#else
-    // Linux: add runtime library directories to LD_LIBRARY_PATH so ASAN .so is found at runtime
-    // This mirrors the Windows PATH logic above and provides a fallback when
-    // rpath/$ORIGIN deployment isn't available.
+
+    // 2. Group object inputs by directory
+    size_t min_members = 8;
+    std::string min_env = get_env("CLANG_TOOL_CHAIN_PRELINK_MIN");
+    if (!min_env.empty() && atoi(min_env.c_str()) > 1) min_members = (size_t)atoi(min_env.c_str());
+    std::vector<std::string> group_dirs;
+    std::unordered_map<std::string, PrelinkGroup> groups;
+    for (size_t i = 0; i < args.size(); i++) {
+        const std::string& a = args[i];
+        if (takes_separate_value(a)) { i++; continue; }
+        if (a.empty() || a[0] == '-' || !ends_with(a, ".o")) continue;
+        std::string dir = get_dir_name(a);
+        auto it = groups.find(dir);
+        if (it == groups.end()) {
+            group_dirs.push_back(dir);
+            it = groups.emplace(dir, PrelinkGroup()).first;
+        }
+        it->second.positions.push_back(i);
+    }
+    std::vector<std::string> candidates;
+    for (const auto& dir : group_dirs) {
+        if (groups[dir].positions.size() >= min_members) candidates.push_back(dir);
+    }
+    if (candidates.empty()) return false;
+
+    // 3. Previous link's state: group keys and the stamp -> digest memo
+    std::string state_dir = output_path + ".ctc-prelink";
+    std::string state_path = path_join(state_dir, "state");
+    mkdir(state_dir.c_str(), 0755);
+    std::unordered_map<std::string, bool> previous_keys;
+    std::unordered_map<std::string, PrelinkMember> memo;
     {
-        std::string lib_dir = path_join(cache.clang_root, "lib");
-        auto search_dirs = build_lib_search_dirs(lib_dir, cache.resource_dir, platform);
-        if (!search_dirs.empty()) {
-            std::string prepend_ld;
-            for (const auto& dir : search_dirs) {
-                if (!prepend_ld.empty()) prepend_ld += ":";
-                prepend_ld += dir;
-            }
-            std::string current_ld = get_env("LD_LIBRARY_PATH");
-            if (!current_ld.empty()) {
-                set_env("LD_LIBRARY_PATH", prepend_ld + ":" + current_ld);
-            } else {
-                set_env("LD_LIBRARY_PATH", prepend_ld);
+        std::istringstream in(read_file(state_path));
+        std::string line;
+        if (std::getline(in, line) && line == PRELINK_VERSION) {
+            while (std::getline(in, line)) {
+                if (starts_with(line, "k ")) {
+                    previous_keys[line.substr(2)] = true;
+                    continue;
+                }
+                unsigned long long size = 0, mtime = 0;
+                char digest[64] = {0};
+                int consumed = 0;
+                if (sscanf(line.c_str(), "o %llu %llu %40s %n", &size, &mtime, digest, &consumed) == 3 &&
+                    consumed > 0) {
+                    PrelinkMember m;
+                    m.stamp.size = size;
+                    m.stamp.mtime_ns = mtime;
+                    m.digest = digest;
+                    memo[line.substr((size_t)consumed)] = m;
+                }
             }
         }
     }
-#endif
+
+    // 4. Member digests (re-hashed only when the stamp moved)
+    std::vector<std::string> paths;
+    for (const auto& dir : candidates) {
+        for (size_t pos : groups[dir].positions) paths.push_back(args[pos]);
+    }
+    std::vector<PrelinkMember> members(paths.size());
+    std::vector<char> readable(paths.size(), 0);
+    parallel_for(paths.size(), [&](size_t i) {
+        PrelinkMember& m = members[i];
+        if (!file_stamp(paths[i], m.stamp)) return;
+        readable[i] = 1;
+        auto it = memo.find(paths[i]);
+        if (it != memo.end() && it->second.stamp.size == m.stamp.size &&
+            it->second.stamp.mtime_ns == m.stamp.mtime_ns) {
+            m.digest = it->second.digest;
+            return;
+        }
+        char magic[4] = {0};
+        FILE* f = fopen(paths[i].c_str(), "rb");
+        bool elf = f && fread(magic, 1, 4, f) == 4 && memcmp(magic, "\x7f" "ELF", 4) == 0;
+        if (f) fclose(f);
+        Hash128 h;
+        m.digest = elf && file_digest(paths[i], h, 1) ? h.hex() : "-";
+    });
+
+    // 5. Group keys; stable groups use (or get) a blob, changed ones stay loose
+    std::vector<std::string> to_build;
+    size_t reused = 0, next = 0;
+    for (const auto& dir : candidates) {
+        PrelinkGroup& g = groups[dir];
+        std::vector<std::string> parts = {PRELINK_VERSION, ld, std::to_string(ld_stamp.size),
+                                          std::to_string(ld_stamp.mtime_ns), dir};
+        for (size_t k = 0; k < g.positions.size(); k++, next++) {
+            if (!readable[next] || members[next].digest == "-") g.eligible = false;
+            parts.push_back(paths[next]);
+            parts.push_back(members[next].digest);
+        }
+        g.key = hash128_parts(parts).hex();
+        if (!g.eligible) continue;
+        if (path_exists(path_join(state_dir, g.key + ".o"))) {
+            reused++;
+        } else if (previous_keys.count(g.key)) {
+            to_build.push_back(dir);
+        } else {
+            g.eligible = false;
+        }
+    }
+
+    std::string pid = std::to_string((int)getpid());
+    parallel_for(to_build.size(), [&](size_t b) {
+        PrelinkGroup& g = groups[to_build[b]];
+        std::string blob = path_join(state_dir, g.key + ".o");
+        std::string tmp = blob + ".tmp." + pid;
+        std::string rsp_text;
+        for (size_t pos : g.positions) rsp_text += quote_response_arg(args[pos]) + "\n";
+        std::string rsp = tmp + ".rsp";
+        bool ok = write_file_atomic(rsp, rsp_text) && run_and_wait({ld, "-r", "-o", tmp, "@" + rsp}) == 0 &&
+                  rename(tmp.c_str(), blob.c_str()) == 0;
+        std::remove(rsp.c_str());
+        if (!ok) {
+            std::remove(tmp.c_str());
+            g.eligible = false;
+            fprintf(stderr, "%sld.lld -r failed for %s; linking its objects directly\n", CTC_TAG,
+                    to_build[b].c_str());
+        }
+    });
+
+    // 6. State for the next link; drop blobs of keys that are gone
+    std::string state = std::string(PRELINK_VERSION) + "\n";
+    std::unordered_map<std::string, bool> current_keys;
+    for (const auto& dir : candidates) {
+        state += "k " + groups[dir].key + "\n";
+        current_keys[groups[dir].key + ".o"] = true;
+    }
+    for (size_t i = 0; i < paths.size(); i++) {
+        if (!readable[i]) continue;
+        state += "o " + std::to_string(members[i].stamp.size) + " " + std::to_string(members[i].stamp.mtime_ns) +
+                 " " + members[i].digest + " " + paths[i] + "\n";
+    }
+    write_file_atomic(state_path, state);
+    for (const auto& name : list_directory(state_dir)) {
+        if (ends_with(name, ".o") && !current_keys.count(name)) std::remove(path_join(state_dir, name).c_str());
+    }
+
+    // 7. Each pre-linked group collapses onto its first member's position
+    std::vector<char> drop(args.size(), 0);
+    size_t blobs = 0;
+    for (const auto& dir : candidates) {
+        const PrelinkGroup& g = groups[dir];
+        if (!g.eligible) continue;
+        args[g.positions[0]] = path_join(state_dir, g.key + ".o");
+        for (size_t k = 1; k < g.positions.size(); k++) drop[g.positions[k]] = 1;
+        blobs++;
+    }
+    if (debug) {
+        fprintf(stderr, "[ctc-debug] prelink: %zu group(s): %zu reused, %zu built, %zu loose\n",
+                candidates.size(), reused, blobs - reused, candidates.size() - blobs);
+    }
+    if (blobs == 0) return false;
+
+    std::vector<std::string> rewritten = {cmd[0]};
+    for (size_t i = 0; i < args.size(); i++) {
+        if (!drop[i]) rewritten.push_back(std::move(args[i]));
+    }
+    if (used_rsp) {
+        // The original command needed a response file; so does the rewrite.
+        std::string rsp_text;
+        for (size_t i = 1; i < rewritten.size(); i++) rsp_text += quote_response_arg(rewritten[i]) + "\n";
+        std::string rsp = path_join(state_dir, "link.rsp");
+        if (!write_file_atomic(rsp, rsp_text)) return false;
+        rewritten.resize(1);
+        rewritten.push_back("@" + rsp);
+    }
+    cmd = std::move(rewritten);
+    return true;
 }
+#endif
 
 // ============================================================================
 // Section 9: Toolchain Not Found (Slow Path)
@@ -1620,6 +2717,135 @@ static void check_toolchain_integrity(const CtcCache& cache, const std::string&
 // (print_command, win_quote_arg, create_process_and_wait, exec_process live
 //  in ctc_common.h. Callers pass CTC_TAG explicitly.)
 
+// ============================================================================
+// Section 11b: Clang Zygote Client (Linux, CLANG_TOOL_CHAIN_ZYGOTE=1)
+// ============================================================================
+//
+// Hands the compile to a pre-initialized clang (libctc_zygote.so preloaded
+// into the bundled clang, see ctc_zygote.cpp) instead of exec'ing a fresh one.
+// Every failure before the zygote reports a pid falls back to plain exec, and
+// a missing zygote is started in the background for the next compile.
+
+#ifdef __linux__
+
+static constexpr const char* ZYGOTE_LIB_NAME = "libctc_zygote.so";
+static constexpr int ZYGOTE_SPAWN_INTERVAL_S = 10;
+
+static volatile pid_t g_zygote_child = 0;
+
+static void forward_signal_to_zygote_child(int sig) {
+    if (g_zygote_child > 0) kill(g_zygote_child, sig);
+}
+
+// Start a detached zygote for `clang_real` listening on `sock_path`. At most
+// one attempt per ZYGOTE_SPAWN_INTERVAL_S so a broken setup (no shim, clang
+// that will not preload it) costs a stat() per compile, not a spawn.
+static void maybe_start_zygote(const std::string& clang_real, const std::string& sock_path, bool debug) {
+    std::string lib = path_join(get_exe_dir(), ZYGOTE_LIB_NAME);
+    if (!path_exists(lib)) {
+        if (debug) fprintf(stderr, "[ctc-debug] zygote: %s not found, not starting\n", lib.c_str());
+        return;
+    }
+    std::string stamp = sock_path + ".spawn";
+    struct stat st;
+    if (stat(stamp.c_str(), &st) == 0 && time(nullptr) - st.st_mtime < ZYGOTE_SPAWN_INTERVAL_S) return;
+    if (!write_file_atomic(stamp, "")) return;
+    if (debug) fprintf(stderr, "[ctc-debug] zygote: starting %s on %s\n", clang_real.c_str(), sock_path.c_str());
+
+    pid_t pid = fork();
+    if (pid != 0) {
+        if (pid > 0) waitpid(pid, nullptr, 0);
+        return;
+    }
+    // Double fork + setsid: the zygote must not be our child (we exec or exit
+    // right after) nor share the build's session, stdio or inherited fds.
+    setsid();
+    if (fork() != 0) _exit(0);
+    int devnull = open("/dev/null", O_RDWR);
+    if (devnull >= 0) {
+        for (int fd = 0; fd < 3; fd++) dup2(devnull, fd);
+    }
+    long max_fd = std::min(sysconf(_SC_OPEN_MAX), 65536L);
+    for (long fd = 3; fd < max_fd; fd++) close((int)fd);
+    setenv("LD_PRELOAD", lib.c_str(), 1);
+    setenv("CTC_ZYGOTE_SOCKET", sock_path.c_str(), 1);
+    execl(clang_real.c_str(), clang_real.c_str(), "--version", (char*)nullptr);
+    _exit(127);
+}
+
+// Run `cmd` in the zygote for cmd[0]. Returns false (nothing has run) when the
+// caller should exec clang itself; otherwise `status` is the wait status.
+static bool run_via_zygote(const std::vector<std::string>& cmd, int& status, bool debug) {
+    if (!env_is_truthy("CLANG_TOOL_CHAIN_ZYGOTE") || cmd.empty()) return false;
+    char real_buf[PATH_MAX];
+    if (!realpath(cmd[0].c_str(), real_buf)) return false;
+    std::string clang_real = real_buf;
+    std::string dir = zygote_socket_dir();
+    if (dir.empty()) return false;
+    std::string sock_path = path_join(dir, hash128(clang_real).hex().substr(0, 16) + ".sock");
+
+    int sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (sock < 0) return false;
+    struct sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (sock_path.size() >= sizeof(addr.sun_path)) {
+        close(sock);
+        return false;
+    }
+    memcpy(addr.sun_path, sock_path.c_str(), sock_path.size() + 1);
+    if (connect(sock, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(sock);
+        maybe_start_zygote(clang_real, sock_path, debug);
+        return false;
+    }
+
+    char cwd[PATH_MAX];
+    if (!getcwd(cwd, sizeof(cwd))) {
+        close(sock);
+        return false;
+    }
+    mode_t mask = umask(022);
+    umask(mask);
+    char tag = 0;
+    int32_t value = 0;
+    if (!zygote_send_request(sock, zygote_encode_request(cmd, cwd, environ, (uint32_t)mask)) ||
+        !zygote_read_reply(sock, tag, value) || tag != 'P') {
+        if (debug) fprintf(stderr, "[ctc-debug] zygote: no pid from %s, falling back to exec\n", sock_path.c_str());
+        close(sock);
+        return false;
+    }
+
+    // From here on clang is running: the compile is the zygote child's, and
+    // we only relay signals to it and its status back to our parent.
+    if (debug) fprintf(stderr, "[ctc-debug] zygote: compile running as pid %d\n", (int)value);
+    g_zygote_child = (pid_t)value;
+    struct sigaction sa = {};
+    sa.sa_handler = forward_signal_to_zygote_child;
+    sa.sa_flags = SA_RESTART;
+    for (int sig : {SIGINT, SIGTERM, SIGHUP, SIGQUIT}) sigaction(sig, &sa, nullptr);
+    bool ok = zygote_read_reply(sock, tag, value) && tag == 'S';
+    close(sock);
+    if (!ok) {
+        fprintf(stderr, "%sLost connection to clang zygote (pid %d)\n", CTC_TAG, (int)g_zygote_child);
+        status = 1 << 8;  // exit code 1
+        return true;
+    }
+    status = value;
+    return true;
+}
+
+// Mirror a zygote child's wait status as our own exit.
+[[noreturn]] static void exit_like(int status) {
+    if (WIFSIGNALED(status)) {
+        signal(WTERMSIG(status), SIG_DFL);
+        raise(WTERMSIG(status));
+        exit(128 + WTERMSIG(status));
+    }
+    exit(WIFEXITED(status) ? WEXITSTATUS(status) : 1);
+}
+
+#endif // __linux__
+
 // ============================================================================
 // Section 12: main()
 // ============================================================================
@@ -1645,6 +2871,10 @@ int main(int argc, char* argv[]) {
     Arch arch = get_arch();
     g_prof.mark("detect mode/platform/arch");
 
+    // CTC_TIMING_LOG: run clang as a child and record timings (ctc_common.h Section 17)
+    TimingLog timing;
+    timing.begin(mode == CompilerMode::CXX ? "clang++" : "clang");
+
     if (debug) {
         fprintf(stderr, "[ctc-debug] argv[0]=%s\n", argv[0]);
         fprintf(stderr, "[ctc-debug] basename=%s\n", get_exe_basename(argv[0]).c_str());
@@ -1660,18 +2890,23 @@ int main(int argc, char* argv[]) {
             printf("Launcher flags (consumed by the launcher, not passed to clang):\n");
             printf("  --deploy-dependencies   Deploy runtime DLLs alongside output binary\n");
             printf("  --dry-run               Print the command that would be exec'd\n");
+            printf("  --ctc-translate DB [-o OUT]\n");
+            printf("                          Rewrite a compile_commands.json to the commands\n");
+            printf("                          this launcher would exec (default OUT: stdout)\n");
             printf("  --ctc-help              Show this help (--help is forwarded to clang)\n\n");
             printf("Environment:\n");
             printf("  CTC_DEBUG=1             Debug output\n");
             printf("  CLANG_TOOL_CHAIN_NO_AUTO=1  Skip directive parsing, exec clang directly\n");
+            printf("  CLANG_TOOL_CHAIN_ZYGOTE=1   Fork compiles from a resident clang (Linux)\n");
+            printf("  CLANG_TOOL_CHAIN_PRELINK=1  Link unchanged object groups as cached ld -r blobs (Linux)\n");
+            printf("  CLANG_TOOL_CHAIN_OPT_RECORD=yaml  Save optimization records for ctc-opt-report\n");
+            printf("  CLANG_TOOL_CHAIN_XRAY=1     Build with XRay function tracing (Linux, see ctc-xray)\n");
             return 0;
         }
     }
 
     // 2. Resolve install directory (honors CLANG_TOOL_CHAIN_DOWNLOAD_PATH)
-    std::string install_dir = path_join(get_ctc_home_dir(), "clang");
-    install_dir = path_join(install_dir, platform_str(platform));
-    install_dir = path_join(install_dir, arch_str(arch));
+    std::string install_dir = default_install_dir(platform, arch);
     std::string cache_path = path_join(install_dir, CTC_CACHE_FILENAME);
 
     // 3. Check done.txt (toolchain installed?)
@@ -1696,6 +2931,13 @@ int main(int argc, char* argv[]) {
         return 0;
     }
 
+    // 4c. Batch mode: translate a whole compilation database, no exec
+    if (argc >= 3 && strcmp(argv[1], "--ctc-translate") == 0) {
+        std::string out;
+        if (argc >= 5 && strcmp(argv[3], "-o") == 0) out = argv[4];
+        return run_translate(argv[2], out, cache, platform, arch, debug);
+    }
+
     // 5. Background thread: validate cache still valid
     // Capture by value to avoid use-after-free if main() returns (Windows CreateProcess path)
     std::string validator_clang_bin = cache.clang_bin;
@@ -1730,10 +2972,23 @@ int main(int argc, char* argv[]) {
     ParsedArgs parsed = parse_user_args(argc, argv);
     g_prof.mark("parse user args");
 
-    // 8. Parse directives (synchronous — thread overhead on Windows exceeds the work)
+    // 7b. Register this invocation in the live table ctc-top reads. The slot
+    //     follows the pid through exec, so it keeps describing clang.
+    TopRegistration& top = TopRegistration::self();
+    if (!parsed.dry_run && !parsed.no_print) {
+        const std::string& target = !parsed.output_path.empty() ? parsed.output_path
+                                    : !parsed.source_files.empty() ? parsed.source_files[0]
+                                    : std::string();
+        top.claim(mode == CompilerMode::CXX ? "clang++" : "clang", target, "setup");
+        timing.set_target(target);
+        g_prof.mark("register ctc-top slot");
+    }
+
+    // 8. Parse directives (serial — a few header lines per file, less than a thread start)
     DirectiveResult directives;
     if (!is_feature_disabled("DIRECTIVES") && !parsed.source_files.empty()) {
         directives = parse_all_directives(parsed.source_files, platform);
+        resolve_pkg_config_directives(directives, platform, arch);
     }
     g_prof.mark("parse directives");
 
@@ -1799,12 +3054,23 @@ int main(int argc, char* argv[]) {
         // If capture failed, fall through to normal exec
     }
 
-    // 11d. Set up sanitizer environment variables before exec
-    setup_sanitizer_environment(cache, parsed.has_fsanitize_address, platform);
+    // 11d. CLANG_TOOL_CHAIN_PRELINK: stable object groups link as ld -r blobs (Section 8d)
+#ifndef _WIN32
+    if (!parsed.compile_only && platform == Platform::Linux && env_is_truthy("CLANG_TOOL_CHAIN_PRELINK")) {
+        top.set_phase("prelink");
+        prelink_object_groups(cmd, cache, parsed.output_path, debug);
+        g_prof.mark("prelink object groups");
+    }
+#endif
+
+    // 11e. Set up sanitizer environment variables before exec
+    setup_sanitizer_environment(cache, cache_path, parsed.has_fsanitize_address, parsed.has_fsanitize_fuzzer,
+                                platform);
     g_prof.mark("sanitizer env setup");
     g_prof.report();
 
     // 12. Execute
+    top.set_phase(parsed.compile_only ? "compile" : "link");
 #ifdef _WIN32
     bool needs_post_link = !parsed.compile_only &&
                            !parsed.output_path.empty() &&
@@ -1812,7 +3078,7 @@ int main(int argc, char* argv[]) {
                             get_extension(parsed.output_path) == ".dll");
 
     if (needs_post_link) {
-        int rc = create_process_and_wait(cmd);
+        int rc = timing.active() ? timing.run(cmd, CTC_TAG) : create_process_and_wait(cmd);
         if (rc == 0) {
             // Auto-deploy MinGW DLLs for GNU ABI .exe/.dll outputs (matches
             // Python post_link_dll_deployment). MSVC builds don't auto-deploy
@@ -1832,46 +3098,84 @@ int main(int argc, char* argv[]) {
                                   parsed.deploy_dependencies ||
                                   parsed.has_fsanitize_address);
             if (should_deploy) {
+                top.set_phase("deploy");
                 deploy_dlls(cache, parsed.output_path, parsed.has_fsanitize_address);
             }
         }
         if (rc != 0) {
             check_toolchain_integrity(cache, cache_path);
         }
+        timing.finish();
         return rc;
     }
 #else
+    // Unix, runtime-dir profile: runtimes are reached through the rpath to the
+    // versioned runtime dir, which only has to exist before the binary runs —
+    // publish it now (a stat() once it exists) and exec; nothing to copy after.
+    // If it can't be published, --deploy-dependencies copies as in the default
+    // profile ($ORIGIN is already on the rpath). The static profile has nothing
+    // to deploy at all.
+    RuntimeMode rt_mode = platform == Platform::Linux ? runtime_mode() : RuntimeMode::Copy;
+    if (rt_mode == RuntimeMode::RuntimeDir && !parsed.compile_only && !is_feature_disabled("DEPLOY_LIBS") &&
+        !publish_runtime_dir(cache, platform, arch, debug)) {
+        rt_mode = RuntimeMode::Copy;
+    }
+
     // Unix: if --deploy-dependencies was passed and we're linking, use fork+wait
     // so we can run deploy_shared_libs() after clang finishes
-    if (parsed.deploy_dependencies && !parsed.compile_only && !parsed.output_path.empty()) {
-        std::vector<const char*> argv_ptrs;
-        for (const auto& s : cmd) argv_ptrs.push_back(s.c_str());
-        argv_ptrs.push_back(nullptr);
-
-        pid_t pid = fork();
-        if (pid == 0) {
-            // Child: exec clang
-            execv(cmd[0].c_str(), const_cast<char**>(argv_ptrs.data()));
-            fprintf(stderr, "%sFailed to exec: %s\n", CTC_TAG, cmd[0].c_str());
-            _exit(127);
-        }
-        if (pid < 0) {
-            fprintf(stderr, "%sFailed to fork\n", CTC_TAG);
-            return 1;
+    if (parsed.deploy_dependencies && rt_mode == RuntimeMode::Copy && !parsed.compile_only &&
+        !parsed.output_path.empty()) {
+        int rc = 1;
+        if (timing.active()) {
+            rc = timing.run(cmd, CTC_TAG);
+        } else {
+            int status = 0;
+#ifdef __linux__
+            bool ran = run_via_zygote(cmd, status, debug);
+#else
+            bool ran = false;
+#endif
+            if (!ran) {
+                std::vector<const char*> argv_ptrs;
+                for (const auto& s : cmd) argv_ptrs.push_back(s.c_str());
+                argv_ptrs.push_back(nullptr);
+
+                pid_t pid = fork();
+                if (pid == 0) {
+                    // Child: exec clang
+                    execv(cmd[0].c_str(), const_cast<char**>(argv_ptrs.data()));
+                    fprintf(stderr, "%sFailed to exec: %s\n", CTC_TAG, cmd[0].c_str());
+                    _exit(127);
+                }
+                if (pid < 0) {
+                    fprintf(stderr, "%sFailed to fork\n", CTC_TAG);
+                    return 1;
+                }
+                waitpid(pid, &status, 0);
+            }
+            rc = WIFEXITED(status) ? WEXITSTATUS(status) : 1;
         }
-        int status = 0;
-        waitpid(pid, &status, 0);
-        int rc = WIFEXITED(status) ? WEXITSTATUS(status) : 1;
         if (rc == 0) {
+            top.set_phase("deploy");
             deploy_shared_libs(cache, parsed.output_path, parsed.has_fsanitize_address, platform);
         } else {
             check_toolchain_integrity(cache, cache_path);
         }
+        timing.finish();
         return rc;
     }
 #endif
 
-    // Default: exec (replaces process) — compile-only, or no deploy-dependencies
-    exec_process(cmd, CTC_TAG);
+#ifdef __linux__
+    // Zygote (opt-in): fork a pre-initialized clang instead of exec'ing one
+    if (!timing.active()) {
+        int status = 0;
+        if (run_via_zygote(cmd, status, debug)) exit_like(status);
+    }
+#endif
+
+    // Default: exec (replaces process) — compile-only, or no deploy-dependencies.
+    // Under CTC_TIMING_LOG: run as a child, record, exit with its status.
+    timing.exec(cmd, CTC_TAG);
     // Does not return
 }
@@ -18,14 +18,25 @@
 #ifndef CTC_COMMON_H
 #define CTC_COMMON_H
 
+#include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <deque>
+#include <exception>
 #include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -37,8 +48,16 @@
 #include <process.h>
 #include <windows.h>
 #else
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/uio.h>
+#include <sys/un.h>
 #include <sys/wait.h>
 #include <unistd.h>
 #endif
@@ -47,6 +66,17 @@
 #include <mach-o/dyld.h>
 #endif
 
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#define CTC_HAVE_CXXABI 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#endif
+
 namespace ctc {
 
 // ============================================================================
@@ -153,6 +183,169 @@ static inline void make_directory(const std::string& path) {
 #endif
 }
 
+// Entry names in `path` (excluding "." and ".."). Empty on error.
+static inline std::vector<std::string> list_directory(const std::string& path) {
+    std::vector<std::string> entries;
+#ifdef _WIN32
+    std::string pattern = path + "\\*";
+    WIN32_FIND_DATAA fd;
+    HANDLE h = FindFirstFileA(pattern.c_str(), &fd);
+    if (h == INVALID_HANDLE_VALUE) return entries;
+    do {
+        std::string name = fd.cFileName;
+        if (name != "." && name != "..") entries.push_back(name);
+    } while (FindNextFileA(h, &fd));
+    FindClose(h);
+#else
+    DIR* dir = opendir(path.c_str());
+    if (!dir) return entries;
+    struct dirent* ent;
+    while ((ent = readdir(dir)) != nullptr) {
+        std::string name = ent->d_name;
+        if (name != "." && name != "..") entries.push_back(name);
+    }
+    closedir(dir);
+#endif
+    return entries;
+}
+
+// Deletes `path` and everything under it. Symlinks are removed, not followed.
+// Best effort: entries that can't be removed are left behind silently.
+static inline void remove_tree(const std::string& path) {
+#ifdef _WIN32
+    DWORD attr = GetFileAttributesA(path.c_str());
+    if (attr == INVALID_FILE_ATTRIBUTES) return;
+    if ((attr & FILE_ATTRIBUTE_DIRECTORY) && !(attr & FILE_ATTRIBUTE_REPARSE_POINT)) {
+        for (const auto& name : list_directory(path)) remove_tree(path_join(path, name));
+        RemoveDirectoryA(path.c_str());
+    } else if (attr & FILE_ATTRIBUTE_DIRECTORY) {
+        RemoveDirectoryA(path.c_str());
+    } else {
+        DeleteFileA(path.c_str());
+    }
+#else
+    struct stat st;
+    if (lstat(path.c_str(), &st) != 0) return;
+    if (S_ISDIR(st.st_mode)) {
+        for (const auto& name : list_directory(path)) remove_tree(path_join(path, name));
+        rmdir(path.c_str());
+    } else {
+        unlink(path.c_str());
+    }
+#endif
+}
+
+static inline bool ends_with(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() &&
+           s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+static inline bool is_absolute_path(const std::string& p) {
+#ifdef _WIN32
+    if (p.size() >= 2 && p[1] == ':') return true;
+    if (!p.empty() && p[0] == '\\') return true;
+#endif
+    return !p.empty() && p[0] == '/';
+}
+
+// Lexical clean-up with '/' separators: drops "." and empty segments and
+// folds "dir/.." pairs, so one file spelled two ways compares equal. Leading
+// ".." of a relative path are kept; symlinks are not consulted.
+static inline std::string normalize_path(const std::string& path) {
+    bool clean = path.find('\\') == std::string::npos && path.find("//") == std::string::npos &&
+                 path.find("/./") == std::string::npos && path.find("/../") == std::string::npos &&
+                 path.compare(0, 2, "./") != 0 && !ends_with(path, "/.") && !ends_with(path, "/..");
+    if (clean) return path;
+
+    std::string p = path;
+    for (auto& c : p) {
+        if (c == '\\') c = '/';
+    }
+    std::string root;  // "/", "C:" or "C:/"
+    if (p.size() >= 2 && p[1] == ':' && isalpha((unsigned char)p[0])) root = p.substr(0, 2);
+    if (p.size() > root.size() && p[root.size()] == '/') root += '/';
+    std::string out;
+    size_t i = root.size();
+    while (i <= p.size()) {
+        size_t j = p.find('/', i);
+        if (j == std::string::npos) j = p.size();
+        std::string part = p.substr(i, j - i);
+        i = j + 1;
+        if (part.empty() || part == ".") continue;
+        if (part == "..") {
+            size_t cut = out.find_last_of('/');
+            std::string last = cut == std::string::npos ? out : out.substr(cut + 1);
+            if (!out.empty() && last != "..") {
+                out.erase(cut == std::string::npos ? 0 : cut);
+                continue;
+            }
+            if (!root.empty() && root.back() == '/') continue;  // "/.." is "/"
+        }
+        if (!out.empty()) out += '/';
+        out += part;
+    }
+    if (out.empty() && root.empty()) return ".";
+    return root + out;
+}
+
+// Recursively collect regular files under `root` whose name ends with any of
+// `suffixes`. Symlinked directories are not followed, so cyclic links in a
+// build tree can't loop forever.
+static inline void walk_files(const std::string& root,
+                              const std::vector<std::string>& suffixes,
+                              std::vector<std::string>& out) {
+    std::vector<std::string> stack{root};
+    while (!stack.empty()) {
+        std::string dir = std::move(stack.back());
+        stack.pop_back();
+#ifdef _WIN32
+        std::string pattern = dir + "\\*";
+        WIN32_FIND_DATAA fd;
+        HANDLE h = FindFirstFileA(pattern.c_str(), &fd);
+        if (h == INVALID_HANDLE_VALUE) continue;
+        do {
+            std::string name = fd.cFileName;
+            if (name == "." || name == "..") continue;
+            std::string full = path_join(dir, name);
+            if (fd.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) continue;
+            if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+                stack.push_back(full);
+                continue;
+            }
+            for (const auto& sfx : suffixes) {
+                if (ends_with(name, sfx)) { out.push_back(full); break; }
+            }
+        } while (FindNextFileA(h, &fd));
+        FindClose(h);
+#else
+        DIR* d = opendir(dir.c_str());
+        if (!d) continue;
+        struct dirent* ent;
+        while ((ent = readdir(d)) != nullptr) {
+            const char* name = ent->d_name;
+            if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0) continue;
+            std::string full = path_join(dir, name);
+            unsigned char type = ent->d_type;
+            if (type == DT_UNKNOWN) {
+                struct stat st;
+                if (lstat(full.c_str(), &st) != 0) continue;
+                type = S_ISDIR(st.st_mode) ? DT_DIR : S_ISREG(st.st_mode) ? DT_REG : DT_LNK;
+            }
+            if (type == DT_DIR) {
+                stack.push_back(full);
+                continue;
+            }
+            if (type != DT_REG) continue;
+            std::string n = name;
+            for (const auto& sfx : suffixes) {
+                if (ends_with(n, sfx)) { out.push_back(full); break; }
+            }
+        }
+        closedir(d);
+#endif
+    }
+}
+
 static inline std::string get_home_dir() {
 #ifdef _WIN32
     const char* profile = getenv("USERPROFILE");
@@ -215,6 +408,31 @@ static inline std::string get_exe_dir() {
     return (sep == std::string::npos) ? "" : p.substr(0, sep);
 }
 
+// Absolute form of `path` (symlinks resolved on POSIX); `path` unchanged if it
+// can't be resolved, e.g. because it doesn't exist.
+static inline std::string absolute_path(const std::string& path) {
+#ifdef _WIN32
+    char buf[MAX_PATH * 2];
+    DWORD n = GetFullPathNameA(path.c_str(), (DWORD)sizeof(buf), buf, nullptr);
+    return (n == 0 || n >= sizeof(buf)) ? path : std::string(buf, n);
+#else
+    char* real = realpath(path.c_str(), nullptr);
+    if (!real) return path;
+    std::string out = real;
+    free(real);
+    return out;
+#endif
+}
+
+// Resolves the base clang-tool-chain directory. Mirrors Python's
+// path_utils.get_home_toolchain_dir — honors CLANG_TOOL_CHAIN_DOWNLOAD_PATH
+// (the var Python actually reads) and falls back to ~/.clang-tool-chain.
+static inline std::string get_ctc_home_dir() {
+    const char* override_path = getenv("CLANG_TOOL_CHAIN_DOWNLOAD_PATH");
+    if (override_path && override_path[0]) return override_path;
+    return path_join(get_home_dir(), ".clang-tool-chain");
+}
+
 // ============================================================================
 // Section 4: String Helpers
 // ============================================================================
@@ -229,6 +447,23 @@ static inline bool starts_with(const std::string& s, const char* prefix) {
     return s.compare(0, std::strlen(prefix), prefix) == 0;
 }
 
+// Itanium-ABI demangling where the C++ runtime provides it; `sym` unchanged
+// otherwise (MSVC runtime, plain C names, malformed manglings).
+static inline std::string demangle(const std::string& sym) {
+#ifdef CTC_HAVE_CXXABI
+    if (starts_with(sym, "_Z")) {
+        int status = 0;
+        char* out = abi::__cxa_demangle(sym.c_str(), nullptr, nullptr, &status);
+        if (out) {
+            std::string s = status == 0 ? out : sym;
+            free(out);
+            return s;
+        }
+    }
+#endif
+    return sym;
+}
+
 // ============================================================================
 // Section 5: Environment Helpers
 // ============================================================================
@@ -274,16 +509,47 @@ static inline std::string read_file(const std::string& path) {
     return ss.str();
 }
 
-// Write content to path via a uniquely-named tmp file + atomic rename.
-// Returns false on any I/O error.
-static inline bool write_file_atomic(const std::string& path, const std::string& content) {
-    std::string tmp = path + ".tmp." + std::to_string(
+// "<path>.tmp.<pid>.<n>": unique per call, so threads of one process
+// (libctc callers, --ctc-translate) writing the same file never share it.
+static inline std::string unique_tmp_path(const std::string& path) {
+    static std::atomic<uint32_t> counter{0};
+#ifdef _WIN32
+    int pid = (int)GetCurrentProcessId();
+#else
+    int pid = (int)getpid();
+#endif
+    return path + ".tmp." + std::to_string(pid) + "." + std::to_string(counter.fetch_add(1));
+}
+
+// Fresh private directory "<tmp>/<prefix>.XXXXXX" for scratch builds, or ""
+// if none could be created. The caller removes it with remove_tree().
+static inline std::string make_work_dir(const char* prefix) {
 #ifdef _WIN32
-        (int)GetCurrentProcessId()
+    char buf[MAX_PATH + 1];
+    DWORD n = GetTempPathA((DWORD)sizeof(buf), buf);
+    std::string base = (n == 0 || n > MAX_PATH) ? "." : std::string(buf, n);
+    uint64_t seed = ((uint64_t)GetCurrentProcessId() << 20) ^ (uint64_t)GetTickCount64();
+    for (int attempt = 0; attempt < 100; attempt++) {
+        std::string dir = path_join(base, std::string(prefix) + "." + std::to_string(seed + (uint64_t)attempt));
+        if (CreateDirectoryA(dir.c_str(), nullptr)) return dir;
+        if (GetLastError() != ERROR_ALREADY_EXISTS) break;
+    }
+    return "";
 #else
-        (int)getpid()
+    std::string base = get_env("TMPDIR");
+    if (base.empty()) base = "/tmp";
+    std::string tmpl = path_join(base, std::string(prefix) + ".XXXXXX");
+    std::vector<char> buf(tmpl.begin(), tmpl.end());
+    buf.push_back('\0');
+    if (!mkdtemp(buf.data())) return "";
+    return buf.data();
 #endif
-    );
+}
+
+// Write content to path via a uniquely-named tmp file + atomic rename.
+// Returns false on any I/O error.
+static inline bool write_file_atomic(const std::string& path, const std::string& content) {
+    std::string tmp = unique_tmp_path(path);
     {
         std::ofstream f(tmp, std::ios::binary);
         if (!f) return false;
@@ -307,6 +573,34 @@ static inline bool write_file_atomic(const std::string& path, const std::string&
     return true;
 }
 
+// Size + modification time, the cheap "did this file change" check in front
+// of a content digest. False for directories and missing files.
+struct FileStamp {
+    uint64_t size = 0;
+    uint64_t mtime_ns = 0;
+};
+
+static inline bool file_stamp(const std::string& path, FileStamp& out) {
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA fa;
+    if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &fa)) return false;
+    if (fa.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) return false;
+    out.size = ((uint64_t)fa.nFileSizeHigh << 32) | fa.nFileSizeLow;
+    uint64_t ticks = ((uint64_t)fa.ftLastWriteTime.dwHighDateTime << 32) | fa.ftLastWriteTime.dwLowDateTime;
+    out.mtime_ns = ticks * 100;
+#else
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) return false;
+    out.size = (uint64_t)st.st_size;
+#ifdef __APPLE__
+    out.mtime_ns = (uint64_t)st.st_mtimespec.tv_sec * 1000000000ULL + (uint64_t)st.st_mtimespec.tv_nsec;
+#else
+    out.mtime_ns = (uint64_t)st.st_mtim.tv_sec * 1000000000ULL + (uint64_t)st.st_mtim.tv_nsec;
+#endif
+#endif
+    return true;
+}
+
 // ============================================================================
 // Section 7: PATH lookup
 // ============================================================================
@@ -435,6 +729,77 @@ static inline std::vector<std::string> parse_json_array(const std::string& conte
     return result;
 }
 
+// Escape `s` for embedding inside a JSON string literal (quotes not included).
+static inline std::string json_escape(const std::string& s) {
+    std::string out;
+    out.reserve(s.size() + 2);
+    for (char c : s) {
+        switch (c) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if ((unsigned char)c < 0x20) {
+                char buf[8];
+                snprintf(buf, sizeof(buf), "\\u%04x", (unsigned)(unsigned char)c);
+                out += buf;
+            } else {
+                out += c;
+            }
+        }
+    }
+    return out;
+}
+
+// Prerequisites of the first rule of a Make-style depfile (-MD / -M output):
+// handles "\ " and "\#" escapes, "$$", line continuations and drive-letter
+// colons in Windows targets.
+static inline std::vector<std::string> parse_depfile_prereqs(const std::string& buf) {
+    std::vector<std::string> deps;
+    std::string tok;
+    bool in_deps = false;
+    auto flush = [&]() {
+        if (tok.empty()) return;
+        if (in_deps) {
+            deps.push_back(tok);
+        } else if (tok.back() == ':') {
+            in_deps = true;
+        }
+        tok.clear();
+    };
+    for (size_t i = 0, n = buf.size(); i < n; i++) {
+        char c = buf[i];
+        if (c == '\\' && i + 1 < n) {
+            char next = buf[i + 1];
+            if (next == '\n' || next == '\r') {
+                flush();
+                i++;
+                if (next == '\r' && i + 1 < n && buf[i + 1] == '\n') i++;
+                continue;
+            }
+            if (next == ' ' || next == '#') { tok += next; i++; continue; }
+        }
+        if (c == '$' && i + 1 < n && buf[i + 1] == '$') { tok += '$'; i++; continue; }
+        if (c == ' ' || c == '\t') { flush(); continue; }
+        if (c == '\n' || c == '\r') {
+            flush();
+            if (in_deps) break;
+            continue;
+        }
+        if (c == ':' && !in_deps && (i + 1 >= n || buf[i + 1] == ' ' || buf[i + 1] == '\t' ||
+                                      buf[i + 1] == '\n' || buf[i + 1] == '\r')) {
+            tok += ':';
+            flush();
+            continue;
+        }
+        tok += c;
+    }
+    flush();
+    return deps;
+}
+
 // ============================================================================
 // Section 10: Process Execution
 // ============================================================================
@@ -529,6 +894,54 @@ static inline int create_process_and_wait(const std::vector<std::string>& cmd,
 #endif
 }
 
+#ifndef _WIN32
+// Resources one measured child used (wait4). maxrss is in KiB everywhere.
+struct ProcessUsage {
+    double wall_s = 0;
+    double cpu_s = 0;  // user + sys
+    uint64_t maxrss_kb = 0;
+};
+
+// fork + execvp + wait4; returns the exit code (128+signal, -1 if it could
+// not start). `quiet` sends the child's stdout/stderr to /dev/null; a
+// command that can't be exec'd is reported on stderr under `tag` either way.
+static inline int run_measured(const std::vector<std::string>& cmd, bool quiet, ProcessUsage& u, const char* tag) {
+    std::vector<const char*> argv_ptrs;
+    for (const auto& s : cmd) argv_ptrs.push_back(s.c_str());
+    argv_ptrs.push_back(nullptr);
+    auto t0 = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid == 0) {
+        int err_fd = quiet ? fcntl(2, F_DUPFD_CLOEXEC, 3) : 2;
+        if (quiet) {
+            int null_fd = open("/dev/null", O_WRONLY);
+            if (null_fd >= 0) {
+                dup2(null_fd, 1);
+                dup2(null_fd, 2);
+                close(null_fd);
+            }
+        }
+        execvp(cmd[0].c_str(), const_cast<char**>(argv_ptrs.data()));
+        if (err_fd >= 0) dprintf(err_fd, "%scannot run %s\n", tag, cmd[0].c_str());
+        _exit(127);
+    }
+    if (pid < 0) return -1;
+    int status = 0;
+    struct rusage ru = {};
+    while (wait4(pid, &status, 0, &ru) < 0 && errno == EINTR) {
+    }
+    u.wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    u.cpu_s = (double)ru.ru_utime.tv_sec + (double)ru.ru_utime.tv_usec / 1e6 + (double)ru.ru_stime.tv_sec +
+              (double)ru.ru_stime.tv_usec / 1e6;
+#ifdef __APPLE__
+    u.maxrss_kb = (uint64_t)ru.ru_maxrss / 1024;  // bytes on macOS
+#else
+    u.maxrss_kb = (uint64_t)ru.ru_maxrss;
+#endif
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+}
+#endif
+
 // Run a shell command, capturing stdout. Returns empty string on non-zero
 // exit. Used by one-shot Python discovery scripts.
 static inline std::string run_capture(const std::string& cmd) {
@@ -553,6 +966,1624 @@ static inline std::string run_capture(const std::string& cmd) {
     return result;
 }
 
+// ============================================================================
+// Section 11: Live Invocation Table (ctc-top)
+// ============================================================================
+//
+// Each launcher claims one slot in a fixed-size table shared through a
+// memory-mapped file at <ctc_home>/.ctc-top and records what it is doing
+// (role, output or TU, phase, start time). ctc-top maps the same file and
+// renders the in-flight set. Nothing blocks: slots are claimed with a CAS on
+// the pid field, and the text fields are published under a per-slot seqlock
+// so a reader never sees a half-written target.
+//
+// exec() keeps the pid, so the slot a launcher claims goes on describing the
+// clang / wasm-ld that replaces it. Nobody is left to release that slot when
+// the compiler exits; the next claimant (or ctc-top) probes the pid, finds it
+// gone and reaps the slot, counting it as finished. Launchers that stay
+// resident (fork+wait, Windows CreateProcess) release from atexit.
+//
+// The table is opt-in: launchers only map a file that already exists, which
+// ctc-top (interactive) or CLANG_TOOL_CHAIN_TOP=1 creates. Without it a
+// launcher pays one failed open() (~0.6 us). With it: one open+mmap of a
+// 128 KB file (~10 us), then a CAS and ~250 bytes of plain stores, well
+// under a microsecond (measurement notes in launcher_top.cpp).
+// CLANG_TOOL_CHAIN_NO_TOP=1 turns registration off even when the file exists.
+//
+// `finished` counts slots freed by release() or reap(); since a reap can come
+// much later than the exit, ctc-top reports started minus live owners instead.
+
+static constexpr uint32_t TOP_MAGIC = 0x504f5443;  // "CTOP"
+static constexpr uint32_t TOP_INITIALIZING = 1;
+static constexpr uint32_t TOP_VERSION = 1;
+static constexpr uint32_t TOP_SLOTS = 512;
+static constexpr const char* TOP_FILENAME = ".ctc-top";
+
+struct TopHeader {
+    std::atomic<uint32_t> magic;
+    uint32_t version;
+    uint32_t nslots;
+    uint32_t slot_size;
+    uint64_t created_us;
+    std::atomic<uint64_t> started;    // slots ever claimed
+    std::atomic<uint64_t> finished;   // slots released or reaped (lags exits)
+    char reserved[24];
+};
+
+struct TopSlot {
+    std::atomic<uint32_t> pid;        // 0 = free
+    std::atomic<uint32_t> seq;        // odd while the fields below are written
+    uint64_t start_us;
+    uint64_t phase_us;
+    char role[24];
+    char phase[16];
+    char target[192];                 // tail of the path when it doesn't fit
+};
+
+static_assert(sizeof(TopHeader) == 64, "TopHeader layout is part of the .ctc-top format");
+static_assert(sizeof(TopSlot) == 256, "TopSlot layout is part of the .ctc-top format");
+static_assert(std::atomic<uint32_t>::is_always_lock_free &&
+              std::atomic<uint64_t>::is_always_lock_free,
+              "shared-memory atomics must be lock-free to be address-free");
+
+static constexpr size_t TOP_FILE_SIZE = sizeof(TopHeader) + sizeof(TopSlot) * TOP_SLOTS;
+
+// Plain copy of a slot taken under its seqlock.
+struct TopSnapshot {
+    uint32_t pid = 0;
+    uint64_t start_us = 0;
+    uint64_t phase_us = 0;
+    std::string role;
+    std::string phase;
+    std::string target;
+};
+
+// Wall-clock microseconds; comparable across processes.
+static inline uint64_t now_us() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static inline uint32_t current_pid() {
+#ifdef _WIN32
+    return (uint32_t)GetCurrentProcessId();
+#else
+    return (uint32_t)getpid();
+#endif
+}
+
+static inline bool pid_alive(uint32_t pid) {
+#ifdef _WIN32
+    HANDLE h = OpenProcess(SYNCHRONIZE, FALSE, (DWORD)pid);
+    if (!h) return GetLastError() == ERROR_ACCESS_DENIED;
+    bool alive = WaitForSingleObject(h, 0) == WAIT_TIMEOUT;
+    CloseHandle(h);
+    return alive;
+#else
+    return kill((pid_t)pid, 0) == 0 || errno == EPERM;
+#endif
+}
+
+class TopTable {
+public:
+    // Map the table file. With `create`, a missing or short file is created
+    // and zero-extended; without it, a missing file just returns false
+    // (ctc-top has nothing to show yet).
+    bool open(const std::string& path, bool create) {
+        void* base = nullptr;
+#ifdef _WIN32
+        HANDLE f = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE,
+                               FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                               create ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (f == INVALID_HANDLE_VALUE) return false;
+        HANDLE m = CreateFileMappingA(f, nullptr, PAGE_READWRITE, 0, (DWORD)TOP_FILE_SIZE, nullptr);
+        CloseHandle(f);
+        if (!m) return false;
+        base = MapViewOfFile(m, FILE_MAP_ALL_ACCESS, 0, 0, TOP_FILE_SIZE);
+        CloseHandle(m);
+        if (!base) return false;
+#else
+        int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC | (create ? O_CREAT : 0), 0666);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 ||
+            ((size_t)st.st_size < TOP_FILE_SIZE &&
+             (!create || ftruncate(fd, (off_t)TOP_FILE_SIZE) != 0))) {
+            close(fd);
+            return false;
+        }
+        base = mmap(nullptr, TOP_FILE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED) return false;
+#endif
+        hdr_ = static_cast<TopHeader*>(base);
+
+        // First mapper of a fresh (zero-filled) file lays out the header.
+        uint32_t expected = 0;
+        if (create && hdr_->magic.compare_exchange_strong(expected, TOP_INITIALIZING,
+                                                          std::memory_order_acq_rel)) {
+            hdr_->version = TOP_VERSION;
+            hdr_->nslots = TOP_SLOTS;
+            hdr_->slot_size = (uint32_t)sizeof(TopSlot);
+            hdr_->created_us = now_us();
+            hdr_->magic.store(TOP_MAGIC, std::memory_order_release);
+        }
+        if (hdr_->magic.load(std::memory_order_acquire) != TOP_MAGIC ||
+            hdr_->version != TOP_VERSION || hdr_->nslots != TOP_SLOTS ||
+            hdr_->slot_size != sizeof(TopSlot)) {
+            hdr_ = nullptr;  // foreign layout or mid-init; the mapping is left for exit
+            return false;
+        }
+        return true;
+    }
+
+    TopHeader* header() const { return hdr_; }
+
+    TopSlot* slot(uint32_t i) const {
+        return reinterpret_cast<TopSlot*>(reinterpret_cast<char*>(hdr_) + sizeof(TopHeader)) + i;
+    }
+
+    // Free a slot whose owner exited without releasing it (the usual case
+    // after exec). Returns true if this call did the reaping.
+    bool reap(TopSlot& s, uint32_t pid) {
+        if (pid == 0 || pid_alive(pid)) return false;
+        if (!s.pid.compare_exchange_strong(pid, 0, std::memory_order_acq_rel)) return false;
+        hdr_->finished.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Consistent copy of a slot; returns false if it is free or kept changing.
+    bool read(const TopSlot& s, TopSnapshot& out) const {
+        for (int attempt = 0; attempt < 16; attempt++) {
+            uint32_t q1 = s.seq.load(std::memory_order_acquire);
+            if (q1 & 1) continue;
+            uint32_t pid = s.pid.load(std::memory_order_acquire);
+            if (pid == 0) return false;
+            char role[sizeof(s.role)], phase[sizeof(s.phase)], target[sizeof(s.target)];
+            memcpy(role, s.role, sizeof(role));
+            memcpy(phase, s.phase, sizeof(phase));
+            memcpy(target, s.target, sizeof(target));
+            uint64_t start = s.start_us, phase_at = s.phase_us;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (s.seq.load(std::memory_order_relaxed) != q1) continue;
+            out.pid = pid;
+            out.start_us = start;
+            out.phase_us = phase_at;
+            out.role.assign(role, strnlen(role, sizeof(role)));
+            out.phase.assign(phase, strnlen(phase, sizeof(phase)));
+            out.target.assign(target, strnlen(target, sizeof(target)));
+            return true;
+        }
+        return false;
+    }
+
+private:
+    TopHeader* hdr_ = nullptr;
+};
+
+// Copy `src` into a fixed field, keeping the tail when it is too long (the
+// file name is the useful end of a path).
+static inline void top_copy_field(char* dst, size_t cap, const char* src) {
+    size_t n = strlen(src);
+    if (n >= cap) { src += n - (cap - 1); n = cap - 1; }
+    memcpy(dst, src, n);
+    memset(dst + n, 0, cap - n);
+}
+
+// This process's slot. Every method is a no-op when registration is
+// disabled or the table could not be mapped.
+class TopRegistration {
+public:
+    void claim(const char* role, const std::string& target, const char* phase) {
+        if (slot_) return;
+        if (!table_.header()) {
+            if (env_is_truthy("CLANG_TOOL_CHAIN_NO_TOP")) return;
+            // Only an existing table is mapped unless the caller opted in; a
+            // missing ctc home (nothing installed yet) just fails the open.
+            bool create = env_is_truthy("CLANG_TOOL_CHAIN_TOP");
+            if (!table_.open(path_join(get_ctc_home_dir(), TOP_FILENAME), create)) return;
+        }
+
+        pid_ = current_pid();
+        uint32_t start = (uint32_t)((pid_ * 2654435761ull) % TOP_SLOTS);
+        // Pass 1: a free slot near our hash bucket.
+        for (uint32_t k = 0; k < TOP_SLOTS && !slot_; k++) {
+            TopSlot* s = table_.slot((start + k) % TOP_SLOTS);
+            uint32_t expected = 0;
+            if (s->pid.load(std::memory_order_relaxed) == 0 &&
+                s->pid.compare_exchange_strong(expected, pid_, std::memory_order_acq_rel)) {
+                slot_ = s;
+            }
+        }
+        // Pass 2: the table is full of exited compilers nobody has reaped yet.
+        for (uint32_t k = 0; k < TOP_SLOTS && !slot_; k++) {
+            TopSlot* s = table_.slot((start + k) % TOP_SLOTS);
+            uint32_t expected = 0;
+            if (table_.reap(*s, s->pid.load(std::memory_order_relaxed)) &&
+                s->pid.compare_exchange_strong(expected, pid_, std::memory_order_acq_rel)) {
+                slot_ = s;
+            }
+        }
+        if (!slot_) return;
+        table_.header()->started.fetch_add(1, std::memory_order_relaxed);
+
+        uint64_t t = now_us();
+        begin_write();
+        slot_->start_us = t;
+        slot_->phase_us = t;
+        top_copy_field(slot_->role, sizeof(slot_->role), role);
+        top_copy_field(slot_->phase, sizeof(slot_->phase), phase);
+        top_copy_field(slot_->target, sizeof(slot_->target), target.c_str());
+        end_write();
+        if (!atexit_registered_) atexit_registered_ = std::atexit(release_at_exit) == 0;
+    }
+
+    void set_phase(const char* phase) {
+        if (!slot_) return;
+        begin_write();
+        slot_->phase_us = now_us();
+        top_copy_field(slot_->phase, sizeof(slot_->phase), phase);
+        end_write();
+    }
+
+    void release() {
+        if (!slot_) return;
+        uint32_t expected = pid_;
+        if (slot_->pid.compare_exchange_strong(expected, 0, std::memory_order_acq_rel)) {
+            table_.header()->finished.fetch_add(1, std::memory_order_relaxed);
+        }
+        slot_ = nullptr;
+    }
+
+    static TopRegistration& self() {
+        static TopRegistration reg;
+        return reg;
+    }
+
+private:
+    void begin_write() {
+        uint32_t q = slot_->seq.load(std::memory_order_relaxed);
+        slot_->seq.store(q | 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+    void end_write() {
+        uint32_t q = slot_->seq.load(std::memory_order_relaxed);
+        slot_->seq.store(q + 1, std::memory_order_release);
+    }
+    static void release_at_exit() { self().release(); }
+
+    TopTable table_;
+    TopSlot* slot_ = nullptr;
+    uint32_t pid_ = 0;
+    bool atexit_registered_ = false;
+};
+
+// Best-effort "what is this invocation producing": the -o / /OUT: value,
+// else the first argument that looks like a file.
+static inline std::string guess_invocation_target(int argc, char* argv[]) {
+    std::string first_file;
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        if (strcmp(a, "-o") == 0 && i + 1 < argc) return argv[i + 1];
+        if (starts_with(to_lower(a), "/out:") || starts_with(to_lower(a), "-out:")) return a + 5;
+        if (starts_with(a, "--output=")) return a + 9;
+        if (a[0] == '-' && a[1] == 'o' && a[2]) return a + 2;
+        if (first_file.empty() && a[0] != '-' &&
+            (strchr(a, '.') || strchr(a, '/') || strchr(a, '\\'))) {
+            first_file = a;
+        }
+    }
+    return first_file;
+}
+
+// ============================================================================
+// Section 12: Native Emscripten Discovery
+// ============================================================================
+//
+// The emcc, wasm-ld and em* launchers used to spawn Python on every cache
+// miss just to import clang_tool_chain.execution.emscripten and print a few
+// paths. The layout those helpers compute is fixed, so it is resolved here
+// directly:
+//
+//   ~/.clang-tool-chain/emscripten/<plat>/<arch>/
+//       done.txt        install marker
+//       .emscripten     config (LLVM_ROOT = '...', NODE_JS = '...')
+//       emscripten/     emcc.py, em++.py, tools/*.py
+//       bin/            clang, wasm-ld, wasm-opt (LLVM_ROOT)
+//   ~/.clang-tool-chain/nodejs/<plat>/<arch>/bin/node[.exe]
+//
+// Python is still needed when this fails — the install is missing or
+// incomplete and the package's installer has to run.
+
+struct EmscriptenLayout {
+    std::string install_dir;      // .../emscripten/<plat>/<arch>
+    std::string emscripten_dir;   // install_dir/emscripten
+    std::string config_path;      // install_dir/.emscripten
+    std::string bin_dir;          // LLVM_ROOT (install_dir/bin)
+    std::string node_path;        // bundled node, else NODE_JS / PATH
+    std::string python_path;      // interpreter for the .py tools (may be empty)
+};
+
+// Read a string assignment (`KEY = '...'` or `KEY = "..."`) from an
+// emscripten config file. The config is Python, but the installer only ever
+// writes plain literals; anything else returns empty.
+static inline std::string em_config_value(const std::string& content, const char* key) {
+    size_t klen = strlen(key);
+    std::istringstream stream(content);
+    std::string line;
+    while (std::getline(stream, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        size_t i = line.find_first_not_of(" \t");
+        if (i == std::string::npos || line.compare(i, klen, key) != 0) continue;
+        i = line.find_first_not_of(" \t", i + klen);
+        if (i == std::string::npos || line[i] != '=') continue;
+        i = line.find_first_not_of(" \t", i + 1);
+        if (i == std::string::npos || (line[i] != '\'' && line[i] != '"')) return "";
+        size_t end = line.find(line[i], i + 1);
+        if (end == std::string::npos) return "";
+        return line.substr(i + 1, end - i - 1);
+    }
+    return "";
+}
+
+// Locate an emscripten tool script, mirroring find_emscripten_tool: core
+// tools sit at the top level, newer releases keep the rest under tools/.
+static inline std::string find_emscripten_script(const std::string& emscripten_dir,
+                                                 const std::string& tool) {
+    const std::string tools_dir = path_join(emscripten_dir, "tools");
+    const std::string candidates[] = {
+        path_join(emscripten_dir, tool + ".py"),
+        path_join(emscripten_dir, tool),
+        path_join(tools_dir, tool + ".py"),
+        path_join(tools_dir, tool),
+    };
+    for (const auto& c : candidates) {
+        if (path_exists(c)) return c;
+    }
+    return "";
+}
+
+// Python for the emscripten .py tools. EMSDK_PYTHON is emsdk's own override;
+// otherwise the first python on PATH. emcc.py only needs a stock Python 3,
+// not the interpreter clang-tool-chain happens to be installed into.
+static inline std::string find_emscripten_python() {
+    std::string p = get_env("EMSDK_PYTHON");
+    if (!p.empty() && path_exists(p)) return p;
+    return find_python();
+}
+
+// Fill `out` from the on-disk layout. Returns false (with `why` set) when the
+// install is missing or incomplete; `need_node` also requires a node binary.
+static inline bool discover_emscripten_native(Platform platform, Arch arch, bool need_node,
+                                              EmscriptenLayout& out, std::string& why) {
+    std::string base = get_ctc_home_dir();
+    out.install_dir = path_join(path_join(path_join(base, "emscripten"), platform_str(platform)),
+                                arch_str(arch));
+    out.emscripten_dir = path_join(out.install_dir, "emscripten");
+    out.config_path = path_join(out.install_dir, ".emscripten");
+
+    if (!path_exists(path_join(out.install_dir, "done.txt"))) {
+        why = "emscripten not installed at " + out.install_dir;
+        return false;
+    }
+    std::string config = read_file(out.config_path);
+    if (config.empty()) {
+        why = "missing config " + out.config_path;
+        return false;
+    }
+    out.bin_dir = em_config_value(config, "LLVM_ROOT");
+    if (out.bin_dir.empty()) out.bin_dir = path_join(out.install_dir, "bin");
+#ifdef _WIN32
+    for (auto& c : out.bin_dir) if (c == '/') c = '\\';  // config uses forward slashes
+#endif
+    if (!is_directory(out.bin_dir) || !is_directory(out.emscripten_dir)) {
+        why = "incomplete install (no " + out.bin_dir + " or " + out.emscripten_dir + ")";
+        return false;
+    }
+
+    const char* node_name = platform == Platform::Windows ? "node.exe" : "node";
+    std::string bundled = path_join(path_join(path_join(path_join(path_join(
+        base, "nodejs"), platform_str(platform)), arch_str(arch)), "bin"), node_name);
+    std::string config_node = em_config_value(config, "NODE_JS");
+    if (path_exists(bundled)) {
+        out.node_path = bundled;
+    } else if (!config_node.empty() && path_exists(config_node)) {
+        out.node_path = config_node;
+    } else {
+        out.node_path = find_in_path(node_name);
+    }
+    if (need_node && out.node_path.empty()) {
+        why = "node not found (bundled Node.js not installed)";
+        return false;
+    }
+
+    // Only the .py tools need it; wasm-ld doesn't, so absence isn't fatal here.
+    out.python_path = find_emscripten_python();
+    return true;
+}
+
+// ============================================================================
+// Section 13: Work-Stealing Executor
+// ============================================================================
+//
+// Fork/join pool for launcher phases that fan out over files. Every thread
+// owns a deque: it pops its own work LIFO and steals from the others FIFO.
+// Threads start lazily — one more only when two or more tasks are queued and
+// nobody is idle — so a phase that submits a single task runs it inline in
+// wait() and never creates a thread (async() opts out of that for work the
+// caller wants to overlap with its own). Width comes from CTC_JOBS, else the
+// hardware concurrency; under a GNU make jobserver each extra thread must
+// first take a token (non-blocking), so a `make -jN` build stays at N.
+// A task that throws doesn't stop the others; wait() rethrows the first
+// exception once everything has finished.
+
+// Client side of the GNU make jobserver (MAKEFLAGS --jobserver-auth=...).
+// Tokens are only taken non-blockingly; when that is impossible (pipe fds on
+// a host without /proc) the launcher simply stays serial.
+class Jobserver {
+public:
+    static Jobserver& instance() {
+        static Jobserver js;
+        return js;
+    }
+
+    bool present() const { return present_; }
+
+    bool try_acquire() {
+        if (!present_) return true;
+        std::lock_guard<std::mutex> lock(m_);
+#ifdef _WIN32
+        if (!sem_ || WaitForSingleObject(sem_, 0) != WAIT_OBJECT_0) return false;
+        held_.push_back('+');
+        return true;
+#else
+        if (rfd_ < 0) return false;
+        char c;
+        if (::read(rfd_, &c, 1) != 1) return false;
+        held_.push_back(c);
+        return true;
+#endif
+    }
+
+    void release() {
+        if (!present_) return;
+        std::lock_guard<std::mutex> lock(m_);
+        if (held_.empty()) return;
+        char c = held_.back();
+        held_.pop_back();
+#ifdef _WIN32
+        (void)c;
+        ReleaseSemaphore(sem_, 1, nullptr);
+#else
+        while (::write(wfd_, &c, 1) < 0 && errno == EINTR) {}
+#endif
+    }
+
+private:
+    Jobserver() {
+        std::string flags = get_env("MAKEFLAGS");
+        std::string auth;
+        std::istringstream ss(flags);
+        for (std::string tok; ss >> tok;) {
+            for (const char* key : {"--jobserver-auth=", "--jobserver-fds="}) {
+                if (tok.compare(0, strlen(key), key) == 0) auth = tok.substr(strlen(key));
+            }
+        }
+        if (auth.empty()) return;
+        present_ = true;
+#ifdef _WIN32
+        sem_ = OpenSemaphoreA(SEMAPHORE_MODIFY_STATE | SYNCHRONIZE, FALSE, auth.c_str());
+#else
+        if (auth.compare(0, 5, "fifo:") == 0) {
+            rfd_ = wfd_ = ::open(auth.c_str() + 5, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+            return;
+        }
+        int r = -1, w = -1;
+        if (sscanf(auth.c_str(), "%d,%d", &r, &w) != 2 || r < 0 || w < 0) return;
+        if (fcntl(r, F_GETFD) < 0 || fcntl(w, F_GETFD) < 0) return;  // make didn't pass them down
+#ifdef __linux__
+        // A private non-blocking description of the read end; setting
+        // O_NONBLOCK on the inherited fd would flip it for make as well.
+        rfd_ = ::open(("/proc/self/fd/" + std::to_string(r)).c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        wfd_ = w;
+#endif
+#endif
+    }
+
+    bool present_ = false;
+    std::mutex m_;
+    std::vector<char> held_;
+#ifdef _WIN32
+    HANDLE sem_ = nullptr;
+#else
+    int rfd_ = -1;
+    int wfd_ = -1;
+#endif
+};
+
+// Threads a launcher phase may use in total, the calling thread included.
+static inline unsigned default_parallelism() {
+    int jobs = atoi(get_env("CTC_JOBS").c_str());
+    if (jobs > 0) return (unsigned)jobs;
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+class Executor {
+public:
+    // max_threads counts the calling thread; 0 = default_parallelism().
+    explicit Executor(unsigned max_threads = 0)
+        : max_threads_(max_threads ? max_threads : default_parallelism()) {
+        for (unsigned i = 0; i < max_threads_; i++) queues_.emplace_back(new Queue);
+    }
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    ~Executor() {
+        drain();
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& t : threads_) t.join();
+        for (size_t i = 0; i < threads_.size(); i++) Jobserver::instance().release();
+    }
+
+    void submit(std::function<void()> task) {
+        size_t self = this_queue();
+        {
+            std::lock_guard<std::mutex> lock(queues_[self]->m);
+            queues_[self]->tasks.push_back(std::move(task));
+        }
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        size_t queued;
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            queued = ++queued_;
+        }
+        if (idle_.load(std::memory_order_relaxed) > 0) cv_.notify_one();
+        else if (queued >= 2) maybe_spawn();
+    }
+
+    // Like submit(), but starts a thread for the task even if it is the only
+    // one queued, so the caller can overlap its own (non-task) work with it.
+    void async(std::function<void()> task) {
+        submit(std::move(task));
+        if (idle_.load(std::memory_order_relaxed) == 0) maybe_spawn();
+    }
+
+    // Run and steal tasks on the calling thread until every submitted task
+    // (including ones submitted by other tasks) has finished, then rethrow
+    // the first exception a task raised, if any.
+    void wait() {
+        drain();
+        std::exception_ptr error;
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            std::swap(error, error_);
+        }
+        if (error) std::rethrow_exception(error);
+    }
+
+    unsigned max_threads() const { return max_threads_; }
+    size_t threads_started() const { return threads_.size(); }
+
+private:
+    struct Queue {
+        std::mutex m;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void drain() {
+        std::function<void()> task;
+        for (;;) {
+            if (take(0, task)) {
+                run(task);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m_);
+            if (pending_.load(std::memory_order_acquire) == 0) return;
+            cv_.wait(lock, [&] { return queued_ > 0 || pending_.load(std::memory_order_acquire) == 0; });
+        }
+    }
+
+    // Queue of the current thread: its worker index, or 0 for outside threads.
+    size_t this_queue() const {
+        const auto& tl = tls();
+        return tl.first == this ? tl.second : 0;
+    }
+
+    static std::pair<const Executor*, size_t>& tls() {
+        static thread_local std::pair<const Executor*, size_t> owner{nullptr, 0};
+        return owner;
+    }
+
+    bool take(size_t self, std::function<void()>& out) {
+        {
+            std::lock_guard<std::mutex> lock(queues_[self]->m);
+            auto& q = queues_[self]->tasks;
+            if (!q.empty()) {
+                out = std::move(q.back());
+                q.pop_back();
+                return claimed();
+            }
+        }
+        for (size_t k = 1; k < queues_.size(); k++) {
+            Queue& victim = *queues_[(self + k) % queues_.size()];
+            std::lock_guard<std::mutex> lock(victim.m);
+            if (!victim.tasks.empty()) {
+                out = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return claimed();
+            }
+        }
+        return false;
+    }
+
+    bool claimed() {
+        std::lock_guard<std::mutex> lock(m_);
+        queued_--;
+        return true;
+    }
+
+    void run(std::function<void()>& task) {
+        try {
+            task();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(m_);
+            if (!error_) error_ = std::current_exception();
+        }
+        task = nullptr;
+        if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lock(m_);
+            cv_.notify_all();
+        }
+    }
+
+    void maybe_spawn() {
+        std::lock_guard<std::mutex> lock(spawn_m_);
+        if (threads_.size() + 1 >= max_threads_) return;
+        if (!Jobserver::instance().try_acquire()) return;
+        size_t index = threads_.size() + 1;
+        threads_.emplace_back([this, index] { worker(index); });
+    }
+
+    void worker(size_t index) {
+        tls() = {this, index};
+        std::function<void()> task;
+        for (;;) {
+            if (take(index, task)) {
+                run(task);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m_);
+            idle_.fetch_add(1, std::memory_order_relaxed);
+            cv_.wait(lock, [&] { return stop_ || queued_ > 0; });
+            idle_.fetch_sub(1, std::memory_order_relaxed);
+            if (stop_ && queued_ == 0) return;
+        }
+    }
+
+    const unsigned max_threads_;
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+    std::mutex spawn_m_;
+    std::mutex m_;  // guards queued_, stop_, error_; pairs with cv_
+    std::condition_variable cv_;
+    size_t queued_ = 0;
+    bool stop_ = false;
+    std::exception_ptr error_;
+    std::atomic<size_t> pending_{0};
+    std::atomic<unsigned> idle_{0};
+};
+
+// Run fn(0) .. fn(n-1) on an Executor; n <= 1 runs inline with no pool.
+// Every index runs even if some throw; the first exception is rethrown.
+template <typename F>
+static inline void parallel_for(size_t n, F&& fn, unsigned max_threads = 0) {
+    if (n == 0) return;
+    if (n == 1 || max_threads == 1) {
+        std::exception_ptr error;
+        for (size_t i = 0; i < n; i++) {
+            try {
+                fn(i);
+            } catch (...) {
+                if (!error) error = std::current_exception();
+            }
+        }
+        if (error) std::rethrow_exception(error);
+        return;
+    }
+    Executor ex(max_threads);
+    for (size_t i = 0; i < n; i++) ex.submit([&fn, i] { fn(i); });
+    ex.wait();
+}
+
+// ============================================================================
+// Section 14: Hashing (128-bit content hash + file digest)
+// ============================================================================
+//
+// Non-cryptographic 128-bit hash for cache keys and file digests. Input is
+// consumed in 64-byte stripes by eight 64-bit accumulator lanes — the XXH3
+// long-input step: acc[i] += lo32(d^k) * hi32(d^k), acc[i^1] += d — with a
+// scramble every 16 stripes and a multiply-fold finalizer. The SSE2 and NEON
+// kernels compute exactly the scalar function, so digests are identical on
+// every host. The key schedule is our own: values are NOT XXH3-compatible.
+
+struct Hash128 {
+    uint64_t lo = 0;
+    uint64_t hi = 0;
+
+    bool operator==(const Hash128& o) const { return lo == o.lo && hi == o.hi; }
+    bool operator!=(const Hash128& o) const { return !(*this == o); }
+
+    std::string hex() const {
+        char buf[33];
+        snprintf(buf, sizeof(buf), "%016llx%016llx", (unsigned long long)hi, (unsigned long long)lo);
+        return buf;
+    }
+};
+
+namespace hash_detail {
+
+static constexpr size_t STRIPE = 64;
+static constexpr size_t STRIPES_PER_BLOCK = 16;
+static constexpr uint64_t P32_1 = 0x9E3779B1ULL;
+static constexpr uint64_t P64_1 = 0x9E3779B185EBCA87ULL;
+static constexpr uint64_t P64_2 = 0xC2B2AE3D27D4EB4FULL;
+
+// Key schedule: 32 words of splitmix64. Stripe n of a block reads words
+// [n, n+8), the scramble [24, 32), the two finalizer halves [8, 16) / [16, 24).
+struct Secret {
+    uint64_t w[32];
+    constexpr Secret() : w{} {
+        uint64_t x = 0x6374632d68617368ULL;  // "ctc-hash"
+        for (int i = 0; i < 32; i++) {
+            x += 0x9E3779B97F4A7C15ULL;
+            uint64_t z = x;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            w[i] = z ^ (z >> 31);
+        }
+    }
+};
+static constexpr Secret SECRET{};
+
+static inline uint64_t read64(const unsigned char* p) {
+    uint64_t v;
+    memcpy(&v, p, 8);  // little-endian hosts only (x86_64, arm64)
+    return v;
+}
+
+#if defined(CTC_HASH_NO_SIMD)
+static constexpr const char* HASH_KERNEL = "scalar";
+#elif defined(__SSE2__) || defined(_M_X64)
+static constexpr const char* HASH_KERNEL = "sse2";
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+static constexpr const char* HASH_KERNEL = "neon";
+#else
+static constexpr const char* HASH_KERNEL = "scalar";
+#endif
+
+// Accumulate `n` whole stripes, the first being stripe `first` of its block
+// (first + n <= STRIPES_PER_BLOCK).
+static inline void accumulate(uint64_t* acc, const unsigned char* p, size_t n, size_t first) {
+    const uint64_t* key = SECRET.w + first;
+#if !defined(CTC_HASH_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+    __m128i a[4];
+    for (int i = 0; i < 4; i++) a[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + 2 * i));
+    for (size_t s = 0; s < n; s++, p += STRIPE, key++) {
+        for (int i = 0; i < 4; i++) {
+            __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * i));
+            __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key + 2 * i));
+            __m128i dk = _mm_xor_si128(d, k);
+            __m128i prod = _mm_mul_epu32(dk, _mm_shuffle_epi32(dk, _MM_SHUFFLE(0, 3, 0, 1)));
+            __m128i swap = _mm_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+            a[i] = _mm_add_epi64(a[i], _mm_add_epi64(prod, swap));
+        }
+    }
+    for (int i = 0; i < 4; i++) _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + 2 * i), a[i]);
+#elif !defined(CTC_HASH_NO_SIMD) && (defined(__ARM_NEON) || defined(_M_ARM64))
+    uint64x2_t a[4];
+    for (int i = 0; i < 4; i++) a[i] = vld1q_u64(acc + 2 * i);
+    for (size_t s = 0; s < n; s++, p += STRIPE, key++) {
+        for (int i = 0; i < 4; i++) {
+            uint64x2_t d = vreinterpretq_u64_u8(vld1q_u8(p + 16 * i));
+            uint64x2_t dk = veorq_u64(d, vld1q_u64(key + 2 * i));
+            uint64x2_t prod = vmull_u32(vmovn_u64(dk), vshrn_n_u64(dk, 32));
+            a[i] = vaddq_u64(a[i], vaddq_u64(prod, vextq_u64(d, d, 1)));
+        }
+    }
+    for (int i = 0; i < 4; i++) vst1q_u64(acc + 2 * i, a[i]);
+#else
+    for (size_t s = 0; s < n; s++, p += STRIPE, key++) {
+        for (int i = 0; i < 8; i++) {
+            uint64_t d = read64(p + 8 * i);
+            uint64_t dk = d ^ key[i];
+            acc[i ^ 1] += d;
+            acc[i] += (dk & 0xFFFFFFFFULL) * (dk >> 32);
+        }
+    }
+#endif
+}
+
+static inline void scramble(uint64_t* acc) {
+    for (int i = 0; i < 8; i++) {
+        uint64_t a = acc[i];
+        a ^= a >> 47;
+        a ^= SECRET.w[24 + i];
+        acc[i] = a * P32_1;
+    }
+}
+
+static inline uint64_t mul_fold64(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = (__uint128_t)a * b;
+    return (uint64_t)r ^ (uint64_t)(r >> 64);
+#else
+    uint64_t al = a & 0xFFFFFFFFULL, ah = a >> 32, bl = b & 0xFFFFFFFFULL, bh = b >> 32;
+    uint64_t ll = al * bl, lh = al * bh, hl = ah * bl, hh = ah * bh;
+    uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFFULL) + (hl & 0xFFFFFFFFULL);
+    uint64_t lo = (mid << 32) | (ll & 0xFFFFFFFFULL);
+    uint64_t hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+    return lo ^ hi;
+#endif
+}
+
+static inline uint64_t merge(const uint64_t* acc, const uint64_t* key, uint64_t start) {
+    uint64_t r = start;
+    for (int i = 0; i < 4; i++) r += mul_fold64(acc[2 * i] ^ key[2 * i], acc[2 * i + 1] ^ key[2 * i + 1]);
+    r ^= r >> 37;
+    r *= 0x165667919E3779F9ULL;
+    return r ^ (r >> 32);
+}
+
+} // namespace hash_detail
+
+// Streaming hasher. Any split of the same bytes across update() calls gives
+// the same digest; digest() does not consume the state.
+class Hasher128 {
+public:
+    Hasher128() { reset(); }
+
+    void reset() {
+        static constexpr uint64_t init[8] = {
+            0xC2B2AE3DULL, 0x9E3779B185EBCA87ULL, 0xC2B2AE3D27D4EB4FULL, 0x165667B19E3779F9ULL,
+            0x85EBCA77C2B2AE63ULL, 0x85EBCA77ULL, 0x27D4EB2F165667C5ULL, 0x9E3779B1ULL};
+        memcpy(acc_, init, sizeof(acc_));
+        total_ = 0;
+        stripe_ = 0;
+        buf_len_ = 0;
+    }
+
+    void update(const void* data, size_t len) {
+        using namespace hash_detail;
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        total_ += len;
+        if (buf_len_) {
+            size_t take = std::min(len, STRIPE - buf_len_);
+            memcpy(buf_ + buf_len_, p, take);
+            buf_len_ += take;
+            p += take;
+            len -= take;
+            if (buf_len_ < STRIPE) return;
+            consume(buf_, 1);
+            buf_len_ = 0;
+        }
+        if (len >= STRIPE) {
+            size_t n = len / STRIPE;
+            consume(p, n);
+            p += n * STRIPE;
+            len -= n * STRIPE;
+        }
+        if (len) {
+            memcpy(buf_, p, len);
+            buf_len_ = len;
+        }
+    }
+
+    void update(const std::string& s) { update(s.data(), s.size()); }
+
+    Hash128 digest() const {
+        using namespace hash_detail;
+        uint64_t acc[8];
+        memcpy(acc, acc_, sizeof(acc));
+        if (buf_len_) {
+            // Zero-padded final stripe; the length in the finalizer keeps
+            // "ab" and "ab\0" apart.
+            unsigned char last[STRIPE] = {};
+            memcpy(last, buf_, buf_len_);
+            accumulate(acc, last, 1, stripe_);
+        }
+        Hash128 h;
+        h.lo = merge(acc, SECRET.w + 8, total_ * P64_1);
+        h.hi = merge(acc, SECRET.w + 16, ~(total_ * P64_2));
+        return h;
+    }
+
+private:
+    // Whole stripes straight from the caller's buffer, scrambling at each
+    // block boundary.
+    void consume(const unsigned char* p, size_t n) {
+        using namespace hash_detail;
+        while (n) {
+            size_t take = std::min(n, STRIPES_PER_BLOCK - stripe_);
+            accumulate(acc_, p, take, stripe_);
+            p += take * STRIPE;
+            n -= take;
+            stripe_ += take;
+            if (stripe_ == STRIPES_PER_BLOCK) {
+                scramble(acc_);
+                stripe_ = 0;
+            }
+        }
+    }
+
+    uint64_t acc_[8];
+    uint64_t total_;
+    size_t stripe_;
+    size_t buf_len_;
+    unsigned char buf_[hash_detail::STRIPE];
+};
+
+static inline Hash128 hash128(const void* data, size_t len) {
+    Hasher128 h;
+    h.update(data, len);
+    return h.digest();
+}
+
+static inline Hash128 hash128(const std::string& s) { return hash128(s.data(), s.size()); }
+
+// Cache key over an argument list. Each part is length-prefixed, so
+// {"ab", "c"} and {"a", "bc"} never collide.
+static inline Hash128 hash128_parts(const std::vector<std::string>& parts) {
+    Hasher128 h;
+    for (const auto& s : parts) {
+        uint64_t n = (uint64_t)s.size();
+        h.update(&n, sizeof(n));
+        h.update(s);
+    }
+    return h.digest();
+}
+
+// Read-only mapping of a whole file. Empty files map to (nullptr, 0).
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+
+    bool open(const std::string& path) {
+        close();
+#ifdef _WIN32
+        HANDLE f = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                               nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (f == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(f, &size)) {
+            CloseHandle(f);
+            return false;
+        }
+        size_ = (size_t)size.QuadPart;
+        if (size_ == 0) {
+            CloseHandle(f);
+            return true;
+        }
+        HANDLE m = CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(f);
+        if (!m) return false;
+        data_ = static_cast<const unsigned char*>(MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0));
+        CloseHandle(m);
+        return data_ != nullptr;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+            ::close(fd);
+            return false;
+        }
+        size_ = (size_t)st.st_size;
+        if (size_ == 0) {
+            ::close(fd);
+            return true;
+        }
+        void* p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        data_ = static_cast<const unsigned char*>(p);
+        return true;
+#endif
+    }
+
+    void close() {
+        if (data_) {
+#ifdef _WIN32
+            UnmapViewOfFile(data_);
+#else
+            munmap(const_cast<unsigned char*>(data_), size_);
+#endif
+        }
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    const unsigned char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const unsigned char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Files above this size are digested as independent chunks.
+static constexpr size_t FILE_DIGEST_CHUNK = (size_t)8 << 20;
+
+// Digest of a file's contents. Files up to FILE_DIGEST_CHUNK hash to exactly
+// hash128(contents). Larger files are cut into FILE_DIGEST_CHUNK pieces hashed
+// on up to `threads` threads (0 = default_parallelism()); the digest is then the
+// hash of the chunk digests plus the size — independent of the thread count,
+// but only comparable with other file digests.
+static inline bool file_digest(const std::string& path, Hash128& out, unsigned threads = 0) {
+    MappedFile f;
+    if (!f.open(path)) return false;
+    if (f.size() <= FILE_DIGEST_CHUNK) {
+        out = hash128(f.data(), f.size());
+        return true;
+    }
+    size_t nchunks = (f.size() + FILE_DIGEST_CHUNK - 1) / FILE_DIGEST_CHUNK;
+    std::vector<Hash128> chunks(nchunks);
+    parallel_for(nchunks, [&](size_t i) {
+        size_t off = i * FILE_DIGEST_CHUNK;
+        chunks[i] = hash128(f.data() + off, std::min(FILE_DIGEST_CHUNK, f.size() - off));
+    }, threads);
+
+    Hasher128 h;
+    for (const auto& c : chunks) {
+        h.update(&c.lo, sizeof(c.lo));
+        h.update(&c.hi, sizeof(c.hi));
+    }
+    uint64_t size = (uint64_t)f.size();
+    h.update(&size, sizeof(size));
+    out = h.digest();
+    return true;
+}
+
+// ============================================================================
+// Section 15: Clang Zygote Protocol (Linux)
+// ============================================================================
+//
+// Client half of the fork-server protocol spoken by libctc_zygote.so
+// (ctc_zygote.cpp — keep the two in sync). One connection per compile:
+//
+//   client -> u32 length, with SCM_RIGHTS {stdin, stdout, stderr} attached,
+//             then `length` bytes: u32 magic, u32 umask, u32 argc, argv...,
+//             cwd, u32 envc, env... (strings are u32 length + bytes; all
+//             integers little-endian)
+//   server -> 'P' + u32 pid once the compile is forked, then 'S' + i32 wait
+//             status when it exits; 'E' + u32 errno if it could not fork.
+//
+// Nothing is sent back before 'P', so a client that sees the connection drop
+// earlier can still fall back to exec'ing clang itself.
+
+#ifdef __linux__
+
+static constexpr uint32_t ZYGOTE_MAGIC = 0x315a5443;  // "CTZ1"
+
+// Per-user directory for zygote sockets. sun_path holds only 108 bytes, so
+// this stays short: $XDG_RUNTIME_DIR, else /tmp/ctc-zygote-<uid> (0700,
+// must be ours and not a symlink). Empty when no safe directory exists.
+static inline std::string zygote_socket_dir() {
+    std::string xdg = get_env("XDG_RUNTIME_DIR");
+    if (!xdg.empty() && is_directory(xdg) && xdg.size() < 60) return xdg;
+    std::string dir = "/tmp/ctc-zygote-" + std::to_string((unsigned)getuid());
+    mkdir(dir.c_str(), 0700);
+    struct stat st;
+    if (lstat(dir.c_str(), &st) != 0 || !S_ISDIR(st.st_mode) || st.st_uid != getuid() ||
+        (st.st_mode & 077) != 0) {
+        return "";
+    }
+    return dir;
+}
+
+static inline void zygote_put_u32(std::string& out, uint32_t v) {
+    char b[4] = {(char)(v & 0xff), (char)((v >> 8) & 0xff), (char)((v >> 16) & 0xff), (char)(v >> 24)};
+    out.append(b, 4);
+}
+
+static inline void zygote_put_str(std::string& out, const std::string& s) {
+    zygote_put_u32(out, (uint32_t)s.size());
+    out += s;
+}
+
+static inline std::string zygote_encode_request(const std::vector<std::string>& argv,
+                                                const std::string& cwd, char** envp,
+                                                uint32_t umask_bits) {
+    std::string out;
+    zygote_put_u32(out, ZYGOTE_MAGIC);
+    zygote_put_u32(out, umask_bits);
+    zygote_put_u32(out, (uint32_t)argv.size());
+    for (const auto& a : argv) zygote_put_str(out, a);
+    zygote_put_str(out, cwd);
+    uint32_t envc = 0;
+    for (char** e = envp; e && *e; e++) envc++;
+    zygote_put_u32(out, envc);
+    for (char** e = envp; e && *e; e++) zygote_put_str(out, *e);
+    return out;
+}
+
+// Socket writes only: MSG_NOSIGNAL turns a zygote that hung up without
+// reading (clang upgraded, client table full) into EPIPE instead of SIGPIPE,
+// so the client can fall back to exec.
+static inline bool zygote_write_all(int fd, const char* p, size_t n) {
+    while (n) {
+        ssize_t w = ::send(fd, p, n, MSG_NOSIGNAL);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return false;
+        p += w;
+        n -= (size_t)w;
+    }
+    return true;
+}
+
+static inline bool zygote_read_all(int fd, char* p, size_t n) {
+    while (n) {
+        ssize_t r = ::read(fd, p, n);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return false;
+        p += r;
+        n -= (size_t)r;
+    }
+    return true;
+}
+
+// Send the request with our stdio attached. False if the zygote hung up.
+static inline bool zygote_send_request(int sock, const std::string& body) {
+    char len[4];
+    uint32_t n = (uint32_t)body.size();
+    for (int i = 0; i < 4; i++) len[i] = (char)((n >> (8 * i)) & 0xff);
+    int fds[3] = {0, 1, 2};
+    char ctrl[CMSG_SPACE(sizeof(fds))];
+    memset(ctrl, 0, sizeof(ctrl));
+    struct iovec iov = {len, sizeof(len)};
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctrl;
+    msg.msg_controllen = sizeof(ctrl);
+    struct cmsghdr* cm = CMSG_FIRSTHDR(&msg);
+    cm->cmsg_level = SOL_SOCKET;
+    cm->cmsg_type = SCM_RIGHTS;
+    cm->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cm), fds, sizeof(fds));
+    ssize_t w;
+    do {
+        w = sendmsg(sock, &msg, MSG_NOSIGNAL);
+    } while (w < 0 && errno == EINTR);
+    return w == (ssize_t)sizeof(len) && zygote_write_all(sock, body.data(), body.size());
+}
+
+// Read one 5-byte reply: tag + 32-bit value.
+static inline bool zygote_read_reply(int sock, char& tag, int32_t& value) {
+    unsigned char b[5];
+    if (!zygote_read_all(sock, reinterpret_cast<char*>(b), sizeof(b))) return false;
+    tag = (char)b[0];
+    value = (int32_t)((uint32_t)b[1] | ((uint32_t)b[2] << 8) | ((uint32_t)b[3] << 16) | ((uint32_t)b[4] << 24));
+    return true;
+}
+
+#endif // __linux__
+
+// ============================================================================
+// Section 16: Compilation Database (compile_commands.json)
+// ============================================================================
+//
+// Pull parser for the clang JSON compilation database: one pass over the
+// (usually mmap'd) buffer, one CompileCommand per next() call, no DOM. Keys
+// other than directory/file/output/arguments/command are skipped, whatever
+// their value. "command" strings are split with split_shell().
+
+struct CompileCommand {
+    std::string directory;
+    std::string file;
+    std::string output;
+    std::vector<std::string> arguments;
+};
+
+class CompileDbReader {
+public:
+    CompileDbReader(const char* data, size_t size) : p_(data), end_(data + size) {}
+
+    // Next entry, or false at the end of the array or on malformed input
+    // (then error() says what and where).
+    bool next(CompileCommand& out) {
+        if (!error_.empty() || done_) return false;
+        ws();
+        if (!started_) {
+            if (!expect('[')) return false;
+            started_ = true;
+            ws();
+            if (p_ < end_ && *p_ == ']') return finish();
+        } else {
+            if (p_ < end_ && *p_ == ']') return finish();
+            if (!expect(',')) return false;
+            ws();
+        }
+        return entry(out);
+    }
+
+    const std::string& error() const { return error_; }
+
+private:
+    const char* p_;
+    const char* end_;
+    const char* begin_ = p_;
+    bool started_ = false;
+    bool done_ = false;
+    std::string error_;
+
+    bool fail(const char* what) {
+        if (error_.empty()) error_ = std::string(what) + " at byte " + std::to_string(p_ - begin_);
+        return false;
+    }
+
+    bool finish() {
+        p_++;
+        done_ = true;
+        return false;
+    }
+
+    void ws() {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\n' || *p_ == '\r' || *p_ == '\t')) p_++;
+    }
+
+    bool expect(char c) {
+        ws();
+        if (p_ >= end_ || *p_ != c) return fail((std::string("expected '") + c + "'").c_str());
+        p_++;
+        return true;
+    }
+
+    static int hex_digit(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    bool hex4(uint32_t& cp) {
+        if (end_ - p_ < 4) return false;
+        cp = 0;
+        for (int i = 0; i < 4; i++) {
+            int d = hex_digit(p_[i]);
+            if (d < 0) return false;
+            cp = (cp << 4) | (uint32_t)d;
+        }
+        p_ += 4;
+        return true;
+    }
+
+    static void put_utf8(std::string& s, uint32_t cp) {
+        if (cp < 0x80) {
+            s += (char)cp;
+        } else if (cp < 0x800) {
+            s += (char)(0xC0 | (cp >> 6));
+            s += (char)(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            s += (char)(0xE0 | (cp >> 12));
+            s += (char)(0x80 | ((cp >> 6) & 0x3F));
+            s += (char)(0x80 | (cp & 0x3F));
+        } else {
+            s += (char)(0xF0 | (cp >> 18));
+            s += (char)(0x80 | ((cp >> 12) & 0x3F));
+            s += (char)(0x80 | ((cp >> 6) & 0x3F));
+            s += (char)(0x80 | (cp & 0x3F));
+        }
+    }
+
+    bool string(std::string& s) {
+        s.clear();
+        if (!expect('"')) return false;
+        for (;;) {
+            // Copy the unescaped run in one go; escapes are rare in paths/flags.
+            const char* run = p_;
+            while (p_ < end_ && *p_ != '"' && *p_ != '\\') p_++;
+            s.append(run, (size_t)(p_ - run));
+            if (p_ >= end_) return fail("unterminated string");
+            if (*p_++ == '"') return true;
+            if (p_ >= end_) return fail("unterminated string");
+            char e = *p_++;
+            switch (e) {
+            case '"': s += '"'; break;
+            case '\\': s += '\\'; break;
+            case '/': s += '/'; break;
+            case 'b': s += '\b'; break;
+            case 'f': s += '\f'; break;
+            case 'n': s += '\n'; break;
+            case 'r': s += '\r'; break;
+            case 't': s += '\t'; break;
+            case 'u': {
+                uint32_t cp;
+                if (!hex4(cp)) return fail("bad \\u escape");
+                if (cp >= 0xD800 && cp < 0xDC00 && end_ - p_ >= 6 && p_[0] == '\\' && p_[1] == 'u') {
+                    p_ += 2;
+                    uint32_t lo;
+                    if (!hex4(lo) || lo < 0xDC00 || lo > 0xDFFF) return fail("bad surrogate pair");
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                }
+                put_utf8(s, cp);
+                break;
+            }
+            default: return fail("bad escape");
+            }
+        }
+    }
+
+    // Skip any JSON value (numbers, literals, nested arrays/objects).
+    bool skip_value() {
+        ws();
+        if (p_ >= end_) return fail("unexpected end of input");
+        if (*p_ == '"') {
+            std::string ignored;
+            return string(ignored);
+        }
+        if (*p_ == '[' || *p_ == '{') {
+            int depth = 0;
+            while (p_ < end_) {
+                char c = *p_;
+                if (c == '"') {
+                    std::string ignored;
+                    if (!string(ignored)) return false;
+                    continue;
+                }
+                p_++;
+                if (c == '[' || c == '{') depth++;
+                else if ((c == ']' || c == '}') && --depth == 0) return true;
+            }
+            return fail("unterminated value");
+        }
+        while (p_ < end_ && *p_ != ',' && *p_ != '}' && *p_ != ']' && *p_ != ' ' && *p_ != '\n' &&
+               *p_ != '\r' && *p_ != '\t') {
+            p_++;
+        }
+        return true;
+    }
+
+    bool string_array(std::vector<std::string>& out) {
+        out.clear();
+        if (!expect('[')) return false;
+        ws();
+        if (p_ < end_ && *p_ == ']') {
+            p_++;
+            return true;
+        }
+        for (;;) {
+            out.emplace_back();
+            if (!string(out.back())) return false;
+            ws();
+            if (p_ < end_ && *p_ == ']') {
+                p_++;
+                return true;
+            }
+            if (!expect(',')) return false;
+        }
+    }
+
+    bool entry(CompileCommand& out) {
+        out = CompileCommand();
+        std::string command, key;
+        bool have_arguments = false;
+        if (!expect('{')) return false;
+        ws();
+        if (p_ < end_ && *p_ == '}') {
+            p_++;
+            return fail("entry without file");
+        }
+        for (;;) {
+            if (!string(key) || !expect(':')) return false;
+            ws();
+            bool ok;
+            if (key == "directory") ok = string(out.directory);
+            else if (key == "file") ok = string(out.file);
+            else if (key == "output") ok = string(out.output);
+            else if (key == "command") ok = string(command);
+            else if (key == "arguments") ok = have_arguments = string_array(out.arguments);
+            else ok = skip_value();
+            if (!ok) return false;
+            ws();
+            if (p_ < end_ && *p_ == '}') {
+                p_++;
+                break;
+            }
+            if (!expect(',')) return false;
+            ws();
+        }
+        if (!have_arguments) out.arguments = split_shell(command);
+        if (out.file.empty() || out.arguments.empty()) return fail("entry without file or command");
+        return true;
+    }
+};
+
+// One database entry as a JSON object ("arguments" form), no trailing newline.
+static inline std::string compile_command_json(const CompileCommand& c) {
+    std::string out = "  {\n    \"directory\": \"" + json_escape(c.directory) + "\",\n    \"file\": \"" +
+                      json_escape(c.file) + "\",\n";
+    if (!c.output.empty()) out += "    \"output\": \"" + json_escape(c.output) + "\",\n";
+    out += "    \"arguments\": [";
+    for (size_t i = 0; i < c.arguments.size(); i++) {
+        if (i) out += ", ";
+        out += '"';
+        out += json_escape(c.arguments[i]);
+        out += '"';
+    }
+    out += "]\n  }";
+    return out;
+}
+
+// ============================================================================
+// Section 17: Build Timing Log (CTC_TIMING_LOG)
+// ============================================================================
+//
+// Opt-in per-invocation record for ctc-critical-path. With CTC_TIMING_LOG set
+// to a file, a launcher runs its compiler as a child instead of exec'ing it
+// and appends one tab-separated line when done:
+//
+//   v1 pid role start_us spawn_us exit_us done_us user_us sys_us maxrss_kb rc cwd target
+//
+// start..spawn is launcher setup, spawn..exit the compiler, exit..done
+// post-link work (DLL / shared-lib deployment). Times are wall-clock
+// microseconds (now_us), so records from concurrent launchers line up; CPU
+// time and peak RSS come from wait4() (zero on Windows). Each record is one
+// fwrite to an append-mode stream, so parallel jobs do not interleave lines.
+
+static constexpr const char* TIMING_LOG_VERSION = "v1";
+
+struct TimingRecord {
+    uint32_t pid = 0;
+    std::string role;
+    uint64_t start_us = 0;
+    uint64_t spawn_us = 0;
+    uint64_t exit_us = 0;
+    uint64_t done_us = 0;
+    uint64_t user_us = 0;
+    uint64_t sys_us = 0;
+    uint64_t maxrss_kb = 0;
+    int rc = 0;
+    std::string cwd;
+    std::string target;
+};
+
+// Tabs and newlines would split the record; paths never legitimately have them.
+static inline std::string timing_field(const std::string& s) {
+    std::string out = s;
+    for (auto& c : out) {
+        if (c == '\t' || c == '\n' || c == '\r') c = ' ';
+    }
+    return out;
+}
+
+static inline std::string format_timing_record(const TimingRecord& r) {
+    char nums[256];
+    snprintf(nums, sizeof(nums), "\t%llu\t%llu\t%llu\t%llu\t%llu\t%llu\t%llu\t%d\t",
+             (unsigned long long)r.start_us, (unsigned long long)r.spawn_us, (unsigned long long)r.exit_us,
+             (unsigned long long)r.done_us, (unsigned long long)r.user_us, (unsigned long long)r.sys_us,
+             (unsigned long long)r.maxrss_kb, r.rc);
+    return std::string(TIMING_LOG_VERSION) + "\t" + std::to_string(r.pid) + "\t" + timing_field(r.role) + nums +
+           timing_field(r.cwd) + "\t" + timing_field(r.target) + "\n";
+}
+
+// Inverse of format_timing_record; false for foreign or truncated lines.
+static inline bool parse_timing_record(const std::string& line, TimingRecord& r) {
+    std::vector<std::string> f;
+    size_t pos = 0;
+    while (f.size() < 12) {
+        size_t tab = line.find('\t', pos);
+        if (tab == std::string::npos) break;
+        f.push_back(line.substr(pos, tab - pos));
+        pos = tab + 1;
+    }
+    if (f.size() != 12 || f[0] != TIMING_LOG_VERSION) return false;
+    std::string target = line.substr(pos);
+    if (!target.empty() && target.back() == '\r') target.pop_back();
+    r.pid = (uint32_t)strtoul(f[1].c_str(), nullptr, 10);
+    r.role = f[2];
+    uint64_t* nums[] = {&r.start_us, &r.spawn_us, &r.exit_us, &r.done_us, &r.user_us, &r.sys_us, &r.maxrss_kb};
+    for (size_t i = 0; i < 7; i++) *nums[i] = strtoull(f[3 + i].c_str(), nullptr, 10);
+    r.rc = atoi(f[10].c_str());
+    r.cwd = f[11];
+    r.target = target;
+    return r.exit_us >= r.spawn_us && r.spawn_us >= r.start_us;
+}
+
+class TimingLog {
+public:
+    // Reads CTC_TIMING_LOG once; every other method is a no-op when unset.
+    void begin(const char* role) {
+        path_ = get_env("CTC_TIMING_LOG");
+        if (path_.empty()) return;
+        rec_.start_us = now_us();
+        rec_.pid = current_pid();
+        rec_.role = role;
+#ifdef _WIN32
+        char buf[MAX_PATH * 2];
+        DWORD n = GetCurrentDirectoryA((DWORD)sizeof(buf), buf);
+        if (n > 0 && n < sizeof(buf)) rec_.cwd.assign(buf, n);
+#else
+        char buf[4096];
+        if (getcwd(buf, sizeof(buf))) rec_.cwd = buf;
+#endif
+    }
+
+    bool active() const { return !path_.empty(); }
+    void set_target(const std::string& target) { rec_.target = target; }
+
+    // Run `cmd` as a child and wait; returns its exit code (128+signal when
+    // killed). Call finish() once any post-link work is done.
+    int run(const std::vector<std::string>& cmd, const char* tag) {
+        rec_.spawn_us = now_us();
+#ifdef _WIN32
+        rec_.rc = create_process_and_wait(cmd, tag);
+#else
+        std::vector<const char*> argv_ptrs;
+        for (const auto& s : cmd) argv_ptrs.push_back(s.c_str());
+        argv_ptrs.push_back(nullptr);
+        fflush(stdout);
+        fflush(stderr);
+        pid_t pid = fork();
+        if (pid == 0) {
+            execv(cmd[0].c_str(), const_cast<char**>(argv_ptrs.data()));
+            fprintf(stderr, "%sFailed to exec: %s\n", tag, cmd[0].c_str());
+            _exit(127);
+        }
+        if (pid < 0) {
+            fprintf(stderr, "%sFailed to fork\n", tag);
+            rec_.rc = 1;
+        } else {
+            int status = 0;
+            struct rusage ru;
+            memset(&ru, 0, sizeof(ru));
+            while (wait4(pid, &status, 0, &ru) < 0 && errno == EINTR) {
+            }
+            rec_.rc = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+            rec_.user_us = (uint64_t)ru.ru_utime.tv_sec * 1000000 + (uint64_t)ru.ru_utime.tv_usec;
+            rec_.sys_us = (uint64_t)ru.ru_stime.tv_sec * 1000000 + (uint64_t)ru.ru_stime.tv_usec;
+#ifdef __APPLE__
+            rec_.maxrss_kb = (uint64_t)ru.ru_maxrss / 1024;  // bytes on macOS
+#else
+            rec_.maxrss_kb = (uint64_t)ru.ru_maxrss;
+#endif
+        }
+#endif
+        rec_.exit_us = now_us();
+        return rec_.rc;
+    }
+
+    void finish() {
+        if (!active() || rec_.spawn_us == 0) return;
+        rec_.done_us = now_us();
+        std::string line = format_timing_record(rec_);
+        FILE* f = fopen(path_.c_str(), "ab");
+        if (!f) return;
+        fwrite(line.data(), 1, line.size(), f);
+        fclose(f);
+    }
+
+    // exec_process() when inactive; otherwise run, record and exit with the
+    // child's status.
+    [[noreturn]] void exec(const std::vector<std::string>& cmd, const char* tag) {
+        if (!active()) exec_process(cmd, tag);
+        int rc = run(cmd, tag);
+        finish();
+        std::exit(rc);
+    }
+
+private:
+    std::string path_;
+    TimingRecord rec_;
+};
+
 } // namespace ctc
 
 #endif // CTC_COMMON_H
@@ -0,0 +1,403 @@
+// clang-tool-chain clang zygote (libctc_zygote.so, Linux only)
+//
+// LD_PRELOAD shim that turns the bundled clang into a fork server. Most of a
+// tiny TU's wall time is clang's own startup: mapping and relocating a 100+ MB
+// binary and running LLVM's static initializers (option, target and pass
+// registries). The zygote pays that once and fork()s a pre-initialized copy
+// per compile.
+//
+// How: the shim interposes __libc_start_main. glibc calls main() only after
+// every initializer has run, so the wrapped main() below gets control in a
+// fully initialized clang. With CTC_ZYGOTE_SOCKET unset it just calls clang's
+// real main() (the shim is inert); with it set, the process becomes the
+// server: it listens on that Unix socket and, per connection, receives
+// argv/cwd/env/umask plus the client's stdin/stdout/stderr (SCM_RIGHTS),
+// forks, and in the child installs them and calls clang's main(). The wait
+// status is relayed back to the client (ctc-clang), which exits with it.
+//
+// Protocol: see Section 15 of ctc_common.h (keep the two in sync).
+//
+// Lifecycle: started detached by ctc-clang on a connect() miss (that compile
+// execs clang as usual). One zygote per clang binary, held by an flock on
+// <socket>.lock. Exits after CTC_ZYGOTE_IDLE seconds (default 600) without a
+// request, or as soon as the clang binary on disk is replaced.
+//
+// This code runs inside clang's process, so unlike the launchers it does not
+// use ctc_common.h or the C++ library: libc only, no exceptions, and every
+// symbol except __libc_start_main is hidden.
+//
+// Build: clang++ -O3 -std=c++17 -shared -fPIC -fvisibility=hidden
+//          -fno-exceptions -fno-rtti -o libctc_zygote.so ctc_zygote.cpp -ldl
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace {
+
+// ============================================================================
+// Section 1: Constants / state
+// ============================================================================
+
+constexpr uint32_t ZYGOTE_MAGIC = 0x315a5443;  // "CTZ1"
+constexpr uint32_t MAX_REQUEST = 16u << 20;
+constexpr int MAX_CLIENTS = 1024;
+constexpr int DEFAULT_IDLE_S = 600;
+
+using MainFn = int (*)(int, char**, char**);
+MainFn g_real_main = nullptr;
+
+int g_sigchld_pipe[2] = {-1, -1};
+
+struct Client {
+    pid_t pid;
+    int fd;
+};
+Client g_clients[MAX_CLIENTS];
+int g_nclients = 0;
+
+// ============================================================================
+// Section 2: I/O helpers
+// ============================================================================
+
+bool write_all(int fd, const void* data, size_t n) {
+    const char* p = static_cast<const char*>(data);
+    while (n) {
+        ssize_t w = write(fd, p, n);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return false;
+        p += w;
+        n -= (size_t)w;
+    }
+    return true;
+}
+
+bool read_all(int fd, void* data, size_t n) {
+    char* p = static_cast<char*>(data);
+    while (n) {
+        ssize_t r = read(fd, p, n);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return false;
+        p += r;
+        n -= (size_t)r;
+    }
+    return true;
+}
+
+void reply(int fd, char tag, uint32_t value) {
+    unsigned char b[5] = {(unsigned char)tag, (unsigned char)(value & 0xff), (unsigned char)((value >> 8) & 0xff),
+                          (unsigned char)((value >> 16) & 0xff), (unsigned char)(value >> 24)};
+    write_all(fd, b, sizeof(b));
+}
+
+uint32_t get_u32(const unsigned char* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// ============================================================================
+// Section 3: Request decoding
+// ============================================================================
+
+// Decoded in place: every string is NUL-terminated inside `arena` and the
+// argv/env pointer arrays point into it.
+struct Request {
+    char* arena = nullptr;
+    char** argv = nullptr;
+    char** env = nullptr;
+    char* cwd = nullptr;
+    int argc = 0;
+    uint32_t umask_bits = 022;
+    int fds[3] = {-1, -1, -1};
+};
+
+void free_request(Request& r) {
+    for (int& fd : r.fds) {
+        if (fd >= 0) close(fd);
+        fd = -1;
+    }
+    free(r.arena);
+    free(r.argv);
+    free(r.env);
+    r = Request();
+}
+
+// Cursor over the request body; strings are re-laid out as C strings.
+struct Reader {
+    const unsigned char* p;
+    const unsigned char* end;
+    char* out;
+
+    bool u32(uint32_t& v) {
+        if (end - p < 4) return false;
+        v = get_u32(p);
+        p += 4;
+        return true;
+    }
+
+    char* str() {
+        uint32_t n;
+        if (!u32(n) || (size_t)(end - p) < n) return nullptr;
+        char* s = out;
+        memcpy(out, p, n);
+        out[n] = '\0';
+        out += n + 1;
+        p += n;
+        return s;
+    }
+};
+
+bool read_request(int cfd, Request& r) {
+    unsigned char len_buf[4];
+    int fds[3];
+    char ctrl[CMSG_SPACE(sizeof(fds))];
+    struct iovec iov = {len_buf, sizeof(len_buf)};
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctrl;
+    msg.msg_controllen = sizeof(ctrl);
+    ssize_t got;
+    do {
+        got = recvmsg(cfd, &msg, MSG_CMSG_CLOEXEC);
+    } while (got < 0 && errno == EINTR);
+    for (struct cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+        if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_RIGHTS &&
+            cm->cmsg_len == CMSG_LEN(sizeof(fds))) {
+            memcpy(fds, CMSG_DATA(cm), sizeof(fds));
+            for (int i = 0; i < 3; i++) r.fds[i] = fds[i];
+        }
+    }
+    if (got <= 0 || r.fds[2] < 0) return false;
+    if (got < (ssize_t)sizeof(len_buf) && !read_all(cfd, len_buf + got, sizeof(len_buf) - got)) return false;
+
+    uint32_t len = get_u32(len_buf);
+    if (len < 16 || len > MAX_REQUEST) return false;
+    unsigned char* body = static_cast<unsigned char*>(malloc(len));
+    // Every string grows by one NUL and its 4-byte length goes away, so the
+    // arena never needs more than the body size.
+    r.arena = static_cast<char*>(malloc(len));
+    if (!body || !r.arena || !read_all(cfd, body, len)) {
+        free(body);
+        return false;
+    }
+
+    Reader rd{body, body + len, r.arena};
+    uint32_t magic = 0, argc = 0, envc = 0;
+    bool ok = rd.u32(magic) && magic == ZYGOTE_MAGIC && rd.u32(r.umask_bits) && rd.u32(argc) &&
+              argc > 0 && argc < len / 4;
+    if (ok) {
+        r.argc = (int)argc;
+        r.argv = static_cast<char**>(calloc(argc + 1, sizeof(char*)));
+        for (uint32_t i = 0; ok && i < argc; i++) ok = (r.argv[i] = rd.str()) != nullptr;
+    }
+    ok = ok && (r.cwd = rd.str()) != nullptr && rd.u32(envc) && envc < len / 4;
+    if (ok) {
+        r.env = static_cast<char**>(calloc(envc + 1, sizeof(char*)));
+        for (uint32_t i = 0; ok && i < envc; i++) ok = (r.env[i] = rd.str()) != nullptr;
+    }
+    free(body);
+    return ok;
+}
+
+// ============================================================================
+// Section 4: Children
+// ============================================================================
+
+void on_sigchld(int) {
+    int saved = errno;
+    char c = 0;
+    (void)!write(g_sigchld_pipe[1], &c, 1);
+    errno = saved;
+}
+
+// Runs in the forked child: become the compile the client asked for.
+[[noreturn]] void become_compile(Request& r, int listen_fd) {
+    close(listen_fd);
+    close(g_sigchld_pipe[0]);
+    close(g_sigchld_pipe[1]);
+    for (int i = 0; i < g_nclients; i++) close(g_clients[i].fd);
+
+    struct sigaction sa = {};
+    sa.sa_handler = SIG_DFL;
+    const int reset[] = {SIGCHLD, SIGPIPE, SIGINT, SIGTERM, SIGHUP};
+    for (int sig : reset) sigaction(sig, &sa, nullptr);
+    sigset_t none;
+    sigemptyset(&none);
+    sigprocmask(SIG_SETMASK, &none, nullptr);
+
+    for (int i = 0; i < 3; i++) {
+        if (r.fds[i] != i) {
+            dup2(r.fds[i], i);
+            close(r.fds[i]);
+        }
+    }
+    umask((mode_t)r.umask_bits);
+    if (chdir(r.cwd) != 0) {
+        fprintf(stderr, "[ctc-zygote] chdir(%s): %s\n", r.cwd, strerror(errno));
+        _exit(127);
+    }
+    environ = r.env;
+    exit(g_real_main(r.argc, r.argv, environ));
+}
+
+void reap_children() {
+    int status;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+        for (int i = 0; i < g_nclients; i++) {
+            if (g_clients[i].pid != pid) continue;
+            reply(g_clients[i].fd, 'S', (uint32_t)status);
+            close(g_clients[i].fd);
+            g_clients[i] = g_clients[--g_nclients];
+            break;
+        }
+    }
+}
+
+void handle_connection(int cfd, int listen_fd) {
+    struct timeval tv = {5, 0};  // a client that stalls mid-request is dropped
+    setsockopt(cfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    Request r;
+    if (g_nclients == MAX_CLIENTS || !read_request(cfd, r)) {
+        free_request(r);
+        close(cfd);  // client falls back to exec
+        return;
+    }
+    pid_t pid = fork();
+    if (pid == 0) become_compile(r, listen_fd);
+    if (pid < 0) {
+        reply(cfd, 'E', (uint32_t)errno);
+        close(cfd);
+    } else {
+        reply(cfd, 'P', (uint32_t)pid);
+        g_clients[g_nclients++] = {pid, cfd};
+    }
+    free_request(r);
+}
+
+// ============================================================================
+// Section 5: Server loop
+// ============================================================================
+
+// True while the clang binary we were started from is still the one on disk.
+bool binary_unchanged(const char* exe_path, const struct stat& started) {
+    struct stat now;
+    return stat(exe_path, &now) == 0 && now.st_ino == started.st_ino && now.st_dev == started.st_dev &&
+           now.st_mtime == started.st_mtime;
+}
+
+int serve(const char* socket_path_env) {
+    char path[sizeof(sockaddr_un::sun_path)];
+    if (strlen(socket_path_env) >= sizeof(path)) return 1;
+    strcpy(path, socket_path_env);
+    const char* idle_env = getenv("CTC_ZYGOTE_IDLE");
+    int idle_s = idle_env ? atoi(idle_env) : DEFAULT_IDLE_S;
+    if (idle_s <= 0) idle_s = DEFAULT_IDLE_S;
+    unsetenv("CTC_ZYGOTE_SOCKET");
+    unsetenv("CTC_ZYGOTE_IDLE");
+    unsetenv("LD_PRELOAD");
+
+    // Singleton per socket: whoever holds the lock serves.
+    char lock_path[sizeof(path) + 8];
+    snprintf(lock_path, sizeof(lock_path), "%s.lock", path);
+    int lock_fd = open(lock_path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (lock_fd < 0 || flock(lock_fd, LOCK_EX | LOCK_NB) != 0) return 0;
+
+    char exe_path[4096];
+    ssize_t n = readlink("/proc/self/exe", exe_path, sizeof(exe_path) - 1);
+    struct stat exe_st;
+    if (n <= 0 || stat("/proc/self/exe", &exe_st) != 0) return 1;
+    exe_path[n] = '\0';
+
+    int lfd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    struct sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    unlink(path);
+    mode_t old_umask = umask(077);
+    bool bound = lfd >= 0 && bind(lfd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0 &&
+                 listen(lfd, 128) == 0;
+    umask(old_umask);
+    if (!bound) return 1;
+    struct stat sock_st;
+    stat(path, &sock_st);
+
+    if (pipe2(g_sigchld_pipe, O_CLOEXEC | O_NONBLOCK) != 0) return 1;
+    struct sigaction sa = {};
+    sa.sa_handler = on_sigchld;
+    sa.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+    sigaction(SIGCHLD, &sa, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+
+    bool accepting = true;
+    while (accepting || g_nclients > 0) {
+        struct pollfd pfd[2] = {{g_sigchld_pipe[0], POLLIN, 0}, {lfd, (short)(accepting ? POLLIN : 0), 0}};
+        int timeout_ms = g_nclients > 0 ? -1 : idle_s * 1000;
+        int rc = poll(pfd, 2, timeout_ms);
+        if (rc < 0 && errno == EINTR) continue;
+        if (rc == 0) break;  // idle
+        if (pfd[0].revents & POLLIN) {
+            char buf[64];
+            while (read(g_sigchld_pipe[0], buf, sizeof(buf)) > 0) {}
+            reap_children();
+        }
+        if (accepting && (pfd[1].revents & POLLIN)) {
+            int cfd = accept4(lfd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (cfd < 0) continue;
+            if (!binary_unchanged(exe_path, exe_st)) {
+                // Toolchain was upgraded under us: refuse (client execs the new
+                // clang) and wind down once running compiles finish.
+                close(cfd);
+                accepting = false;
+                continue;
+            }
+            handle_connection(cfd, lfd);
+        }
+    }
+
+    // Only remove the socket if it is still ours (a successor may have rebound).
+    struct stat cur;
+    if (stat(path, &cur) == 0 && cur.st_ino == sock_st.st_ino) unlink(path);
+    close(lfd);
+    return 0;
+}
+
+int zygote_main(int argc, char** argv, char** envp) {
+    const char* sock = getenv("CTC_ZYGOTE_SOCKET");
+    if (!sock || !*sock) return g_real_main(argc, argv, envp);
+    return serve(sock);
+}
+
+} // namespace
+
+// ============================================================================
+// Section 6: __libc_start_main interposer (the only exported symbol)
+// ============================================================================
+
+using StartMainFn = int (*)(MainFn, int, char**, void (*)(), void (*)(), void (*)(), void*);
+
+extern "C" __attribute__((visibility("default"))) int __libc_start_main(
+    MainFn main, int argc, char** argv, void (*init)(), void (*fini)(), void (*rtld_fini)(), void* stack_end) {
+    StartMainFn real = reinterpret_cast<StartMainFn>(dlsym(RTLD_NEXT, "__libc_start_main"));
+    if (!real) return 127;
+    g_real_main = main;
+    return real(zygote_main, argc, argv, init, fini, rtld_fini, stack_end);
+}
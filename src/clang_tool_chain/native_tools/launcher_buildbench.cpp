@@ -0,0 +1,543 @@
+// clang-tool-chain end-to-end build throughput benchmark (ctc-buildbench)
+//
+// Generates a synthetic C++ project and builds it through ctc-clang++ in each
+// launcher mode, reporting what the whole pipeline sustains rather than what a
+// single compile costs:
+//
+//   ctc-buildbench                                  # 200 TUs, all modes, 3 runs
+//   ctc-buildbench --tus 1000 --depth 6 --templates 32 --json > bench.json
+//   ctc-buildbench --generate-only --out /tmp/synth # just write the project
+//
+// Project: --tus translation units, each including --includes headers from
+// the top of a --depth deep header graph (every header includes two from the
+// level below; the bottom level pulls in one standard header). Each TU
+// explicitly instantiates --templates class templates on its own tag types
+// and defines --functions plain functions. --links executables each link
+// --fan-in objects (default: all of them) plus their own main. Generation is
+// deterministic for a given --seed, so numbers from different days compare.
+//
+// Modes (same sources, separate build directories, run one after another):
+//   plain        directives off (CLANG_TOOL_CHAIN_NO_DIRECTIVES=1), -std and
+//                -D on the command line
+//   deploy       plain, links add --deploy-dependencies
+//   directives   directive parsing on; -std and -D come from each TU's
+//                // @std / // @cflags lines
+//   zccache      clang-tool-chain-zccache-clang-cpp (from PATH or --zccache)
+//                with a fresh cache: run 1 is cold, later runs are warm
+//
+// Per run: compile phase wall time (TUs/s), link wall times, CPU time of all
+// compiler processes (wait4), and the launcher's share of each invocation
+// from CTC_TIMING_LOG records (clang_launcher.cpp; ctc_common.h Section 17).
+// The timing log makes ctc-clang wait for clang instead of exec'ing it;
+// --no-timing-log measures without it.
+//
+// Single-file C++17. Common utilities live in ctc_common.h. POSIX only (wait4).
+//
+// Build: clang++ -O3 -std=c++17 -o ctc-buildbench launcher_buildbench.cpp
+//   Linux:   add -static-libstdc++ -static-libgcc -lpthread
+
+#include "ctc_common.h"
+
+#include <random>
+
+using namespace ctc;
+
+// ============================================================================
+// Section 0: Tool-specific constants
+// ============================================================================
+
+static constexpr const char* CTC_TAG = "[ctc-buildbench] ";
+static constexpr const char* ZCCACHE_ENTRY = "clang-tool-chain-zccache-clang-cpp";
+
+// One per bottom-level header, in rotation.
+static const char* const STD_HEADERS[] = {"<vector>", "<string>", "<map>", "<algorithm>", "<memory>", "<functional>"};
+
+struct Config {
+    size_t tus = 200;
+    size_t depth = 4;
+    size_t width = 8;       // headers per level
+    size_t includes = 4;    // top-level headers per TU
+    size_t templates = 8;   // explicit instantiations per TU
+    size_t functions = 16;  // plain functions per TU
+    size_t links = 2;
+    size_t fan_in = 0;      // objects per link; 0 = all
+    uint32_t seed = 1;
+};
+
+// ============================================================================
+// Section 1: Project generator
+// ============================================================================
+
+static std::string header_name(size_t level, size_t index) {
+    return "h_" + std::to_string(level) + "_" + std::to_string(index) + ".h";
+}
+
+static std::string header_ns(size_t level, size_t index) {
+    return "h" + std::to_string(level) + "_" + std::to_string(index);
+}
+
+// Objects linked into executable `e`: a window of fan_in TUs, rotating so
+// different executables share some objects and not others.
+static std::vector<size_t> link_set(const Config& c, size_t e) {
+    size_t k = c.fan_in == 0 ? c.tus : std::min(c.fan_in, c.tus);
+    std::vector<size_t> out;
+    for (size_t t = 0; t < k; t++) out.push_back((e * k + t) % c.tus);
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return out;
+}
+
+static bool generate_project(const Config& c, const std::string& src) {
+    std::mt19937 rng(c.seed);
+    std::string inc = path_join(src, "include");
+    make_directory(src);
+    make_directory(inc);
+    bool ok = true;
+
+    // Header graph: level 0 is what TUs include; the last level includes STL.
+    for (size_t k = 0; k < c.depth; k++) {
+        for (size_t j = 0; j < c.width; j++) {
+            std::ostringstream h;
+            h << "// Generated by ctc-buildbench (seed " << c.seed << ")\n#pragma once\n#include <cstddef>\n";
+            std::vector<size_t> below;
+            if (k + 1 < c.depth) {
+                below = {rng() % c.width, rng() % c.width};
+                for (size_t b : below) h << "#include \"" << header_name(k + 1, b) << "\"\n";
+            } else {
+                size_t n_std = sizeof(STD_HEADERS) / sizeof(STD_HEADERS[0]);
+                h << "#include " << STD_HEADERS[(j + k) % n_std] << "\n";
+            }
+            h << "\nnamespace " << header_ns(k, j) << " {\n\n";
+            h << "struct Data {\n    int a = " << j << ";\n    double b = " << k << ".5;\n};\n\n";
+            h << "inline int f(int x) {\n    return x * " << (k + 3) << " + " << j;
+            if (!below.empty()) h << " + " << header_ns(k + 1, below[0]) << "::f(x - 1)";
+            h << ";\n}\n\n";
+            h << "template <typename T>\nstruct Box {\n    T value{};\n    std::size_t n = 0;\n\n"
+                 "    T get() const { return value; }\n"
+                 "    void put(const T& v) {\n        value = v;\n        ++n;\n    }\n"
+                 "    T twice() const {\n        T t = value;\n        t += value;\n        return t;\n    }\n"
+                 "};\n\n";
+            h << "template <typename T, int N>\nT accumulate(const T* p) {\n    T s{};\n"
+                 "    for (int i = 0; i < N; ++i) s += p[i];\n    return s;\n}\n\n";
+            h << "}  // namespace " << header_ns(k, j) << "\n";
+            ok &= write_file_atomic(path_join(inc, header_name(k, j)), h.str());
+        }
+    }
+
+    // Translation units
+    for (size_t i = 0; i < c.tus; i++) {
+        std::vector<size_t> tops;
+        for (size_t n = 0; n < std::min(c.includes, c.width); n++) {
+            size_t pick = rng() % c.width;
+            while (std::find(tops.begin(), tops.end(), pick) != tops.end()) pick = (pick + 1) % c.width;
+            tops.push_back(pick);
+        }
+        std::string ns = "tu" + std::to_string(i);
+        std::ostringstream s;
+        s << "// Generated by ctc-buildbench (seed " << c.seed << ")\n// @std: c++17\n// @cflags: -DCTC_BENCH=1\n";
+        for (size_t t : tops) s << "#include \"" << header_name(0, t) << "\"\n";
+        s << "\n#ifndef CTC_BENCH\n#error CTC_BENCH not defined\n#endif\n\nnamespace " << ns << " {\n\n";
+        for (size_t n = 0; n < c.templates; n++) {
+            std::string top = header_ns(0, tops[n % tops.size()]);
+            s << "struct Tag" << n << " {\n    int v = " << (i + n) << ";\n"
+              << "    Tag" << n << "& operator+=(const Tag" << n << "& o) {\n        v += o.v;\n        return *this;\n"
+              << "    }\n};\n\n}  // namespace " << ns << "\n\n"
+              << "template struct " << top << "::Box<" << ns << "::Tag" << n << ">;\n\nnamespace " << ns << " {\n\n"
+              << "static int use" << n << "() {\n    Tag" << n << " arr[4] = {};\n"
+              << "    " << top << "::Box<Tag" << n << "> box;\n    box.put(" << top << "::accumulate<Tag" << n
+              << ", 4>(arr));\n    return box.twice().v;\n}\n\n";
+        }
+        for (size_t n = 0; n < c.functions; n++) {
+            std::string top = header_ns(0, tops[n % tops.size()]);
+            s << "int fn" << n << "(int x) {\n    int acc = " << top << "::f(x);\n"
+              << "    for (int k = 0; k < x % " << (n + 7) << "; ++k) acc = acc * " << (n + 31) << " + k;\n"
+              << "    return acc ^ " << (rng() % 65536) << ";\n}\n\n";
+        }
+        s << "}  // namespace " << ns << "\n\nint tu_" << i << "(int x) {\n    int s = 0;\n";
+        for (size_t n = 0; n < c.functions; n++) s << "    s += " << ns << "::fn" << n << "(x);\n";
+        for (size_t n = 0; n < c.templates; n++) s << "    s += " << ns << "::use" << n << "();\n";
+        s << "    return s;\n}\n";
+        ok &= write_file_atomic(path_join(src, "tu_" + std::to_string(i) + ".cpp"), s.str());
+    }
+
+    // One main per executable, calling every TU it links
+    for (size_t e = 0; e < c.links; e++) {
+        std::vector<size_t> set = link_set(c, e);
+        std::ostringstream s;
+        s << "// Generated by ctc-buildbench (seed " << c.seed << ")\n// @std: c++17\n// @cflags: -DCTC_BENCH=1\n"
+          << "#include <cstdio>\n\n";
+        for (size_t i : set) s << "int tu_" << i << "(int);\n";
+        s << "\nint main(int argc, char**) {\n    long s = 0;\n";
+        for (size_t i : set) s << "    s += tu_" << i << "(argc);\n";
+        s << "    std::printf(\"%ld\\n\", s);\n    return 0;\n}\n";
+        ok &= write_file_atomic(path_join(src, "main_" + std::to_string(e) + ".cpp"), s.str());
+    }
+    return ok;
+}
+
+// ============================================================================
+// Section 2: Mode builds
+// ============================================================================
+
+struct Run {
+    double build_wall_s = 0;
+    double compile_wall_s = 0;
+    double compile_cpu_s = 0;
+    double link_cpu_s = 0;
+    std::vector<double> link_wall_s;
+    double tus_per_s = 0;
+    double launcher_share = -1;  // fraction of invocation time; -1 = no records
+    double launcher_ms = -1;     // mean launcher time per invocation
+};
+
+struct Mode {
+    std::string name;
+    std::string cxx;
+    std::vector<std::pair<std::string, std::string>> env;  // set for this mode only
+    std::vector<std::string> compile_flags, link_flags;
+    bool available = true;
+    std::string note;
+    std::vector<Run> runs;
+};
+
+// Launcher setup + post-link share of every ctc-clang invocation in the log.
+static void read_launcher_share(const std::string& log, Run& r) {
+    std::istringstream ss(read_file(log));
+    std::string line;
+    uint64_t launcher_us = 0, total_us = 0, n = 0;
+    while (std::getline(ss, line)) {
+        TimingRecord rec;
+        if (!parse_timing_record(line, rec)) continue;
+        uint64_t done = std::max(rec.done_us, rec.exit_us);
+        launcher_us += (rec.spawn_us - rec.start_us) + (done - rec.exit_us);
+        total_us += done - rec.start_us;
+        n++;
+    }
+    if (n == 0 || total_us == 0) return;
+    r.launcher_share = (double)launcher_us / (double)total_us;
+    r.launcher_ms = (double)launcher_us / 1000.0 / (double)n;
+}
+
+static bool build_once(const Config& c, Mode& m, const std::string& src, const std::string& dir, size_t run,
+                       bool timing_log, bool verbose, unsigned jobs) {
+    std::string obj = path_join(dir, "obj"), bin = path_join(dir, "bin");
+    remove_tree(obj);
+    remove_tree(bin);
+    make_directory(dir);
+    make_directory(obj);
+    make_directory(bin);
+    std::string log = path_join(dir, "timing-" + std::to_string(run) + ".log");
+    std::remove(log.c_str());
+    for (const auto& kv : m.env) set_env(kv.first.c_str(), kv.second);
+    if (timing_log) set_env("CTC_TIMING_LOG", log.c_str());
+
+    Run r;
+    auto t0 = std::chrono::steady_clock::now();
+    size_t n_compiles = c.tus + c.links;
+    std::vector<ProcessUsage> usage(n_compiles);
+    std::vector<int> rcs(n_compiles, 0);
+    parallel_for(n_compiles, [&](size_t t) {
+        std::string stem = t < c.tus ? "tu_" + std::to_string(t) : "main_" + std::to_string(t - c.tus);
+        std::vector<std::string> cmd = {m.cxx};
+        cmd.insert(cmd.end(), m.compile_flags.begin(), m.compile_flags.end());
+        cmd.insert(cmd.end(), {"-I" + path_join(src, "include"), "-c", path_join(src, stem + ".cpp"), "-o",
+                               path_join(obj, stem + ".o")});
+        rcs[t] = run_measured(cmd, !verbose, usage[t], CTC_TAG);
+    }, jobs);
+    auto t1 = std::chrono::steady_clock::now();
+    bool ok = true;
+    for (size_t t = 0; t < n_compiles; t++) {
+        r.compile_cpu_s += usage[t].cpu_s;
+        if (rcs[t] != 0 && ok) {
+            fprintf(stderr, "%s%s: compile %zu failed (exit %d)%s\n", CTC_TAG, m.name.c_str(), t, rcs[t],
+                    verbose ? "" : "; rerun with -v for compiler output");
+            ok = false;
+        }
+    }
+
+    if (ok) {
+        std::vector<ProcessUsage> link_usage(c.links);
+        std::vector<int> link_rcs(c.links, 0);
+        parallel_for(c.links, [&](size_t e) {
+            std::vector<std::string> cmd = {m.cxx};
+            cmd.insert(cmd.end(), m.link_flags.begin(), m.link_flags.end());
+            cmd.push_back(path_join(obj, "main_" + std::to_string(e) + ".o"));
+            for (size_t i : link_set(c, e)) cmd.push_back(path_join(obj, "tu_" + std::to_string(i) + ".o"));
+            cmd.insert(cmd.end(), {"-o", path_join(bin, "app_" + std::to_string(e))});
+            link_rcs[e] = run_measured(cmd, !verbose, link_usage[e], CTC_TAG);
+        }, jobs);
+        for (size_t e = 0; e < c.links; e++) {
+            r.link_wall_s.push_back(link_usage[e].wall_s);
+            r.link_cpu_s += link_usage[e].cpu_s;
+            if (link_rcs[e] != 0 && ok) {
+                fprintf(stderr, "%s%s: link %zu failed (exit %d)\n", CTC_TAG, m.name.c_str(), e, link_rcs[e]);
+                ok = false;
+            }
+        }
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    for (const auto& kv : m.env) unset_env(kv.first.c_str());
+    if (timing_log) unset_env("CTC_TIMING_LOG");
+    if (!ok) return false;
+
+    r.compile_wall_s = std::chrono::duration<double>(t1 - t0).count();
+    r.build_wall_s = std::chrono::duration<double>(t2 - t0).count();
+    r.tus_per_s = r.compile_wall_s > 0 ? (double)n_compiles / r.compile_wall_s : 0.0;
+    if (timing_log) read_launcher_share(log, r);
+    m.runs.push_back(std::move(r));
+    return true;
+}
+
+// ============================================================================
+// Section 3: Report
+// ============================================================================
+
+static double median(std::vector<double> v) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    size_t n = v.size();
+    return n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2.0;
+}
+
+// Median of one Run field across a mode's runs.
+template <typename F>
+static double median_of(const Mode& m, F field) {
+    std::vector<double> v;
+    for (const auto& r : m.runs) v.push_back(field(r));
+    return median(v);
+}
+
+static double max_link(const Run& r) {
+    return r.link_wall_s.empty() ? 0.0 : *std::max_element(r.link_wall_s.begin(), r.link_wall_s.end());
+}
+
+static void print_json_number(double v, bool valid) {
+    if (valid) printf("%.6g", v);
+    else printf("null");
+}
+
+static void report(const Config& c, const std::vector<Mode>& modes, int runs, unsigned jobs, bool json) {
+    if (json) {
+        printf("{\n  \"config\": {\"tus\": %zu, \"depth\": %zu, \"width\": %zu, \"includes\": %zu, \"templates\": %zu, "
+               "\"functions\": %zu, \"links\": %zu, \"fan_in\": %zu, \"seed\": %u, \"runs\": %d, \"jobs\": %u},\n",
+               c.tus, c.depth, c.width, c.includes, c.templates, c.functions, c.links,
+               c.fan_in == 0 ? c.tus : std::min(c.fan_in, c.tus), c.seed, runs, jobs);
+        printf("  \"host\": {\"platform\": \"%s\", \"arch\": \"%s\", \"cpus\": %u},\n  \"modes\": [",
+               platform_str(get_platform()), arch_str(get_arch()), std::max(1u, std::thread::hardware_concurrency()));
+        for (size_t i = 0; i < modes.size(); i++) {
+            const Mode& m = modes[i];
+            printf("%s\n    {\"name\": \"%s\", \"available\": %s", i ? "," : "", m.name.c_str(),
+                   m.available ? "true" : "false");
+            if (!m.note.empty()) printf(", \"note\": \"%s\"", json_escape(m.note).c_str());
+            printf(", \"runs\": [");
+            for (size_t k = 0; k < m.runs.size(); k++) {
+                const Run& r = m.runs[k];
+                printf("%s\n      {\"build_wall_s\": %.4f, \"compile_wall_s\": %.4f, \"tus_per_s\": %.3f, "
+                       "\"compile_cpu_s\": %.4f, \"link_cpu_s\": %.4f, \"link_wall_s\": [",
+                       k ? "," : "", r.build_wall_s, r.compile_wall_s, r.tus_per_s, r.compile_cpu_s, r.link_cpu_s);
+                for (size_t e = 0; e < r.link_wall_s.size(); e++) printf("%s%.4f", e ? ", " : "", r.link_wall_s[e]);
+                printf("], \"launcher_share\": ");
+                print_json_number(r.launcher_share, r.launcher_share >= 0);
+                printf(", \"launcher_ms\": ");
+                print_json_number(r.launcher_ms, r.launcher_ms >= 0);
+                printf("}");
+            }
+            printf("%s]", m.runs.empty() ? "" : "\n    ");
+            if (!m.runs.empty()) {
+                bool timed = m.runs[0].launcher_share >= 0;
+                printf(", \"median\": {\"build_wall_s\": %.4f, \"tus_per_s\": %.3f, \"link_wall_max_s\": %.4f, "
+                       "\"launcher_share\": ",
+                       median_of(m, [](const Run& r) { return r.build_wall_s; }),
+                       median_of(m, [](const Run& r) { return r.tus_per_s; }), median_of(m, max_link));
+                print_json_number(median_of(m, [](const Run& r) { return r.launcher_share; }), timed);
+                printf("}");
+            }
+            printf("}");
+        }
+        printf("\n  ]\n}\n");
+        return;
+    }
+
+    printf("ctc-buildbench: %zu TUs + %zu mains, depth %zu x %zu headers, %zu templates/TU, %zu link(s) x %zu "
+           "objects, %d run(s) per mode, -j %u\n\n",
+           c.tus, c.links, c.depth, c.width, c.templates, c.links, c.fan_in == 0 ? c.tus : std::min(c.fan_in, c.tus),
+           runs, jobs);
+    printf("  %-12s %10s %12s %12s %12s %10s %12s\n", "mode", "TUs/s", "compile", "link (max)", "build", "launcher",
+           "per call");
+    for (const auto& m : modes) {
+        if (!m.available || m.runs.empty()) {
+            printf("  %-12s %s\n", m.name.c_str(), m.note.empty() ? "failed" : m.note.c_str());
+            continue;
+        }
+        char share[32] = "-", per_call[32] = "-";
+        if (m.runs[0].launcher_share >= 0) {
+            snprintf(share, sizeof(share), "%.1f%%", median_of(m, [](const Run& r) { return r.launcher_share; }) * 100);
+            snprintf(per_call, sizeof(per_call), "%.2f ms", median_of(m, [](const Run& r) { return r.launcher_ms; }));
+        }
+        printf("  %-12s %10.1f %10.3f s %10.3f s %10.3f s %10s %12s\n", m.name.c_str(),
+               median_of(m, [](const Run& r) { return r.tus_per_s; }),
+               median_of(m, [](const Run& r) { return r.compile_wall_s; }), median_of(m, max_link),
+               median_of(m, [](const Run& r) { return r.build_wall_s; }), share, per_call);
+        if (m.name == "zccache" && m.runs.size() > 1) {
+            printf("  %-12s %10.1f (cold run 1)\n", "", m.runs[0].tus_per_s);
+        }
+    }
+    printf("\nMedians over runs. \"launcher\" is ctc-clang's setup + post-link share of each invocation "
+           "(CTC_TIMING_LOG).\n");
+}
+
+// ============================================================================
+// Section 4: main()
+// ============================================================================
+
+static void print_usage() {
+    printf("Usage: ctc-buildbench [options]\n\n");
+    printf("Generates a synthetic C++ project and builds it through ctc-clang++ in each\n");
+    printf("launcher mode, reporting TUs/s, link times and the launcher's share of\n");
+    printf("every invocation. Modes: plain, deploy (--deploy-dependencies), directives,\n");
+    printf("zccache (clang-tool-chain-zccache-clang-cpp).\n\n");
+    printf("Project:\n");
+    printf("  --tus N             Translation units (default: 200)\n");
+    printf("  --depth N           Header graph depth (default: 4)\n");
+    printf("  --width N           Headers per level (default: 8)\n");
+    printf("  --includes N        Top-level headers per TU (default: 4)\n");
+    printf("  --templates N       Explicit template instantiations per TU (default: 8)\n");
+    printf("  --functions N       Plain functions per TU (default: 16)\n");
+    printf("  --links N           Executables (default: 2)\n");
+    printf("  --fan-in N          Objects per executable (default: all TUs)\n");
+    printf("  --seed N            Generator seed (default: 1)\n\n");
+    printf("Build:\n");
+    printf("  --modes LIST        Comma-separated modes (default: all)\n");
+    printf("  --runs N            Clean builds per mode (default: 3)\n");
+    printf("  -j N                Parallel jobs (default: all cores / CTC_JOBS)\n");
+    printf("  --flag FLAG         Extra compile flag (repeatable, e.g. -O2)\n");
+    printf("  --clang PATH        ctc-clang++ to benchmark (default: next to ctc-buildbench)\n");
+    printf("  --zccache PATH      zccache entry point (default: %s on PATH)\n", ZCCACHE_ENTRY);
+    printf("  --no-timing-log     Don't set CTC_TIMING_LOG (no launcher share)\n");
+    printf("  --out DIR           Work in DIR and keep it (default: temp dir)\n");
+    printf("  --generate-only     Write the project to --out DIR/src and exit\n");
+    printf("  -v                  Show compiler output\n");
+    printf("  --json              JSON output\n");
+    printf("  --help, -h          Show this help\n");
+}
+
+int main(int argc, char* argv[]) {
+    Config c;
+    int runs = 3;
+    unsigned jobs = 0;
+    bool json = false, verbose = false, generate_only = false, timing_log = true;
+    std::string cxx, zccache, out_dir, mode_list = "plain,deploy,directives,zccache";
+    std::vector<std::string> extra_flags;
+
+    auto size_arg = [](const char* s, size_t min) { return (size_t)std::max<long>((long)min, atol(s)); };
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h" || arg == "--ctc-help") { print_usage(); return 0; }
+        if (arg == "--json") { json = true; continue; }
+        if (arg == "-v") { verbose = true; continue; }
+        if (arg == "--generate-only") { generate_only = true; continue; }
+        if (arg == "--no-timing-log") { timing_log = false; continue; }
+        if (arg == "--tus" && i + 1 < argc) { c.tus = size_arg(argv[++i], 1); continue; }
+        if (arg == "--depth" && i + 1 < argc) { c.depth = size_arg(argv[++i], 1); continue; }
+        if (arg == "--width" && i + 1 < argc) { c.width = size_arg(argv[++i], 1); continue; }
+        if (arg == "--includes" && i + 1 < argc) { c.includes = size_arg(argv[++i], 1); continue; }
+        if (arg == "--templates" && i + 1 < argc) { c.templates = size_arg(argv[++i], 0); continue; }
+        if (arg == "--functions" && i + 1 < argc) { c.functions = size_arg(argv[++i], 0); continue; }
+        if (arg == "--links" && i + 1 < argc) { c.links = size_arg(argv[++i], 1); continue; }
+        if (arg == "--fan-in" && i + 1 < argc) { c.fan_in = size_arg(argv[++i], 0); continue; }
+        if (arg == "--seed" && i + 1 < argc) { c.seed = (uint32_t)strtoul(argv[++i], nullptr, 10); continue; }
+        if (arg == "--modes" && i + 1 < argc) { mode_list = argv[++i]; continue; }
+        if (arg == "--runs" && i + 1 < argc) { runs = std::max(1, atoi(argv[++i])); continue; }
+        if (arg == "-j" && i + 1 < argc) { jobs = (unsigned)std::max(1, atoi(argv[++i])); continue; }
+        if (arg == "--flag" && i + 1 < argc) { extra_flags.push_back(argv[++i]); continue; }
+        if (arg == "--clang" && i + 1 < argc) { cxx = argv[++i]; continue; }
+        if (arg == "--zccache" && i + 1 < argc) { zccache = argv[++i]; continue; }
+        if (arg == "--out" && i + 1 < argc) { out_dir = argv[++i]; continue; }
+        fprintf(stderr, "%sUnknown option: %s\n", CTC_TAG, arg.c_str());
+        return 2;
+    }
+    if (generate_only && out_dir.empty()) {
+        fprintf(stderr, "%s--generate-only needs --out DIR\n", CTC_TAG);
+        return 2;
+    }
+
+    // 1. Modes
+    std::vector<Mode> modes;
+    std::istringstream names(mode_list);
+    std::string name;
+    if (cxx.empty()) cxx = path_join(get_exe_dir(), "ctc-clang++");
+    if (zccache.empty()) zccache = find_in_path(ZCCACHE_ENTRY);
+    std::vector<std::string> plain_flags = {"-std=c++17", "-DCTC_BENCH=1"};
+    plain_flags.insert(plain_flags.end(), extra_flags.begin(), extra_flags.end());
+    while (std::getline(names, name, ',')) {
+        Mode m;
+        m.name = name;
+        m.cxx = cxx;
+        m.compile_flags = plain_flags;
+        m.env = {{"CLANG_TOOL_CHAIN_NO_DIRECTIVES", "1"}};
+        if (name == "deploy") {
+            m.link_flags = {"--deploy-dependencies"};
+        } else if (name == "directives") {
+            m.compile_flags = extra_flags;
+            m.env.clear();
+        } else if (name == "zccache") {
+            m.cxx = zccache;
+            m.available = !zccache.empty() && access(zccache.c_str(), X_OK) == 0;
+            if (!m.available) m.note = std::string("skipped: ") + ZCCACHE_ENTRY + " not found (--zccache PATH)";
+        } else if (name != "plain") {
+            fprintf(stderr, "%sUnknown mode: %s (plain, deploy, directives, zccache)\n", CTC_TAG, name.c_str());
+            return 2;
+        }
+        modes.push_back(std::move(m));
+    }
+    for (const auto& m : modes) {
+        if (generate_only || m.name == "zccache" || access(cxx.c_str(), X_OK) == 0) continue;
+        fprintf(stderr, "%s%s not found (use --clang PATH)\n", CTC_TAG, cxx.c_str());
+        return 1;
+    }
+
+    // 2. Project
+    std::string work = out_dir.empty() ? make_work_dir("ctc-buildbench") : out_dir;
+    if (!work.empty() && !is_directory(work)) make_directory(work);
+    if (work.empty() || !is_directory(work)) {
+        fprintf(stderr, "%scannot create a work directory\n", CTC_TAG);
+        return 1;
+    }
+    std::string src = path_join(work, "src");
+    if (!generate_project(c, src)) {
+        fprintf(stderr, "%scannot write the project under %s\n", CTC_TAG, src.c_str());
+        if (out_dir.empty()) remove_tree(work);
+        return 1;
+    }
+    if (generate_only) {
+        printf("%s\n", src.c_str());
+        return 0;
+    }
+
+    // 3. Builds: all runs of one mode, then the next mode
+    if (jobs == 0) jobs = default_parallelism();
+    int rc = 0;
+    for (auto& m : modes) {
+        if (!m.available) continue;
+        std::string dir = path_join(work, m.name);
+        if (m.name == "zccache") {
+            // Fresh cache per invocation of the benchmark: run 1 is cold
+            remove_tree(path_join(dir, "cache"));
+            make_directory(dir);
+            m.env.push_back({"ZCCACHE_DIR", path_join(dir, "cache")});
+        }
+        for (int r = 0; r < runs; r++) {
+            if (!build_once(c, m, src, dir, (size_t)r, timing_log, verbose, jobs)) {
+                m.runs.clear();
+                m.note = "build failed";
+                rc = 1;
+                break;
+            }
+        }
+    }
+
+    report(c, modes, runs, jobs, json);
+    if (out_dir.empty()) remove_tree(work);
+    return rc;
+}
@@ -49,7 +49,8 @@
 #include "clang_launcher.cpp"  // provides clang_launcher_main + ctc_common helpers
 
 // ``using namespace ctc;`` is already established by clang_launcher.cpp.
-// CTC_TAG and get_ctc_home_dir likewise come from there — don't redefine.
+// CTC_TAG likewise comes from there — don't redefine. get_ctc_home_dir
+// lives in ctc_common.h.
 
 // ============================================================================
 // Section 1: Tool table — which install dir each name lives in
@@ -279,5 +280,9 @@ int main(int argc, char* argv[]) {
         print_command(cmd);
         return 0;
     }
+    bool is_linker = tool_name == "lld" || tool_name == "ld.lld" ||
+                     tool_name == "ld64.lld" || tool_name == "lld-link";
+    TopRegistration::self().claim(tool_name.c_str(), guess_invocation_target(argc, argv),
+                                  is_linker ? "link" : "run");
     exec_process(cmd, tag.c_str());
 }
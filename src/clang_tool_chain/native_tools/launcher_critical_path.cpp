@@ -0,0 +1,591 @@
+// clang-tool-chain build critical-path analyzer (ctc-critical-path)
+//
+// Answers "which chain of jobs bounds this build, and how much of it is the
+// launcher?" from two inputs:
+//
+//   .ninja_log      Start/end of every edge of the last ninja run (ms,
+//                   relative to ninja's start). Edges sharing one command
+//                   (start, end, hash) are folded into one job.
+//   timing log      One record per ctc-clang invocation, written when the
+//                   build runs with CTC_TIMING_LOG=<file> (ctc_common.h
+//                   Section 17): launcher setup, compiler and post-link
+//                   spans plus CPU time and peak RSS. For Make or any other
+//                   driver without a .ninja_log it is the timeline itself.
+//
+// Records are joined to ninja edges by absolute output path and the two
+// clocks are aligned by the median offset of the matches. The report gives
+// the critical path, parallelism over time (mean, a time-weighted histogram
+// of concurrency, per-bucket means) and where the time went: launcher setup
+// vs. compiler vs. post-link, build-wide and along the critical path.
+// --trace writes the same timeline as Chrome trace-event JSON, which
+// ui.perfetto.dev and chrome://tracing open directly.
+//
+// Without a dependency graph the critical path is inferred from the timeline:
+// starting at the job that finished last, each step goes to the job that
+// finished last before the current one started. Gaps between the two are
+// reported; a long gap means the job waited for a slot (-j), not an input.
+//
+// Single-file C++17. Common utilities live in ctc_common.h.
+//
+// Build: clang++ -O3 -std=c++17 -o ctc-critical-path launcher_critical_path.cpp
+//   Linux:   add -static-libstdc++ -static-libgcc -lpthread
+//   Windows: add -static-libstdc++ -static-libgcc
+
+#include "ctc_common.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+using namespace ctc;
+
+// ============================================================================
+// Section 0: Tool-specific constants
+// ============================================================================
+
+static constexpr const char* CTC_TAG = "[ctc-critical-path] ";
+static constexpr const char* DEFAULT_TIMING_LOG = ".ctc-timing.log";
+
+// A launcher record matches a ninja edge when its aligned start lies within
+// this window of the edge's start (ninja's spawn → launcher main()).
+static constexpr double MATCH_WINDOW_MS = 1000.0;
+
+// ============================================================================
+// Section 1: Job model
+// ============================================================================
+
+struct Job {
+    std::string name;              // first output (ninja) or target (log)
+    size_t outputs = 1;
+    double start_ms = 0.0;
+    double end_ms = 0.0;
+    // Launcher attribution (from the timing log), ms on the job's clock
+    bool timed = false;
+    double launch_ms = 0.0;        // launcher main() entered
+    double spawn_ms = 0.0;         // compiler started
+    double exit_ms = 0.0;          // compiler exited
+    double done_ms = 0.0;          // launcher finished post-link work
+    double cpu_ms = 0.0;
+    double maxrss_mb = 0.0;
+    int rc = 0;
+    int lane = 0;
+    bool critical = false;
+
+    double duration() const { return end_ms - start_ms; }
+    double setup_ms() const { return timed ? spawn_ms - launch_ms : 0.0; }
+    double compiler_ms() const { return timed ? exit_ms - spawn_ms : 0.0; }
+    double post_ms() const { return timed ? done_ms - exit_ms : 0.0; }
+};
+
+static std::string absolute_in(const std::string& dir, const std::string& p) {
+    return normalize_path(is_absolute_path(p) ? p : path_join(dir, p));
+}
+
+static std::string current_dir() {
+#ifdef _WIN32
+    char buf[MAX_PATH * 2];
+    DWORD n = GetCurrentDirectoryA((DWORD)sizeof(buf), buf);
+    return (n > 0 && n < sizeof(buf)) ? std::string(buf, n) : std::string(".");
+#else
+    char buf[4096];
+    return getcwd(buf, sizeof(buf)) ? std::string(buf) : std::string(".");
+#endif
+}
+
+// ============================================================================
+// Section 2: .ninja_log (last build only)
+// ============================================================================
+
+// "start\tend\tmtime\toutput\thash" in ms (v5+). Ninja appends one line per
+// output as edges finish, so end times only go backwards where a new run
+// starts: everything before the last such drop belongs to older builds.
+static std::vector<Job> read_ninja_log(const std::string& path) {
+    struct Line { double start, end; std::string output, hash; };
+    std::vector<Line> lines;
+    std::istringstream ss(read_file(path));
+    std::string line;
+    double last_end = -1.0;
+    while (std::getline(ss, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        if (line.back() == '\r') line.pop_back();
+        size_t t1 = line.find('\t');
+        size_t t2 = t1 == std::string::npos ? t1 : line.find('\t', t1 + 1);
+        size_t t3 = t2 == std::string::npos ? t2 : line.find('\t', t2 + 1);
+        size_t t4 = t3 == std::string::npos ? t3 : line.find('\t', t3 + 1);
+        if (t3 == std::string::npos) continue;
+        Line l;
+        l.start = atof(line.c_str());
+        l.end = atof(line.c_str() + t1 + 1);
+        l.output = line.substr(t3 + 1, t4 == std::string::npos ? std::string::npos : t4 - t3 - 1);
+        l.hash = t4 == std::string::npos ? std::string() : line.substr(t4 + 1);
+        if (l.end < last_end) lines.clear();
+        last_end = l.end;
+        lines.push_back(std::move(l));
+    }
+
+    // One job per command: outputs of the same edge share start, end and hash.
+    std::vector<Job> jobs;
+    std::map<std::string, size_t> by_edge;
+    for (const auto& l : lines) {
+        std::string key = std::to_string(l.start) + "/" + std::to_string(l.end) + "/" + l.hash;
+        auto it = by_edge.find(key);
+        if (it != by_edge.end() && !l.hash.empty()) {
+            jobs[it->second].outputs++;
+            continue;
+        }
+        Job j;
+        j.name = l.output;
+        j.start_ms = l.start;
+        j.end_ms = l.end;
+        by_edge[key] = jobs.size();
+        jobs.push_back(std::move(j));
+    }
+    return jobs;
+}
+
+// ============================================================================
+// Section 3: Launcher timing log
+// ============================================================================
+
+static std::vector<TimingRecord> read_timing_log(const std::string& path, size_t& skipped) {
+    std::vector<TimingRecord> out;
+    std::istringstream ss(read_file(path));
+    std::string line;
+    while (std::getline(ss, line)) {
+        if (line.empty()) continue;
+        TimingRecord r;
+        if (parse_timing_record(line, r)) out.push_back(std::move(r));
+        else skipped++;
+    }
+    return out;
+}
+
+static void attach(Job& j, const TimingRecord& r, double origin_us) {
+    j.timed = true;
+    j.launch_ms = ((double)r.start_us - origin_us) / 1000.0;
+    j.spawn_ms = ((double)r.spawn_us - origin_us) / 1000.0;
+    j.exit_ms = ((double)r.exit_us - origin_us) / 1000.0;
+    j.done_ms = ((double)std::max(r.done_us, r.exit_us) - origin_us) / 1000.0;
+    j.cpu_ms = (double)(r.user_us + r.sys_us) / 1000.0;
+    j.maxrss_mb = (double)r.maxrss_kb / 1024.0;
+    j.rc = r.rc;
+}
+
+// Joins records to ninja jobs. The latest record per output wins (earlier
+// ones are from older builds); the clock offset is the median of
+// launcher start - ninja start over those pairs. Returns the match count.
+static size_t join_timing(std::vector<Job>& jobs, const std::vector<TimingRecord>& recs,
+                          const std::string& build_dir, double& offset_ms) {
+    std::unordered_map<std::string, size_t> latest;
+    for (size_t i = 0; i < recs.size(); i++) {
+        if (recs[i].target.empty()) continue;
+        std::string key = absolute_in(recs[i].cwd, recs[i].target);
+        auto it = latest.find(key);
+        if (it == latest.end() || recs[it->second].start_us < recs[i].start_us) latest[key] = i;
+    }
+    std::vector<std::pair<size_t, size_t>> pairs;
+    std::vector<double> offsets;
+    for (size_t j = 0; j < jobs.size(); j++) {
+        auto it = latest.find(absolute_in(build_dir, jobs[j].name));
+        if (it == latest.end()) continue;
+        pairs.push_back({j, it->second});
+        offsets.push_back((double)recs[it->second].start_us / 1000.0 - jobs[j].start_ms);
+    }
+    if (offsets.empty()) return 0;
+    std::nth_element(offsets.begin(), offsets.begin() + offsets.size() / 2, offsets.end());
+    offset_ms = offsets[offsets.size() / 2];
+
+    size_t matched = 0;
+    for (const auto& p : pairs) {
+        const TimingRecord& r = recs[p.second];
+        if (std::fabs((double)r.start_us / 1000.0 - offset_ms - jobs[p.first].start_ms) > MATCH_WINDOW_MS) continue;
+        attach(jobs[p.first], r, offset_ms * 1000.0);
+        matched++;
+    }
+    return matched;
+}
+
+// No .ninja_log: the records are the timeline (Make, scripts, IDEs).
+static std::vector<Job> jobs_from_timing(const std::vector<TimingRecord>& recs) {
+    std::vector<Job> jobs;
+    if (recs.empty()) return jobs;
+    uint64_t origin = recs[0].start_us;
+    for (const auto& r : recs) origin = std::min(origin, r.start_us);
+    for (const auto& r : recs) {
+        Job j;
+        j.name = r.target.empty() ? r.role + " (pid " + std::to_string(r.pid) + ")" : r.target;
+        attach(j, r, (double)origin);
+        j.start_ms = j.launch_ms;
+        j.end_ms = j.done_ms;
+        jobs.push_back(std::move(j));
+    }
+    return jobs;
+}
+
+// ============================================================================
+// Section 4: Analysis
+// ============================================================================
+
+struct CriticalStep {
+    size_t job;
+    double gap_ms;  // idle time between the previous step's end and this start
+};
+
+// Walks back from the last job to finish; see the header comment.
+static std::vector<CriticalStep> critical_path(std::vector<Job>& jobs) {
+    std::vector<size_t> by_end(jobs.size());
+    for (size_t i = 0; i < jobs.size(); i++) by_end[i] = i;
+    std::sort(by_end.begin(), by_end.end(), [&](size_t a, size_t b) {
+        if (jobs[a].end_ms != jobs[b].end_ms) return jobs[a].end_ms < jobs[b].end_ms;
+        return jobs[a].start_ms < jobs[b].start_ms;
+    });
+    std::vector<CriticalStep> path;
+    if (by_end.empty()) return path;
+    size_t cur = by_end.back();
+    while (true) {
+        jobs[cur].critical = true;
+        // Last job (by end) that ended no later than `cur` started.
+        auto it = std::upper_bound(by_end.begin(), by_end.end(), jobs[cur].start_ms,
+                                   [&](double t, size_t j) { return t < jobs[j].end_ms; });
+        size_t pred = SIZE_MAX;
+        while (it != by_end.begin()) {
+            --it;
+            if (*it != cur && !jobs[*it].critical) { pred = *it; break; }
+        }
+        path.push_back({cur, pred == SIZE_MAX ? jobs[cur].start_ms : jobs[cur].start_ms - jobs[pred].end_ms});
+        if (pred == SIZE_MAX) break;
+        cur = pred;
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+struct Parallelism {
+    double mean = 0.0;
+    std::vector<double> time_at;      // ms spent at each concurrency level
+    std::vector<double> bucket_mean;  // mean concurrency per time bucket
+    std::vector<std::pair<double, int>> steps;  // (t, concurrency from t on)
+};
+
+// Wall time with at least one job running (sum over levels >= 1).
+static double busy_time(const std::vector<double>& time_at) {
+    double s = 0.0;
+    for (size_t i = 1; i < time_at.size(); i++) s += time_at[i];
+    return s;
+}
+
+static Parallelism parallelism(const std::vector<Job>& jobs, double t0, double t1, size_t buckets) {
+    Parallelism p;
+    std::vector<std::pair<double, int>> ev;
+    double busy = 0.0;
+    for (const auto& j : jobs) {
+        ev.push_back({j.start_ms, +1});
+        ev.push_back({j.end_ms, -1});
+        busy += j.duration();
+    }
+    std::sort(ev.begin(), ev.end());  // ends (-1) sort before starts at the same instant
+    double span = t1 - t0;
+    p.mean = span > 0.0 ? busy / span : 0.0;
+    p.bucket_mean.assign(buckets, 0.0);
+    double width = span / (double)buckets;
+    int level = 0;
+    double prev = t0;
+    auto account = [&](double a, double b, int lvl) {
+        if (b <= a || lvl <= 0) return;
+        if ((size_t)lvl >= p.time_at.size()) p.time_at.resize(lvl + 1, 0.0);
+        p.time_at[lvl] += b - a;
+        for (size_t k = 0; k < buckets && width > 0.0; k++) {
+            double lo = t0 + width * (double)k, hi = lo + width;
+            double ov = std::min(b, hi) - std::max(a, lo);
+            if (ov > 0.0) p.bucket_mean[k] += ov * lvl / width;
+        }
+    };
+    for (const auto& e : ev) {
+        account(prev, e.first, level);
+        prev = e.first;
+        level += e.second;
+        if (!p.steps.empty() && p.steps.back().first == e.first) p.steps.back().second = level;
+        else p.steps.push_back({e.first, level});
+    }
+    if (p.time_at.empty()) p.time_at.resize(1, 0.0);
+    p.time_at[0] = std::max(0.0, span - busy_time(p.time_at));
+    return p;
+}
+
+// Greedy lanes: a job takes the lowest lane free at its start.
+static size_t assign_lanes(std::vector<Job>& jobs) {
+    std::vector<size_t> order(jobs.size());
+    for (size_t i = 0; i < jobs.size(); i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return jobs[a].start_ms < jobs[b].start_ms; });
+    std::vector<double> lane_end;
+    for (size_t i : order) {
+        size_t lane = 0;
+        while (lane < lane_end.size() && lane_end[lane] > jobs[i].start_ms) lane++;
+        if (lane == lane_end.size()) lane_end.push_back(0.0);
+        lane_end[lane] = jobs[i].end_ms;
+        jobs[i].lane = (int)lane;
+    }
+    return lane_end.size();
+}
+
+struct Attribution {
+    size_t jobs = 0;
+    double wall = 0.0;       // sum of job durations (driver's view)
+    double setup = 0.0;
+    double compiler = 0.0;
+    double post = 0.0;
+    double cpu = 0.0;
+    double outside = 0.0;    // driver span not covered by the launcher (process start, ninja)
+};
+
+static Attribution attribute(const std::vector<Job>& jobs, const std::vector<size_t>* subset) {
+    Attribution a;
+    auto add = [&](const Job& j) {
+        if (!j.timed) return;
+        a.jobs++;
+        a.wall += j.duration();
+        a.setup += j.setup_ms();
+        a.compiler += j.compiler_ms();
+        a.post += j.post_ms();
+        a.cpu += j.cpu_ms;
+        a.outside += std::max(0.0, j.duration() - (j.done_ms - j.launch_ms));
+    };
+    if (subset) {
+        for (size_t i : *subset) add(jobs[i]);
+    } else {
+        for (const auto& j : jobs) add(j);
+    }
+    return a;
+}
+
+// ============================================================================
+// Section 5: Trace-event output (Perfetto / chrome://tracing)
+// ============================================================================
+
+static void span_event(std::string& out, const char* name, const char* cat, int tid, double a_ms, double b_ms,
+                       const std::string& args) {
+    char buf[256];
+    snprintf(buf, sizeof(buf),
+             ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.0f,\"dur\":%.0f,"
+             "\"cat\":\"%s\",\"name\":\"", tid, a_ms * 1000.0, std::max(0.0, b_ms - a_ms) * 1000.0, cat);
+    out += buf;
+    out += json_escape(name);
+    out += "\"";
+    if (!args.empty()) out += ",\"args\":{" + args + "}";
+    out += "}";
+}
+
+static std::string build_trace(const std::vector<Job>& jobs, const std::vector<CriticalStep>& path,
+                               const Parallelism& par, size_t lanes) {
+    std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+                      "{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\",\"args\":{\"name\":\"build\"}}";
+    char buf[160];
+    snprintf(buf, sizeof(buf), ",\n{\"ph\":\"M\",\"pid\":1,\"tid\":0,\"name\":\"thread_name\","
+                               "\"args\":{\"name\":\"critical path\"}}");
+    out += buf;
+    for (size_t l = 0; l < lanes; l++) {
+        snprintf(buf, sizeof(buf), ",\n{\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"name\":\"thread_name\","
+                                   "\"args\":{\"name\":\"lane %zu\"}}", l + 1, l);
+        out += buf;
+    }
+    for (const auto& j : jobs) {
+        std::string args = "\"output\":\"" + json_escape(j.name) + "\"";
+        if (j.outputs > 1) args += ",\"outputs\":" + std::to_string(j.outputs);
+        if (j.timed) {
+            snprintf(buf, sizeof(buf), ",\"cpu_ms\":%.1f,\"maxrss_mb\":%.1f,\"rc\":%d", j.cpu_ms, j.maxrss_mb, j.rc);
+            args += buf;
+        }
+        std::string base = j.name.substr(j.name.find_last_of('/') + 1);
+        const char* cat = j.critical ? "job,critical" : "job";
+        span_event(out, base.c_str(), cat, j.lane + 1, j.start_ms, j.end_ms, args);
+        if (j.timed) {
+            span_event(out, "launcher setup", "launcher", j.lane + 1, j.launch_ms, j.spawn_ms, "");
+            span_event(out, "compiler", "compiler", j.lane + 1, j.spawn_ms, j.exit_ms, "");
+            if (j.post_ms() > 0.0) span_event(out, "post-link", "launcher", j.lane + 1, j.exit_ms, j.done_ms, "");
+        }
+    }
+    for (const auto& s : path) {
+        const Job& j = jobs[s.job];
+        std::string base = j.name.substr(j.name.find_last_of('/') + 1);
+        snprintf(buf, sizeof(buf), "\"gap_ms\":%.1f", s.gap_ms);
+        span_event(out, base.c_str(), "critical", 0, j.start_ms, j.end_ms, buf);
+    }
+    for (const auto& st : par.steps) {
+        snprintf(buf, sizeof(buf), ",\n{\"ph\":\"C\",\"pid\":1,\"ts\":%.0f,\"name\":\"parallelism\","
+                                   "\"args\":{\"jobs\":%d}}", st.first * 1000.0, st.second);
+        out += buf;
+    }
+    out += "\n]}\n";
+    return out;
+}
+
+// ============================================================================
+// Section 6: Report + main()
+// ============================================================================
+
+static double pct(double part, double whole) { return whole > 0.0 ? part / whole * 100.0 : 0.0; }
+
+static void print_attribution(const char* label, const Attribution& a) {
+    if (a.jobs == 0) return;
+    printf("  %-15s %5zu jobs  setup %8.1f ms (%4.1f%%)  compiler %9.1f ms (%4.1f%%)  post-link %7.1f ms (%4.1f%%)"
+           "  outside %7.1f ms (%4.1f%%)\n",
+           label, a.jobs, a.setup, pct(a.setup, a.wall), a.compiler, pct(a.compiler, a.wall), a.post,
+           pct(a.post, a.wall), a.outside, pct(a.outside, a.wall));
+}
+
+static void print_usage() {
+    printf("Usage: ctc-critical-path [options] [build-dir]\n\n");
+    printf("Reconstruct a build's job timeline and report its critical path,\n");
+    printf("parallelism over time and launcher vs. compiler time.\n\n");
+    printf("Inputs:\n");
+    printf("  <build-dir>/.ninja_log   Job timeline of the last ninja run\n");
+    printf("  timing log               ctc-clang records (build with CTC_TIMING_LOG=<file>);\n");
+    printf("                           the timeline itself when there is no .ninja_log\n\n");
+    printf("Options:\n");
+    printf("  --ninja-log PATH    Timeline from PATH instead of <build-dir>/.ninja_log\n");
+    printf("  --timing-log PATH   Launcher records (default: $CTC_TIMING_LOG, else\n");
+    printf("                      <build-dir>/%s when present)\n", DEFAULT_TIMING_LOG);
+    printf("  --trace PATH        Write Chrome trace-event JSON (ui.perfetto.dev)\n");
+    printf("  --top N             Rows for the longest-jobs table (default 10, 0 = all)\n");
+    printf("  --buckets N         Parallelism-over-time rows (default 20)\n");
+    printf("  --help, -h          Show this help\n");
+}
+
+int main(int argc, char* argv[]) {
+    std::string build_dir = ".", ninja_log, timing_log, trace_path;
+    size_t top = 10, buckets = 20;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h" || arg == "--ctc-help") { print_usage(); return 0; }
+        if (arg == "--ninja-log" && i + 1 < argc) { ninja_log = argv[++i]; continue; }
+        if (arg == "--timing-log" && i + 1 < argc) { timing_log = argv[++i]; continue; }
+        if (arg == "--trace" && i + 1 < argc) { trace_path = argv[++i]; continue; }
+        if (arg == "--top" && i + 1 < argc) { top = (size_t)atol(argv[++i]); continue; }
+        if (arg == "--buckets" && i + 1 < argc) { buckets = std::max<size_t>(1, (size_t)atol(argv[++i])); continue; }
+        if (!arg.empty() && arg[0] == '-') {
+            fprintf(stderr, "%sUnknown option: %s\n", CTC_TAG, arg.c_str());
+            return 2;
+        }
+        build_dir = arg;
+    }
+    std::string abs_build = absolute_in(current_dir(), build_dir);
+
+    // 1. Inputs
+    if (ninja_log.empty()) ninja_log = path_join(build_dir, ".ninja_log");
+    if (timing_log.empty()) timing_log = get_env("CTC_TIMING_LOG");
+    if (timing_log.empty() && path_exists(path_join(build_dir, DEFAULT_TIMING_LOG))) {
+        timing_log = path_join(build_dir, DEFAULT_TIMING_LOG);
+    }
+    size_t skipped = 0;
+    std::vector<TimingRecord> recs;
+    if (!timing_log.empty() && path_exists(timing_log)) recs = read_timing_log(timing_log, skipped);
+
+    // 2. Timeline
+    std::vector<Job> jobs;
+    bool from_ninja = path_exists(ninja_log);
+    size_t matched = 0;
+    double offset_ms = 0.0;
+    if (from_ninja) {
+        jobs = read_ninja_log(ninja_log);
+        matched = join_timing(jobs, recs, abs_build, offset_ms);
+    } else {
+        jobs = jobs_from_timing(recs);
+        matched = jobs.size();
+    }
+    if (jobs.empty()) {
+        fprintf(stderr, "%sNo jobs: no %s and no timing records%s%s\n", CTC_TAG, ninja_log.c_str(),
+                timing_log.empty() ? "" : " in ", timing_log.c_str());
+        return 1;
+    }
+
+    // 3. Analysis
+    double t0 = jobs[0].start_ms, t1 = jobs[0].end_ms;
+    for (const auto& j : jobs) {
+        t0 = std::min(t0, j.start_ms);
+        t1 = std::max(t1, j.end_ms);
+    }
+    double span = t1 - t0;
+    auto path = critical_path(jobs);
+    Parallelism par = parallelism(jobs, t0, t1, buckets);
+    size_t lanes = assign_lanes(jobs);
+    std::vector<size_t> path_jobs;
+    double path_busy = 0.0, path_gaps = 0.0;
+    for (const auto& s : path) {
+        path_jobs.push_back(s.job);
+        path_busy += jobs[s.job].duration();
+        path_gaps += s.gap_ms;
+    }
+
+    // 4. Report
+    printf("%s%zu jobs over %.2f s from %s", CTC_TAG, jobs.size(), span / 1000.0,
+           from_ninja ? ninja_log.c_str() : timing_log.c_str());
+    if (from_ninja && !recs.empty()) {
+        printf("; %zu/%zu matched to %s", matched, jobs.size(), timing_log.c_str());
+    }
+    printf("\n");
+    if (skipped) printf("%sskipped %zu unreadable timing records\n", CTC_TAG, skipped);
+
+    printf("\nCritical path: %zu jobs, %.2f s busy + %.2f s gaps (%.0f%% of the build)\n", path.size(),
+           path_busy / 1000.0, path_gaps / 1000.0, pct(path_busy + path_gaps, span));
+    printf("  %10s  %10s  %8s  %s\n", "start (s)", "dur (ms)", "gap (ms)", "job");
+    for (const auto& s : path) {
+        const Job& j = jobs[s.job];
+        printf("  %10.3f  %10.1f  %8.1f  %s", (j.start_ms - t0) / 1000.0, j.duration(), s.gap_ms, j.name.c_str());
+        if (j.timed) printf("  [setup %.1f ms, compiler %.1f ms]", j.setup_ms(), j.compiler_ms());
+        printf("\n");
+    }
+
+    printf("\nParallelism: mean %.2f, peak %zu, idle %.2f s\n", par.mean, par.time_at.size() - 1,
+           par.time_at[0] / 1000.0);
+    for (size_t lvl = 1; lvl < par.time_at.size(); lvl++) {
+        if (par.time_at[lvl] <= 0.0) continue;
+        printf("  %3zu jobs  %8.2f s  %5.1f%%\n", lvl, par.time_at[lvl] / 1000.0, pct(par.time_at[lvl], span));
+    }
+    printf("  over time (mean jobs per %.2f s):\n", span / (double)buckets / 1000.0);
+    double peak_mean = 0.0;
+    for (double m : par.bucket_mean) peak_mean = std::max(peak_mean, m);
+    for (size_t k = 0; k < buckets; k++) {
+        int bar = peak_mean > 0.0 ? (int)std::lround(par.bucket_mean[k] / peak_mean * 40.0) : 0;
+        printf("  %8.2f s  %6.2f  %s\n", span * (double)k / (double)buckets / 1000.0, par.bucket_mean[k],
+               std::string((size_t)bar, '#').c_str());
+    }
+
+    if (matched) {
+        printf("\nLauncher attribution (share of job wall time):\n");
+        print_attribution("all jobs", attribute(jobs, nullptr));
+        print_attribution("critical path", attribute(jobs, &path_jobs));
+        double cpu = 0.0, compiler = 0.0, rss = 0.0;
+        for (const auto& j : jobs) {
+            if (!j.timed) continue;
+            cpu += j.cpu_ms;
+            compiler += j.compiler_ms();
+            rss = std::max(rss, j.maxrss_mb);
+        }
+        if (cpu > 0.0) {
+            printf("  compiler CPU %.1f s (%.0f%% of compiler wall), peak RSS %.0f MB\n", cpu / 1000.0,
+                   pct(cpu, compiler), rss);
+        }
+    }
+
+    std::vector<size_t> order(jobs.size());
+    for (size_t i = 0; i < jobs.size(); i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return jobs[a].duration() > jobs[b].duration(); });
+    if (top > 0 && order.size() > top) order.resize(top);
+    printf("\nLongest jobs:\n");
+    for (size_t i : order) {
+        const Job& j = jobs[i];
+        printf("  %10.1f ms  %s%s", j.duration(), j.critical ? "* " : "  ", j.name.c_str());
+        if (j.timed && j.maxrss_mb > 0.0) printf("  [%.0f MB]", j.maxrss_mb);
+        printf("\n");
+    }
+
+    if (!trace_path.empty()) {
+        if (!write_file_atomic(trace_path, build_trace(jobs, path, par, lanes))) {
+            fprintf(stderr, "%sCannot write %s\n", CTC_TAG, trace_path.c_str());
+            return 1;
+        }
+        printf("\n%swrote %s (open in ui.perfetto.dev)\n", CTC_TAG, trace_path.c_str());
+    }
+    return 0;
+}
@@ -81,26 +81,17 @@ static std::vector<std::string> read_template_file(const std::string& path) {
 }
 
 // ============================================================================
-// Section 4: FNV-1a Hash
+// Section 4: Arg-template cache key
 // ============================================================================
 
+// 128-bit hash of the flag list (Section 14 of ctc_common.h). Keys written by
+// the old 64-bit FNV-1a scheme are simply never looked up again.
 static std::string compute_hash(const std::vector<std::string>& parts) {
-    uint64_t h = 0xcbf29ce484222325ULL;
-    for (const auto& s : parts) {
-        for (char c : s) {
-            h ^= (uint64_t)(unsigned char)c;
-            h *= 0x100000001b3ULL;
-        }
-        h ^= 0xff;
-        h *= 0x100000001b3ULL;
-    }
-    char buf[17];
-    snprintf(buf, sizeof(buf), "%016llx", (unsigned long long)h);
-    return buf;
+    return hash128_parts(parts).hex();
 }
 
 // ============================================================================
-// Section 5: Paths Cache (one-shot Python discovery)
+// Section 5: Paths Cache (native discovery, Python fallback)
 // ============================================================================
 
 struct PathsCache {
@@ -184,11 +175,11 @@ static std::string resolve_ctc_wasmld() {
 // Use str() + concatenation instead of f-strings with inner quotes.
 static const char* DISCOVERY_SCRIPT =
     "import sys; "
-    "from pathlib import Path; "
+    "from clang_tool_chain.path_utils import get_home_toolchain_dir; "
     "from clang_tool_chain.execution.emscripten import "
     "find_emscripten_tool, ensure_nodejs_available, get_platform_info; "
     "pn, ar = get_platform_info(); "
-    "d = Path.home() / '.clang-tool-chain' / 'emscripten' / pn / ar; "
+    "d = get_home_toolchain_dir() / 'emscripten' / pn / ar; "
     "emcc = find_emscripten_tool('emcc'); "
     "node = ensure_nodejs_available(); "
     "print('emscripten_dir=' + str(d / 'emscripten')); "
@@ -201,7 +192,7 @@ static const char* DISCOVERY_SCRIPT =
     "empp = str(empp) if empp.exists() else str(d / 'emscripten' / 'em++'); "
     "print('empp_script=' + empp)";
 
-static PathsCache discover_paths(const std::string& cache_path) {
+static PathsCache discover_paths_via_python(const std::string& cache_path) {
     std::string python = find_python();
     if (python.empty()) {
         fprintf(stderr, "%sPython not found. Install Python to use Emscripten.\n", CTC_TAG);
@@ -226,6 +217,35 @@ static PathsCache discover_paths(const std::string& cache_path) {
     return c;
 }
 
+// Cache miss: resolve everything from the on-disk install layout (no Python
+// import, ~1 ms). Only a missing or incomplete install goes through the
+// Python script above, because that is also what runs the installer.
+static PathsCache discover_paths(const std::string& cache_path) {
+    EmscriptenLayout em;
+    std::string why;
+    if (discover_emscripten_native(get_platform(), get_arch(), /*need_node=*/true, em, why)) {
+        PathsCache c;
+        c.emscripten_dir = em.emscripten_dir;
+        c.config_path = em.config_path;
+        c.bin_dir = em.bin_dir;
+        c.node_path = em.node_path;
+        c.python_path = em.python_path;
+        c.emcc_script = find_emscripten_script(em.emscripten_dir, "emcc");
+        c.empp_script = find_emscripten_script(em.emscripten_dir, "em++");
+        if (c.empp_script.empty()) c.empp_script = path_join(em.emscripten_dir, "em++");
+        if (c.is_valid()) {
+            write_file_atomic(cache_path, serialize_paths_cache(c));
+            return c;
+        }
+        why = c.python_path.empty() ? "python not found in PATH"
+                                    : "emcc.py not found under " + em.emscripten_dir;
+    }
+    if (env_is_truthy("CTC_DEBUG")) {
+        fprintf(stderr, "[ctc-emcc-debug] native discovery failed: %s\n", why.c_str());
+    }
+    return discover_paths_via_python(cache_path);
+}
+
 // ============================================================================
 // Section 6: User Arg Parsing
 // ============================================================================
@@ -610,14 +630,13 @@ int main(int argc, char* argv[]) {
             printf("  CTC_DEBUG=1             Debug output to stderr\n");
             printf("  CTC_NO_WASMLD_INJECT=1  Disable auto-injection of ctc-wasm-ld as the linker\n");
             printf("  EMCC_WASM_LD=<path>     Manually pin emcc's wasm-ld (honored by patched shared.py)\n");
+            printf("  CTC_EMCC_CACHE_LOCK=global  Use emcc's single cache lock (default: library)\n");
             return 0;
         }
     }
 
     // Resolve install directory and cache paths
-    std::string home = get_home_dir();
-    std::string install_dir = path_join(home, ".clang-tool-chain");
-    install_dir = path_join(install_dir, "emscripten");
+    std::string install_dir = path_join(get_ctc_home_dir(), "emscripten");
     install_dir = path_join(install_dir, platform_str(platform));
     install_dir = path_join(install_dir, arch_str(arch));
     std::string paths_cache_file = path_join(install_dir, PATHS_CACHE);
@@ -626,6 +645,14 @@ int main(int argc, char* argv[]) {
     // Parse user args (strips launcher flags)
     UserArgs user = parse_user_args(argc, argv);
 
+    // Register in the live table ctc-top reads; the slot follows exec into
+    // clang / wasm-ld / python emcc.py.
+    if (!user.dry_run) {
+        TopRegistration::self().claim(mode == EmccMode::CXX ? "em++" : "emcc",
+                                      !user.output_file.empty() ? user.output_file : user.input_file,
+                                      user.is_compile ? "compile" : "link");
+    }
+
     // ---------------------------------------------------------------
     // TIER 1: USER TEMPLATE — fastest path, zero Python
     //
@@ -773,6 +800,15 @@ int main(int argc, char* argv[]) {
         paths = discover_paths(paths_cache_file);
     }
 
+    // Per-library emscripten cache locks. The cache.py patch applied during
+    // install is inert until this is set; with it, a worker building libc++
+    // no longer blocks workers that only need an already-built libc. Under
+    // CTC_DEBUG the patched cache.py reports each lock wait on stderr.
+    // CTC_EMCC_CACHE_LOCK=global keeps upstream's single cache lock.
+    if (get_env("CTC_EMCC_CACHE_LOCK").empty()) {
+        set_env("CTC_EMCC_CACHE_LOCK", "library");
+    }
+
     // For compile mode: run emcc with EMCC_VERBOSE=1, cache clang args for next time
     if (user.is_compile && !user.input_file.empty()) {
         std::string stderr_out;
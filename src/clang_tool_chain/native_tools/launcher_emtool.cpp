@@ -34,8 +34,10 @@
 // *wrapper* Python entirely — ~1.2s saved per invocation.
 //
 // Strategy: cache (python_path, emscripten_dir, config_path, bin_dir, tool_script)
-// on first run via a one-shot discovery script; on subsequent runs read the
-// cache, set EMSCRIPTEN/EMSCRIPTEN_ROOT/EM_CONFIG, and exec python tool.py.
+// on first run, resolved from the on-disk emscripten layout (a one-shot Python
+// discovery script is the fallback when the install is missing); on
+// subsequent runs read the cache, set EMSCRIPTEN/EMSCRIPTEN_ROOT/EM_CONFIG,
+// and exec python tool.py.
 //
 // Single-file C++17. Common utilities live in ctc_common.h.
 //
@@ -119,7 +121,7 @@ static PathsCache parse_paths_cache(const std::string& content) {
 }
 
 // ============================================================================
-// Section 3: One-shot Python discovery
+// Section 3: Discovery (native, one-shot Python fallback)
 // ============================================================================
 
 // Discovery script: avoid \" inside -c "..." — cmd.exe mangles it on Windows.
@@ -128,10 +130,10 @@ static PathsCache parse_paths_cache(const std::string& content) {
 static std::string build_discovery_script(const std::string& tool_name) {
     std::string s;
     s += "import sys; ";
-    s += "from pathlib import Path; ";
+    s += "from clang_tool_chain.path_utils import get_home_toolchain_dir; ";
     s += "from clang_tool_chain.execution.emscripten import find_emscripten_tool, get_platform_info; ";
     s += "pn, ar = get_platform_info(); ";
-    s += "d = Path.home() / '.clang-tool-chain' / 'emscripten' / pn / ar; ";
+    s += "d = get_home_toolchain_dir() / 'emscripten' / pn / ar; ";
     s += "tool = find_emscripten_tool('" + tool_name + "'); ";
     s += "print('python_path=' + sys.executable); ";
     s += "print('emscripten_dir=' + str(d / 'emscripten')); ";
@@ -176,6 +178,36 @@ static PathsCache discover_via_python(const std::string& cache_path,
     return cache;
 }
 
+// Cache miss: resolve the tool from the install layout; Python discovery only
+// when the install is missing or incomplete.
+static PathsCache discover(const std::string& cache_path, const std::string& tool_name,
+                           const std::string& tag) {
+    EmscriptenLayout em;
+    std::string why;
+    if (discover_emscripten_native(get_platform(), get_arch(), /*need_node=*/false, em, why)) {
+        PathsCache c;
+        c.python_path = em.python_path;
+        c.emscripten_dir = em.emscripten_dir;
+        c.config_path = em.config_path;
+        c.bin_dir = em.bin_dir;
+        c.tool_script = find_emscripten_script(em.emscripten_dir, tool_name);
+        if (c.is_valid()) {
+            write_file_atomic(cache_path, "python_path=" + c.python_path + "\n" +
+                                              "emscripten_dir=" + c.emscripten_dir + "\n" +
+                                              "config_path=" + c.config_path + "\n" +
+                                              "bin_dir=" + c.bin_dir + "\n" +
+                                              "tool_script=" + c.tool_script + "\n");
+            return c;
+        }
+        why = c.python_path.empty() ? "python not found in PATH"
+                                    : tool_name + " script not found under " + em.emscripten_dir;
+    }
+    if (env_is_truthy("CTC_DEBUG")) {
+        fprintf(stderr, "%snative discovery failed: %s\n", tag.c_str(), why.c_str());
+    }
+    return discover_via_python(cache_path, tool_name, tag);
+}
+
 // ============================================================================
 // Section 4: main()
 // ============================================================================
@@ -233,17 +265,15 @@ int main(int argc, char* argv[]) {
     }
 
     // Resolve cache path
-    std::string home = get_home_dir();
-    std::string install_dir = path_join(home, ".clang-tool-chain");
-    install_dir = path_join(install_dir, "emscripten");
+    std::string install_dir = path_join(get_ctc_home_dir(), "emscripten");
     install_dir = path_join(install_dir, platform_str(platform));
     install_dir = path_join(install_dir, arch_str(arch));
     std::string cache_path = path_join(install_dir, cache_filename);
 
-    // Read cache or run one-shot Python discovery
+    // Read cache or discover (one-time)
     PathsCache cache = parse_paths_cache(read_file(cache_path));
     if (!cache.is_valid()) {
-        cache = discover_via_python(cache_path, tool_name, tag);
+        cache = discover(cache_path, tool_name, tag);
     }
 
     if (debug) {
@@ -258,6 +288,11 @@ int main(int argc, char* argv[]) {
     set_env("EMSCRIPTEN", cache.emscripten_dir);
     set_env("EMSCRIPTEN_ROOT", cache.emscripten_dir);
     set_env("EM_CONFIG", cache.config_path);
+    // Same per-library cache lock default as ctc-emcc: embuilder, emcmake and
+    // emmake build system libraries through the same patched cache.py.
+    if (get_env("CTC_EMCC_CACHE_LOCK").empty()) {
+        set_env("CTC_EMCC_CACHE_LOCK", "library");
+    }
 
     // Prepend emscripten bin/ to PATH so the underlying llvm-ar/llvm-ranlib/etc
     // are found by the python wrapper without needing user PATH setup.
@@ -281,5 +316,6 @@ int main(int argc, char* argv[]) {
     }
 
     if (dry_run) { print_command(cmd); return 0; }
+    TopRegistration::self().claim(tool_name.c_str(), guess_invocation_target(argc, argv), "run");
     exec_process(cmd, tag.c_str());
 }
@@ -0,0 +1,390 @@
+// clang-tool-chain compiler-flag A/B benchmark (ctc-flagbench)
+//
+// Builds one program once per flag profile through ctc-clang++ and compares
+// what each profile costs to build and what it buys at run time:
+//
+//   ctc-flagbench -P o2='-O2' -P o3='-O3 -march=native' -P lto='-O2 -flto=thin'
+//                 src/*.cpp -- {bin} --iterations 1000
+//
+// Build: every (profile, source) compile is one task on the shared executor
+// (ctc_common.h Section 13), followed by one link per profile, each profile in
+// its own directory. Compile CPU time (user+sys) and peak RSS come from wait4()
+// of the compiler processes, so parallel builds do not skew them. LTO work is
+// counted where it happens, in the link.
+//
+// Run: the benchmark command (`{bin}` is replaced by the profile's binary,
+// default: the binary alone) runs --warmup untimed rounds, then --runs timed
+// ones. Rounds are interleaved across profiles so frequency scaling and
+// page-cache drift hit every profile alike. The report gives each profile's
+// mean wall time with a 95% confidence interval (Student t), and its change
+// against the first profile with a Welch t interval. Changes whose interval
+// excludes zero are marked.
+//
+// Single-file C++17. Common utilities live in ctc_common.h. POSIX only (wait4).
+//
+// Build: clang++ -O3 -std=c++17 -o ctc-flagbench launcher_flagbench.cpp
+//   Linux:   add -static-libstdc++ -static-libgcc -lpthread
+
+#include "ctc_common.h"
+
+#include <cmath>
+
+using namespace ctc;
+
+// ============================================================================
+// Section 0: Tool-specific constants
+// ============================================================================
+
+static constexpr const char* CTC_TAG = "[ctc-flagbench] ";
+
+// ============================================================================
+// Section 1: Statistics
+// ============================================================================
+
+// Two-sided 95% Student t critical values for 1..30 degrees of freedom.
+static double t95(double df) {
+    static const double table[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                   2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                   2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+    if (df < 1) return table[0];
+    if (df > 30) return 1.96;
+    return table[(size_t)df - 1];
+}
+
+struct Sample {
+    double mean = 0, var = 0, min = 0;
+    size_t n = 0;
+
+    explicit Sample(const std::vector<double>& v) : n(v.size()) {
+        if (v.empty()) return;
+        min = *std::min_element(v.begin(), v.end());
+        for (double x : v) mean += x;
+        mean /= (double)n;
+        for (double x : v) var += (x - mean) * (x - mean);
+        var = n > 1 ? var / (double)(n - 1) : 0.0;
+    }
+
+    // Half-width of the 95% confidence interval of the mean
+    double ci95() const { return n > 1 ? t95((double)(n - 1)) * std::sqrt(var / (double)n) : 0.0; }
+};
+
+// Welch's interval for mean(b) - mean(a): returns the half-width.
+static double welch_ci95(const Sample& a, const Sample& b) {
+    if (a.n < 2 || b.n < 2) return 0.0;
+    double qa = a.var / (double)a.n, qb = b.var / (double)b.n;
+    double se2 = qa + qb;
+    if (se2 <= 0) return 0.0;
+    double df = se2 * se2 / (qa * qa / (double)(a.n - 1) + qb * qb / (double)(b.n - 1));
+    return t95(std::floor(df)) * std::sqrt(se2);
+}
+
+// ============================================================================
+// Section 2: Profile builds
+// ============================================================================
+
+struct Profile {
+    std::string name;
+    std::vector<std::string> flags;
+    std::string dir;
+    std::string binary;
+    bool built = false;
+    double compile_cpu_s = 0;   // all compiles + link
+    double build_wall_s = 0;    // longest compile + link (as if fully parallel)
+    uint64_t peak_rss_kb = 0;
+    uint64_t size = 0;
+    std::vector<double> run_s;
+};
+
+static std::vector<std::string> split_flags(const std::string& s) {
+    std::vector<std::string> out;
+    std::istringstream in(s);
+    std::string f;
+    while (in >> f) out.push_back(f);
+    return out;
+}
+
+static std::string object_name(const std::string& src, size_t index) {
+    size_t slash = src.find_last_of("/\\");
+    std::string base = slash == std::string::npos ? src : src.substr(slash + 1);
+    size_t dot = base.rfind('.');
+    if (dot != std::string::npos) base = base.substr(0, dot);
+    return std::to_string(index) + "-" + base + ".o";  // index keeps a/x.cpp and b/x.cpp apart
+}
+
+static bool build_profiles(std::vector<Profile>& profiles, const std::vector<std::string>& sources,
+                           const std::string& cxx, const std::string& cc, const std::vector<std::string>& common,
+                           const std::vector<std::string>& link_flags, unsigned jobs) {
+    size_t n_src = sources.size();
+    std::vector<ProcessUsage> usage(profiles.size() * n_src);
+    std::vector<int> rcs(usage.size(), 0);
+    parallel_for(usage.size(), [&](size_t t) {
+        Profile& p = profiles[t / n_src];
+        size_t s = t % n_src;
+        bool is_c = get_extension(sources[s]) == ".c";
+        std::vector<std::string> cmd = {is_c ? cc : cxx};
+        cmd.insert(cmd.end(), p.flags.begin(), p.flags.end());
+        cmd.insert(cmd.end(), common.begin(), common.end());
+        cmd.insert(cmd.end(), {"-c", sources[s], "-o", path_join(p.dir, object_name(sources[s], s))});
+        rcs[t] = run_measured(cmd, false, usage[t], CTC_TAG);
+    }, jobs);
+
+    std::vector<char> compiled(profiles.size(), 1);
+    for (size_t t = 0; t < usage.size(); t++) {
+        Profile& p = profiles[t / n_src];
+        if (rcs[t] != 0) {
+            fprintf(stderr, "%s%s: compiling %s failed (exit %d)\n", CTC_TAG, p.name.c_str(),
+                    sources[t % n_src].c_str(), rcs[t]);
+            compiled[t / n_src] = 0;
+        }
+        p.compile_cpu_s += usage[t].cpu_s;
+        p.build_wall_s = std::max(p.build_wall_s, usage[t].wall_s);
+        p.peak_rss_kb = std::max(p.peak_rss_kb, usage[t].maxrss_kb);
+    }
+
+    parallel_for(profiles.size(), [&](size_t i) {
+        Profile& p = profiles[i];
+        if (!compiled[i]) return;
+        std::vector<std::string> cmd = {cxx};
+        cmd.insert(cmd.end(), p.flags.begin(), p.flags.end());
+        cmd.insert(cmd.end(), common.begin(), common.end());
+        for (size_t s = 0; s < n_src; s++) cmd.push_back(path_join(p.dir, object_name(sources[s], s)));
+        cmd.insert(cmd.end(), link_flags.begin(), link_flags.end());
+        cmd.insert(cmd.end(), {"-o", p.binary});
+        ProcessUsage u;
+        int rc = run_measured(cmd, false, u, CTC_TAG);
+        if (rc != 0) {
+            fprintf(stderr, "%s%s: link failed (exit %d)\n", CTC_TAG, p.name.c_str(), rc);
+            return;
+        }
+        p.compile_cpu_s += u.cpu_s;
+        p.build_wall_s += u.wall_s;
+        p.peak_rss_kb = std::max(p.peak_rss_kb, u.maxrss_kb);
+        FileStamp st;
+        p.built = file_stamp(p.binary, st);
+        p.size = st.size;
+    }, jobs);
+
+    for (const auto& p : profiles) {
+        if (!p.built) return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// Section 3: Benchmark runs + report
+// ============================================================================
+
+static std::vector<std::string> bench_command(const std::vector<std::string>& bench, const std::string& binary) {
+    std::vector<std::string> cmd;
+    bool substituted = false;
+    for (const auto& a : bench) {
+        size_t at = a.find("{bin}");
+        if (at == std::string::npos) {
+            cmd.push_back(a);
+            continue;
+        }
+        cmd.push_back(a.substr(0, at) + binary + a.substr(at + 5));
+        substituted = true;
+    }
+    // No {bin}: the arguments are the binary's own
+    if (!substituted) cmd.insert(cmd.begin(), binary);
+    return cmd;
+}
+
+static bool run_benchmarks(std::vector<Profile>& profiles, const std::vector<std::string>& bench, int runs,
+                           int warmup, bool show_output) {
+    for (int round = 0; round < warmup + runs; round++) {
+        for (auto& p : profiles) {
+            ProcessUsage u;
+            int rc = run_measured(bench_command(bench, p.binary), !show_output, u, CTC_TAG);
+            if (rc != 0) {
+                fprintf(stderr, "%s%s: benchmark exited with %d\n", CTC_TAG, p.name.c_str(), rc);
+                return false;
+            }
+            if (round >= warmup) p.run_s.push_back(u.wall_s);
+        }
+    }
+    return true;
+}
+
+static std::string human_time(double s) {
+    char buf[32];
+    if (s >= 1.0) snprintf(buf, sizeof(buf), "%.3f s", s);
+    else if (s >= 1e-3) snprintf(buf, sizeof(buf), "%.2f ms", s * 1e3);
+    else snprintf(buf, sizeof(buf), "%.1f us", s * 1e6);
+    return buf;
+}
+
+static std::string human_size(uint64_t bytes) {
+    char buf[32];
+    if (bytes >= (1ULL << 20)) snprintf(buf, sizeof(buf), "%.1f MB", (double)bytes / (1 << 20));
+    else snprintf(buf, sizeof(buf), "%.1f KB", (double)bytes / 1024);
+    return buf;
+}
+
+static void report(const std::vector<Profile>& profiles, size_t n_src, int runs, int warmup, bool json) {
+    Sample base(profiles[0].run_s);
+    if (json) {
+        printf("{\n  \"sources\": %zu,\n  \"runs\": %d,\n  \"warmup\": %d,\n  \"profiles\": [", n_src, runs, warmup);
+        for (size_t i = 0; i < profiles.size(); i++) {
+            const Profile& p = profiles[i];
+            Sample s(p.run_s);
+            std::string flags;
+            for (const auto& f : p.flags) flags += (flags.empty() ? "" : " ") + f;
+            printf("%s\n    {\"name\": \"%s\", \"flags\": \"%s\", \"compile_cpu_s\": %.4f, \"build_wall_s\": %.4f, "
+                   "\"peak_rss_kb\": %llu, \"binary_size\": %llu, \"run_mean_s\": %.6f, \"run_ci95_s\": %.6f, "
+                   "\"run_min_s\": %.6f, \"change_vs_base\": %.4f, \"change_ci95\": %.4f}",
+                   i ? "," : "", json_escape(p.name).c_str(), json_escape(flags).c_str(), p.compile_cpu_s,
+                   p.build_wall_s, (unsigned long long)p.peak_rss_kb, (unsigned long long)p.size, s.mean,
+                   s.ci95(), s.min, base.mean > 0 ? (s.mean - base.mean) / base.mean : 0.0,
+                   base.mean > 0 ? welch_ci95(base, s) / base.mean : 0.0);
+        }
+        printf("\n  ]\n}\n");
+        return;
+    }
+
+    printf("ctc-flagbench: %zu profiles, %zu source(s), %d runs each (%d warmup)\n\n", profiles.size(), n_src, runs,
+           warmup);
+    printf("Build:\n");
+    printf("  %-16s %12s %12s %10s %12s\n", "", "compile CPU", "build wall", "peak RSS", "binary");
+    for (const auto& p : profiles) {
+        printf("  %-16s %12s %12s %7llu MB %12s\n", p.name.c_str(), human_time(p.compile_cpu_s).c_str(),
+               human_time(p.build_wall_s).c_str(), (unsigned long long)(p.peak_rss_kb / 1024),
+               human_size(p.size).c_str());
+    }
+    if (runs == 0) return;
+    printf("\nRun (wall time, mean with 95%% CI):\n");
+    printf("  %-16s %12s %12s %12s  vs %s\n", "", "mean", "+/-", "min", profiles[0].name.c_str());
+    for (size_t i = 0; i < profiles.size(); i++) {
+        const Profile& p = profiles[i];
+        Sample s(p.run_s);
+        std::string change = "baseline";
+        if (i > 0 && base.mean > 0) {
+            double pct = (s.mean - base.mean) / base.mean * 100.0;
+            double ci = welch_ci95(base, s) / base.mean * 100.0;
+            char buf[64];
+            const char* verdict = std::fabs(pct) > ci && s.n > 1 ? (pct < 0 ? "faster" : "slower") : "(within noise)";
+            snprintf(buf, sizeof(buf), "%+.1f%% +/- %.1f%%  %s", pct, ci, verdict);
+            change = buf;
+        }
+        printf("  %-16s %12s %12s %12s  %s\n", p.name.c_str(), human_time(s.mean).c_str(), human_time(s.ci95()).c_str(),
+               human_time(s.min).c_str(), change.c_str());
+    }
+}
+
+// ============================================================================
+// Section 4: main()
+// ============================================================================
+
+static void print_usage() {
+    printf("Usage: ctc-flagbench -P NAME=FLAGS [-P ...] [options] SOURCE... [-- BENCH-CMD...]\n\n");
+    printf("Builds SOURCE... once per flag profile with ctc-clang++ (in parallel, one\n");
+    printf("directory per profile) and compares compile CPU time, peak compiler RSS,\n");
+    printf("binary size and benchmark wall time. The first profile is the baseline.\n\n");
+    printf("BENCH-CMD runs each profile's binary; {bin} is replaced by its path. Without\n");
+    printf("{bin}, BENCH-CMD is the binary's arguments. Default: the binary alone.\n\n");
+    printf("Options:\n");
+    printf("  -P, --profile NAME=FLAGS  Flag profile (repeatable), e.g. -P o3='-O3 -march=native'\n");
+    printf("  --flag FLAG               Flag for every compile and link (repeatable, e.g. -Iinclude)\n");
+    printf("  --link-flag FLAG          Flag for every link only (repeatable, e.g. -lpthread)\n");
+    printf("  --runs N                  Timed benchmark runs per profile (default: 10)\n");
+    printf("  --warmup N                Untimed rounds first (default: 2)\n");
+    printf("  --build-only              Build and report build costs, skip the benchmark\n");
+    printf("  -j N                      Parallel compiles (default: all cores / CTC_JOBS)\n");
+    printf("  --clang PATH              C++ compiler (default: ctc-clang++ next to ctc-flagbench;\n");
+    printf("                            C sources use ctc-clang from the same directory)\n");
+    printf("  --out DIR                 Build into DIR/<profile>/ and keep it (default: temp dir)\n");
+    printf("  --show-output             Let the benchmark print to the terminal\n");
+    printf("  --json                    JSON output\n");
+    printf("  --help, -h                Show this help\n");
+}
+
+int main(int argc, char* argv[]) {
+    int runs = 10, warmup = 2;
+    unsigned jobs = 0;
+    bool json = false, build_only = false, show_output = false;
+    std::string cxx, out_dir;
+    std::vector<Profile> profiles;
+    std::vector<std::string> sources, common, link_flags, bench;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--") {
+            for (i++; i < argc; i++) bench.push_back(argv[i]);
+            break;
+        }
+        if (arg == "--help" || arg == "-h" || arg == "--ctc-help") { print_usage(); return 0; }
+        if (arg == "--json") { json = true; continue; }
+        if (arg == "--build-only") { build_only = true; continue; }
+        if (arg == "--show-output") { show_output = true; continue; }
+        if (arg == "--runs" && i + 1 < argc) { runs = std::max(1, atoi(argv[++i])); continue; }
+        if (arg == "--warmup" && i + 1 < argc) { warmup = std::max(0, atoi(argv[++i])); continue; }
+        if (arg == "-j" && i + 1 < argc) { jobs = (unsigned)std::max(1, atoi(argv[++i])); continue; }
+        if (arg == "--clang" && i + 1 < argc) { cxx = argv[++i]; continue; }
+        if (arg == "--out" && i + 1 < argc) { out_dir = argv[++i]; continue; }
+        if (arg == "--flag" && i + 1 < argc) { common.push_back(argv[++i]); continue; }
+        if (arg == "--link-flag" && i + 1 < argc) { link_flags.push_back(argv[++i]); continue; }
+        if ((arg == "-P" || arg == "--profile") && i + 1 < argc) {
+            std::string spec = argv[++i];
+            size_t eq = spec.find('=');
+            Profile p;
+            p.name = spec.substr(0, eq);
+            if (eq != std::string::npos) p.flags = split_flags(spec.substr(eq + 1));
+            bool valid = !p.name.empty() && p.name.find_first_of("/\\") == std::string::npos;
+            for (const auto& other : profiles) valid &= other.name != p.name;
+            if (!valid) {
+                fprintf(stderr, "%sInvalid or duplicate profile name: %s\n", CTC_TAG, p.name.c_str());
+                return 2;
+            }
+            profiles.push_back(std::move(p));
+            continue;
+        }
+        if (arg.size() > 1 && arg[0] == '-') {
+            fprintf(stderr, "%sUnknown option: %s\n", CTC_TAG, arg.c_str());
+            return 2;
+        }
+        sources.push_back(arg);
+    }
+
+    if (profiles.empty() || sources.empty()) {
+        print_usage();
+        return 2;
+    }
+    for (const auto& s : sources) {
+        if (!path_exists(s)) {
+            fprintf(stderr, "%sSource not found: %s\n", CTC_TAG, s.c_str());
+            return 1;
+        }
+    }
+    if (cxx.empty()) cxx = path_join(get_exe_dir(), "ctc-clang++");
+    if (!path_exists(cxx)) {
+        fprintf(stderr, "%s%s not found (use --clang PATH)\n", CTC_TAG, cxx.c_str());
+        return 1;
+    }
+    size_t slash = cxx.find_last_of('/');
+    std::string cc = path_join(slash == std::string::npos ? "." : cxx.substr(0, slash), "ctc-clang");
+    if (!path_exists(cc)) cc = cxx;
+
+    std::string work = out_dir.empty() ? make_work_dir("ctc-flagbench") : out_dir;
+    if (!work.empty() && !is_directory(work)) make_directory(work);
+    if (work.empty() || !is_directory(work)) {
+        fprintf(stderr, "%scannot create a build directory\n", CTC_TAG);
+        return 1;
+    }
+    for (auto& p : profiles) {
+        p.dir = path_join(work, p.name);
+        make_directory(p.dir);
+        p.binary = path_join(p.dir, "bench");
+    }
+
+    int rc = 1;
+    if (build_profiles(profiles, sources, cxx, cc, common, link_flags, jobs)) {
+        if (build_only || run_benchmarks(profiles, bench, build_only ? 0 : runs, warmup, show_output)) {
+            report(profiles, sources.size(), build_only ? 0 : runs, build_only ? 0 : warmup, json);
+            rc = 0;
+        }
+    }
+
+    if (out_dir.empty()) remove_tree(work);
+    return rc;
+}
@@ -0,0 +1,655 @@
+// clang-tool-chain libFuzzer campaign manager (ctc-fuzz)
+//
+// Builds libFuzzer targets through ctc-clang++ and runs them as managed
+// parallel campaigns:
+//
+//   ctc-fuzz build -o fuzz_parser fuzz_parser.cpp src/parser.cpp -- -Iinclude
+//   ctc-fuzz run ./fuzz_parser corpus/ seeds/ --time 3600 --merge-every 600
+//   ctc-fuzz merge ./fuzz_parser corpus/ crash-repro/
+//
+// build: -fsanitize=fuzzer plus --sanitize (default address,undefined) with
+// -g -O1 -fno-omit-frame-pointer, UBSAN made fatal so findings become crashes,
+// and --deploy-dependencies so the shared ASAN runtime ctc-clang links
+// travels with the binary.
+//
+// run: rounds of --merge-every seconds. Each round starts --workers libFuzzer
+// processes on the shared corpus (libFuzzer's -reload picks up the others'
+// finds), then merges and minimizes the corpus with -merge=1 into a fresh
+// directory and swaps it in. Workers default to one per core, capped so
+// workers x --rss-limit-mb fits in available memory. Each round reports
+// exec/s per worker, coverage (cov/ft), corpus size before and after the
+// merge, and any crash, timeout, OOM or leak artifacts with their sanitizer
+// SUMMARY line. Stops at --time, on the first round with a crash, or on
+// Ctrl-C after a final merge. Exit code 1 = crashes.
+//
+// --keep-going runs each worker as -fork=1 -ignore_crashes=1 (and timeouts,
+// OOMs), so libFuzzer itself restarts the target after a finding and the
+// worker lives out its round. Workers are independent processes rather than
+// one -fork=N: that keeps per-worker stats and lets the merge see each
+// round's finds.
+//
+// Single-file C++17. Common utilities live in ctc_common.h. POSIX only.
+//
+// Build: clang++ -O3 -std=c++17 -o ctc-fuzz launcher_fuzz.cpp
+//   Linux:   add -static-libstdc++ -static-libgcc -lpthread
+
+#include "ctc_common.h"
+
+#include <csignal>
+
+using namespace ctc;
+
+// ============================================================================
+// Section 0: Tool-specific constants
+// ============================================================================
+
+static constexpr const char* CTC_TAG = "[ctc-fuzz] ";
+static constexpr const char* DEFAULT_SANITIZERS = "address,undefined";
+
+// Workers get this much past -max_total_time before SIGTERM (a unit can
+// outlive the deadline by up to libFuzzer's -timeout).
+static constexpr int WORKER_GRACE_S = 60;
+
+// Ctrl-C count; nonzero = interrupted. wait_all forwards only the ones that
+// arrive while it waits, so the final merge after a Ctrl-C still runs.
+static volatile sig_atomic_t g_interrupted = 0;
+
+static void on_sigint(int) {
+    g_interrupted = g_interrupted + 1;
+}
+
+// ============================================================================
+// Section 1: Process helpers
+// ============================================================================
+
+// fork + execv with stdout/stderr to `log` ("" = inherit); returns the pid.
+static pid_t spawn_logged(const std::vector<std::string>& cmd, const std::string& log) {
+    std::vector<const char*> argv_ptrs;
+    for (const auto& s : cmd) argv_ptrs.push_back(s.c_str());
+    argv_ptrs.push_back(nullptr);
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (!log.empty()) {
+            int fd = open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd >= 0) {
+                dup2(fd, 1);
+                dup2(fd, 2);
+                close(fd);
+            }
+        }
+        execvp(cmd[0].c_str(), const_cast<char**>(argv_ptrs.data()));
+        fprintf(stderr, "%scannot run %s: %s\n", CTC_TAG, cmd[0].c_str(), strerror(errno));
+        _exit(127);
+    }
+    return pid;
+}
+
+// Waits for all `pids`; SIGTERMs stragglers after `deadline_s` and forwards
+// a Ctrl-C that arrives during the wait once. Returns exit codes
+// (128+signal) in the same order.
+static std::vector<int> wait_all(const std::vector<pid_t>& pids, double deadline_s) {
+    std::vector<int> rcs(pids.size(), -1);
+    size_t remaining = 0;
+    for (pid_t p : pids) remaining += p > 0;
+    const sig_atomic_t interrupts_before = g_interrupted;
+    bool forwarded = false, terminated = false;
+    uint64_t start = now_us();
+    while (remaining > 0) {
+        for (size_t i = 0; i < pids.size(); i++) {
+            if (pids[i] <= 0 || rcs[i] != -1) continue;
+            int status = 0;
+            if (waitpid(pids[i], &status, WNOHANG) != pids[i]) continue;
+            rcs[i] = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+            remaining--;
+        }
+        if (remaining == 0) break;
+        double elapsed = (double)(now_us() - start) / 1e6;
+        bool interrupted = g_interrupted != interrupts_before;
+        if ((interrupted && !forwarded) || (elapsed > deadline_s && !terminated)) {
+            int sig = interrupted ? SIGINT : SIGTERM;
+            for (size_t i = 0; i < pids.size(); i++) {
+                if (pids[i] > 0 && rcs[i] == -1) kill(pids[i], sig);
+            }
+            forwarded = forwarded || interrupted;
+            terminated = terminated || !interrupted;
+        }
+        usleep(50000);
+    }
+    return rcs;
+}
+
+static int run_wait(const std::vector<std::string>& cmd, const std::string& log) {
+    pid_t pid = spawn_logged(cmd, log);
+    if (pid < 0) return -1;
+    return wait_all({pid}, 1e12)[0];
+}
+
+static size_t count_files(const std::string& dir) {
+    size_t n = 0;
+    for (const auto& name : list_directory(dir)) n += !is_directory(path_join(dir, name));
+    return n;
+}
+
+// Memory the workers may use: MemAvailable on Linux, physical memory elsewhere.
+static uint64_t available_memory_mb() {
+    std::istringstream meminfo(read_file("/proc/meminfo"));
+    std::string key;
+    uint64_t kb = 0;
+    while (meminfo >> key >> kb) {
+        if (key == "MemAvailable:") return kb / 1024;
+        meminfo.ignore(256, '\n');
+    }
+    long pages = sysconf(_SC_PHYS_PAGES), page_size = sysconf(_SC_PAGE_SIZE);
+    if (pages <= 0 || page_size <= 0) return 0;
+    return (uint64_t)pages / 1024 * (uint64_t)page_size / 1024;
+}
+
+// ============================================================================
+// Section 2: build
+// ============================================================================
+
+static int cmd_build(const std::vector<std::string>& args) {
+    std::string output, sanitizers = DEFAULT_SANITIZERS, cxx;
+    bool deploy = true, dry_run = false;
+    std::vector<std::string> sources, extra;
+    for (size_t i = 0; i < args.size(); i++) {
+        const std::string& a = args[i];
+        if (a == "--") {
+            extra.assign(args.begin() + (long)i + 1, args.end());
+            break;
+        }
+        if (a == "-o" && i + 1 < args.size()) { output = args[++i]; continue; }
+        if (a == "--sanitize" && i + 1 < args.size()) { sanitizers = args[++i]; continue; }
+        if (a == "--clang" && i + 1 < args.size()) { cxx = args[++i]; continue; }
+        if (a == "--no-deploy") { deploy = false; continue; }
+        if (a == "--dry-run") { dry_run = true; continue; }
+        if (!a.empty() && a[0] == '-') {
+            fprintf(stderr, "%sUnknown build option: %s (compiler flags go after --)\n", CTC_TAG, a.c_str());
+            return 2;
+        }
+        sources.push_back(a);
+    }
+    if (sources.empty()) {
+        fprintf(stderr, "%sbuild: no sources\n", CTC_TAG);
+        return 2;
+    }
+    if (output.empty()) {
+        std::string base = sources[0].substr(sources[0].find_last_of('/') + 1);
+        output = base.substr(0, base.find_last_of('.'));
+    }
+    if (cxx.empty()) {
+        bool all_c = true;
+        for (const auto& s : sources) all_c &= get_extension(s) == ".c";
+        cxx = path_join(get_exe_dir(), all_c ? "ctc-clang" : "ctc-clang++");
+    }
+
+    std::string fsanitize = "-fsanitize=fuzzer";
+    if (sanitizers != "none" && !sanitizers.empty()) fsanitize += "," + sanitizers;
+    std::vector<std::string> cmd = {cxx, "-g", "-O1", "-fno-omit-frame-pointer", fsanitize};
+    if (fsanitize.find("undefined") != std::string::npos) cmd.push_back("-fno-sanitize-recover=undefined");
+    if (deploy) cmd.push_back("--deploy-dependencies");
+    cmd.insert(cmd.end(), sources.begin(), sources.end());
+    cmd.insert(cmd.end(), extra.begin(), extra.end());
+    cmd.insert(cmd.end(), {"-o", output});
+
+    if (dry_run) {
+        for (size_t i = 0; i < cmd.size(); i++) printf("%s%s", i ? " " : "", cmd[i].c_str());
+        printf("\n");
+        return 0;
+    }
+    int rc = run_wait(cmd, "");
+    if (rc != 0) {
+        fprintf(stderr, "%sbuild failed (exit %d)\n", CTC_TAG, rc);
+        return 1;
+    }
+    fprintf(stderr, "%sbuilt %s\n", CTC_TAG, output.c_str());
+    return 0;
+}
+
+// ============================================================================
+// Section 3: Worker log parsing
+// ============================================================================
+
+struct Finding {
+    std::string kind;      // crash, timeout, oom, leak
+    std::string artifact;
+    std::string summary;   // sanitizer SUMMARY line or libFuzzer's deadly-signal line
+    size_t worker = 0;
+    int round = 0;
+};
+
+struct WorkerStats {
+    uint64_t execs = 0;
+    double exec_per_s = 0;
+    uint64_t cov = 0, ft = 0;
+    uint64_t peak_rss_mb = 0;
+    int rc = 0;
+    std::vector<Finding> findings;
+};
+
+// Value after `key` in a libFuzzer line ("cov: 123", "exec/s: 4567").
+static bool field_after(const std::string& line, const char* key, uint64_t& out) {
+    size_t pos = line.find(key);
+    if (pos == std::string::npos) return false;
+    pos += strlen(key);
+    while (pos < line.size() && line[pos] == ' ') pos++;
+    if (pos >= line.size() || !isdigit((unsigned char)line[pos])) return false;
+    out = strtoull(line.c_str() + pos, nullptr, 10);
+    return true;
+}
+
+static WorkerStats parse_worker_log(const std::string& log) {
+    WorkerStats w;
+    std::istringstream ss(read_file(log));
+    std::string line, summary;
+    uint64_t v = 0;
+    while (std::getline(ss, line)) {
+        if (!line.empty() && line[0] == '#') {
+            if (field_after(line, "cov:", v)) w.cov = std::max(w.cov, v);
+            if (field_after(line, "ft:", v)) w.ft = std::max(w.ft, v);
+            if (field_after(line, "exec/s:", v)) w.exec_per_s = (double)v;
+            uint64_t n = strtoull(line.c_str() + 1, nullptr, 10);
+            w.execs = std::max(w.execs, n);
+        } else if (field_after(line, "stat::number_of_executed_units:", v)) {
+            w.execs = v;
+        } else if (field_after(line, "stat::average_exec_per_sec:", v)) {
+            w.exec_per_s = (double)v;
+        } else if (field_after(line, "stat::peak_rss_mb:", v)) {
+            w.peak_rss_mb = v;
+        } else if (starts_with(line, "SUMMARY: ") || line.find("deadly signal") != std::string::npos ||
+                   line.find("ERROR: libFuzzer: ") != std::string::npos) {
+            if (summary.empty() || starts_with(line, "SUMMARY: ")) summary = line;
+        } else if (line.find("Test unit written to ") != std::string::npos) {
+            Finding f;
+            f.artifact = line.substr(line.find("Test unit written to ") + 21);
+            std::string base = f.artifact.substr(f.artifact.find_last_of('/') + 1);
+            f.kind = base.substr(0, base.find('-'));
+            if (f.kind == "slow") continue;  // slow-unit-*: informational
+            f.summary = summary;
+            summary.clear();
+            w.findings.push_back(std::move(f));
+        }
+    }
+    return w;
+}
+
+// "MERGE-OUTER: 85 new files with 1234 new features added; 567 new coverage edges"
+// Merging into an empty directory, "new" is the whole minimized corpus.
+static bool parse_merge_log(const std::string& log, uint64_t& files, uint64_t& features, uint64_t& edges) {
+    std::istringstream ss(read_file(log));
+    std::string line;
+    bool found = false;
+    while (std::getline(ss, line)) {
+        if (!starts_with(line, "MERGE-OUTER: ") || line.find("new files") == std::string::npos) continue;
+        files = strtoull(line.c_str() + 13, nullptr, 10);
+        size_t with = line.find(" with ");
+        if (with != std::string::npos) features = strtoull(line.c_str() + with + 6, nullptr, 10);
+        size_t semi = line.find("; ");
+        if (semi != std::string::npos) edges = strtoull(line.c_str() + semi + 2, nullptr, 10);
+        found = true;
+    }
+    return found;
+}
+
+// ============================================================================
+// Section 4: merge
+// ============================================================================
+
+struct MergeResult {
+    bool ok = false;
+    size_t before = 0, after = 0;
+    uint64_t features = 0, edges = 0;
+};
+
+// Campaign flags that also bound the merge run, the user's included: its
+// resource limits and where crashing inputs land. Coverage-shaping flags
+// (-max_len, -dict, -use_value_profile, ...) and -fork stay with the workers.
+static bool is_merge_flag(const std::string& flag) {
+    for (const char* name : {"-rss_limit_mb=", "-malloc_limit_mb=", "-timeout=", "-artifact_prefix="}) {
+        if (starts_with(flag, name)) return true;
+    }
+    return false;
+}
+
+// Minimizes `corpus` (plus `extra` dirs) into a fresh directory and swaps it
+// in. The old corpus is only removed once the new one is in place.
+static MergeResult merge_corpus(const std::string& binary, const std::string& corpus,
+                                const std::vector<std::string>& extra, const std::vector<std::string>& fuzzer_flags,
+                                const std::string& log) {
+    MergeResult m;
+    m.before = count_files(corpus);
+    std::string fresh = corpus + ".merge", old = corpus + ".old";
+    remove_tree(fresh);
+    remove_tree(old);
+    make_directory(fresh);
+    std::vector<std::string> cmd = {binary, "-merge=1"};
+    cmd.insert(cmd.end(), fuzzer_flags.begin(), fuzzer_flags.end());
+    cmd.push_back(fresh);
+    cmd.push_back(corpus);
+    cmd.insert(cmd.end(), extra.begin(), extra.end());
+    uint64_t files = 0;
+    int rc = run_wait(cmd, log);
+    if (rc != 0 || !parse_merge_log(log, files, m.features, m.edges)) {
+        fprintf(stderr, "%smerge failed (exit %d), keeping the corpus as is; see %s\n", CTC_TAG, rc, log.c_str());
+        remove_tree(fresh);
+        m.after = m.before;
+        return m;
+    }
+    if (std::rename(corpus.c_str(), old.c_str()) != 0 || std::rename(fresh.c_str(), corpus.c_str()) != 0) {
+        fprintf(stderr, "%scannot swap in the merged corpus: %s\n", CTC_TAG, strerror(errno));
+        if (!is_directory(corpus)) std::rename(old.c_str(), corpus.c_str());
+        m.after = m.before;
+        return m;
+    }
+    remove_tree(old);
+    m.ok = true;
+    m.after = count_files(corpus);
+    return m;
+}
+
+// ============================================================================
+// Section 5: run
+// ============================================================================
+
+struct RunOptions {
+    std::string binary, corpus, artifacts;
+    std::vector<std::string> seeds;
+    std::vector<std::string> fuzzer_flags;  // passed through after --
+    unsigned workers = 0;
+    uint64_t rss_limit_mb = 2048;
+    int total_s = 600;
+    int merge_every_s = 300;
+    bool keep_going = false;
+    bool json = false;
+    std::string dict;
+    int max_len = 0;
+    int unit_timeout_s = 0;
+};
+
+struct Round {
+    int index = 0;
+    double wall_s = 0;
+    std::vector<WorkerStats> workers;
+    MergeResult merge;
+};
+
+static std::string human_count(double v) {
+    char buf[32];
+    if (v >= 1e6) snprintf(buf, sizeof(buf), "%.1fM", v / 1e6);
+    else if (v >= 1e4) snprintf(buf, sizeof(buf), "%.1fk", v / 1e3);
+    else snprintf(buf, sizeof(buf), "%.0f", v);
+    return buf;
+}
+
+static void print_round(const Round& r) {
+    uint64_t execs = 0, cov = 0, ft = 0;
+    size_t found = 0;
+    for (const auto& w : r.workers) {
+        execs += w.execs;
+        cov = std::max(cov, w.cov);
+        ft = std::max(ft, w.ft);
+        found += w.findings.size();
+    }
+    fprintf(stderr, "%sround %d: %.0fs, %zu worker(s), %s execs (%s/s), cov %llu ft %llu, corpus %zu -> %zu",
+            CTC_TAG, r.index, r.wall_s, r.workers.size(), human_count((double)execs).c_str(),
+            human_count(r.wall_s > 0 ? (double)execs / r.wall_s : 0).c_str(), (unsigned long long)cov,
+            (unsigned long long)ft, r.merge.before, r.merge.after);
+    if (r.merge.ok) fprintf(stderr, " (%llu edges)", (unsigned long long)r.merge.edges);
+    fprintf(stderr, ", %zu finding(s)\n%s  exec/s per worker:", found, CTC_TAG);
+    for (const auto& w : r.workers) fprintf(stderr, " %s", human_count(w.exec_per_s).c_str());
+    fprintf(stderr, "\n");
+    for (const auto& w : r.workers) {
+        for (const auto& f : w.findings) {
+            fprintf(stderr, "%s  %s (worker %zu): %s\n", CTC_TAG, f.kind.c_str(), f.worker, f.artifact.c_str());
+            if (!f.summary.empty()) fprintf(stderr, "%s    %s\n", CTC_TAG, f.summary.c_str());
+        }
+    }
+}
+
+static void print_json(const RunOptions& o, const std::vector<Round>& rounds, double wall_s, bool interrupted) {
+    printf("{\n  \"binary\": \"%s\",\n  \"corpus\": \"%s\",\n  \"workers\": %u,\n  \"rss_limit_mb\": %llu,\n"
+           "  \"wall_s\": %.1f,\n  \"interrupted\": %s,\n  \"rounds\": [",
+           json_escape(o.binary).c_str(), json_escape(o.corpus).c_str(), o.workers,
+           (unsigned long long)o.rss_limit_mb, wall_s, interrupted ? "true" : "false");
+    std::vector<const Finding*> findings;
+    for (size_t i = 0; i < rounds.size(); i++) {
+        const Round& r = rounds[i];
+        printf("%s\n    {\"round\": %d, \"wall_s\": %.2f, \"corpus_before\": %zu, \"corpus_after\": %zu, "
+               "\"merge_ok\": %s, \"features\": %llu, \"edges\": %llu, \"workers\": [",
+               i ? "," : "", r.index, r.wall_s, r.merge.before, r.merge.after, r.merge.ok ? "true" : "false",
+               (unsigned long long)r.merge.features, (unsigned long long)r.merge.edges);
+        for (size_t k = 0; k < r.workers.size(); k++) {
+            const WorkerStats& w = r.workers[k];
+            printf("%s\n      {\"execs\": %llu, \"exec_per_s\": %.0f, \"cov\": %llu, \"ft\": %llu, "
+                   "\"peak_rss_mb\": %llu, \"exit\": %d}",
+                   k ? "," : "", (unsigned long long)w.execs, w.exec_per_s, (unsigned long long)w.cov,
+                   (unsigned long long)w.ft, (unsigned long long)w.peak_rss_mb, w.rc);
+            for (const auto& f : w.findings) findings.push_back(&f);
+        }
+        printf("\n    ]}");
+    }
+    printf("\n  ],\n  \"findings\": [");
+    for (size_t i = 0; i < findings.size(); i++) {
+        const Finding& f = *findings[i];
+        printf("%s\n    {\"kind\": \"%s\", \"round\": %d, \"worker\": %zu, \"artifact\": \"%s\", \"summary\": \"%s\"}",
+               i ? "," : "", f.kind.c_str(), f.round, f.worker, json_escape(f.artifact).c_str(),
+               json_escape(f.summary).c_str());
+    }
+    printf("%s]\n}\n", findings.empty() ? "" : "\n  ");
+}
+
+static int cmd_run(RunOptions& o) {
+    if (access(o.binary.c_str(), X_OK) != 0) {
+        fprintf(stderr, "%s%s is not an executable fuzz target\n", CTC_TAG, o.binary.c_str());
+        return 2;
+    }
+    make_directory(o.corpus);
+    if (o.artifacts.empty()) o.artifacts = o.corpus + "-artifacts";
+    make_directory(o.artifacts);
+    std::string logs = path_join(o.artifacts, "logs");
+    make_directory(logs);
+    if (!is_directory(o.corpus) || !is_directory(logs)) {
+        fprintf(stderr, "%scannot create %s / %s\n", CTC_TAG, o.corpus.c_str(), logs.c_str());
+        return 1;
+    }
+
+    // Workers: one per core unless -w says otherwise, bounded by memory at
+    // the RSS limit each
+    unsigned cores = default_parallelism();
+    unsigned want = o.workers ? o.workers : cores;
+    uint64_t mem_mb = available_memory_mb();
+    unsigned by_memory = mem_mb && o.rss_limit_mb ? (unsigned)std::max<uint64_t>(1, mem_mb / o.rss_limit_mb) : want;
+    o.workers = std::max(1u, std::min(want, by_memory));
+    if (o.workers < want) {
+        fprintf(stderr, "%susing %u worker(s): %u core(s), %llu MB available at -rss_limit_mb=%llu\n", CTC_TAG,
+                o.workers, cores, (unsigned long long)mem_mb, (unsigned long long)o.rss_limit_mb);
+    }
+
+    std::vector<std::string> common = {"-rss_limit_mb=" + std::to_string(o.rss_limit_mb),
+                                       "-artifact_prefix=" + o.artifacts + "/"};
+    if (!o.dict.empty()) common.push_back("-dict=" + o.dict);
+    if (o.max_len > 0) common.push_back("-max_len=" + std::to_string(o.max_len));
+    if (o.unit_timeout_s > 0) common.push_back("-timeout=" + std::to_string(o.unit_timeout_s));
+    if (o.keep_going) {
+        common.insert(common.end(), {"-fork=1", "-ignore_crashes=1", "-ignore_timeouts=1", "-ignore_ooms=1"});
+    }
+    common.insert(common.end(), o.fuzzer_flags.begin(), o.fuzzer_flags.end());
+    std::vector<std::string> merge_flags;
+    for (const auto& flag : common) {
+        if (is_merge_flag(flag)) merge_flags.push_back(flag);
+    }
+
+    struct sigaction sa = {};
+    sa.sa_handler = on_sigint;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, nullptr);
+
+    std::vector<Round> rounds;
+    uint64_t start = now_us();
+    size_t total_findings = 0;
+    uint32_t seed_base = (uint32_t)(now_us() & 0x7fffffff);
+    for (int index = 1; !g_interrupted; index++) {
+        double elapsed = (double)(now_us() - start) / 1e6;
+        int round_s = std::min(o.merge_every_s, o.total_s - (int)elapsed);
+        if (round_s <= 0) break;
+
+        Round r;
+        r.index = index;
+        std::vector<pid_t> pids;
+        std::vector<std::string> worker_logs;
+        uint64_t t0 = now_us();
+        for (unsigned k = 0; k < o.workers; k++) {
+            std::vector<std::string> cmd = {o.binary, "-max_total_time=" + std::to_string(round_s),
+                                            "-print_final_stats=1",
+                                            "-seed=" + std::to_string(seed_base + (uint32_t)(index * 1000 + k))};
+            cmd.insert(cmd.end(), common.begin(), common.end());
+            cmd.push_back(o.corpus);  // new units land in the first corpus dir
+            if (index == 1) cmd.insert(cmd.end(), o.seeds.begin(), o.seeds.end());
+            worker_logs.push_back(path_join(logs, "round" + std::to_string(index) + "-worker" + std::to_string(k) +
+                                                      ".log"));
+            pids.push_back(spawn_logged(cmd, worker_logs.back()));
+        }
+        std::vector<int> rcs = wait_all(pids, round_s + WORKER_GRACE_S);
+        r.wall_s = (double)(now_us() - t0) / 1e6;
+        size_t round_findings = 0, failed = 0;
+        for (unsigned k = 0; k < o.workers; k++) {
+            WorkerStats w = parse_worker_log(worker_logs[k]);
+            w.rc = rcs[k];
+            for (auto& f : w.findings) {
+                f.worker = k;
+                f.round = index;
+            }
+            round_findings += w.findings.size();
+            failed += w.rc != 0 && w.findings.empty();
+            r.workers.push_back(std::move(w));
+        }
+        if (failed == o.workers && !g_interrupted) {
+            fprintf(stderr, "%severy worker failed without a finding (exit %d); see %s\n", CTC_TAG, rcs[0],
+                    worker_logs[0].c_str());
+            return 1;
+        }
+
+        // Seed dirs are folded in on the first merge; later rounds only need the corpus
+        std::vector<std::string> extra = index == 1 ? o.seeds : std::vector<std::string>{};
+        r.merge = merge_corpus(o.binary, o.corpus, extra, merge_flags,
+                               path_join(logs, "round" + std::to_string(index) + "-merge.log"));
+        if (!o.json) print_round(r);
+        rounds.push_back(std::move(r));
+        total_findings += round_findings;
+        if (round_findings > 0 && !o.keep_going) break;
+    }
+
+    double wall_s = (double)(now_us() - start) / 1e6;
+    if (o.json) {
+        print_json(o, rounds, wall_s, g_interrupted != 0);
+    } else {
+        uint64_t first = rounds.empty() ? 0 : rounds.front().merge.edges;
+        uint64_t last = rounds.empty() ? 0 : rounds.back().merge.edges;
+        fprintf(stderr, "%s%zu round(s) in %.0fs, coverage %llu -> %llu edges, corpus %zu file(s), %zu finding(s)%s\n",
+                CTC_TAG, rounds.size(), wall_s, (unsigned long long)first, (unsigned long long)last,
+                count_files(o.corpus), total_findings, g_interrupted ? " (interrupted)" : "");
+    }
+    return total_findings > 0 ? 1 : 0;
+}
+
+// ============================================================================
+// Section 6: main()
+// ============================================================================
+
+static void print_usage() {
+    printf("Usage: ctc-fuzz build [-o OUT] [--sanitize LIST] [--no-deploy] SOURCES... [-- FLAGS...]\n");
+    printf("       ctc-fuzz run BINARY CORPUS [SEED_DIRS...] [options] [-- LIBFUZZER_FLAGS...]\n");
+    printf("       ctc-fuzz merge BINARY CORPUS [DIRS...] [-- LIBFUZZER_FLAGS...]\n\n");
+    printf("Builds libFuzzer targets through ctc-clang++ and runs parallel campaigns with\n");
+    printf("periodic corpus merge/minimization, per-worker exec/s, coverage and crashes.\n\n");
+    printf("build:\n");
+    printf("  -o OUT              Output binary (default: first source's stem)\n");
+    printf("  --sanitize LIST     Sanitizers besides fuzzer (default: %s; none)\n", DEFAULT_SANITIZERS);
+    printf("  --no-deploy         Don't pass --deploy-dependencies\n");
+    printf("  --clang PATH        Compiler (default: ctc-clang++ next to ctc-fuzz)\n");
+    printf("  --dry-run           Print the compile command\n\n");
+    printf("run:\n");
+    printf("  -w, --workers N     Parallel workers (default: cores, capped by memory)\n");
+    printf("  --rss-limit-mb N    Per-worker RSS limit (default: 2048)\n");
+    printf("  --time S            Campaign length in seconds (default: 600)\n");
+    printf("  --merge-every S     Round length between merges (default: 300)\n");
+    printf("  --artifacts DIR     Crash artifacts and logs (default: CORPUS-artifacts)\n");
+    printf("  --dict FILE         libFuzzer dictionary\n");
+    printf("  --max-len N         Maximum input length\n");
+    printf("  --timeout S         Per-input timeout\n");
+    printf("  --keep-going        Keep fuzzing after crashes (-fork=1 -ignore_crashes=1)\n");
+    printf("  --json              JSON summary on stdout\n\n");
+    printf("merge: minimizes CORPUS in place, folding in DIRS.\n");
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        print_usage();
+        return 2;
+    }
+    std::string sub = argv[1];
+    if (sub == "--help" || sub == "-h" || sub == "--ctc-help") {
+        print_usage();
+        return 0;
+    }
+    std::vector<std::string> args(argv + 2, argv + argc);
+    if (sub == "build") return cmd_build(args);
+    if (sub != "run" && sub != "merge") {
+        fprintf(stderr, "%sUnknown command: %s (build, run, merge)\n", CTC_TAG, sub.c_str());
+        return 2;
+    }
+
+    RunOptions o;
+    std::vector<std::string> positional;
+    for (size_t i = 0; i < args.size(); i++) {
+        const std::string& a = args[i];
+        auto next = [&]() { return i + 1 < args.size() ? args[++i] : std::string(); };
+        if (a == "--") {
+            o.fuzzer_flags.assign(args.begin() + (long)i + 1, args.end());
+            break;
+        }
+        if (a == "--help" || a == "-h") { print_usage(); return 0; }
+        if (a == "--keep-going") { o.keep_going = true; continue; }
+        if (a == "--json") { o.json = true; continue; }
+        if (i + 1 < args.size()) {
+            if (a == "-w" || a == "--workers") { o.workers = (unsigned)std::max(1, atoi(next().c_str())); continue; }
+            if (a == "--rss-limit-mb") { o.rss_limit_mb = strtoull(next().c_str(), nullptr, 10); continue; }
+            if (a == "--time") { o.total_s = std::max(1, atoi(next().c_str())); continue; }
+            if (a == "--merge-every") { o.merge_every_s = std::max(1, atoi(next().c_str())); continue; }
+            if (a == "--artifacts") { o.artifacts = next(); continue; }
+            if (a == "--dict") { o.dict = next(); continue; }
+            if (a == "--max-len") { o.max_len = atoi(next().c_str()); continue; }
+            if (a == "--timeout") { o.unit_timeout_s = atoi(next().c_str()); continue; }
+        }
+        if (!a.empty() && a[0] == '-') {
+            fprintf(stderr, "%sUnknown option: %s (libFuzzer flags go after --)\n", CTC_TAG, a.c_str());
+            return 2;
+        }
+        positional.push_back(a);
+    }
+    if (positional.size() < 2) {
+        fprintf(stderr, "%s%s needs BINARY and CORPUS\n", CTC_TAG, sub.c_str());
+        return 2;
+    }
+    o.binary = positional[0];
+    if (o.binary.find('/') == std::string::npos) o.binary = "./" + o.binary;
+    o.corpus = positional[1];
+    while (o.corpus.size() > 1 && o.corpus.back() == '/') o.corpus.pop_back();
+    o.seeds.assign(positional.begin() + 2, positional.end());
+
+    if (sub == "run") return cmd_run(o);
+
+    // merge
+    make_directory(o.corpus);
+    std::string log = o.corpus + ".merge.log";
+    std::vector<std::string> flags = {"-rss_limit_mb=" + std::to_string(o.rss_limit_mb)};
+    flags.insert(flags.end(), o.fuzzer_flags.begin(), o.fuzzer_flags.end());
+    MergeResult m = merge_corpus(o.binary, o.corpus, o.seeds, flags, log);
+    if (!m.ok) return 1;
+    std::remove(log.c_str());
+    size_t inputs = m.before;
+    for (const auto& d : o.seeds) inputs += count_files(d);
+    printf("%zu input(s) -> %zu file(s), %llu features, %llu edges\n", inputs, m.after,
+           (unsigned long long)m.features, (unsigned long long)m.edges);
+    return 0;
+}
@@ -0,0 +1,206 @@
+// clang-tool-chain content hasher and hash benchmark (ctc-hash)
+//
+// Front end for the 128-bit hash in Section 14 of ctc_common.h — the hash
+// every launcher cache key is built on:
+//
+//   ctc-hash FILE...          <32-hex digest>  FILE   (like sha256sum)
+//   ctc-hash -                digest of stdin, via the streaming API
+//   ctc-hash --string TEXT    digest of a literal string
+//   ctc-hash --bench          throughput in GB/s vs. the legacy FNV-1a loop
+//
+// File digests are mmap-based; files above 8 MiB are digested as parallel
+// chunks (see file_digest()), so a digest is only comparable with another
+// file digest, not with --string over the same bytes.
+//
+// Single-file C++17. Common utilities live in ctc_common.h.
+//
+// Build: clang++ -O3 -std=c++17 -o ctc-hash launcher_hash.cpp
+//   Linux:   add -static-libstdc++ -static-libgcc -lpthread
+//   Windows: add -static-libstdc++ -static-libgcc
+
+#include "ctc_common.h"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#endif
+
+using namespace ctc;
+
+// ============================================================================
+// Section 0: Tool-specific constants
+// ============================================================================
+
+static constexpr const char* CTC_TAG = "[ctc-hash] ";
+
+// ============================================================================
+// Section 1: Benchmark
+// ============================================================================
+
+// The byte-at-a-time 64-bit FNV-1a loop launcher_emcc.cpp used for cache keys
+// before the 128-bit hash; kept here only as the benchmark baseline.
+static uint64_t fnv1a64(const unsigned char* p, size_t n) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < n; i++) {
+        h ^= (uint64_t)p[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+struct BenchResult {
+    std::string name;
+    double gbps = 0.0;
+};
+
+// Best of `reps` runs, in GB/s (10^9 bytes per second).
+template <typename Fn>
+static double measure(size_t bytes, int reps, Fn&& fn) {
+    double best = 0.0;
+    for (int r = 0; r < reps; r++) {
+        auto t0 = std::chrono::steady_clock::now();
+        fn();
+        double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        if (s > 0) best = std::max(best, (double)bytes / s / 1e9);
+    }
+    return best;
+}
+
+static std::string temp_dir() {
+    for (const char* k : {"TMPDIR", "TEMP", "TMP"}) {
+        std::string v = get_env(k);
+        if (!v.empty()) return v;
+    }
+    return "/tmp";
+}
+
+static int run_bench(size_t mib, int reps, unsigned threads, bool json) {
+    size_t size = mib << 20;
+    std::vector<unsigned char> buf(size);
+    uint64_t x = 0x1234567887654321ULL;
+    for (size_t i = 0; i + 8 <= size; i += 8) {
+        x += 0x9E3779B97F4A7C15ULL;
+        uint64_t z = (x ^ (x >> 31)) * 0xBF58476D1CE4E5B9ULL;
+        memcpy(&buf[i], &z, 8);
+    }
+
+    volatile uint64_t sink = 0;  // keeps the hash calls from being optimized out
+    std::vector<BenchResult> results;
+    results.push_back({"fnv1a-64 (legacy)", measure(size, reps, [&] { sink = sink + fnv1a64(buf.data(), size); })});
+    results.push_back({"hash128", measure(size, reps, [&] { sink = sink + hash128(buf.data(), size).lo; })});
+    results.push_back({"hash128 streaming (4093 B updates)", measure(size, reps, [&] {
+        Hasher128 h;
+        for (size_t off = 0; off < size; off += 4093) h.update(buf.data() + off, std::min<size_t>(4093, size - off));
+        sink = sink + h.digest().lo;
+    })});
+
+    std::string path = path_join(temp_dir(), "ctc-hash-bench." + std::to_string(current_pid()));
+    if (write_file_atomic(path, std::string(reinterpret_cast<const char*>(buf.data()), size))) {
+        Hash128 d;
+        results.push_back({"file_digest (1 thread)", measure(size, reps, [&] { file_digest(path, d, 1); })});
+        unsigned n = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+        if (n > 1) {
+            results.push_back({"file_digest (" + std::to_string(n) + " threads)",
+                               measure(size, reps, [&] { file_digest(path, d, n); })});
+        }
+        remove(path.c_str());
+    } else {
+        fprintf(stderr, "%scannot write %s, skipping file_digest\n", CTC_TAG, path.c_str());
+    }
+
+    double base = results[0].gbps;
+    if (json) {
+        printf("{\n  \"kernel\": \"%s\",\n  \"bytes\": %zu,\n  \"results\": [", hash_detail::HASH_KERNEL, size);
+        for (size_t i = 0; i < results.size(); i++) {
+            printf("%s\n    {\"name\": \"%s\", \"gb_per_s\": %.3f, \"speedup\": %.2f}", i ? "," : "",
+                   json_escape(results[i].name).c_str(), results[i].gbps,
+                   base > 0 ? results[i].gbps / base : 0.0);
+        }
+        printf("\n  ]\n}\n");
+    } else {
+        printf("ctc-hash bench: %zu MiB, best of %d, kernel=%s\n", mib, reps, hash_detail::HASH_KERNEL);
+        for (const auto& r : results) {
+            printf("  %-38s %8.2f GB/s  %6.1fx\n", r.name.c_str(), r.gbps, base > 0 ? r.gbps / base : 0.0);
+        }
+    }
+    return 0;
+}
+
+// ============================================================================
+// Section 2: main()
+// ============================================================================
+
+static void print_usage() {
+    printf("Usage: ctc-hash [options] FILE...\n\n");
+    printf("128-bit content digests (the hash behind the launcher caches).\n\n");
+    printf("Options:\n");
+    printf("  -                Hash stdin\n");
+    printf("  --string TEXT    Hash a literal string\n");
+    printf("  --threads N      Threads for chunked digests of large files (default: all cores)\n");
+    printf("  --json           JSON output\n");
+    printf("  --bench          Measure throughput against the legacy FNV-1a loop\n");
+    printf("  --size MIB       Benchmark buffer size (default: 256)\n");
+    printf("  --reps N         Benchmark repetitions, best is reported (default: 3)\n");
+    printf("  --help, -h       Show this help\n");
+}
+
+int main(int argc, char* argv[]) {
+    bool json = false, bench = false;
+    unsigned threads = 0;
+    size_t bench_mib = 256;
+    int reps = 3;
+    std::vector<std::pair<std::string, bool>> inputs;  // (value, is_string)
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h" || arg == "--ctc-help") { print_usage(); return 0; }
+        if (arg == "--json") { json = true; continue; }
+        if (arg == "--bench") { bench = true; continue; }
+        if (arg == "--string" && i + 1 < argc) { inputs.emplace_back(argv[++i], true); continue; }
+        if (arg == "--threads" && i + 1 < argc) { threads = (unsigned)atoi(argv[++i]); continue; }
+        if (arg == "--size" && i + 1 < argc) { bench_mib = std::max(1L, atol(argv[++i])); continue; }
+        if (arg == "--reps" && i + 1 < argc) { reps = std::max(1, atoi(argv[++i])); continue; }
+        if (arg.size() > 1 && arg[0] == '-') {
+            fprintf(stderr, "%sUnknown option: %s\n", CTC_TAG, arg.c_str());
+            return 2;
+        }
+        inputs.emplace_back(arg, false);
+    }
+
+    if (bench) return run_bench(bench_mib, reps, threads, json);
+    if (inputs.empty()) {
+        print_usage();
+        return 2;
+    }
+
+    int rc = 0;
+    bool first = true;
+    if (json) printf("[");
+    for (const auto& in : inputs) {
+        Hash128 h;
+        if (in.second) {
+            h = hash128(in.first);
+        } else if (in.first == "-") {
+#ifdef _WIN32
+            _setmode(_fileno(stdin), _O_BINARY);
+#endif
+            Hasher128 s;
+            char chunk[1 << 16];
+            size_t n;
+            while ((n = fread(chunk, 1, sizeof(chunk), stdin)) > 0) s.update(chunk, n);
+            h = s.digest();
+        } else if (!file_digest(in.first, h, threads)) {
+            fprintf(stderr, "%s%s: cannot read\n", CTC_TAG, in.first.c_str());
+            rc = 1;
+            continue;
+        }
+        if (json) {
+            printf("%s\n  {\"%s\": \"%s\", \"digest\": \"%s\"}", first ? "" : ",", in.second ? "string" : "path",
+                   json_escape(in.first).c_str(), h.hex().c_str());
+        } else {
+            printf("%s  %s\n", h.hex().c_str(), in.first.c_str());
+        }
+        first = false;
+    }
+    if (json) printf("%s]\n", first ? "" : "\n");
+    return rc;
+}
@@ -0,0 +1,488 @@
+// clang-tool-chain header impact analyzer (ctc-include-impact)
+//
+// Answers "which headers make incremental builds expensive?" by ingesting
+// every Make-style dependency file (.d, as written by -MD / -MMD) under a
+// build directory and building the header -> translation-unit graph.
+//
+// Each header is ranked by its REBUILD COST: the summed compile time of every
+// TU that depends on it, i.e. what touching that header costs the next
+// incremental build. Compile times come from the build dir's .ninja_log
+// (end - start of each object's edge). TUs without a recorded time weigh the
+// mean of the recorded ones; with no .ninja_log at all every TU weighs 1 and
+// the cost degenerates to a plain fan-out count.
+//
+// Include traces — clang -H output saved next to the object as
+// <object>.includes, one ". path" line per entered header with one dot per
+// nesting level — are ingested alongside .d files. They contribute the mean
+// inclusion DEPTH per header: a high-cost header that is only ever reached
+// through deep transitive chains is a candidate for pruning from the
+// intermediate headers that drag it in.
+//
+// Performance: dependency files are split across worker threads. Each worker
+// tokenises its files with a reusable read buffer and interns paths into a
+// thread-local table, so the hot loop never takes a lock. The per-worker
+// tables are merged into one global path table at the end — unique headers
+// are orders of magnitude fewer than edges, so the merge is cheap.
+//
+// Single-file C++17. Common utilities live in ctc_common.h.
+//
+// Build: clang++ -O3 -std=c++17 -o ctc-include-impact launcher_include_impact.cpp
+//   Linux:   add -static-libstdc++ -static-libgcc -lpthread
+//   Windows: add -static-libstdc++ -static-libgcc
+
+#include "ctc_common.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+using namespace ctc;
+
+// ============================================================================
+// Section 0: Tool-specific constants
+// ============================================================================
+
+static constexpr const char* CTC_TAG = "[ctc-include-impact] ";
+static constexpr const char* TRACE_SUFFIX = ".includes";
+
+enum class SortKey { Cost, Tus, Depth };
+
+// ============================================================================
+// Section 1: Interned path table
+// ============================================================================
+
+// Maps a path string to a dense uint32_t id. unordered_map nodes are stable,
+// so names[] can point straight at the keys without a second copy.
+struct PathTable {
+    std::unordered_map<std::string, uint32_t> ids;
+    std::vector<const std::string*> names;
+
+    uint32_t intern(const std::string& s) {
+        auto it = ids.find(s);
+        if (it != ids.end()) return it->second;
+        uint32_t id = (uint32_t)names.size();
+        auto ins = ids.emplace(s, id);
+        names.push_back(&ins.first->first);
+        return id;
+    }
+};
+
+static bool is_source_path(const std::string& p) {
+    std::string ext = get_extension(p);
+    return ext == ".c" || ext == ".cpp" || ext == ".cc" || ext == ".cxx" ||
+           ext == ".c++" || ext == ".m" || ext == ".mm";
+}
+
+// ============================================================================
+// Section 2: Per-worker parsing
+// ============================================================================
+
+// One TU's worth of headers, in worker-local ids. depth[] is parallel to
+// headers[] for include traces and empty for .d files.
+struct TuRecord {
+    uint32_t tu;
+    bool from_trace;
+    std::vector<uint32_t> headers;
+    std::vector<uint16_t> depth;
+};
+
+struct WorkerResult {
+    PathTable table;
+    std::vector<TuRecord> records;
+};
+
+static bool read_into(const std::string& path, std::string& buf) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+    buf.clear();
+    char chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) buf.append(chunk, n);
+    fclose(f);
+    return true;
+}
+
+// Parse the first rule of a Make-style dependency file:
+//   obj/foo.o: ../src/foo.cpp ../include/a.h \   (line continuation)
+//     ../include\ with\ space/b.h
+//   ../include/a.h:
+// The first target names the TU; the trailing phony rules emitted by -MP are
+// ignored. A ':' only separates targets when followed by whitespace or end of
+// line, so Windows drive letters (C:\...) survive.
+static void parse_dep_file(const std::string& buf, WorkerResult& out,
+                           const std::vector<std::string>& excludes) {
+    TuRecord rec{0, false, {}, {}};
+    bool have_tu = false, in_deps = false;
+    std::string tok;
+    size_t i = 0, n = buf.size();
+
+    auto flush = [&]() {
+        if (tok.empty()) return;
+        if (!in_deps) {
+            bool sep = tok.back() == ':';
+            if (sep) tok.pop_back();
+            if (!tok.empty() && !have_tu) {
+                tok = normalize_path(tok);
+                rec.tu = out.table.intern(tok);
+                have_tu = true;
+            }
+            if (sep) in_deps = true;
+        } else {
+            tok = normalize_path(tok);
+            bool skip = is_source_path(tok);
+            for (const auto& ex : excludes) {
+                if (!skip && starts_with(tok, ex.c_str())) skip = true;
+            }
+            if (!skip) rec.headers.push_back(out.table.intern(tok));
+        }
+        tok.clear();
+    };
+
+    for (; i < n; i++) {
+        char c = buf[i];
+        if (c == '\\' && i + 1 < n) {
+            char next = buf[i + 1];
+            if (next == '\n' || next == '\r') {  // line continuation
+                flush();
+                i++;
+                if (next == '\r' && i + 1 < n && buf[i + 1] == '\n') i++;
+                continue;
+            }
+            if (next == ' ' || next == '#') { tok += next; i++; continue; }
+            tok += c;
+            continue;
+        }
+        if (c == '$' && i + 1 < n && buf[i + 1] == '$') { tok += '$'; i++; continue; }
+        if (c == ' ' || c == '\t') { flush(); continue; }
+        if (c == '\n' || c == '\r') {
+            flush();
+            if (in_deps) break;  // end of first rule
+            continue;
+        }
+        if (c == ':' && !in_deps && (i + 1 >= n || buf[i + 1] == ' ' || buf[i + 1] == '\t' ||
+                                      buf[i + 1] == '\n' || buf[i + 1] == '\r')) {
+            tok += ':';
+            flush();
+            continue;
+        }
+        tok += c;
+    }
+    flush();
+    if (!have_tu || rec.headers.empty()) return;
+    std::sort(rec.headers.begin(), rec.headers.end());
+    rec.headers.erase(std::unique(rec.headers.begin(), rec.headers.end()), rec.headers.end());
+    out.records.push_back(std::move(rec));
+}
+
+// Parse clang -H output: ". a.h", ".. b.h", ... Stops at the "Multiple include
+// guards may be useful for:" trailer. Keeps each header's shallowest depth.
+static void parse_trace_file(const std::string& trace_path, const std::string& buf,
+                             WorkerResult& out, const std::vector<std::string>& excludes) {
+    std::string tu = trace_path.substr(0, trace_path.size() - strlen(TRACE_SUFFIX));
+    tu = normalize_path(tu);
+    TuRecord rec{out.table.intern(tu), true, {}, {}};
+    std::unordered_map<uint32_t, size_t> seen;
+    std::string path;
+
+    size_t pos = 0, n = buf.size();
+    while (pos < n) {
+        size_t eol = buf.find('\n', pos);
+        if (eol == std::string::npos) eol = n;
+        size_t dots = 0;
+        while (pos + dots < eol && buf[pos + dots] == '.') dots++;
+        if (dots == 0) {
+            if (buf.compare(pos, 8, "Multiple") == 0) break;
+            pos = eol + 1;
+            continue;
+        }
+        size_t start = pos + dots;
+        while (start < eol && buf[start] == ' ') start++;
+        size_t end = eol;
+        while (end > start && (buf[end - 1] == '\r' || buf[end - 1] == ' ')) end--;
+        pos = eol + 1;
+        if (end <= start) continue;
+        path.assign(buf, start, end - start);
+        path = normalize_path(path);
+        bool skip = false;
+        for (const auto& ex : excludes) {
+            if (starts_with(path, ex.c_str())) { skip = true; break; }
+        }
+        if (skip) continue;
+        uint32_t id = out.table.intern(path);
+        uint16_t depth = (uint16_t)std::min<size_t>(dots, 0xffff);
+        auto it = seen.find(id);
+        if (it == seen.end()) {
+            seen.emplace(id, rec.headers.size());
+            rec.headers.push_back(id);
+            rec.depth.push_back(depth);
+        } else if (depth < rec.depth[it->second]) {
+            rec.depth[it->second] = depth;
+        }
+    }
+    if (!rec.headers.empty()) out.records.push_back(std::move(rec));
+}
+
+// Traces name their TU by path, so strip the build-dir prefix to line them up
+// with .d targets and .ninja_log outputs (both relative to the build dir).
+static void run_worker(const std::vector<std::string>& files, size_t begin, size_t end,
+                       const std::string& root, const std::vector<std::string>& excludes,
+                       WorkerResult& out) {
+    std::string buf;
+    for (size_t i = begin; i < end; i++) {
+        const std::string& f = files[i];
+        if (!read_into(f, buf)) continue;
+        if (ends_with(f, TRACE_SUFFIX)) {
+            size_t skip = (f.size() > root.size() && f.compare(0, root.size(), root) == 0 &&
+                           (f[root.size()] == '/' || f[root.size()] == '\\'))
+                              ? root.size() + 1 : 0;
+            parse_trace_file(f.substr(skip), buf, out, excludes);
+        } else {
+            parse_dep_file(buf, out, excludes);
+        }
+    }
+}
+
+// ============================================================================
+// Section 3: .ninja_log compile times
+// ============================================================================
+
+// .ninja_log v5: "start\tend\tmtime\toutput\thash" in ms. Later lines for the
+// same output supersede earlier ones (ninja appends on every rebuild).
+static std::unordered_map<std::string, double> read_ninja_log(const std::string& path) {
+    std::unordered_map<std::string, double> times;
+    std::string content = read_file(path);
+    std::istringstream ss(content);
+    std::string line;
+    while (std::getline(ss, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        if (line.back() == '\r') line.pop_back();
+        size_t t1 = line.find('\t');
+        size_t t2 = t1 == std::string::npos ? t1 : line.find('\t', t1 + 1);
+        size_t t3 = t2 == std::string::npos ? t2 : line.find('\t', t2 + 1);
+        size_t t4 = t3 == std::string::npos ? t3 : line.find('\t', t3 + 1);
+        if (t3 == std::string::npos) continue;
+        double start = atof(line.c_str());
+        double end = atof(line.c_str() + t1 + 1);
+        std::string output = line.substr(t3 + 1, t4 == std::string::npos ? std::string::npos : t4 - t3 - 1);
+        output = normalize_path(output);
+        times[output] = (end - start) / 1000.0;
+    }
+    return times;
+}
+
+// ============================================================================
+// Section 4: Aggregation + report
+// ============================================================================
+
+struct HeaderStat {
+    uint32_t tus = 0;
+    double cost = 0.0;
+    uint64_t depth_sum = 0;
+    uint32_t depth_n = 0;
+};
+
+static void print_usage() {
+    printf("Usage: ctc-include-impact [options] <build-dir>\n\n");
+    printf("Rank headers by the incremental rebuild cost of touching them.\n\n");
+    printf("Inputs (found recursively under <build-dir>):\n");
+    printf("  *.d            Make-style dependency files (-MD / -MMD)\n");
+    printf("  *%s     clang -H include traces (adds inclusion depth)\n", TRACE_SUFFIX);
+    printf("  .ninja_log     Per-TU compile times (weights the cost)\n\n");
+    printf("Options:\n");
+    printf("  --top N              Rows to print (default 30, 0 = all)\n");
+    printf("  --sort cost|tus|depth  Ranking key (default cost)\n");
+    printf("  --exclude PREFIX     Drop headers under PREFIX (repeatable)\n");
+    printf("  --ninja-log PATH     Compile times from PATH instead of <build-dir>/.ninja_log\n");
+    printf("  -j N                 Worker threads (default: all cores)\n");
+    printf("  --json               Machine-readable output\n");
+    printf("  --help, -h           Show this help\n");
+}
+
+int main(int argc, char* argv[]) {
+    using Clock = std::chrono::steady_clock;
+    auto t0 = Clock::now();
+
+    std::string build_dir, ninja_log;
+    std::vector<std::string> excludes;
+    size_t top = 30;
+    unsigned jobs = 0;
+    bool json = false;
+    SortKey sort_key = SortKey::Cost;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h" || arg == "--ctc-help") { print_usage(); return 0; }
+        if (arg == "--json") { json = true; continue; }
+        if (arg == "--top" && i + 1 < argc) { top = (size_t)atol(argv[++i]); continue; }
+        if (arg == "-j" && i + 1 < argc) { jobs = (unsigned)atoi(argv[++i]); continue; }
+        if (arg == "--exclude" && i + 1 < argc) {
+            // Same spelling as the interned paths; a trailing separator still
+            // limits the prefix to whole directories.
+            std::string ex = argv[++i];
+            bool dir = !ex.empty() && (ex.back() == '/' || ex.back() == '\\');
+            ex = normalize_path(ex);
+            if (dir && !ends_with(ex, "/")) ex += '/';
+            excludes.push_back(ex);
+            continue;
+        }
+        if (arg == "--ninja-log" && i + 1 < argc) { ninja_log = argv[++i]; continue; }
+        if (arg == "--sort" && i + 1 < argc) {
+            std::string k = argv[++i];
+            if (k == "cost") sort_key = SortKey::Cost;
+            else if (k == "tus") sort_key = SortKey::Tus;
+            else if (k == "depth") sort_key = SortKey::Depth;
+            else { fprintf(stderr, "%sUnknown --sort key: %s\n", CTC_TAG, k.c_str()); return 2; }
+            continue;
+        }
+        if (!arg.empty() && arg[0] == '-') {
+            fprintf(stderr, "%sUnknown option: %s\n", CTC_TAG, arg.c_str());
+            return 2;
+        }
+        build_dir = arg;
+    }
+    if (build_dir.empty()) { print_usage(); return 2; }
+    if (!is_directory(build_dir)) {
+        fprintf(stderr, "%sNot a directory: %s\n", CTC_TAG, build_dir.c_str());
+        return 1;
+    }
+
+    // 1. Collect inputs
+    std::vector<std::string> files;
+    walk_files(build_dir, {".d", TRACE_SUFFIX}, files);
+    if (files.empty()) {
+        fprintf(stderr, "%sNo .d or %s files under %s (build with -MD?)\n",
+                CTC_TAG, TRACE_SUFFIX, build_dir.c_str());
+        return 1;
+    }
+
+    // 2. Parse in parallel, one contiguous slice per worker
+    if (jobs == 0) jobs = default_parallelism();
+    jobs = (unsigned)std::min<size_t>(jobs, (files.size() + 63) / 64);
+    std::vector<WorkerResult> results(jobs);
+    size_t per = (files.size() + jobs - 1) / jobs;
+    parallel_for(jobs, [&](size_t w) {
+        size_t b = std::min(files.size(), w * per), e = std::min(files.size(), b + per);
+        run_worker(files, b, e, build_dir, excludes, results[w]);
+    }, jobs);
+    auto t_parse = Clock::now();
+
+    // 3. Merge worker tables into the global path table
+    PathTable global;
+    struct GlobalRecord { uint32_t tu; const TuRecord* rec; std::vector<uint32_t> remap_ids; };
+    std::vector<GlobalRecord> merged;
+    for (auto& r : results) {
+        std::vector<uint32_t> remap(r.table.names.size());
+        for (size_t i = 0; i < remap.size(); i++) remap[i] = global.intern(*r.table.names[i]);
+        for (const auto& rec : r.records) {
+            GlobalRecord g{remap[rec.tu], &rec, {}};
+            g.remap_ids.reserve(rec.headers.size());
+            for (uint32_t h : rec.headers) g.remap_ids.push_back(remap[h]);
+            merged.push_back(std::move(g));
+        }
+    }
+
+    // 4. TU weights from .ninja_log
+    if (ninja_log.empty()) ninja_log = path_join(build_dir, ".ninja_log");
+    auto times = path_exists(ninja_log) ? read_ninja_log(ninja_log)
+                                        : std::unordered_map<std::string, double>{};
+    std::vector<char> tu_has_dep(global.names.size(), 0);
+    std::vector<double> tu_weight(global.names.size(), -1.0);
+    size_t timed = 0, tu_count = 0;
+    double time_sum = 0.0;
+    for (const auto& g : merged) {
+        if (!g.rec->from_trace) tu_has_dep[g.tu] = 1;
+        if (tu_weight[g.tu] >= 0.0 || times.empty()) continue;
+        auto it = times.find(*global.names[g.tu]);
+        if (it != times.end()) {
+            tu_weight[g.tu] = it->second;
+            time_sum += it->second;
+            timed++;
+        }
+    }
+    double default_weight = timed ? time_sum / (double)timed : 1.0;
+
+    // 5. Accumulate per-header stats. .d records own TU counts and cost; a
+    //    trace only counts toward them when its TU has no .d file.
+    std::vector<HeaderStat> stats(global.names.size());
+    std::vector<char> tu_seen(global.names.size(), 0);
+    size_t edges = 0;
+    for (const auto& g : merged) {
+        bool counts = !g.rec->from_trace || !tu_has_dep[g.tu];
+        if (counts && !tu_seen[g.tu]) { tu_seen[g.tu] = 1; tu_count++; }
+        double w = tu_weight[g.tu] >= 0.0 ? tu_weight[g.tu] : default_weight;
+        for (size_t k = 0; k < g.remap_ids.size(); k++) {
+            HeaderStat& s = stats[g.remap_ids[k]];
+            if (counts) { s.tus++; s.cost += w; edges++; }
+            if (g.rec->from_trace) { s.depth_sum += g.rec->depth[k]; s.depth_n++; }
+        }
+    }
+
+    std::vector<uint32_t> order;
+    for (uint32_t id = 0; id < stats.size(); id++) {
+        if (stats[id].tus > 0 || stats[id].depth_n > 0) order.push_back(id);
+    }
+    auto mean_depth = [&](uint32_t id) {
+        return stats[id].depth_n ? (double)stats[id].depth_sum / stats[id].depth_n : 0.0;
+    };
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        switch (sort_key) {
+        case SortKey::Tus:
+            if (stats[a].tus != stats[b].tus) return stats[a].tus > stats[b].tus;
+            break;
+        case SortKey::Depth:
+            if (mean_depth(a) != mean_depth(b)) return mean_depth(a) > mean_depth(b);
+            break;
+        case SortKey::Cost:
+            break;
+        }
+        if (stats[a].cost != stats[b].cost) return stats[a].cost > stats[b].cost;
+        return *global.names[a] < *global.names[b];
+    });
+    size_t header_count = order.size();
+    if (top > 0 && order.size() > top) order.resize(top);
+
+    double total_cost = tu_count * default_weight;
+    if (timed) {
+        total_cost = 0.0;
+        for (size_t id = 0; id < tu_seen.size(); id++) {
+            if (tu_seen[id]) total_cost += tu_weight[id] >= 0.0 ? tu_weight[id] : default_weight;
+        }
+    }
+    double parse_s = std::chrono::duration<double>(t_parse - t0).count();
+    double total_s = std::chrono::duration<double>(Clock::now() - t0).count();
+
+    if (json) {
+        printf("{\n  \"files\": %zu,\n  \"tus\": %zu,\n  \"headers\": %zu,\n  \"edges\": %zu,\n",
+               files.size(), tu_count, header_count, edges);
+        printf("  \"timed_tus\": %zu,\n  \"total_cost\": %.3f,\n  \"cost_unit\": \"%s\",\n",
+               timed, total_cost, timed ? "seconds" : "tus");
+        printf("  \"ranking\": [\n");
+        for (size_t r = 0; r < order.size(); r++) {
+            uint32_t id = order[r];
+            printf("    {\"header\": \"%s\", \"tus\": %u, \"cost\": %.3f, \"mean_depth\": %.2f}%s\n",
+                   json_escape(*global.names[id]).c_str(), stats[id].tus, stats[id].cost,
+                   mean_depth(id), r + 1 < order.size() ? "," : "");
+        }
+        printf("  ]\n}\n");
+        return 0;
+    }
+
+    printf("%sscanned %zu files in %.2f s (%u threads), total %.2f s\n",
+           CTC_TAG, files.size(), parse_s, jobs, total_s);
+    printf("%s%zu TUs, %zu headers, %zu header->TU edges", CTC_TAG, tu_count,
+           header_count, edges);
+    if (timed) printf("; compile times for %zu TUs (%.1f s)", timed, time_sum);
+    printf("\n\n");
+    printf("%4s  %12s  %6s  %7s  %5s  %s\n", "rank", timed ? "cost (s)" : "cost (TUs)",
+           "share", "TUs", "depth", "header");
+    for (size_t r = 0; r < order.size(); r++) {
+        uint32_t id = order[r];
+        const HeaderStat& s = stats[id];
+        double share = total_cost > 0.0 ? s.cost / total_cost * 100.0 : 0.0;
+        char depth[16] = "-";
+        if (s.depth_n) snprintf(depth, sizeof(depth), "%.1f", mean_depth(id));
+        printf("%4zu  %12.2f  %5.1f%%  %7u  %5s  %s\n", r + 1, s.cost, share, s.tus, depth,
+               global.names[id]->c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,583 @@
+// clang-tool-chain parallel include-what-you-use driver (ctc-iwyu-tool)
+//
+// Native replacement for `clang-tool-chain-iwyu-tool` (upstream iwyu_tool.py)
+// on whole projects:
+//
+//   ctc-iwyu-tool -p build -j 16 --mapping qt5_11.imp > iwyu.out
+//   fix_includes.py < iwyu.out
+//
+// Every compilation-database entry becomes one task on the shared
+// work-stealing executor (ctc_common.h Section 13, GNU make jobserver aware).
+// A task runs include-what-you-use with the entry's own arguments in the
+// entry's directory and captures its output.
+//
+// Results are cached per TU. The key hashes the arguments, directory, extra
+// IWYU flags, the mapping files' contents and the IWYU binary's stamp. The
+// record keeps the TU's dependency closure — `<compiler> -M` over the same
+// command, run before IWYU on a miss — as (size, mtime, digest) per file. A
+// record is reused while every listed file still has the same stamp or, after
+// a touch, the same digest, so the key is in effect a hash of everything the
+// preprocessor reads.
+//
+// Outputs are merged into one report in IWYU's own format, which fix_includes.py
+// reads. A header analyzed by several TUs — its associated .cc files,
+// --check_also — yields the same block several times; the first block per
+// file is kept, and blocks that disagree with it are counted on stderr. TUs
+// whose run reports a compile error (or crashes) are listed on stderr, left out
+// of the cache and make the exit status 1.
+//
+// Single-file C++17. Common utilities live in ctc_common.h.
+//
+// Build: clang++ -O3 -std=c++17 -o ctc-iwyu-tool launcher_iwyu_tool.cpp
+//   Linux:   add -static-libstdc++ -static-libgcc -lpthread
+//   Windows: add -static-libstdc++ -static-libgcc
+
+#include "ctc_common.h"
+
+#include <chrono>
+#include <map>
+
+using namespace ctc;
+
+// ============================================================================
+// Section 0: Tool-specific constants
+// ============================================================================
+
+static constexpr const char* CTC_TAG = "[ctc-iwyu-tool] ";
+static constexpr const char* CACHE_VERSION = "ctc-iwyu/1";
+
+// ============================================================================
+// Section 1: Child processes with captured output
+// ============================================================================
+
+// Runs `cmd` in `cwd` with stdout and stderr captured together into `out`.
+// Returns the exit code (128+signal when killed, -1 when it could not start).
+static int run_captured(const std::vector<std::string>& cmd, const std::string& cwd, std::string& out) {
+#ifdef _WIN32
+    std::string cmdline;
+    for (size_t i = 0; i < cmd.size(); i++) {
+        if (i > 0) cmdline += ' ';
+        cmdline += win_quote_arg(cmd[i]);
+    }
+    HANDLE read_pipe = nullptr, write_pipe = nullptr;
+    SECURITY_ATTRIBUTES sa = {};
+    sa.nLength = sizeof(sa);
+    sa.bInheritHandle = TRUE;
+    if (!CreatePipe(&read_pipe, &write_pipe, &sa, 0)) return -1;
+    SetHandleInformation(read_pipe, HANDLE_FLAG_INHERIT, 0);
+    STARTUPINFOA si = {};
+    si.cb = sizeof(si);
+    si.hStdInput = GetStdHandle(STD_INPUT_HANDLE);
+    si.hStdOutput = write_pipe;
+    si.hStdError = write_pipe;
+    si.dwFlags = STARTF_USESTDHANDLES;
+    PROCESS_INFORMATION pi = {};
+    std::vector<char> buf(cmdline.begin(), cmdline.end());
+    buf.push_back('\0');
+    BOOL ok = CreateProcessA(nullptr, buf.data(), nullptr, nullptr, TRUE, 0, nullptr,
+                             cwd.empty() ? nullptr : cwd.c_str(), &si, &pi);
+    CloseHandle(write_pipe);
+    if (!ok) {
+        CloseHandle(read_pipe);
+        out = "cannot start " + cmd[0] + "\n";
+        return -1;
+    }
+    char chunk[65536];
+    DWORD n = 0;
+    while (ReadFile(read_pipe, chunk, sizeof(chunk), &n, nullptr) && n > 0) out.append(chunk, n);
+    CloseHandle(read_pipe);
+    WaitForSingleObject(pi.hProcess, INFINITE);
+    DWORD code = 1;
+    GetExitCodeProcess(pi.hProcess, &code);
+    CloseHandle(pi.hProcess);
+    CloseHandle(pi.hThread);
+    return (int)code;
+#else
+    std::vector<const char*> argv_ptrs;
+    for (const auto& s : cmd) argv_ptrs.push_back(s.c_str());
+    argv_ptrs.push_back(nullptr);
+    int fds[2];
+    if (pipe(fds) != 0) return -1;
+    pid_t pid = fork();
+    if (pid == 0) {
+        dup2(fds[1], 1);
+        dup2(fds[1], 2);
+        close(fds[0]);
+        close(fds[1]);
+        if (!cwd.empty() && chdir(cwd.c_str()) != 0) {
+            fprintf(stderr, "cannot enter %s\n", cwd.c_str());
+            _exit(127);
+        }
+        execv(cmd[0].c_str(), const_cast<char**>(argv_ptrs.data()));
+        fprintf(stderr, "cannot start %s\n", cmd[0].c_str());
+        _exit(127);
+    }
+    close(fds[1]);
+    if (pid < 0) {
+        close(fds[0]);
+        return -1;
+    }
+    char chunk[65536];
+    ssize_t n;
+    while ((n = read(fds[0], chunk, sizeof(chunk))) != 0) {
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        out.append(chunk, (size_t)n);
+    }
+    close(fds[0]);
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+#endif
+}
+
+// ============================================================================
+// Section 2: Per-TU commands
+// ============================================================================
+
+static std::string resolve_in(const std::string& dir, const std::string& p) {
+    return is_absolute_path(p) || dir.empty() ? p : path_join(dir, p);
+}
+
+// Compiler-cache wrappers in front of the real compiler are dropped.
+static size_t compiler_index(const std::vector<std::string>& args) {
+    if (args.size() > 1) {
+        std::string base = to_lower(get_exe_basename(args[0]));
+        if (base == "ccache" || base == "sccache" || base == "zccache") return 1;
+    }
+    return 0;
+}
+
+static bool is_cl_driver(const std::string& compiler) {
+    std::string base = to_lower(get_exe_basename(compiler));
+    return base == "cl" || base == "clang-cl" || ends_with(base, "-clang-cl");
+}
+
+// include-what-you-use <extra> <mapping flags> <compile args minus the compiler>
+static std::vector<std::string> iwyu_command(const CompileCommand& cc, const std::string& iwyu,
+                                             const std::vector<std::string>& extra) {
+    size_t ci = compiler_index(cc.arguments);
+    std::vector<std::string> cmd = {iwyu};
+    if (is_cl_driver(cc.arguments[ci])) cmd.push_back("--driver-mode=cl");
+    cmd.insert(cmd.end(), extra.begin(), extra.end());
+    cmd.insert(cmd.end(), cc.arguments.begin() + (long)ci + 1, cc.arguments.end());
+    return cmd;
+}
+
+// The entry's compiler with -M into `depfile` in place of its outputs.
+// Empty for cl-style drivers, which have no -M (those TUs run uncached).
+static std::vector<std::string> dep_scan_command(const CompileCommand& cc, const std::string& depfile) {
+    size_t ci = compiler_index(cc.arguments);
+    if (is_cl_driver(cc.arguments[ci])) return {};
+    std::vector<std::string> cmd = {cc.arguments[ci]};
+    for (size_t i = ci + 1; i < cc.arguments.size(); i++) {
+        const std::string& a = cc.arguments[i];
+        if (a == "-o" || a == "-MF" || a == "-MT" || a == "-MQ") { i++; continue; }
+        if (a == "-c" || a == "-MD" || a == "-MMD" || a == "-MP" || a == "-M" || a == "-MM") continue;
+        if ((starts_with(a, "-o") || starts_with(a, "-MF") || starts_with(a, "-MT") || starts_with(a, "-MQ")) &&
+            a.size() > 3) {
+            continue;
+        }
+        cmd.push_back(a);
+    }
+    cmd.insert(cmd.end(), {"-M", "-MF", depfile});
+    return cmd;
+}
+
+// Compile errors and crashes are not results worth caching.
+static bool iwyu_failed(int rc, const std::string& out) {
+    if (rc < 0 || rc >= 128) return true;
+    return out.find(": error:") != std::string::npos || out.find(": fatal error:") != std::string::npos;
+}
+
+// ============================================================================
+// Section 3: Result cache
+// ============================================================================
+//
+// <cache>/<key>.rec:
+//   ctc-iwyu/1
+//   <number of deps>
+//   <size> <mtime_ns> <digest hex> <absolute path>     (one per dep)
+//   <IWYU output, verbatim, to the end of the file>
+
+struct DepEntry {
+    FileStamp stamp;
+    std::string digest;
+    std::string path;
+};
+
+struct CacheRecord {
+    std::vector<DepEntry> deps;
+    std::string output;
+};
+
+static bool read_record(const std::string& path, CacheRecord& rec) {
+    std::string content = read_file(path);
+    size_t pos = 0;
+    auto next_line = [&](std::string& line) {
+        size_t nl = content.find('\n', pos);
+        if (nl == std::string::npos) return false;
+        line = content.substr(pos, nl - pos);
+        pos = nl + 1;
+        return true;
+    };
+    std::string line;
+    if (!next_line(line) || line != CACHE_VERSION || !next_line(line)) return false;
+    size_t n = (size_t)strtoul(line.c_str(), nullptr, 10);
+    for (size_t i = 0; i < n; i++) {
+        if (!next_line(line)) return false;
+        DepEntry d;
+        unsigned long long size = 0, mtime = 0;
+        char digest[64] = {0};
+        int consumed = 0;
+        if (sscanf(line.c_str(), "%llu %llu %40s %n", &size, &mtime, digest, &consumed) != 3 || consumed <= 0) {
+            return false;
+        }
+        d.stamp.size = size;
+        d.stamp.mtime_ns = mtime;
+        d.digest = digest;
+        d.path = line.substr((size_t)consumed);
+        rec.deps.push_back(std::move(d));
+    }
+    rec.output = content.substr(pos);
+    return true;
+}
+
+static std::string format_record(const CacheRecord& rec) {
+    std::string out = std::string(CACHE_VERSION) + "\n" + std::to_string(rec.deps.size()) + "\n";
+    for (const auto& d : rec.deps) {
+        out += std::to_string(d.stamp.size) + " " + std::to_string(d.stamp.mtime_ns) + " " + d.digest + " " +
+               d.path + "\n";
+    }
+    return out + rec.output;
+}
+
+// True when every dep is unchanged; touched-but-identical deps get their
+// stamps refreshed in `rec` and `refreshed` set.
+static bool deps_unchanged(CacheRecord& rec, bool& refreshed) {
+    for (auto& d : rec.deps) {
+        FileStamp now;
+        if (!file_stamp(d.path, now)) return false;
+        if (now.size == d.stamp.size && now.mtime_ns == d.stamp.mtime_ns) continue;
+        Hash128 h;
+        if (now.size != d.stamp.size || !file_digest(d.path, h, 1) || h.hex() != d.digest) return false;
+        d.stamp = now;
+        refreshed = true;
+    }
+    return true;
+}
+
+// ============================================================================
+// Section 4: Report merging
+// ============================================================================
+//
+// IWYU prints, per analyzed file, either
+//   <file> should add these lines: ... should remove ... full include-list ... ---
+// or
+//   (<file> has correct #includes/fwd-decls)
+// Everything else (warnings, notes) is diagnostics.
+
+struct Report {
+    std::vector<std::string> order;                  // files, first appearance
+    std::map<std::string, std::string> blocks;       // file -> block text
+    std::map<std::string, bool> correct;             // files reported correct
+    size_t duplicates = 0;
+    size_t conflicts = 0;
+    std::vector<std::string> conflicting;
+
+    void add_block(const std::string& file, const std::string& text) {
+        auto it = blocks.find(file);
+        if (it == blocks.end()) {
+            if (!correct.count(file)) order.push_back(file);
+            blocks[file] = text;
+            return;
+        }
+        duplicates++;
+        if (it->second != text) {
+            conflicts++;
+            conflicting.push_back(file);
+        }
+    }
+
+    void add_correct(const std::string& file) {
+        if (blocks.count(file) || correct.count(file)) {
+            duplicates++;
+            return;
+        }
+        correct[file] = true;
+        order.push_back(file);
+    }
+
+    void merge(const std::string& output) {
+        static const std::string ADD = " should add these lines:";
+        static const std::string OK_SUFFIX = " has correct #includes/fwd-decls)";
+        std::istringstream in(output);
+        std::string line, file, block;
+        bool in_block = false;
+        while (std::getline(in, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (in_block) {
+                block += line + "\n";
+                if (line == "---") {
+                    add_block(file, block);
+                    in_block = false;
+                }
+                continue;
+            }
+            if (ends_with(line, ADD)) {
+                file = line.substr(0, line.size() - ADD.size());
+                block = line + "\n";
+                in_block = true;
+            } else if (starts_with(line, "(") && ends_with(line, OK_SUFFIX)) {
+                add_correct(line.substr(1, line.size() - 1 - OK_SUFFIX.size()));
+            }
+        }
+    }
+
+    std::string render() const {
+        std::string out;
+        for (const auto& f : order) {
+            auto it = blocks.find(f);
+            if (it != blocks.end()) out += it->second + "\n";
+            else out += "(" + f + " has correct #includes/fwd-decls)\n";
+        }
+        return out;
+    }
+
+    size_t files_with_suggestions() const { return blocks.size(); }
+};
+
+// ============================================================================
+// Section 5: main()
+// ============================================================================
+
+struct Options {
+    std::string db_path = "compile_commands.json";
+    std::string iwyu;
+    std::string output;
+    std::string cache_dir;
+    bool use_cache = true;
+    unsigned jobs = 0;
+    std::vector<std::string> mappings;
+    std::vector<std::string> sources;     // substring filters on the entry's file
+    std::vector<std::string> iwyu_args;   // after "--"
+    bool verbose = false;
+};
+
+static void print_usage() {
+    printf("Usage: ctc-iwyu-tool [options] [source-filter...] [-- iwyu-args...]\n\n");
+    printf("Runs include-what-you-use over a compilation database in parallel,\n");
+    printf("caching each TU's result, and prints one merged report that\n");
+    printf("fix_includes.py accepts.\n\n");
+    printf("Options:\n");
+    printf("  -p DIR              Build dir holding compile_commands.json (default: .)\n");
+    printf("  --db FILE           Compilation database path\n");
+    printf("  -j N                Parallel IWYU processes (default: all cores / CTC_JOBS)\n");
+    printf("  --mapping FILE      IWYU mapping file (repeatable; part of the cache key)\n");
+    printf("  --iwyu PATH         include-what-you-use binary (default: installed one)\n");
+    printf("  -o, --output FILE   Write the report to FILE instead of stdout\n");
+    printf("  --cache-dir DIR     Result cache (default: $CLANG_TOOL_CHAIN_IWYU_CACHE or\n");
+    printf("                      ~/.clang-tool-chain/iwyu-cache)\n");
+    printf("  --no-cache          Run every TU\n");
+    printf("  -v, --verbose       List TUs as they finish and conflicting blocks\n");
+    printf("  --help, -h          Show this help\n\n");
+    printf("source-filter keeps entries whose file contains the string. Arguments\n");
+    printf("after -- go to include-what-you-use (e.g. -- -Xiwyu --no_fwd_decls).\n");
+}
+
+static std::string default_iwyu() {
+    std::string root = path_join(path_join(path_join(get_ctc_home_dir(), "iwyu"), platform_str(get_platform())),
+                                 arch_str(get_arch()));
+#ifdef _WIN32
+    return path_join(path_join(root, "bin"), "include-what-you-use.exe");
+#else
+    // The bundled binary finds its shared libraries through <root>/lib
+    std::string lib = path_join(root, "lib");
+    if (is_directory(lib)) {
+        std::string old = get_env("LD_LIBRARY_PATH");
+        set_env("LD_LIBRARY_PATH", old.empty() ? lib : lib + ":" + old);
+    }
+    return path_join(path_join(root, "bin"), "include-what-you-use");
+#endif
+}
+
+int main(int argc, char* argv[]) {
+    using Clock = std::chrono::steady_clock;
+    auto t0 = Clock::now();
+    Options opt;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--") {
+            for (i++; i < argc; i++) opt.iwyu_args.push_back(argv[i]);
+            break;
+        }
+        if (arg == "--help" || arg == "-h" || arg == "--ctc-help") { print_usage(); return 0; }
+        if (arg == "-p" && i + 1 < argc) { opt.db_path = path_join(argv[++i], "compile_commands.json"); continue; }
+        if (arg == "--db" && i + 1 < argc) { opt.db_path = argv[++i]; continue; }
+        if (arg == "-j" && i + 1 < argc) { opt.jobs = (unsigned)atoi(argv[++i]); continue; }
+        if (starts_with(arg, "-j") && arg.size() > 2) { opt.jobs = (unsigned)atoi(arg.c_str() + 2); continue; }
+        if (arg == "--mapping" && i + 1 < argc) { opt.mappings.push_back(argv[++i]); continue; }
+        if (arg == "--iwyu" && i + 1 < argc) { opt.iwyu = argv[++i]; continue; }
+        if ((arg == "-o" || arg == "--output") && i + 1 < argc) { opt.output = argv[++i]; continue; }
+        if (arg == "--cache-dir" && i + 1 < argc) { opt.cache_dir = argv[++i]; continue; }
+        if (arg == "--no-cache") { opt.use_cache = false; continue; }
+        if (arg == "-v" || arg == "--verbose") { opt.verbose = true; continue; }
+        if (!arg.empty() && arg[0] == '-') {
+            fprintf(stderr, "%sUnknown option: %s\n", CTC_TAG, arg.c_str());
+            return 2;
+        }
+        opt.sources.push_back(arg);
+    }
+
+    // 1. Compilation database
+    MappedFile db;
+    if (!db.open(opt.db_path)) {
+        fprintf(stderr, "%sCannot read compilation database: %s\n", CTC_TAG, opt.db_path.c_str());
+        return 1;
+    }
+    std::vector<CompileCommand> entries;
+    CompileDbReader reader(reinterpret_cast<const char*>(db.data()), db.size());
+    CompileCommand entry;
+    while (reader.next(entry)) {
+        if (entry.arguments.empty()) continue;
+        bool keep = opt.sources.empty();
+        for (const auto& s : opt.sources) keep |= entry.file.find(s) != std::string::npos;
+        if (keep) entries.push_back(std::move(entry));
+        entry = CompileCommand();
+    }
+    if (!reader.error().empty()) {
+        fprintf(stderr, "%s%s: %s\n", CTC_TAG, opt.db_path.c_str(), reader.error().c_str());
+        return 1;
+    }
+    if (entries.empty()) {
+        fprintf(stderr, "%sNo matching entries in %s\n", CTC_TAG, opt.db_path.c_str());
+        return 1;
+    }
+
+    // 2. IWYU binary, mapping files, cache
+    if (opt.iwyu.empty()) opt.iwyu = default_iwyu();
+    FileStamp iwyu_stamp;
+    if (!file_stamp(opt.iwyu, iwyu_stamp)) {
+        fprintf(stderr, "%sinclude-what-you-use not found: %s\n", CTC_TAG, opt.iwyu.c_str());
+        fprintf(stderr, "%sRun: clang-tool-chain install iwyu (or pass --iwyu PATH)\n", CTC_TAG);
+        return 1;
+    }
+    std::vector<std::string> extra = opt.iwyu_args;
+    std::vector<std::string> key_base = {CACHE_VERSION, opt.iwyu, std::to_string(iwyu_stamp.size),
+                                         std::to_string(iwyu_stamp.mtime_ns)};
+    for (const auto& m : opt.mappings) {
+        if (!path_exists(m)) {
+            fprintf(stderr, "%sMapping file not found: %s\n", CTC_TAG, m.c_str());
+            return 1;
+        }
+        extra.push_back("-Xiwyu");
+        extra.push_back("--mapping_file=" + m);
+        key_base.push_back(read_file(m));
+    }
+    key_base.push_back("args");
+    key_base.insert(key_base.end(), extra.begin(), extra.end());
+
+    if (opt.cache_dir.empty()) opt.cache_dir = get_env("CLANG_TOOL_CHAIN_IWYU_CACHE");
+    if (opt.cache_dir.empty()) opt.cache_dir = path_join(get_ctc_home_dir(), "iwyu-cache");
+    if (opt.use_cache && !is_directory(opt.cache_dir)) {
+        make_directory(get_ctc_home_dir());
+        make_directory(opt.cache_dir);
+    }
+
+    // 3. One task per TU
+    std::vector<std::string> outputs(entries.size());
+    std::vector<char> cached(entries.size(), 0), failed(entries.size(), 0);
+    std::mutex log_mutex;
+    std::string pid = std::to_string(current_pid());
+    parallel_for(entries.size(), [&](size_t i) {
+        const CompileCommand& cc = entries[i];
+        std::vector<std::string> parts = key_base;
+        parts.push_back(cc.directory);
+        parts.push_back(cc.file);
+        parts.insert(parts.end(), cc.arguments.begin(), cc.arguments.end());
+        std::string key = hash128_parts(parts).hex();
+        std::string rec_path = path_join(opt.cache_dir, key + ".rec");
+
+        CacheRecord rec;
+        if (opt.use_cache && read_record(rec_path, rec)) {
+            bool refreshed = false;
+            if (deps_unchanged(rec, refreshed)) {
+                if (refreshed) write_file_atomic(rec_path, format_record(rec));
+                outputs[i] = std::move(rec.output);
+                cached[i] = 1;
+                return;
+            }
+        }
+
+        // Miss: dependency closure first, so an edit racing the run is seen next time
+        rec = CacheRecord();
+        bool cacheable = opt.use_cache;
+        if (cacheable) {
+            std::string depfile = path_join(opt.cache_dir, key + ".d." + pid);
+            auto scan = dep_scan_command(cc, depfile);
+            std::string scan_out;
+            cacheable = !scan.empty() && run_captured(scan, cc.directory, scan_out) == 0;
+            if (cacheable) {
+                for (const auto& dep : parse_depfile_prereqs(read_file(depfile))) {
+                    DepEntry d;
+                    d.path = resolve_in(cc.directory, dep);
+                    Hash128 h;
+                    if (!file_stamp(d.path, d.stamp) || !file_digest(d.path, h, 1)) continue;
+                    d.digest = h.hex();
+                    rec.deps.push_back(std::move(d));
+                }
+                cacheable = !rec.deps.empty();
+            }
+            std::remove(depfile.c_str());
+        }
+
+        std::string out;
+        int rc = run_captured(iwyu_command(cc, opt.iwyu, extra), cc.directory, out);
+        if (iwyu_failed(rc, out)) {
+            failed[i] = 1;
+        } else if (cacheable) {
+            rec.output = out;
+            write_file_atomic(rec_path, format_record(rec));
+        }
+        outputs[i] = std::move(out);
+        if (opt.verbose) {
+            std::lock_guard<std::mutex> lock(log_mutex);
+            fprintf(stderr, "%s%s %s\n", CTC_TAG, failed[i] ? "FAILED" : "done", cc.file.c_str());
+        }
+    }, opt.jobs);
+
+    // 4. Merge in database order, so the report is stable across -j
+    Report report;
+    size_t hits = 0, failures = 0;
+    for (size_t i = 0; i < entries.size(); i++) {
+        hits += cached[i];
+        if (failed[i]) {
+            failures++;
+            fprintf(stderr, "%sIWYU failed for %s:\n%s", CTC_TAG, entries[i].file.c_str(), outputs[i].c_str());
+            if (!outputs[i].empty() && outputs[i].back() != '\n') fputc('\n', stderr);
+        }
+        report.merge(outputs[i]);
+    }
+    std::string text = report.render();
+    if (opt.output.empty()) {
+        fwrite(text.data(), 1, text.size(), stdout);
+    } else if (!write_file_atomic(opt.output, text)) {
+        fprintf(stderr, "%sCannot write %s\n", CTC_TAG, opt.output.c_str());
+        return 1;
+    }
+
+    double secs = std::chrono::duration<double>(Clock::now() - t0).count();
+    fprintf(stderr, "%s%zu TUs: %zu cached, %zu run, %zu failed in %.2f s; %zu files with suggestions",
+            CTC_TAG, entries.size(), hits, entries.size() - hits, failures, secs, report.files_with_suggestions());
+    fprintf(stderr, ", %zu duplicate reports merged", report.duplicates);
+    if (report.conflicts) fprintf(stderr, " (%zu disagreed, first kept)", report.conflicts);
+    fprintf(stderr, "\n");
+    if (opt.verbose) {
+        for (const auto& f : report.conflicting) fprintf(stderr, "%sconflicting reports for %s\n", CTC_TAG, f.c_str());
+    }
+    return failures ? 1 : 0;
+}
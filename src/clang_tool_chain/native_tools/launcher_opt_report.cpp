@@ -0,0 +1,553 @@
+// clang-tool-chain optimization-remark report (ctc-opt-report)
+//
+// Build-wide replacement for opt-viewer: reads every optimization record a
+// build saved (ctc-clang with CLANG_TOOL_CHAIN_OPT_RECORD=yaml|bitstream,
+// clang_launcher.cpp 6.11, or any -fsave-optimization-record build) and ranks
+// what the optimizer did and failed to do:
+//
+//   CLANG_TOOL_CHAIN_OPT_RECORD=yaml ninja -C build
+//   ctc-opt-report build                          # top missed remarks
+//   ctc-opt-report build --pass loop-vectorize    # loops that did not vectorize
+//   ctc-opt-report build --pass inline --kind all --weights perf.txt
+//
+// Records are mapped and parsed in parallel, one task per file on the shared
+// executor (ctc_common.h Section 13). Bitstream records are converted to YAML
+// with llvm-remarkutil first. The same remark reached from several TUs (a
+// header function) is merged into one entry with an occurrence count.
+//
+// Ranking: by the records' Hotness when the build used a profile (PGO builds
+// get -fdiagnostics-show-hotness from the launcher), else by the --weights
+// profile of the enclosing function, else by occurrence count.
+//
+// The parser reads the subset of YAML that LLVM's remark serializer writes:
+// `--- !Kind` documents with Pass/Name/DebugLoc/Function/Hotness/Args keys.
+//
+// Single-file C++17. Common utilities live in ctc_common.h.
+//
+// Build: clang++ -O3 -std=c++17 -o ctc-opt-report launcher_opt_report.cpp
+//   Linux:   add -static-libstdc++ -static-libgcc -lpthread
+//   Windows: add -static-libstdc++ -static-libgcc
+
+#include "ctc_common.h"
+
+#include <array>
+#include <map>
+
+using namespace ctc;
+
+// ============================================================================
+// Section 0: Tool-specific constants
+// ============================================================================
+
+static constexpr const char* CTC_TAG = "[ctc-opt-report] ";
+
+enum RemarkKind : uint8_t { KIND_PASSED, KIND_MISSED, KIND_ANALYSIS, KIND_FAILURE, KIND_COUNT };
+static const char* const KIND_NAMES[KIND_COUNT] = {"passed", "missed", "analysis", "failure"};
+
+// ============================================================================
+// Section 1: Remark records
+// ============================================================================
+
+struct Remark {
+    RemarkKind kind = KIND_ANALYSIS;
+    std::string pass, name, file, function, message;
+    uint32_t line = 0, column = 0;
+    uint64_t hotness = 0;
+    bool has_hotness = false;
+};
+
+static std::string trim_ws(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t\r");
+    if (b == std::string::npos) return "";
+    size_t e = s.find_last_not_of(" \t\r");
+    return s.substr(b, e - b + 1);
+}
+
+// A YAML scalar as LLVM writes it: 'single' ('' escapes '), "double"
+// (backslash escapes), or plain.
+static std::string yaml_scalar(const std::string& raw) {
+    std::string v = trim_ws(raw);
+    if (v.size() >= 2 && v.front() == '\'' && v.back() == '\'') {
+        std::string out;
+        for (size_t i = 1; i + 1 < v.size(); i++) {
+            out += v[i];
+            if (v[i] == '\'' && v[i + 1] == '\'') i++;
+        }
+        return out;
+    }
+    if (v.size() >= 2 && v.front() == '"' && v.back() == '"') {
+        std::string out;
+        for (size_t i = 1; i + 1 < v.size(); i++) {
+            if (v[i] == '\\' && i + 2 < v.size()) {
+                char c = v[++i];
+                out += c == 'n' ? '\n' : c == 't' ? '\t' : c;
+            } else {
+                out += v[i];
+            }
+        }
+        return out;
+    }
+    return v;
+}
+
+// { File: 'a.cpp', Line: 3, Column: 5 }
+static void parse_debug_loc(const std::string& raw, Remark& r) {
+    size_t open = raw.find('{'), close = raw.rfind('}');
+    if (open == std::string::npos || close == std::string::npos || close < open) return;
+    std::string body = raw.substr(open + 1, close - open - 1);
+    std::vector<std::string> fields;
+    std::string cur;
+    char quote = 0;
+    for (char c : body) {
+        if (quote) {
+            if (c == quote) quote = 0;
+        } else if (c == '\'' || c == '"') {
+            quote = c;
+        } else if (c == ',') {
+            fields.push_back(cur);
+            cur.clear();
+            continue;
+        }
+        cur += c;
+    }
+    fields.push_back(cur);
+    for (const auto& f : fields) {
+        size_t colon = f.find(':');
+        if (colon == std::string::npos) continue;
+        std::string key = trim_ws(f.substr(0, colon));
+        std::string value = yaml_scalar(f.substr(colon + 1));
+        if (key == "File") r.file = value;
+        else if (key == "Line") r.line = (uint32_t)strtoul(value.c_str(), nullptr, 10);
+        else if (key == "Column") r.column = (uint32_t)strtoul(value.c_str(), nullptr, 10);
+    }
+}
+
+static bool parse_kind(const std::string& tag, RemarkKind& kind) {
+    if (tag == "!Passed") kind = KIND_PASSED;
+    else if (tag == "!Missed") kind = KIND_MISSED;
+    else if (tag == "!Failure") kind = KIND_FAILURE;
+    else if (starts_with(tag, "!Analysis")) kind = KIND_ANALYSIS;  // also AnalysisFPCommute/Aliasing
+    else return false;
+    return true;
+}
+
+// Parses one YAML remark file. The message is the Args values concatenated,
+// as opt-viewer renders it, with symbol arguments demangled.
+static void parse_yaml_remarks(const char* data, size_t size, std::vector<Remark>& out) {
+    Remark cur;
+    bool in_doc = false, in_args = false;
+    std::string loc;  // DebugLoc flow map, which LLVM wraps past column 70
+    auto flush = [&]() {
+        if (in_doc) out.push_back(std::move(cur));
+        cur = Remark();
+        in_doc = in_args = false;
+        loc.clear();
+    };
+    size_t pos = 0;
+    while (pos < size) {
+        const char* nl = static_cast<const char*>(memchr(data + pos, '\n', size - pos));
+        size_t end = nl ? (size_t)(nl - data) : size;
+        std::string line(data + pos, end - pos);
+        pos = end + 1;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+
+        if (starts_with(line, "---")) {
+            flush();
+            RemarkKind kind;
+            if (parse_kind(trim_ws(line.substr(3)), kind)) {
+                cur.kind = kind;
+                in_doc = true;
+            }
+            continue;
+        }
+        if (line == "...") {
+            flush();
+            continue;
+        }
+        if (!in_doc || line.empty()) continue;
+        if (!loc.empty()) {
+            loc += " " + trim_ws(line);
+            if (loc.find('}') != std::string::npos) {
+                parse_debug_loc(loc, cur);
+                loc.clear();
+            }
+            continue;
+        }
+
+        if (line[0] != ' ') {
+            in_args = false;
+            size_t colon = line.find(':');
+            if (colon == std::string::npos) continue;
+            std::string key = line.substr(0, colon);
+            std::string value = line.substr(colon + 1);
+            if (key == "Pass") cur.pass = yaml_scalar(value);
+            else if (key == "Name") cur.name = yaml_scalar(value);
+            else if (key == "Function") cur.function = yaml_scalar(value);
+            else if (key == "DebugLoc" && value.find('}') == std::string::npos) loc = value;
+            else if (key == "DebugLoc") parse_debug_loc(value, cur);
+            else if (key == "Hotness") {
+                cur.hotness = strtoull(trim_ws(value).c_str(), nullptr, 10);
+                cur.has_hotness = true;
+            } else if (key == "Args") in_args = true;
+            continue;
+        }
+        // "  - Key: value" starts an argument; deeper lines (its DebugLoc) are skipped
+        if (in_args) {
+            std::string t = trim_ws(line);
+            if (!starts_with(t, "- ")) continue;
+            size_t colon = t.find(':');
+            if (colon == std::string::npos) continue;
+            std::string key = trim_ws(t.substr(2, colon - 2));
+            std::string value = yaml_scalar(t.substr(colon + 1));
+            if (key == "Callee" || key == "Caller") value = demangle(value);
+            cur.message += value;
+        }
+    }
+    flush();
+}
+
+// ============================================================================
+// Section 2: Collecting and converting records
+// ============================================================================
+
+static int run_tool(const std::vector<std::string>& cmd) {
+#ifdef _WIN32
+    return create_process_and_wait(cmd);
+#else
+    std::vector<const char*> argv_ptrs;
+    for (const auto& s : cmd) argv_ptrs.push_back(s.c_str());
+    argv_ptrs.push_back(nullptr);
+    pid_t pid = fork();
+    if (pid == 0) {
+        execvp(cmd[0].c_str(), const_cast<char**>(argv_ptrs.data()));
+        _exit(127);
+    }
+    if (pid < 0) return -1;
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+#endif
+}
+
+// llvm-remarkutil from the bundled toolchain, else whatever PATH has.
+static std::string find_remarkutil() {
+    std::string root = path_join(path_join(path_join(get_ctc_home_dir(), "clang"), platform_str(get_platform())),
+                                 arch_str(get_arch()));
+#ifdef _WIN32
+    std::string bundled = path_join(path_join(root, "bin"), "llvm-remarkutil.exe");
+#else
+    std::string bundled = path_join(path_join(root, "bin"), "llvm-remarkutil");
+#endif
+    return path_exists(bundled) ? bundled : "llvm-remarkutil";
+}
+
+// ============================================================================
+// Section 3: Aggregation
+// ============================================================================
+
+struct Entry {
+    Remark r;
+    uint64_t count = 0;
+    uint64_t hotness = 0;   // max over occurrences
+    double score = 0;
+};
+
+struct Filters {
+    std::vector<std::string> passes;  // exact pass names; empty = all
+    int kind = KIND_MISSED;           // KIND_COUNT = all kinds
+    std::string function, file;       // substrings
+};
+
+static bool keep(const Remark& r, const Filters& f, const std::string& pretty) {
+    if (f.kind != KIND_COUNT && r.kind != f.kind) return false;
+    if (!f.passes.empty() && std::find(f.passes.begin(), f.passes.end(), r.pass) == f.passes.end()) return false;
+    if (!f.function.empty() && pretty.find(f.function) == std::string::npos &&
+        r.function.find(f.function) == std::string::npos) {
+        return false;
+    }
+    return f.file.empty() || r.file.find(f.file) != std::string::npos;
+}
+
+// --weights: "<number>[%] [[.]] <symbol>" per line, e.g. `perf report --stdio
+// --no-children -F overhead,sym` output or "count symbol" pairs. Both the
+// mangled and demangled spelling of a symbol match.
+static std::unordered_map<std::string, double> read_weights(const std::string& path) {
+    std::unordered_map<std::string, double> weights;
+    std::istringstream in(read_file(path));
+    std::string line;
+    while (std::getline(in, line)) {
+        std::string t = trim_ws(line);
+        if (t.empty() || t[0] == '#') continue;
+        char* endp = nullptr;
+        double w = strtod(t.c_str(), &endp);
+        if (endp == t.c_str()) continue;
+        std::string rest = trim_ws(std::string(endp));
+        if (!rest.empty() && rest[0] == '%') rest = trim_ws(rest.substr(1));
+        if (starts_with(rest, "[.]") || starts_with(rest, "[k]")) rest = trim_ws(rest.substr(3));
+        if (rest.empty()) continue;
+        weights[rest] += w;
+    }
+    return weights;
+}
+
+// ============================================================================
+// Section 4: main()
+// ============================================================================
+
+static void print_usage() {
+    printf("Usage: ctc-opt-report [options] [PATH...]\n\n");
+    printf("Aggregates optimization records (*.opt.yaml, *.opt.bitstream) under PATH\n");
+    printf("(files or directories, default: .) and ranks remarks by hotness, profile\n");
+    printf("weight or occurrence count. Produce records with\n");
+    printf("CLANG_TOOL_CHAIN_OPT_RECORD=yaml (or bitstream) set during the build.\n\n");
+    printf("Options:\n");
+    printf("  --pass NAME         Only this pass (repeatable: inline, loop-vectorize,\n");
+    printf("                      slp-vectorizer, licm, gvn, ...)\n");
+    printf("  --kind K            missed (default), passed, analysis, failure or all\n");
+    printf("  --function S        Only functions whose name contains S\n");
+    printf("  --file S            Only source files whose path contains S\n");
+    printf("  --weights FILE      Function weights (\"<weight> <symbol>\" lines; perf report\n");
+    printf("                      --stdio output works) used when records carry no hotness\n");
+    printf("  --top N             Entries in the ranked lists (default: 30)\n");
+    printf("  --remarkutil PATH   llvm-remarkutil for bitstream records\n");
+    printf("  -j N                Parallel parsers (default: all cores / CTC_JOBS)\n");
+    printf("  --json              JSON output\n");
+    printf("  --help, -h          Show this help\n");
+}
+
+int main(int argc, char* argv[]) {
+    using Clock = std::chrono::steady_clock;
+    auto t0 = Clock::now();
+    Filters filters;
+    std::vector<std::string> roots;
+    std::string weights_path, remarkutil;
+    size_t top = 30;
+    unsigned jobs = 0;
+    bool json = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h" || arg == "--ctc-help") { print_usage(); return 0; }
+        if (arg == "--json") { json = true; continue; }
+        if (arg == "--pass" && i + 1 < argc) { filters.passes.push_back(argv[++i]); continue; }
+        if (arg == "--function" && i + 1 < argc) { filters.function = argv[++i]; continue; }
+        if (arg == "--file" && i + 1 < argc) { filters.file = argv[++i]; continue; }
+        if (arg == "--weights" && i + 1 < argc) { weights_path = argv[++i]; continue; }
+        if (arg == "--remarkutil" && i + 1 < argc) { remarkutil = argv[++i]; continue; }
+        if (arg == "--top" && i + 1 < argc) { top = (size_t)std::max(1, atoi(argv[++i])); continue; }
+        if (arg == "-j" && i + 1 < argc) { jobs = (unsigned)std::max(1, atoi(argv[++i])); continue; }
+        if (arg == "--kind" && i + 1 < argc) {
+            std::string k = argv[++i];
+            filters.kind = -1;
+            for (int n = 0; n < KIND_COUNT; n++) {
+                if (k == KIND_NAMES[n]) filters.kind = n;
+            }
+            if (k == "all") filters.kind = KIND_COUNT;
+            if (filters.kind < 0) {
+                fprintf(stderr, "%sUnknown kind: %s (missed, passed, analysis, failure, all)\n", CTC_TAG, k.c_str());
+                return 2;
+            }
+            continue;
+        }
+        if (arg.size() > 1 && arg[0] == '-') {
+            fprintf(stderr, "%sUnknown option: %s\n", CTC_TAG, arg.c_str());
+            return 2;
+        }
+        roots.push_back(arg);
+    }
+    if (roots.empty()) roots.push_back(".");
+
+    // 1. Find records
+    std::vector<std::string> files;
+    for (const auto& root : roots) {
+        if (is_directory(root)) walk_files(root, {".opt.yaml", ".opt.bitstream"}, files);
+        else if (path_exists(root)) files.push_back(root);
+        else fprintf(stderr, "%sNot found: %s\n", CTC_TAG, root.c_str());
+    }
+    if (files.empty()) {
+        fprintf(stderr, "%sNo optimization records (*.opt.yaml, *.opt.bitstream) found.\n", CTC_TAG);
+        fprintf(stderr, "%sBuild with CLANG_TOOL_CHAIN_OPT_RECORD=yaml to produce them.\n", CTC_TAG);
+        return 1;
+    }
+    std::sort(files.begin(), files.end());
+    if (remarkutil.empty()) remarkutil = find_remarkutil();
+
+    // 2. Parse in parallel (bitstream via a YAML conversion next to a temp name)
+    std::vector<std::vector<Remark>> per_file(files.size());
+    std::vector<char> unreadable(files.size(), 0);
+    std::string pid = std::to_string(current_pid());
+    parallel_for(files.size(), [&](size_t i) {
+        std::string path = files[i];
+        std::string converted;
+        if (ends_with(path, ".opt.bitstream")) {
+            converted = path + ".ctc-opt-report." + pid + ".yaml";
+            if (run_tool({remarkutil, "bitstream2yaml", path, "-o", converted}) != 0) {
+                std::remove(converted.c_str());
+                unreadable[i] = 1;
+                return;
+            }
+            path = converted;
+        }
+        MappedFile mf;
+        if (mf.open(path)) {
+            parse_yaml_remarks(reinterpret_cast<const char*>(mf.data()), mf.size(), per_file[i]);
+        } else {
+            unreadable[i] = 1;
+        }
+        if (!converted.empty()) {
+            mf.close();
+            std::remove(converted.c_str());
+        }
+    }, jobs);
+    size_t failed = 0;
+    for (size_t i = 0; i < files.size(); i++) {
+        if (!unreadable[i]) continue;
+        if (failed++ < 5) fprintf(stderr, "%sCannot read %s\n", CTC_TAG, files[i].c_str());
+    }
+    if (failed && failed < files.size() && failed >= 5) fprintf(stderr, "%s... %zu unreadable\n", CTC_TAG, failed);
+    if (failed && std::any_of(files.begin(), files.end(),
+                              [](const std::string& f) { return ends_with(f, ".opt.bitstream"); })) {
+        fprintf(stderr, "%sBitstream records need llvm-remarkutil (--remarkutil PATH)\n", CTC_TAG);
+    }
+
+    // 3. Merge duplicates (same remark from several TUs) and tally
+    std::unordered_map<std::string, double> weights;
+    if (!weights_path.empty()) weights = read_weights(weights_path);
+    std::map<std::string, std::array<uint64_t, KIND_COUNT>> by_pass;
+    std::unordered_map<std::string, size_t> index;
+    std::vector<Entry> entries;
+    std::unordered_map<std::string, std::string> pretty_names;
+    size_t total = 0;
+    bool any_hotness = false;
+    for (auto& remarks : per_file) {
+        for (auto& r : remarks) {
+            total++;
+            by_pass[r.pass][r.kind]++;
+            auto pn = pretty_names.find(r.function);
+            if (pn == pretty_names.end()) pn = pretty_names.emplace(r.function, demangle(r.function)).first;
+            if (!keep(r, filters, pn->second)) continue;
+            std::string key = std::to_string(r.kind) + '\x1f' + r.pass + '\x1f' + r.name + '\x1f' + r.file + '\x1f' +
+                              std::to_string(r.line) + ':' + std::to_string(r.column) + '\x1f' + r.function +
+                              '\x1f' + r.message;
+            auto it = index.find(key);
+            if (it == index.end()) {
+                it = index.emplace(key, entries.size()).first;
+                entries.push_back(Entry());
+                entries.back().r = std::move(r);
+            }
+            Entry& e = entries[it->second];
+            e.count++;
+            if (e.r.has_hotness) any_hotness = true;
+            e.hotness = std::max(e.hotness, e.r.hotness);
+        }
+        std::vector<Remark>().swap(remarks);
+    }
+
+    // 4. Rank: hotness, else function weight, else occurrences
+    const char* score_name = any_hotness ? "hotness" : !weights.empty() ? "weight" : "count";
+    for (auto& e : entries) {
+        if (any_hotness) {
+            e.score = (double)e.hotness;
+        } else if (!weights.empty()) {
+            auto w = weights.find(e.r.function);
+            if (w == weights.end()) w = weights.find(pretty_names[e.r.function]);
+            e.score = w == weights.end() ? 0.0 : w->second;
+        } else {
+            e.score = (double)e.count;
+        }
+    }
+    std::vector<size_t> order(entries.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        if (entries[a].score != entries[b].score) return entries[a].score > entries[b].score;
+        return entries[a].count > entries[b].count;
+    });
+
+    struct FnRow {
+        std::string name;
+        uint64_t remarks = 0;
+        double score = 0;
+    };
+    std::unordered_map<std::string, size_t> fn_index;
+    std::vector<FnRow> functions;
+    for (const auto& e : entries) {
+        auto it = fn_index.find(e.r.function);
+        if (it == fn_index.end()) {
+            it = fn_index.emplace(e.r.function, functions.size()).first;
+            functions.push_back({pretty_names[e.r.function], 0, 0});
+        }
+        functions[it->second].remarks += e.count;
+        functions[it->second].score = std::max(functions[it->second].score, e.score);
+    }
+    std::stable_sort(functions.begin(), functions.end(), [](const FnRow& a, const FnRow& b) {
+        if (a.score != b.score) return a.score > b.score;
+        return a.remarks > b.remarks;
+    });
+
+    double secs = std::chrono::duration<double>(Clock::now() - t0).count();
+    const char* kind_label = filters.kind == KIND_COUNT ? "all" : KIND_NAMES[filters.kind];
+    auto location = [](const Remark& r) {
+        return r.file.empty() ? std::string("<unknown>")
+                              : r.file + ":" + std::to_string(r.line) + ":" + std::to_string(r.column);
+    };
+
+    if (json) {
+        printf("{\n  \"records\": %zu,\n  \"remarks\": %zu,\n  \"kind\": \"%s\",\n  \"ranked_by\": \"%s\",\n",
+               files.size(), total, kind_label, score_name);
+        printf("  \"passes\": [");
+        size_t n = 0;
+        for (const auto& p : by_pass) {
+            printf("%s\n    {\"pass\": \"%s\", \"passed\": %llu, \"missed\": %llu, \"analysis\": %llu, "
+                   "\"failure\": %llu}",
+                   n++ ? "," : "", json_escape(p.first).c_str(), (unsigned long long)p.second[KIND_PASSED],
+                   (unsigned long long)p.second[KIND_MISSED], (unsigned long long)p.second[KIND_ANALYSIS],
+                   (unsigned long long)p.second[KIND_FAILURE]);
+        }
+        printf("\n  ],\n  \"remarks_ranked\": [");
+        for (size_t k = 0; k < std::min(top, order.size()); k++) {
+            const Entry& e = entries[order[k]];
+            printf("%s\n    {\"kind\": \"%s\", \"pass\": \"%s\", \"name\": \"%s\", \"file\": \"%s\", \"line\": %u, "
+                   "\"column\": %u, \"function\": \"%s\", \"message\": \"%s\", \"count\": %llu, \"score\": %.6g}",
+                   k ? "," : "", KIND_NAMES[e.r.kind], json_escape(e.r.pass).c_str(), json_escape(e.r.name).c_str(),
+                   json_escape(e.r.file).c_str(), e.r.line, e.r.column,
+                   json_escape(pretty_names[e.r.function]).c_str(), json_escape(e.r.message).c_str(),
+                   (unsigned long long)e.count, e.score);
+        }
+        printf("\n  ],\n  \"functions\": [");
+        for (size_t k = 0; k < std::min(top, functions.size()); k++) {
+            printf("%s\n    {\"function\": \"%s\", \"remarks\": %llu, \"score\": %.6g}", k ? "," : "",
+                   json_escape(functions[k].name).c_str(), (unsigned long long)functions[k].remarks,
+                   functions[k].score);
+        }
+        printf("\n  ]\n}\n");
+        return failed == files.size() ? 1 : 0;
+    }
+
+    printf("ctc-opt-report: %zu remarks from %zu record file(s) in %.2f s\n\n", total, files.size(), secs);
+    printf("Remarks by pass:\n");
+    printf("  %-28s %10s %10s %10s %10s\n", "pass", "passed", "missed", "analysis", "failure");
+    for (const auto& p : by_pass) {
+        printf("  %-28s %10llu %10llu %10llu %10llu\n", p.first.c_str(), (unsigned long long)p.second[KIND_PASSED],
+               (unsigned long long)p.second[KIND_MISSED], (unsigned long long)p.second[KIND_ANALYSIS],
+               (unsigned long long)p.second[KIND_FAILURE]);
+    }
+
+    printf("\nTop %s remarks (%zu distinct, ranked by %s):\n", kind_label, entries.size(), score_name);
+    for (size_t k = 0; k < std::min(top, order.size()); k++) {
+        const Entry& e = entries[order[k]];
+        printf("  %10.6g  %s  [%s%s%s]  in %s\n", e.score, location(e.r).c_str(), e.r.pass.c_str(),
+               filters.kind == KIND_COUNT ? " " : "", filters.kind == KIND_COUNT ? KIND_NAMES[e.r.kind] : "",
+               pretty_names[e.r.function].c_str());
+        printf("              %s%s\n", e.r.message.empty() ? e.r.name.c_str() : e.r.message.c_str(),
+               e.count > 1 ? (" (x" + std::to_string(e.count) + ")").c_str() : "");
+    }
+
+    printf("\nFunctions (%zu, ranked by %s):\n", functions.size(), score_name);
+    printf("  %10s %8s  %s\n", score_name, "remarks", "function");
+    for (size_t k = 0; k < std::min(top, functions.size()); k++) {
+        printf("  %10.6g %8llu  %s\n", functions[k].score, (unsigned long long)functions[k].remarks,
+               functions[k].name.c_str());
+    }
+    return failed == files.size() ? 1 : 0;
+}
@@ -0,0 +1,425 @@
+// clang-tool-chain native single-file runner (ctc-run)
+//
+// Native counterpart of `clang-tool-chain-build-run --cached` for C/C++
+// programs kept as one source file, typically run through a shebang:
+//
+//   #!/usr/bin/env -S ctc-run -O2
+//   // @std: c++20
+//   #include <cstdio>
+//   int main(int argc, char** argv) { puts(argc > 1 ? argv[1] : "hi"); }
+//
+// Each SOURCE is built once per (content, directory, flags, directives,
+// toolchain) into a content-addressed cache and the cached binary is exec'd
+// on every later run. A warm start costs one read+hash of the source, the
+// directive scan, one stat() per recorded header and the exec — no Python.
+//
+//   Hit:   <cache>/<key>/deps lists (size, mtime, digest) for every header the
+//          last compile read (-MD). Headers whose stat matches are trusted;
+//          only touched ones are re-hashed.
+//   Miss:  the source is compiled through ctc-clang's own dispatch
+//          (clang_launcher.cpp, #included with CTC_LAUNCHER_NO_MAIN the same
+//          way launcher_clang_tool.cpp and libctc.cpp embed it), so flag
+//          injection, directives and DLL deployment match ctc-clang exactly.
+//          A shebang line is blanked to a comment in a temporary copy next
+//          to the source, so relative includes and line numbers still work.
+//          Older entries for the same source, flags and environment (an
+//          earlier edit, a previous toolchain) are deleted afterwards, so the
+//          cache holds one entry per variant instead of one per edit.
+//
+// Single-file C++17. Common utilities live in ctc_common.h.
+//
+// Build: clang++ -O3 -std=c++17 -o ctc-run launcher_run.cpp
+//   Linux:   add -static-libstdc++ -static-libgcc -lpthread
+//   Windows: add -static-libstdc++ -static-libgcc
+
+#define CTC_LAUNCHER_NO_MAIN
+#include "clang_launcher.cpp"  // provides clang_launcher_main, parse_directives_from_file, CtcCache
+
+// ``using namespace ctc;`` and CTC_TAG come from clang_launcher.cpp.
+
+// ============================================================================
+// Section 0: Tool-specific constants
+// ============================================================================
+
+static constexpr const char* RUN_TAG = "[ctc-run] ";
+static constexpr const char* RUN_CACHE_VERSION = "ctc-run/2";
+static constexpr const char* DEPS_FILENAME = "deps";
+
+// Environment that ctc-clang's dispatch reads and that changes the binary
+// (or what gets deployed next to it). Part of every cache key.
+static constexpr const char* KEY_ENV_VARS[] = {
+    "CLANG_TOOL_CHAIN_RUNTIME", "CLANG_TOOL_CHAIN_RUNTIME_DIR", "CLANG_TOOL_CHAIN_NO_AUTO",
+    "CLANG_TOOL_CHAIN_NO_DIRECTIVES", "CLANG_TOOL_CHAIN_NO_SYSROOT", "CLANG_TOOL_CHAIN_NO_BUNDLED_SYSROOT",
+    "CLANG_TOOL_CHAIN_NO_BUNDLED_UNWIND", "CLANG_TOOL_CHAIN_NO_MACOS_UNWIND_FIX", "CLANG_TOOL_CHAIN_NO_RPATH",
+    "CLANG_TOOL_CHAIN_NO_SHARED_ASAN", "CLANG_TOOL_CHAIN_NO_DEPLOY_LIBS", "CLANG_TOOL_CHAIN_NO_DEPLOY_SHARED_LIB",
+    "CLANG_TOOL_CHAIN_NO_DLL_DEPLOY", "CLANG_TOOL_CHAIN_USE_SYSTEM_LD", "CLANG_TOOL_CHAIN_XRAY",
+    "CLANG_TOOL_CHAIN_XRAY_THRESHOLD", "CLANG_TOOL_CHAIN_OPT_RECORD", "CLANG_TOOL_CHAIN_PRELINK",
+    "CLANG_TOOL_CHAIN_PRELINK_MIN", "SDKROOT",
+};
+
+// ============================================================================
+// Section 1: File helpers
+// ============================================================================
+
+static void make_directories(const std::string& path) {
+    if (path.empty() || is_directory(path)) return;
+    size_t sep = path.find_last_of("/\\");
+    if (sep != std::string::npos && sep > 0) make_directories(path.substr(0, sep));
+    make_directory(path);
+}
+
+static bool rename_into_place(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+// ============================================================================
+// Section 2: Dependency record
+// ============================================================================
+//
+// <entry>/deps: the version line, the origin line, then one header per line:
+//   <variant hex> <absolute source path>
+//   <size> <mtime_ns> <digest hex> <absolute path>
+// The origin names the variant (section 3) the entry was built for, so a
+// miss can find and delete the entries it supersedes.
+
+struct DepEntry {
+    FileStamp stamp;
+    std::string digest;
+    std::string path;
+};
+
+static bool read_deps(const std::string& path, std::vector<DepEntry>& out) {
+    std::string content = read_file(path);
+    std::istringstream in(content);
+    std::string line;
+    if (!std::getline(in, line) || line != RUN_CACHE_VERSION) return false;
+    if (!std::getline(in, line)) return false;  // origin
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        DepEntry d;
+        unsigned long long size = 0, mtime = 0;
+        char digest[64] = {0};
+        int consumed = 0;
+        if (sscanf(line.c_str(), "%llu %llu %40s %n", &size, &mtime, digest, &consumed) != 3 || consumed <= 0) {
+            return false;
+        }
+        d.stamp.size = size;
+        d.stamp.mtime_ns = mtime;
+        d.digest = digest;
+        d.path = line.substr((size_t)consumed);
+        out.push_back(std::move(d));
+    }
+    return true;
+}
+
+static std::string format_deps(const std::string& origin, const std::vector<DepEntry>& deps) {
+    std::string out = std::string(RUN_CACHE_VERSION) + "\n" + origin + "\n";
+    for (const auto& d : deps) {
+        out += std::to_string(d.stamp.size) + " " + std::to_string(d.stamp.mtime_ns) + " " + d.digest + " " +
+               d.path + "\n";
+    }
+    return out;
+}
+
+// Returns the first header that changed, or "" when all match. Headers whose
+// stat moved but whose digest did not get their stamp refreshed in `deps`.
+static std::string check_deps(std::vector<DepEntry>& deps, bool& refreshed) {
+    for (auto& d : deps) {
+        FileStamp now;
+        if (!file_stamp(d.path, now)) return d.path;
+        if (now.size == d.stamp.size && now.mtime_ns == d.stamp.mtime_ns) continue;
+        Hash128 h;
+        if (now.size != d.stamp.size || !file_digest(d.path, h) || h.hex() != d.digest) return d.path;
+        d.stamp = now;
+        refreshed = true;
+    }
+    return "";
+}
+
+// ============================================================================
+// Section 3: Cache key
+// ============================================================================
+
+struct RunRequest {
+    std::string source;      // absolute path
+    std::string source_dir;
+    std::string stem;
+    CompilerMode mode = CompilerMode::C;
+    std::vector<std::string> flags;
+    std::vector<std::string> program_args;
+    bool rebuild = false;
+    bool which = false;
+};
+
+static bool is_cxx_source(const std::string& path) {
+    // get_extension() lower-cases, so check the raw suffix for ".C".
+    if (ends_with(path, ".C")) return true;
+    std::string ext = get_extension(path);
+    return ext == ".cpp" || ext == ".cc" || ext == ".cxx" || ext == ".c++" || ext == ".cp";
+}
+
+// The variant: which source, built how. Entries of one variant differ only in
+// source content and toolchain, so a new one makes the others garbage.
+static Hash128 variant_key(const RunRequest& req, Platform platform, Arch arch) {
+    std::vector<std::string> parts = {RUN_CACHE_VERSION, platform_str(platform), arch_str(arch),
+                                      req.mode == CompilerMode::CXX ? "c++" : "c", req.source};
+    parts.push_back("flags");
+    parts.insert(parts.end(), req.flags.begin(), req.flags.end());
+    parts.push_back("env");
+    for (const char* var : KEY_ENV_VARS) parts.push_back(get_env(var));
+    return hash128_parts(parts);
+}
+
+// Everything that can change the binary besides header contents.
+static Hash128 cache_key(const Hash128& variant, const std::string& content, const DirectiveResult& directives,
+                         const std::string& install_dir) {
+    std::vector<std::string> parts = {variant.hex(), hash128(content).hex()};
+    parts.push_back("directives");
+    parts.insert(parts.end(), directives.compiler_args.begin(), directives.compiler_args.end());
+    parts.insert(parts.end(), directives.linker_args.begin(), directives.linker_args.end());
+    // Toolchain identity: done.txt is rewritten by every (re)install.
+    parts.push_back(read_file(path_join(install_dir, DONE_FILENAME)));
+    return hash128_parts(parts);
+}
+
+// Deletes every entry under `cache_root` but `keep` whose origin line names
+// the same variant. Entries still being compiled have no deps file yet and
+// are left alone; a binary another process is running survives on POSIX
+// (unlinked, not truncated) and simply isn't removed on Windows.
+static void evict_superseded(const std::string& cache_root, const std::string& keep, const std::string& variant,
+                             bool debug) {
+    std::string prefix = variant + " ";
+    for (const auto& name : list_directory(cache_root)) {
+        if (name == keep) continue;
+        std::string entry = path_join(cache_root, name);
+        std::ifstream in(path_join(entry, DEPS_FILENAME), std::ios::binary);
+        std::string version, origin;
+        if (!std::getline(in, version) || version != RUN_CACHE_VERSION || !std::getline(in, origin)) continue;
+        if (origin.compare(0, prefix.size(), prefix) != 0) continue;
+        in.close();
+        remove_tree(entry);
+        if (debug) fprintf(stderr, "%sevicted %s\n", RUN_TAG, entry.c_str());
+    }
+}
+
+// ============================================================================
+// Section 4: Compile (cache miss)
+// ============================================================================
+
+// Runs ctc-clang's dispatch on `args` and waits. POSIX forks first because
+// clang_launcher_main() ends in exec; on Windows a linked .exe always takes
+// its create-process-and-deploy path, which returns.
+static int run_clang_launcher(CompilerMode mode, const std::vector<std::string>& args) {
+    std::vector<std::string> owned = {mode == CompilerMode::CXX ? "ctc-clang++" : "ctc-clang"};
+    owned.insert(owned.end(), args.begin(), args.end());
+    std::vector<char*> argv;
+    for (auto& a : owned) argv.push_back(&a[0]);
+    argv.push_back(nullptr);
+#ifdef _WIN32
+    return clang_launcher_main((int)owned.size(), argv.data());
+#else
+    fflush(stdout);
+    fflush(stderr);
+    pid_t pid = fork();
+    if (pid == 0) _exit(clang_launcher_main((int)owned.size(), argv.data()));
+    if (pid < 0) {
+        fprintf(stderr, "%sFailed to fork\n", RUN_TAG);
+        return 1;
+    }
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+#endif
+}
+
+// Compiles into <entry>/<stem> and records the header closure. Returns the
+// path of the binary to run (the temp output if it could not be renamed over
+// a binary that is still running), or "" on failure.
+static std::string compile(const RunRequest& req, const std::string& content, const std::string& entry,
+                           const std::string& binary, const std::string& origin, bool debug) {
+    make_directories(entry);
+    std::string pid = std::to_string(current_pid());
+
+    // Blank the shebang to a comment so line numbers and directives survive.
+    std::string compile_source = req.source;
+    bool temp_source = false;
+    if (content.compare(0, 2, "#!") == 0) {
+        std::string ext = req.source.substr(req.source.size() - get_extension(req.source).size());
+        compile_source = path_join(req.source_dir, "." + req.stem + ".ctc-run." + pid + ext);
+        if (!write_file_atomic(compile_source, "//" + content)) {
+            fprintf(stderr, "%scannot write %s\n", RUN_TAG, compile_source.c_str());
+            return "";
+        }
+        temp_source = true;
+    }
+
+    std::string tmp_binary = binary + ".tmp." + pid;
+#ifdef _WIN32
+    tmp_binary += ".exe";
+#endif
+    std::string depfile = path_join(entry, "deps.d." + pid);
+    std::vector<std::string> args = {compile_source, "-o", tmp_binary};
+    args.insert(args.end(), req.flags.begin(), req.flags.end());
+    args.insert(args.end(), {"-MD", "-MF", depfile});
+    if (debug) {
+        fprintf(stderr, "%scompiling %s -> %s\n", RUN_TAG, req.source.c_str(), binary.c_str());
+    }
+    int rc = run_clang_launcher(req.mode, args);
+    if (temp_source) std::remove(compile_source.c_str());
+    if (rc != 0) {
+        std::remove(depfile.c_str());
+        std::remove(tmp_binary.c_str());
+        return "";
+    }
+
+    std::vector<DepEntry> deps;
+    std::string abs_compiled = absolute_path(compile_source);
+    for (const auto& dep : parse_depfile_prereqs(read_file(depfile))) {
+        std::string path = absolute_path(dep);
+        if (path == req.source || path == abs_compiled) continue;
+        DepEntry d;
+        Hash128 h;
+        if (!file_stamp(path, d.stamp) || !file_digest(path, h)) continue;
+        d.digest = h.hex();
+        d.path = path;
+        deps.push_back(std::move(d));
+    }
+    std::remove(depfile.c_str());
+
+    std::string run_path = binary;
+    if (!rename_into_place(tmp_binary, binary)) run_path = tmp_binary;
+    write_file_atomic(path_join(entry, DEPS_FILENAME), format_deps(origin, deps));
+    if (debug) fprintf(stderr, "%srecorded %zu headers\n", RUN_TAG, deps.size());
+    return run_path;
+}
+
+// ============================================================================
+// Section 5: main()
+// ============================================================================
+
+static void print_usage() {
+    printf("Usage: ctc-run [options] [compiler-flags] SOURCE [program-args...]\n\n");
+    printf("Builds a single C/C++ source with ctc-clang (once per content, flags and\n");
+    printf("headers) and runs it. Shebang: #!/usr/bin/env -S ctc-run [flags]\n\n");
+    printf("Options:\n");
+    printf("  --ctc-rebuild       Ignore the cached binary and compile again\n");
+    printf("  --ctc-which         Build if needed, print the cached binary path, don't run\n");
+    printf("  --ctc-help          Show this help\n\n");
+    printf("Environment:\n");
+    printf("  CLANG_TOOL_CHAIN_RUN_CACHE  Cache directory (default: ~/.clang-tool-chain/run-cache)\n");
+    printf("  CTC_DEBUG=1                 Report cache hits/misses on stderr\n");
+}
+
+int main(int argc, char* argv[]) {
+    bool debug = env_is_truthy("CTC_DEBUG");
+    RunRequest req;
+    std::string source_arg;
+
+    // Options and compiler flags precede SOURCE; everything after it belongs
+    // to the program, so scripts can take "-v" or "--" of their own.
+    int i = 1;
+    for (; i < argc && source_arg.empty(); i++) {
+        std::string arg = argv[i];
+        if (arg == "--ctc-help" || arg == "--help" || arg == "-h") { print_usage(); return 0; }
+        if (arg == "--ctc-rebuild") { req.rebuild = true; continue; }
+        if (arg == "--ctc-which") { req.which = true; continue; }
+        if (!arg.empty() && arg[0] == '-') { req.flags.push_back(arg); continue; }
+        source_arg = arg;
+    }
+    for (; i < argc; i++) req.program_args.push_back(argv[i]);
+    if (source_arg.empty()) {
+        print_usage();
+        return 2;
+    }
+
+    req.source = absolute_path(source_arg);
+    std::string content = read_file(req.source);
+    if (content.empty() && !path_exists(req.source)) {
+        fprintf(stderr, "%sSource file not found: %s\n", RUN_TAG, source_arg.c_str());
+        return 1;
+    }
+    size_t slash = req.source.find_last_of("/\\");
+    req.source_dir = slash == std::string::npos ? "." : req.source.substr(0, slash);
+    std::string name = req.source.substr(slash + 1);
+    req.stem = name.substr(0, name.size() - get_extension(name).size());
+    req.mode = is_cxx_source(req.source) ? CompilerMode::CXX : CompilerMode::C;
+
+    Platform platform = get_platform();
+    Arch arch = get_arch();
+    std::string install_dir = default_install_dir(platform, arch);
+
+    DirectiveResult directives;
+    if (!is_feature_disabled("DIRECTIVES")) {
+        directives = parse_directives_from_file(req.source, platform);
+        resolve_pkg_config_directives(directives, platform, arch);
+    }
+
+    std::string cache_root = get_env("CLANG_TOOL_CHAIN_RUN_CACHE");
+    if (cache_root.empty()) cache_root = path_join(get_ctc_home_dir(), "run-cache");
+    Hash128 variant_hash = variant_key(req, platform, arch);
+    std::string variant = variant_hash.hex();
+    std::string origin = variant + " " + req.source;
+    std::string key = cache_key(variant_hash, content, directives, install_dir).hex();
+    std::string entry = path_join(cache_root, key);
+    std::string binary = path_join(entry, req.stem);
+#ifdef _WIN32
+    binary += ".exe";
+#endif
+
+    std::string run_path;
+    if (!req.rebuild && path_exists(binary)) {
+        std::vector<DepEntry> deps;
+        std::string deps_path = path_join(entry, DEPS_FILENAME);
+        if (read_deps(deps_path, deps)) {
+            bool refreshed = false;
+            std::string changed = check_deps(deps, refreshed);
+            if (changed.empty()) {
+                if (refreshed) write_file_atomic(deps_path, format_deps(origin, deps));
+                run_path = binary;
+                if (debug) fprintf(stderr, "%scache hit: %s\n", RUN_TAG, binary.c_str());
+            } else if (debug) {
+                fprintf(stderr, "%scache miss: %s changed\n", RUN_TAG, changed.c_str());
+            }
+        }
+    } else if (debug) {
+        fprintf(stderr, "%scache miss: %s\n", RUN_TAG, req.rebuild ? "--ctc-rebuild" : "no cached binary");
+    }
+
+    if (run_path.empty()) {
+        run_path = compile(req, content, entry, binary, origin, debug);
+        if (run_path.empty()) return 1;
+        evict_superseded(cache_root, key, variant, debug);
+    }
+
+    if (req.which) {
+        printf("%s\n", run_path.c_str());
+        return 0;
+    }
+
+    // Same runtime environment ctc-clang sets up for sanitized links.
+    bool has_asan = false, has_fuzzer = false;
+    std::vector<std::string> all_flags = req.flags;
+    all_flags.insert(all_flags.end(), directives.compiler_args.begin(), directives.compiler_args.end());
+    for (const auto& f : all_flags) {
+        has_asan |= sanitizer_list_has(f, "address");
+        has_fuzzer |= sanitizer_list_has(f, "fuzzer");
+    }
+    if (has_asan || has_fuzzer) {
+        std::string cache_path = path_join(install_dir, CTC_CACHE_FILENAME);
+        CtcCache cache = read_cache(cache_path);
+        if (cache.is_valid()) setup_sanitizer_environment(cache, cache_path, has_asan, has_fuzzer, platform);
+    }
+    bool xray = env_is_truthy("CLANG_TOOL_CHAIN_XRAY");
+    for (const auto& f : req.flags) xray |= f == "-fxray-instrument";
+    for (const auto& f : directives.compiler_args) xray |= f == "-fxray-instrument";
+    if (xray && get_env("XRAY_OPTIONS").empty()) set_env("XRAY_OPTIONS", XRAY_DEFAULT_OPTIONS);
+
+    std::vector<std::string> cmd = {run_path};
+    cmd.insert(cmd.end(), req.program_args.begin(), req.program_args.end());
+    exec_process(cmd, RUN_TAG);
+}
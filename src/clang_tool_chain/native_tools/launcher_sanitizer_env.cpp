@@ -0,0 +1,154 @@
+// clang-tool-chain sanitizer runtime environment (ctc-sanitizer-env)
+//
+// Prints the environment sanitizer-instrumented programs need, resolved once
+// per toolchain and kept in the launcher cache (.ctc-cache), for test
+// harnesses to load once instead of every test process rediscovering it:
+//
+//   eval "$(ctc-sanitizer-env)"                   # sh/bash/zsh
+//   ctc-sanitizer-env --format env >> "$GITHUB_ENV"
+//   ctc-sanitizer-env --format json --suppressions lsan.supp
+//
+// Variables: ASAN_OPTIONS, LSAN_OPTIONS (plus suppressions=FILE), UBSAN_OPTIONS,
+// ASAN/UBSAN_SYMBOLIZER_PATH (bundled llvm-symbolizer), the runtime directories
+// prepended to LD_LIBRARY_PATH (PATH on Windows), and CTC_SANITIZER_ENV=<toolchain
+// fingerprint>. Values already in the environment win, as they do for
+// ctc-clang and build-run. With the marker set, ctc-clang, ctc-run and
+// build-run skip their own runtime-path setup, and running this again doesn't
+// prepend the directories twice.
+//
+// The runtime dirs and symbolizer come from clang_launcher.cpp's Section 8b
+// (#included with CTC_LAUNCHER_NO_MAIN, like launcher_run.cpp), recomputed
+// only when the toolchain fingerprint changes or with --refresh.
+//
+// Single-file C++17. Common utilities live in ctc_common.h.
+//
+// Build: clang++ -O3 -std=c++17 -o ctc-sanitizer-env launcher_sanitizer_env.cpp
+//   Linux:   add -static-libstdc++ -static-libgcc -lpthread
+//   Windows: add -static-libstdc++ -static-libgcc
+
+#define CTC_LAUNCHER_NO_MAIN
+#include "clang_launcher.cpp"  // provides CtcCache, resolve_sanitizer_env, SANITIZER_* defaults
+
+// ``using namespace ctc;`` comes from clang_launcher.cpp.
+
+// ============================================================================
+// Section 0: Tool-specific constants
+// ============================================================================
+
+static constexpr const char* ENV_TAG = "[ctc-sanitizer-env] ";
+
+// ============================================================================
+// Section 1: Output
+// ============================================================================
+
+// POSIX shell single-quoting: 'it'\''s'
+static std::string sh_quote(const std::string& s) {
+    std::string out = "'";
+    for (char c : s) {
+        if (c == '\'') out += "'\\''";
+        else out += c;
+    }
+    return out + "'";
+}
+
+static void print_usage() {
+    printf("Usage: ctc-sanitizer-env [--format sh|env|json] [--suppressions FILE] [--refresh]\n\n");
+    printf("Prints the sanitizer runtime environment (ASAN/LSAN/UBSAN options,\n");
+    printf("llvm-symbolizer, runtime library path) for the installed toolchain,\n");
+    printf("resolved once per toolchain and cached in .ctc-cache.\n\n");
+    printf("  --format sh         export statements for eval (default)\n");
+    printf("  --format env        KEY=VALUE lines (dotenv, $GITHUB_ENV)\n");
+    printf("  --format json       JSON object\n");
+    printf("  --suppressions F    Add suppressions=F to LSAN_OPTIONS\n");
+    printf("  --refresh           Re-resolve instead of using the cached result\n");
+    printf("  --help, -h          Show this help\n\n");
+    printf("Values already set in the environment are kept.\n");
+}
+
+// ============================================================================
+// Section 2: main()
+// ============================================================================
+
+int main(int argc, char* argv[]) {
+    std::string format = "sh", suppressions;
+    bool refresh = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h" || arg == "--ctc-help") {
+            print_usage();
+            return 0;
+        }
+        if (arg == "--refresh") { refresh = true; continue; }
+        if (arg == "--format" && i + 1 < argc) { format = argv[++i]; continue; }
+        if (arg == "--suppressions" && i + 1 < argc) { suppressions = argv[++i]; continue; }
+        fprintf(stderr, "%sUnknown option: %s\n", ENV_TAG, arg.c_str());
+        return 2;
+    }
+    if (format != "sh" && format != "env" && format != "json") {
+        fprintf(stderr, "%sUnknown format: %s (sh, env, json)\n", ENV_TAG, format.c_str());
+        return 2;
+    }
+    if (!suppressions.empty()) {
+        if (!path_exists(suppressions)) {
+            fprintf(stderr, "%ssuppression file not found: %s\n", ENV_TAG, suppressions.c_str());
+            return 1;
+        }
+        suppressions = absolute_path(suppressions);
+    }
+
+    // 1. Toolchain (installed by any ctc-clang run)
+    Platform platform = get_platform();
+    Arch arch = get_arch();
+    std::string install_dir = default_install_dir(platform, arch);
+    if (!path_exists(path_join(install_dir, DONE_FILENAME))) {
+        fprintf(stderr, "%sclang toolchain not installed in %s (run ctc-clang once, or "
+                        "clang-tool-chain install clang)\n", ENV_TAG, install_dir.c_str());
+        return 1;
+    }
+    std::string cache_path = path_join(install_dir, CTC_CACHE_FILENAME);
+    CtcCache cache = read_cache(cache_path);
+    if (!cache.is_valid()) cache = discover_and_write_cache(install_dir, cache_path, platform, arch);
+    resolve_sanitizer_env(cache, cache_path, platform, refresh);
+
+    // 2. Variables; the user's values win
+    std::vector<std::pair<std::string, std::string>> vars;
+    auto add = [&](const char* name, const std::string& value) {
+        std::string current = get_env(name);
+        if (!current.empty()) vars.push_back({name, current});
+        else if (!value.empty()) vars.push_back({name, value});
+    };
+    add("ASAN_OPTIONS", SANITIZER_ASAN_OPTIONS);
+#ifndef _WIN32
+    std::string lsan = get_env("LSAN_OPTIONS");
+    if (lsan.empty()) lsan = SANITIZER_LSAN_OPTIONS;
+    if (!suppressions.empty() && lsan.find("suppressions=" + suppressions) == std::string::npos) {
+        lsan += ":suppressions=" + suppressions;
+    }
+    vars.push_back({"LSAN_OPTIONS", lsan});
+#endif
+    add("UBSAN_OPTIONS", SANITIZER_UBSAN_OPTIONS);
+    add("ASAN_SYMBOLIZER_PATH", cache.sanitizer_symbolizer);
+    add("UBSAN_SYMBOLIZER_PATH", cache.sanitizer_symbolizer);
+    std::string runtime_path = get_env(RUNTIME_PATH_VAR);
+    if (!cache.sanitizer_lib_path.empty() && get_env(SANITIZER_ENV_MARKER) != cache.sanitizer_fingerprint) {
+        runtime_path = runtime_path.empty() ? cache.sanitizer_lib_path
+                                            : cache.sanitizer_lib_path + PATH_LIST_SEP + runtime_path;
+    }
+    if (!runtime_path.empty()) vars.push_back({RUNTIME_PATH_VAR, runtime_path});
+    vars.push_back({SANITIZER_ENV_MARKER, cache.sanitizer_fingerprint});
+
+    // 3. Output
+    if (format == "json") {
+        printf("{");
+        for (size_t i = 0; i < vars.size(); i++) {
+            printf("%s\n  \"%s\": \"%s\"", i ? "," : "", vars[i].first.c_str(), json_escape(vars[i].second).c_str());
+        }
+        printf("\n}\n");
+    } else {
+        for (const auto& kv : vars) {
+            if (format == "sh") printf("export %s=%s\n", kv.first.c_str(), sh_quote(kv.second).c_str());
+            else printf("%s=%s\n", kv.first.c_str(), kv.second.c_str());
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,255 @@
+// clang-tool-chain process start latency benchmark (ctc-startbench)
+//
+// Measures what a test binary pays before main() under each runtime profile
+// (CLANG_TOOL_CHAIN_RUNTIME, clang_launcher.cpp Section 5b): the dynamic
+// loader resolving libc++/libc++abi/libunwind (copy, runtime-dir) versus
+// nothing to resolve (static).
+//
+//   ctc-startbench                    build a small C++ probe with the sibling
+//                                     ctc-clang++ once per profile, then time
+//                                     spawn+wait of each
+//   ctc-startbench BIN...             time existing binaries instead
+//
+// Runs are interleaved across binaries (round-robin) so frequency scaling and
+// page-cache drift hit every profile alike; the first --warmup rounds are
+// discarded. stdout/stderr of the timed processes go to /dev/null.
+//
+// Single-file C++17. Common utilities live in ctc_common.h. Linux only (the
+// runtime profiles it compares are Linux only).
+//
+// Build: clang++ -O3 -std=c++17 -o ctc-startbench launcher_startbench.cpp
+//   Linux:   add -static-libstdc++ -static-libgcc -lpthread
+
+#include "ctc_common.h"
+
+#include <spawn.h>
+
+extern char** environ;
+
+using namespace ctc;
+
+// ============================================================================
+// Section 0: Tool-specific constants
+// ============================================================================
+
+static constexpr const char* CTC_TAG = "[ctc-startbench] ";
+
+// Touches the C++ runtime the way a typical test binary does: iostreams,
+// allocation, and one throw/catch through the unwinder.
+static constexpr const char* PROBE_SOURCE =
+    "#include <iostream>\n"
+    "#include <stdexcept>\n"
+    "#include <string>\n"
+    "int main(int argc, char**) {\n"
+    "    std::string s(argc + 16, 'x');\n"
+    "    try {\n"
+    "        throw std::runtime_error(s);\n"
+    "    } catch (const std::exception& e) {\n"
+    "        std::cout << e.what()[0] << '\\n';\n"
+    "    }\n"
+    "    return 0;\n"
+    "}\n";
+
+// ============================================================================
+// Section 1: Process spawning
+// ============================================================================
+
+// posix_spawn + waitpid; returns the exit code (-1 when the spawn failed).
+static int spawn_wait(const std::vector<std::string>& cmd, bool quiet) {
+    std::vector<char*> argv;
+    for (const auto& a : cmd) argv.push_back(const_cast<char*>(a.c_str()));
+    argv.push_back(nullptr);
+
+    posix_spawn_file_actions_t fa;
+    posix_spawn_file_actions_init(&fa);
+    if (quiet) {
+        posix_spawn_file_actions_addopen(&fa, 1, "/dev/null", O_WRONLY, 0);
+        posix_spawn_file_actions_addopen(&fa, 2, "/dev/null", O_WRONLY, 0);
+    }
+    pid_t pid = 0;
+    int err = posix_spawn(&pid, argv[0], &fa, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&fa);
+    if (err != 0) return -1;
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+}
+
+// ============================================================================
+// Section 2: Probe builds
+// ============================================================================
+
+struct Subject {
+    std::string name;  // profile name, or the path for user-supplied binaries
+    std::string path;
+    std::vector<double> us;  // per-run latency, microseconds
+};
+
+// Links the probe once per profile. Each profile gets its own subdirectory so
+// copy-mode deployment only sees its own output.
+static bool build_probes(const std::string& clangpp, const std::string& work,
+                         const std::vector<std::string>& profiles, const std::vector<std::string>& extra,
+                         std::vector<Subject>& out) {
+    std::string src = path_join(work, "probe.cpp");
+    if (!write_file_atomic(src, PROBE_SOURCE)) {
+        fprintf(stderr, "%scannot write %s\n", CTC_TAG, src.c_str());
+        return false;
+    }
+    for (const auto& profile : profiles) {
+        std::string dir = path_join(work, profile);
+        make_directory(dir);
+        std::string bin = path_join(dir, "probe");
+        std::vector<std::string> cmd = {clangpp, "-O2", "-stdlib=libc++", src, "-o", bin};
+        cmd.insert(cmd.end(), extra.begin(), extra.end());
+        if (profile == "copy") cmd.push_back("--deploy-dependencies");
+        set_env("CLANG_TOOL_CHAIN_RUNTIME", profile);
+        int rc = spawn_wait(cmd, false);
+        if (rc != 0) {
+            fprintf(stderr, "%sbuilding the %s probe failed (exit %d)\n", CTC_TAG, profile.c_str(), rc);
+            return false;
+        }
+        out.push_back({profile, bin, {}});
+    }
+    unset_env("CLANG_TOOL_CHAIN_RUNTIME");
+    return true;
+}
+
+// ============================================================================
+// Section 3: Measurement + report
+// ============================================================================
+
+static double percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    size_t i = (size_t)(p * (double)(v.size() - 1) + 0.5);
+    return v[std::min(i, v.size() - 1)];
+}
+
+static bool measure(std::vector<Subject>& subjects, int runs, int warmup) {
+    for (int round = 0; round < warmup + runs; round++) {
+        for (auto& s : subjects) {
+            auto t0 = std::chrono::steady_clock::now();
+            int rc = spawn_wait({s.path}, true);
+            double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+            if (rc != 0) {
+                fprintf(stderr, "%s%s exited with %d\n", CTC_TAG, s.path.c_str(), rc);
+                return false;
+            }
+            if (round >= warmup) s.us.push_back(us);
+        }
+    }
+    return true;
+}
+
+static void report(const std::vector<Subject>& subjects, int runs, bool json) {
+    double base = percentile(subjects[0].us, 0.5);
+    if (json) {
+        printf("{\n  \"runs\": %d,\n  \"results\": [", runs);
+        for (size_t i = 0; i < subjects.size(); i++) {
+            const auto& s = subjects[i];
+            double med = percentile(s.us, 0.5);
+            printf("%s\n    {\"name\": \"%s\", \"path\": \"%s\", \"min_us\": %.1f, \"median_us\": %.1f, "
+                   "\"p90_us\": %.1f, \"speedup\": %.2f}",
+                   i ? "," : "", json_escape(s.name).c_str(), json_escape(s.path).c_str(), percentile(s.us, 0.0),
+                   med, percentile(s.us, 0.9), med > 0 ? base / med : 0.0);
+        }
+        printf("\n  ]\n}\n");
+        return;
+    }
+    printf("ctc-startbench: %d runs each, spawn to exit\n", runs);
+    printf("  %-24s %10s %10s %10s %8s\n", "", "min", "median", "p90", "speedup");
+    for (const auto& s : subjects) {
+        double med = percentile(s.us, 0.5);
+        printf("  %-24s %8.0fus %8.0fus %8.0fus %7.2fx\n", s.name.c_str(), percentile(s.us, 0.0), med,
+               percentile(s.us, 0.9), med > 0 ? base / med : 0.0);
+    }
+}
+
+// ============================================================================
+// Section 4: main()
+// ============================================================================
+
+static void print_usage() {
+    printf("Usage: ctc-startbench [options] [BIN...]\n\n");
+    printf("Process start latency per runtime profile (CLANG_TOOL_CHAIN_RUNTIME).\n");
+    printf("Without BIN, builds a C++ probe with ctc-clang++ once per profile.\n\n");
+    printf("Options:\n");
+    printf("  --runs N            Timed runs per binary (default: 200)\n");
+    printf("  --warmup N          Untimed rounds first (default: 10)\n");
+    printf("  --profiles LIST     Comma-separated profiles to build (default: copy,static)\n");
+    printf("  --flag FLAG         Extra flag for the probe builds (repeatable, e.g. -fsanitize=address)\n");
+    printf("  --clang PATH        ctc-clang++ to build with (default: next to ctc-startbench)\n");
+    printf("  --keep              Keep the probe build directory\n");
+    printf("  --json              JSON output\n");
+    printf("  --help, -h          Show this help\n");
+}
+
+int main(int argc, char* argv[]) {
+    int runs = 200, warmup = 10;
+    bool json = false, keep = false;
+    std::string clangpp;
+    std::vector<std::string> profiles = {"copy", "static"};
+    std::vector<std::string> extra;
+    std::vector<Subject> subjects;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h" || arg == "--ctc-help") { print_usage(); return 0; }
+        if (arg == "--json") { json = true; continue; }
+        if (arg == "--keep") { keep = true; continue; }
+        if (arg == "--runs" && i + 1 < argc) { runs = std::max(1, atoi(argv[++i])); continue; }
+        if (arg == "--warmup" && i + 1 < argc) { warmup = std::max(0, atoi(argv[++i])); continue; }
+        if (arg == "--clang" && i + 1 < argc) { clangpp = argv[++i]; continue; }
+        if (arg == "--flag" && i + 1 < argc) { extra.push_back(argv[++i]); continue; }
+        if (arg == "--profiles" && i + 1 < argc) {
+            profiles.clear();
+            std::stringstream ss(argv[++i]);
+            std::string p;
+            while (std::getline(ss, p, ',')) {
+                if (p != "copy" && p != "runtime-dir" && p != "static") {
+                    fprintf(stderr, "%sUnknown profile: %s (copy, runtime-dir, static)\n", CTC_TAG, p.c_str());
+                    return 2;
+                }
+                profiles.push_back(p);
+            }
+            continue;
+        }
+        if (arg.size() > 1 && arg[0] == '-') {
+            fprintf(stderr, "%sUnknown option: %s\n", CTC_TAG, arg.c_str());
+            return 2;
+        }
+        subjects.push_back({arg, arg, {}});
+    }
+
+    std::string work;
+    if (subjects.empty()) {
+        if (profiles.empty()) {
+            print_usage();
+            return 2;
+        }
+        if (clangpp.empty()) clangpp = path_join(get_exe_dir(), "ctc-clang++");
+        if (!path_exists(clangpp)) {
+            fprintf(stderr, "%s%s not found (use --clang PATH)\n", CTC_TAG, clangpp.c_str());
+            return 1;
+        }
+        work = make_work_dir("ctc-startbench");
+        if (work.empty()) {
+            fprintf(stderr, "%scannot create a temp directory\n", CTC_TAG);
+            return 1;
+        }
+        if (!build_probes(clangpp, work, profiles, extra, subjects)) return 1;
+    }
+
+    int rc = measure(subjects, runs, warmup) ? 0 : 1;
+    if (rc == 0) report(subjects, runs, json);
+
+    if (!work.empty()) {
+        if (keep) {
+            fprintf(stderr, "%sprobes kept in %s\n", CTC_TAG, work.c_str());
+        } else {
+            remove_tree(work);
+        }
+    }
+    return rc;
+}
@@ -2,10 +2,11 @@
 // Replaces the Python wasm-ld wrapper with near-zero startup overhead.
 // wasm-ld is a native binary — this launcher bypasses Python entirely.
 //
-// Strategy: On first run (cache miss), invoke Python ONCE to discover the
-// wasm-ld binary path via the clang_tool_chain package (which handles
-// downloading and installation). Cache the result. All subsequent runs
-// read the cache and exec wasm-ld directly — zero Python/Node overhead.
+// Strategy: On first run (cache miss), resolve wasm-ld from the emscripten
+// install layout (LLVM_ROOT in .emscripten) and cache the result. Python is
+// invoked only when the install is missing, because the clang_tool_chain
+// package is what downloads it. All subsequent runs read the cache and exec
+// wasm-ld directly — zero Python/Node overhead.
 //
 // Single-file C++17. Common utilities live in ctc_common.h.
 //
@@ -47,7 +48,7 @@ static WasmLdCache read_cache(const std::string& cache_path) {
 }
 
 // ============================================================================
-// Section 2: One-Shot Python Discovery
+// Section 2: Discovery (native, one-shot Python fallback)
 // ============================================================================
 
 // Python one-liner: discovers wasm-ld path via clang_tool_chain.
@@ -91,6 +92,26 @@ static WasmLdCache discover_via_python(const std::string& cache_path) {
     return cache;
 }
 
+// Cache miss: LLVM_ROOT/wasm-ld from the on-disk layout; Python only when the
+// install is missing or incomplete.
+static WasmLdCache discover(const std::string& cache_path) {
+    EmscriptenLayout em;
+    std::string why;
+    if (discover_emscripten_native(get_platform(), get_arch(), /*need_node=*/false, em, why)) {
+        WasmLdCache cache;
+        cache.wasm_ld_path = path_join(em.bin_dir, get_platform() == Platform::Windows ? "wasm-ld.exe" : "wasm-ld");
+        if (cache.is_valid()) {
+            write_file_atomic(cache_path, "wasm_ld_path=" + cache.wasm_ld_path + "\n");
+            return cache;
+        }
+        why = "wasm-ld not found in " + em.bin_dir;
+    }
+    if (env_is_truthy("CTC_DEBUG")) {
+        fprintf(stderr, "[ctc-wasm-ld-debug] native discovery failed: %s\n", why.c_str());
+    }
+    return discover_via_python(cache_path);
+}
+
 // ============================================================================
 // Section 3: main()
 // ============================================================================
@@ -125,17 +146,15 @@ int main(int argc, char* argv[]) {
     }
 
     // 1. Resolve cache path
-    std::string home = get_home_dir();
-    std::string install_dir = path_join(home, ".clang-tool-chain");
-    install_dir = path_join(install_dir, "emscripten");
+    std::string install_dir = path_join(get_ctc_home_dir(), "emscripten");
     install_dir = path_join(install_dir, platform_str(platform));
     install_dir = path_join(install_dir, arch_str(arch));
     std::string cache_path = path_join(install_dir, CACHE_FILENAME);
 
-    // 2. Read cache or discover via Python (one-time)
+    // 2. Read cache or discover (one-time)
     WasmLdCache cache = read_cache(cache_path);
     if (!cache.is_valid()) {
-        cache = discover_via_python(cache_path);
+        cache = discover(cache_path);
     }
 
     if (debug) {
@@ -150,7 +169,9 @@ int main(int argc, char* argv[]) {
         cmd.push_back(argv[i]);
     }
 
-    // 4. Exec (replaces this process — no Python, no Node, pure native)
+    // 4. Exec (replaces this process — no Python, no Node, pure native).
+    //    The ctc-top slot follows the pid into wasm-ld.
     if (dry_run) { print_command(cmd); return 0; }
+    TopRegistration::self().claim("wasm-ld", guess_invocation_target(argc, argv), "link");
     exec_process(cmd, CTC_TAG);
 }
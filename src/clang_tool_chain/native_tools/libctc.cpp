@@ -0,0 +1,122 @@
+// clang-tool-chain embeddable launcher library (libctc)
+//
+// Exposes ctc-clang's command computation — cache loading, directive parsing,
+// platform flag injection and final command assembly — through the C ABI in
+// libctc.h, so build executors can compute thousands of commands in-process
+// instead of spawning `ctc-clang --dry-run` for each.
+//
+// The logic is clang_launcher.cpp itself, #included with CTC_LAUNCHER_NO_MAIN
+// (the same way launcher_clang_tool.cpp embeds it), so the library cannot
+// drift from the launcher. Everything else stays hidden; only the ctc_*
+// functions are exported.
+//
+// Shared: built by compile-native as libctc.so / libctc.dylib / libctc.dll.
+// Static: compile this file into your program with -DLIBCTC_STATIC.
+//
+// Build: clang++ -O3 -std=c++17 -shared -fPIC -fvisibility=hidden
+//          -o libctc.so libctc.cpp
+//   Linux:   add -static-libstdc++ -static-libgcc -lpthread
+//   Windows: add -static-libstdc++ -static-libgcc
+
+#define LIBCTC_BUILD
+#include "libctc.h"
+
+#define CTC_LAUNCHER_NO_MAIN
+#include "clang_launcher.cpp"  // provides compute_final_command + CtcCache
+
+#include <new>
+
+// ============================================================================
+// Section 1: Opaque handles
+// ============================================================================
+
+struct ctc_context {
+    CtcCache cache;
+    Platform platform;
+    Arch arch;
+};
+
+struct ctc_command {
+    std::vector<std::string> args;
+    std::vector<const char*> argv;  // args' c_str()s + nullptr
+};
+
+// ============================================================================
+// Section 2: C API
+// ============================================================================
+
+extern "C" {
+
+CTC_API int ctc_api_version(void) { return CTC_API_VERSION; }
+
+CTC_API const char* ctc_status_string(ctc_status status) {
+    switch (status) {
+    case CTC_OK: return "ok";
+    case CTC_ERR_INVALID_ARGUMENT: return "invalid argument";
+    case CTC_ERR_NOT_INSTALLED: return "clang toolchain not installed (run: clang-tool-chain install clang)";
+    case CTC_ERR_INTERNAL: return "internal error";
+    }
+    return "unknown status";
+}
+
+CTC_API ctc_status ctc_context_new(const char* install_dir, ctc_context** out) {
+    if (!out) return CTC_ERR_INVALID_ARGUMENT;
+    *out = nullptr;
+    try {
+        // Library callers own stderr; the per-invocation notes are for the CLI.
+        g_notes_muted = true;
+        auto ctx = std::unique_ptr<ctc_context>(new ctc_context());
+        ctx->platform = get_platform();
+        ctx->arch = get_arch();
+        std::string dir = install_dir && *install_dir ? std::string(install_dir)
+                                                      : default_install_dir(ctx->platform, ctx->arch);
+        if (!path_exists(path_join(dir, DONE_FILENAME))) return CTC_ERR_NOT_INSTALLED;
+        std::string cache_path = path_join(dir, CTC_CACHE_FILENAME);
+        ctx->cache = read_cache(cache_path);
+        if (!ctx->cache.is_valid()) {
+            ctx->cache = discover_and_write_cache(dir, cache_path, ctx->platform, ctx->arch);
+        }
+        if (!ctx->cache.is_valid()) return CTC_ERR_NOT_INSTALLED;
+        *out = ctx.release();
+        return CTC_OK;
+    } catch (...) {
+        return CTC_ERR_INTERNAL;
+    }
+}
+
+CTC_API void ctc_context_free(ctc_context* ctx) { delete ctx; }
+
+CTC_API const char* ctc_context_clang_path(const ctc_context* ctx, int cxx) {
+    if (!ctx) return nullptr;
+    return cxx ? ctx->cache.clangpp_bin.c_str() : ctx->cache.clang_bin.c_str();
+}
+
+CTC_API ctc_status ctc_compute_command(const ctc_context* ctx, int argc, const char* const* argv,
+                                       const char* directory, ctc_command** out) {
+    if (!out) return CTC_ERR_INVALID_ARGUMENT;
+    *out = nullptr;
+    if (!ctx || argc < 1 || !argv) return CTC_ERR_INVALID_ARGUMENT;
+    for (int i = 0; i < argc; i++) {
+        if (!argv[i]) return CTC_ERR_INVALID_ARGUMENT;
+    }
+    try {
+        auto cmd = std::unique_ptr<ctc_command>(new ctc_command());
+        cmd->args = compute_final_command(ctx->cache, std::vector<std::string>(argv, argv + argc),
+                                          directory ? directory : "", ctx->platform, ctx->arch);
+        cmd->argv.reserve(cmd->args.size() + 1);
+        for (const auto& a : cmd->args) cmd->argv.push_back(a.c_str());
+        cmd->argv.push_back(nullptr);
+        *out = cmd.release();
+        return CTC_OK;
+    } catch (...) {
+        return CTC_ERR_INTERNAL;
+    }
+}
+
+CTC_API size_t ctc_command_argc(const ctc_command* cmd) { return cmd ? cmd->args.size() : 0; }
+
+CTC_API const char* const* ctc_command_argv(const ctc_command* cmd) { return cmd ? cmd->argv.data() : nullptr; }
+
+CTC_API void ctc_command_free(ctc_command* cmd) { delete cmd; }
+
+} // extern "C"
@@ -0,0 +1,91 @@
+/* libctc — in-process ctc-clang command computation (stable C ABI).
+ *
+ * Computes the exact command ctc-clang / ctc-clang++ would exec for a given
+ * argv (bundled sysroot, inlined directives, platform flags), without
+ * spawning a launcher. Built from clang_launcher.cpp by libctc.cpp; see
+ * docs/CLANG_LLVM.md for build and usage notes.
+ *
+ * Threading: a ctc_context is immutable after ctc_context_new(), so any
+ * number of threads may call ctc_compute_command() on the same context
+ * concurrently. ctc_command objects belong to the caller. Sources with an
+ * @pkg-config directive may read .pc files, run pkg-config once for packages
+ * it can't find and write ~/.clang-tool-chain/pkg-config-cache; that is safe
+ * concurrently too, and libctc prints nothing for unknown packages.
+ *
+ * ABI: only the functions below are exported. New functions may be added;
+ * existing signatures and status codes do not change within a major
+ * CTC_API_VERSION.
+ */
+
+#ifndef LIBCTC_H
+#define LIBCTC_H
+
+#include <stddef.h>
+
+#if defined(LIBCTC_STATIC)
+#define CTC_API
+#elif defined(_WIN32) && defined(LIBCTC_BUILD)
+#define CTC_API __declspec(dllexport)
+#elif defined(_WIN32)
+#define CTC_API __declspec(dllimport)
+#elif defined(__GNUC__)
+#define CTC_API __attribute__((visibility("default")))
+#else
+#define CTC_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CTC_API_VERSION 1
+
+typedef enum ctc_status {
+    CTC_OK = 0,
+    CTC_ERR_INVALID_ARGUMENT = 1, /* NULL pointer, empty argv */
+    CTC_ERR_NOT_INSTALLED = 2,    /* no toolchain at the install dir (done.txt missing) */
+    CTC_ERR_INTERNAL = 3          /* out of memory or another unexpected failure */
+} ctc_status;
+
+typedef struct ctc_context ctc_context;
+typedef struct ctc_command ctc_command;
+
+/* CTC_API_VERSION of the loaded library. */
+CTC_API int ctc_api_version(void);
+
+/* Short description of a status code (static string). */
+CTC_API const char* ctc_status_string(ctc_status status);
+
+/* Load (or discover and write) the toolchain path cache once.
+ * install_dir: NULL for the directory ctc-clang uses
+ * (<ctc_home>/clang/<platform>/<arch>, honors CLANG_TOOL_CHAIN_DOWNLOAD_PATH).
+ * Never installs anything. */
+CTC_API ctc_status ctc_context_new(const char* install_dir, ctc_context** out);
+
+CTC_API void ctc_context_free(ctc_context* ctx);
+
+/* Path of the clang (cxx == 0) or clang++ (cxx != 0) binary the context uses.
+ * Valid until ctc_context_free(). */
+CTC_API const char* ctc_context_clang_path(const ctc_context* ctx, int cxx);
+
+/* Compute the command for argv[0..argc). argv[0] selects clang vs clang++ the
+ * way the ctc-clang / ctc-clang++ names do; launcher-only flags (--dry-run,
+ * --deploy-dependencies) are dropped. directory: where the command will run,
+ * used to find sources for directive parsing (NULL = current directory).
+ * Inlined-directive notes are never printed. */
+CTC_API ctc_status ctc_compute_command(const ctc_context* ctx, int argc, const char* const* argv,
+                                       const char* directory, ctc_command** out);
+
+/* Number of arguments, including the compiler path at index 0. */
+CTC_API size_t ctc_command_argc(const ctc_command* cmd);
+
+/* NULL-terminated argument vector; valid until ctc_command_free(). */
+CTC_API const char* const* ctc_command_argv(const ctc_command* cmd);
+
+CTC_API void ctc_command_free(ctc_command* cmd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LIBCTC_H */
@@ -18,8 +18,10 @@ import pytest
 from clang_tool_chain.execution.sanitizer_env import (
     DEFAULT_ASAN_OPTIONS,
     DEFAULT_LSAN_OPTIONS,
+    DEFAULT_XRAY_OPTIONS,
     _get_builtin_suppression_file,
     detect_sanitizers_from_flags,
+    detect_xray_from_flags,
     get_all_sanitizer_runtime_dlls,
     get_asan_runtime_dll,
     get_runtime_dll_paths,
@@ -336,6 +338,66 @@ class TestSanitizerEnvironmentInjection:
         assert "ASAN_OPTIONS" not in result
         assert "LSAN_OPTIONS" not in result
 
+    def test_xray_options_injected_when_xray_enabled(self):
+        """Test that XRAY_OPTIONS is injected for -fxray-instrument builds only."""
+        base_env = {"PATH": "/usr/bin"}
+
+        result = prepare_sanitizer_environment(base_env, compiler_flags=["-O2", "-fxray-instrument"])
+
+        assert result["XRAY_OPTIONS"] == DEFAULT_XRAY_OPTIONS
+        assert "ASAN_OPTIONS" not in result
+        assert "XRAY_OPTIONS" not in prepare_sanitizer_environment(base_env, compiler_flags=["-fsanitize=address"])
+
+    def test_xray_options_preserved_when_user_specified(self):
+        """Test that user-specified XRAY_OPTIONS is preserved."""
+        base_env = {"PATH": "/usr/bin", "XRAY_OPTIONS": "patch_premain=false"}
+
+        result = prepare_sanitizer_environment(base_env, compiler_flags=["-fxray-instrument"])
+
+        assert result["XRAY_OPTIONS"] == "patch_premain=false"
+
+    def test_runtime_paths_not_prepended_when_sanitizer_env_loaded(self, tmp_path):
+        """Test that CTC_SANITIZER_ENV (from ctc-sanitizer-env) skips runtime path discovery."""
+        (tmp_path / ".ctc-cache").write_text("clang_root=/toolchain\nsanitizer_fingerprint=0123abcd\n")
+        base_env = {"PATH": "/usr/bin", "LD_LIBRARY_PATH": "/toolchain/lib", "CTC_SANITIZER_ENV": "0123abcd"}
+
+        with (
+            patch("clang_tool_chain.execution.sanitizer_env.platform.system", return_value="Linux"),
+            patch("clang_tool_chain.path_utils.get_install_dir", return_value=tmp_path),
+            patch("clang_tool_chain.execution.sanitizer_env.get_runtime_lib_paths") as mock_paths,
+        ):
+            result = prepare_sanitizer_environment(base_env, compiler_flags=["-fsanitize=address"])
+
+        mock_paths.assert_not_called()
+        assert result["LD_LIBRARY_PATH"] == "/toolchain/lib"
+        assert "ASAN_OPTIONS" in result
+
+    def test_stale_sanitizer_env_marker_is_ignored(self, tmp_path):
+        """Test that a CTC_SANITIZER_ENV from another toolchain still gets runtime paths."""
+        (tmp_path / ".ctc-cache").write_text("sanitizer_fingerprint=fedcba98\n")
+        base_env = {"PATH": "/usr/bin", "CTC_SANITIZER_ENV": "0123abcd"}
+
+        with (
+            patch("clang_tool_chain.execution.sanitizer_env.platform.system", return_value="Linux"),
+            patch("clang_tool_chain.path_utils.get_install_dir", return_value=tmp_path),
+            patch(
+                "clang_tool_chain.execution.sanitizer_env.get_runtime_lib_paths", return_value=["/toolchain/lib"]
+            ) as mock_paths,
+        ):
+            result = prepare_sanitizer_environment(base_env, compiler_flags=["-fsanitize=address"])
+            (tmp_path / ".ctc-cache").unlink()
+            no_cache = prepare_sanitizer_environment(base_env, compiler_flags=["-fsanitize=address"])
+
+        assert mock_paths.call_count == 2
+        assert result["LD_LIBRARY_PATH"].split(os.pathsep)[0] == "/toolchain/lib"
+        assert no_cache["LD_LIBRARY_PATH"].split(os.pathsep)[0] == "/toolchain/lib"
+
+    def test_detect_xray_last_flag_wins(self):
+        """Test that -fno-xray-instrument after -fxray-instrument disables it."""
+        assert detect_xray_from_flags(["-fxray-instrument"])
+        assert not detect_xray_from_flags(["-fxray-instrument", "-fno-xray-instrument"])
+        assert not detect_xray_from_flags(["-O2"])
+
 
 class TestGetSymbolizerPath:
     """Test get_symbolizer_path() function."""
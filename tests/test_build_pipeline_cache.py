@@ -0,0 +1,139 @@
+"""
+Unit tests for the dependency-aware --cached mode of the build pipeline.
+
+Uses a pipeline whose _compile() writes the output and a Make-syntax
+dependency file itself, so the cache logic is exercised without a toolchain.
+
+Tests cover:
+- _parse_depfile: continuations, escaped spaces, $$, phony targets
+- Cache record: source hash first line, flags signature, dep lines
+- Header edits invalidate; touching a header without editing it does not
+- Flag changes and records from older versions (hash only) invalidate
+"""
+
+import os
+import tempfile
+import unittest
+from pathlib import Path
+
+from clang_tool_chain.execution.build_pipeline import BuildConfig, BuildPipeline, _parse_depfile
+
+
+class _FakePipeline(BuildPipeline):
+    """Compiles by writing the output and a depfile listing self.headers."""
+
+    headers: list[Path] = []
+    compiles = 0
+
+    def _compile(self) -> int:
+        _FakePipeline.compiles += 1
+        args = self._depfile_args()
+        self.output_path.write_text("binary", encoding="utf-8")
+        if args:
+            deps = " \\\n  ".join(str(h).replace(" ", "\\ ") for h in [self.source_path, *self.headers])
+            Path(args[2]).write_text(f"{self.output_path}: {deps}\n", encoding="utf-8")
+        return 0
+
+
+class TestParseDepfile(unittest.TestCase):
+    def test_continuations_and_escapes(self):
+        text = "out.o: main.cpp \\\n  inc/a\\ b.h \\\n  lib$$x.h\nout.o: main.cpp\n"
+        self.assertEqual(_parse_depfile(text), ["main.cpp", "inc/a b.h", "lib$x.h"])
+
+    def test_phony_targets_dropped(self):
+        text = "out.o: main.cpp a.h\n\na.h:\n"
+        self.assertEqual(_parse_depfile(text), ["main.cpp", "a.h"])
+
+    def test_windows_drive_letters(self):
+        text = "C:\\b\\out.o: C:\\src\\main.cpp C:\\src\\a.h\n"
+        self.assertEqual(_parse_depfile(text), ["C:\\src\\main.cpp", "C:\\src\\a.h"])
+
+
+class TestDependencyAwareCache(unittest.TestCase):
+    def setUp(self):
+        self.temp_dir = tempfile.mkdtemp()
+        self.root = Path(self.temp_dir)
+        self.source = self.root / "main.cpp"
+        self.source.write_text('#include "dir with space/config.h"\nint main() { return 0; }\n', encoding="utf-8")
+        (self.root / "dir with space").mkdir()
+        self.header = self.root / "dir with space" / "config.h"
+        self.header.write_text("#define VALUE 1\n", encoding="utf-8")
+        _FakePipeline.headers = [self.header]
+        _FakePipeline.compiles = 0
+
+    def tearDown(self):
+        import shutil
+
+        shutil.rmtree(self.temp_dir, ignore_errors=True)
+
+    def _pipeline(self, flags: list[str] | None = None) -> _FakePipeline:
+        config = BuildConfig(
+            source_file=str(self.source),
+            output_file=str(self.root / "main"),
+            compiler_flags=flags or [],
+            use_cache=True,
+        )
+        return _FakePipeline(config)
+
+    def _build(self, flags: list[str] | None = None) -> bool:
+        """Returns True on a cache hit, False when it compiled."""
+        p = self._pipeline(flags)
+        if p._check_cache():
+            return True
+        self.assertEqual(p._compile(), 0)
+        p._update_cache()
+        self.assertFalse(p.dep_file is not None and p.dep_file.exists(), "depfile should be removed")
+        return False
+
+    def test_record_lists_header_closure(self):
+        self.assertFalse(self._build())
+        lines = (self.root / "main.hash").read_text(encoding="utf-8").splitlines()
+        self.assertEqual(len(lines[0]), 64)
+        self.assertTrue(lines[1].startswith("flags "))
+        self.assertEqual(len(lines), 3)
+        self.assertTrue(lines[2].startswith("dep ") and lines[2].endswith(str(self.header)))
+
+    def test_header_edit_invalidates(self):
+        self.assertFalse(self._build())
+        self.assertTrue(self._build())
+        self.header.write_text("#define VALUE 2\n", encoding="utf-8")
+        self.assertFalse(self._build())
+        self.assertTrue(self._build())
+        self.assertEqual(_FakePipeline.compiles, 2)
+
+    def test_touched_header_revalidates_by_hash(self):
+        self.assertFalse(self._build())
+        record = (self.root / "main.hash").read_text(encoding="utf-8")
+        st = self.header.stat()
+        os.utime(self.header, ns=(st.st_atime_ns, st.st_mtime_ns + 5_000_000_000))
+        self.assertTrue(self._build())
+        refreshed = (self.root / "main.hash").read_text(encoding="utf-8")
+        self.assertNotEqual(record, refreshed, "stat stamps should be refreshed after a hash match")
+        self.assertEqual(record.splitlines()[0], refreshed.splitlines()[0])
+
+    def test_removed_header_invalidates(self):
+        self.assertFalse(self._build())
+        self.header.unlink()
+        _FakePipeline.headers = []
+        self.assertFalse(self._build())
+
+    def test_flag_change_invalidates(self):
+        self.assertFalse(self._build(["-O2"]))
+        self.assertTrue(self._build(["-O2"]))
+        self.assertFalse(self._build(["-O0"]))
+
+    def test_hash_only_record_recompiles_once(self):
+        from clang_tool_chain.execution.build_pipeline import _compute_file_hash
+
+        (self.root / "main").write_text("binary", encoding="utf-8")
+        (self.root / "main.hash").write_text(_compute_file_hash(self.source), encoding="utf-8")
+        self.assertFalse(self._build())
+        self.assertTrue(self._build())
+
+    def test_user_dependency_flags_are_respected(self):
+        p = self._pipeline(["-MMD"])
+        self.assertEqual(p._depfile_args(), [])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,165 @@
+"""
+Tests for ``clang-tool-chain cache export`` / ``cache import``.
+
+Tests cover:
+- Round trip of launcher path caches and .ctc-emcc-args with ${CTC_HOME} rewriting
+- Content deduplication in the bundle
+- Toolchain fingerprint validation (and --force)
+- Merge policies for files that already exist
+- Extra NAME=PATH roots with import-time relocation
+"""
+
+import json
+import tarfile
+from pathlib import Path
+
+import pytest
+
+pytest.importorskip("pyzstd")
+
+from clang_tool_chain.commands.cache_bundle import (  # noqa: E402
+    HOME_TOKEN,
+    export_bundle,
+    import_bundle,
+    resolve_roots,
+    toolchain_fingerprint,
+)
+
+
+def _make_home(home: Path, done_sha: str = "abc") -> Path:
+    """Create a fake toolchain home with one emscripten install and its caches."""
+    install = home / "emscripten" / "linux" / "x86_64"
+    install.mkdir(parents=True)
+    (install / "done.txt").write_text(f"emscripten 4.0 installed successfully\nSHA256: {done_sha}\n")
+    (install / ".ctc-emcc-paths").write_text(f"python_path=/usr/bin/python3\nemcc_script={install}/emscripten/emcc.py\n")
+    args = install / ".ctc-emcc-args"
+    args.mkdir()
+    (args / "1111.args").write_text(json.dumps([f"{install}/bin/clang", "-c"]))
+    (args / "2222.args").write_text(json.dumps([f"{install}/bin/clang", "-c"]))
+    return install
+
+
+def _read_index(bundle: Path) -> dict:
+    import pyzstd
+
+    with pyzstd.ZstdFile(bundle, "rb") as zf, tarfile.open(fileobj=zf, mode="r|") as tar:
+        member = tar.next()
+        assert member is not None and member.name == "index.json"
+        f = tar.extractfile(member)
+        assert f is not None
+        return json.loads(f.read())
+
+
+class TestExport:
+    def test_paths_are_tokenized_and_deduplicated(self, tmp_path: Path) -> None:
+        home = tmp_path / "home"
+        _make_home(home)
+        bundle = tmp_path / "out" / "cache.tar.zst"
+
+        index = export_bundle(bundle, resolve_roots(["paths", "emcc-args"], []), home=home)
+
+        assert bundle.is_file()
+        rels = sorted(f["rel"] for f in index["files"])
+        assert rels == [
+            "emscripten/linux/x86_64/.ctc-emcc-args/1111.args",
+            "emscripten/linux/x86_64/.ctc-emcc-args/2222.args",
+            "emscripten/linux/x86_64/.ctc-emcc-paths",
+        ]
+        # The two identical .args files share one object.
+        assert index["objects"] == 2
+        assert "emscripten/linux/x86_64" in index["fingerprint"]
+        assert _read_index(bundle)["files"] == index["files"]
+
+    def test_unknown_root_rejected(self) -> None:
+        with pytest.raises(ValueError):
+            resolve_roots(["nope"], [])
+        with pytest.raises(ValueError):
+            resolve_roots([], ["missing-equals"])
+
+
+class TestImport:
+    def test_round_trip_relocates_home(self, tmp_path: Path) -> None:
+        src_home = tmp_path / "runner-a"
+        _make_home(src_home)
+        bundle = tmp_path / "cache.tar.zst"
+        export_bundle(bundle, resolve_roots(["paths", "emcc-args"], []), home=src_home)
+
+        dst_home = tmp_path / "runner-b"
+        dst_install = dst_home / "emscripten" / "linux" / "x86_64"
+        dst_install.mkdir(parents=True)
+        (dst_install / "done.txt").write_bytes((src_home / "emscripten/linux/x86_64/done.txt").read_bytes())
+
+        _, stats = import_bundle(bundle, home=dst_home)
+
+        assert stats.written == 3
+        paths = (dst_install / ".ctc-emcc-paths").read_text()
+        assert str(dst_install) in paths
+        assert str(src_home) not in paths
+        assert HOME_TOKEN not in paths
+        args = json.loads((dst_install / ".ctc-emcc-args" / "2222.args").read_text())
+        assert args[0] == f"{dst_install}/bin/clang"
+
+    def test_fingerprint_mismatch_skips_unless_forced(self, tmp_path: Path) -> None:
+        src_home = tmp_path / "a"
+        _make_home(src_home, done_sha="old")
+        bundle = tmp_path / "cache.tar.zst"
+        export_bundle(bundle, resolve_roots(["paths"], []), home=src_home)
+
+        dst_home = tmp_path / "b"
+        dst_install = dst_home / "emscripten" / "linux" / "x86_64"
+        dst_install.mkdir(parents=True)
+        (dst_install / "done.txt").write_text("emscripten 4.1 installed successfully\nSHA256: new\n")
+        assert toolchain_fingerprint(dst_home) != toolchain_fingerprint(src_home)
+
+        _, stats = import_bundle(bundle, home=dst_home)
+        assert stats.written == 0
+        assert stats.skipped_fingerprint == 1
+        assert not (dst_install / ".ctc-emcc-paths").exists()
+
+        _, stats = import_bundle(bundle, home=dst_home, force=True)
+        assert stats.written == 1
+
+    def test_conflict_policies(self, tmp_path: Path) -> None:
+        home = tmp_path / "home"
+        install = _make_home(home)
+        bundle = tmp_path / "cache.tar.zst"
+        export_bundle(bundle, resolve_roots(["paths"], []), home=home)
+
+        target = install / ".ctc-emcc-paths"
+        target.write_text("local=1\n")
+
+        _, stats = import_bundle(bundle, home=home)
+        assert stats.kept == 1
+        assert target.read_text() == "local=1\n"
+
+        # Local copy is newer than the bundled one, so "newer" keeps it too.
+        _, stats = import_bundle(bundle, home=home, on_conflict="newer")
+        assert stats.kept == 1
+
+        _, stats = import_bundle(bundle, home=home, on_conflict="overwrite")
+        assert stats.written == 1
+        assert target.read_text().startswith("python_path=")
+
+    def test_extra_dir_relocated(self, tmp_path: Path) -> None:
+        home = tmp_path / "home"
+        _make_home(home)
+        thinlto = tmp_path / "thinlto"
+        (thinlto / "sub").mkdir(parents=True)
+        (thinlto / "sub" / "llvmcache-1").write_bytes(b"\x00\x01binary")
+        bundle = tmp_path / "cache.tar.zst"
+        export_bundle(bundle, resolve_roots([], [f"thinlto={thinlto}"]), home=home)
+
+        restored = tmp_path / "restored"
+        _, stats = import_bundle(bundle, home=home, dir_overrides={"thinlto": restored})
+        assert stats.written == 1
+        assert (restored / "sub" / "llvmcache-1").read_bytes() == b"\x00\x01binary"
+
+    def test_rejects_non_bundle(self, tmp_path: Path) -> None:
+        import pyzstd
+
+        bogus = tmp_path / "bogus.tar.zst"
+        with pyzstd.ZstdFile(bogus, "wb") as zf, tarfile.open(fileobj=zf, mode="w|") as tar:
+            info = tarfile.TarInfo("other.txt")
+            tar.addfile(info)
+        with pytest.raises(ValueError):
+            import_bundle(bogus, home=tmp_path)
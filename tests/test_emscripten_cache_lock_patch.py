@@ -0,0 +1,498 @@
+"""
+Unit tests for the per-library cache lock patch appended to
+emscripten/tools/cache.py.
+
+Upstream emcc guards every cache.get() with one cache-wide file lock, so
+parallel builds serialize whenever any system library is checked or built.
+The installer appends a block that, under CTC_EMCC_CACHE_LOCK=library,
+returns existing artifacts without locking and builds missing system
+libraries under per-library locks. These tests load a cache.py stub shaped
+like upstream's (lock/acquire_cache_lock/get/get_lib) with a recording
+filelock module, so no real emscripten install is needed. One test runs two
+worker processes against the patched stub with a real (fcntl) file lock.
+"""
+
+import importlib.util
+import os
+import subprocess
+import sys
+import time
+from pathlib import Path
+
+import pytest
+
+from clang_tool_chain.installers.emscripten import EmscriptenInstaller, _installer
+
+FILELOCK_STUB = """# records acquisitions: (path, 'acquire'|'release'|'busy')
+import os
+
+events = []
+busy = set()  # lock names held elsewhere until a blocking acquire waits them out
+
+
+class Timeout(Exception):
+    pass
+
+
+class FileLock:
+    def __init__(self, path):
+        self.path = str(path)
+
+    def acquire(self, timeout=None):
+        name = os.path.basename(self.path)
+        if name in busy:
+            if timeout is not None:
+                events.append((name, 'busy'))
+                raise Timeout(self.path)
+            busy.discard(name)
+        open(self.path, 'a').close()
+        events.append((name, 'acquire'))
+
+    def release(self):
+        events.append((os.path.basename(self.path), 'release'))
+"""
+
+CACHE_PY_TEMPLATE = """# minimal cache.py stub shaped like emscripten's
+import contextlib
+import os
+from pathlib import Path
+
+import filelock
+
+cachedir = None
+cachelock = None
+acquired_count = 0
+
+
+def acquire_cache_lock(reason):
+  global acquired_count
+  if acquired_count == 0:
+    cachelock.acquire()
+    os.environ['EM_CACHE_IS_LOCKED'] = '1'
+  acquired_count += 1
+
+
+def release_cache_lock():
+  global acquired_count
+  acquired_count -= 1
+  if acquired_count == 0:
+    del os.environ['EM_CACHE_IS_LOCKED']
+    cachelock.release()
+
+
+@contextlib.contextmanager
+def lock(reason):
+  acquire_cache_lock(reason)
+  try:
+    yield
+  finally:
+    release_cache_lock()
+
+
+def get_lib_name(name):
+  return 'sysroot/lib/wasm32-emscripten/' + name
+
+
+def get_lib(libname, *args, **kwargs):
+  return get(get_lib_name(libname), *args, **kwargs)
+
+
+def get(shortname, creator, what=None, force=False, quiet=False, deferred=False):
+  cachename = Path(cachedir, shortname)
+  with lock(shortname):
+    if cachename.exists() and not force:
+      return str(cachename)
+    cachename.parent.mkdir(parents=True, exist_ok=True)
+    creator(str(cachename))
+  return str(cachename)
+
+
+def setup(path):
+  global cachedir, cachelock
+  cachedir = Path(path)
+  cachedir.mkdir(parents=True, exist_ok=True)
+  cachelock = filelock.FileLock(Path(cachedir, 'cache.lock'))
+"""
+
+
+def _make_fake_install(root: Path) -> Path:
+    """Create a minimal install tree containing emscripten/tools/cache.py."""
+    tools_dir = root / "emscripten" / "tools"
+    tools_dir.mkdir(parents=True)
+    (tools_dir / "cache.py").write_text(CACHE_PY_TEMPLATE, encoding="utf-8")
+    (tools_dir / "filelock.py").write_text(FILELOCK_STUB, encoding="utf-8")
+    return root
+
+
+def _load_cache(install_dir: Path, cache_dir: Path) -> tuple[object, object]:
+    """Import the (patched) stub fresh; returns (cache module, filelock module)."""
+    tools_dir = install_dir / "emscripten" / "tools"
+    sys.path.insert(0, str(tools_dir))
+    try:
+        sys.modules.pop("filelock", None)
+        spec = importlib.util.spec_from_file_location("ctc_test_cache", tools_dir / "cache.py")
+        assert spec is not None and spec.loader is not None
+        mod = importlib.util.module_from_spec(spec)
+        spec.loader.exec_module(mod)
+        flock = sys.modules.pop("filelock")
+    finally:
+        sys.path.remove(str(tools_dir))
+    mod.setup(cache_dir)  # type: ignore[attr-defined]
+    return mod, flock
+
+
+def _write(path: str) -> None:
+    Path(path).write_text("built", encoding="utf-8")
+
+
+def test_patch_appends_block_once(tmp_path: Path) -> None:
+    install_dir = _make_fake_install(tmp_path / "emsdk")
+    cache_py = install_dir / "emscripten" / "tools" / "cache.py"
+
+    _installer._apply_cache_lock_patch(install_dir)
+    first = cache_py.read_text(encoding="utf-8")
+    (install_dir / EmscriptenInstaller._CACHE_LOCK_PATCH_MARKER_FILE).unlink()
+    _installer._apply_cache_lock_patch(install_dir)
+
+    assert first.startswith(CACHE_PY_TEMPLATE.rstrip("\n"))
+    assert cache_py.read_text(encoding="utf-8") == first
+    assert first.count(EmscriptenInstaller._CACHE_LOCK_PATCH_MARKER) == 1
+    assert (install_dir / EmscriptenInstaller._CACHE_LOCK_PATCH_MARKER_FILE).exists()
+
+
+def test_patch_skipped_for_unknown_layout(tmp_path: Path) -> None:
+    install_dir = _make_fake_install(tmp_path / "emsdk")
+    cache_py = install_dir / "emscripten" / "tools" / "cache.py"
+    cache_py.write_text("# no get()/lock() here\n", encoding="utf-8")
+
+    _installer._apply_cache_lock_patch(install_dir)
+
+    assert EmscriptenInstaller._CACHE_LOCK_PATCH_MARKER not in cache_py.read_text(encoding="utf-8")
+    assert not (install_dir / EmscriptenInstaller._CACHE_LOCK_PATCH_MARKER_FILE).exists()
+
+
+def test_patch_no_op_when_cache_py_missing(tmp_path: Path) -> None:
+    install_dir = tmp_path / "emsdk"
+    install_dir.mkdir()
+    _installer._apply_cache_lock_patch(install_dir)
+
+
+def test_patch_inert_without_env_var(tmp_path: Path, monkeypatch: pytest.MonkeyPatch) -> None:
+    monkeypatch.delenv("CTC_EMCC_CACHE_LOCK", raising=False)
+    install_dir = _make_fake_install(tmp_path / "emsdk")
+    _installer._apply_cache_lock_patch(install_dir)
+    cache, flock = _load_cache(install_dir, tmp_path / "cache")
+
+    cache.get_lib("libc.a", _write)  # type: ignore[attr-defined]
+
+    assert flock.events == [("cache.lock", "acquire"), ("cache.lock", "release")]  # type: ignore[attr-defined]
+
+
+def test_missing_library_takes_per_library_lock(tmp_path: Path, monkeypatch: pytest.MonkeyPatch) -> None:
+    monkeypatch.setenv("CTC_EMCC_CACHE_LOCK", "library")
+    install_dir = _make_fake_install(tmp_path / "emsdk")
+    _installer._apply_cache_lock_patch(install_dir)
+    cache, flock = _load_cache(install_dir, tmp_path / "cache")
+
+    seen_locked = []
+
+    def creator(path: str) -> None:
+        # Child processes spawned while building must see the cache as locked.
+        seen_locked.append("EM_CACHE_IS_LOCKED" in os.environ)
+        _write(path)
+
+    path = cache.get_lib("libc.a", creator)  # type: ignore[attr-defined]
+
+    assert Path(path).read_text(encoding="utf-8") == "built"
+    lock_name = "sysroot_lib_wasm32-emscripten_libc.a.lock"
+    assert flock.events == [(lock_name, "acquire"), (lock_name, "release")]  # type: ignore[attr-defined]
+    assert (tmp_path / "cache" / "locks" / lock_name).exists()
+    assert seen_locked == [True]
+    assert cache.acquired_count == 0  # type: ignore[attr-defined]
+
+
+def test_existing_library_returns_without_locking(tmp_path: Path, monkeypatch: pytest.MonkeyPatch) -> None:
+    monkeypatch.setenv("CTC_EMCC_CACHE_LOCK", "library")
+    install_dir = _make_fake_install(tmp_path / "emsdk")
+    _installer._apply_cache_lock_patch(install_dir)
+    cache, flock = _load_cache(install_dir, tmp_path / "cache")
+    cache.get_lib("libc.a", _write)  # type: ignore[attr-defined]
+    flock.events.clear()  # type: ignore[attr-defined]
+
+    def never(path: str) -> None:
+        raise AssertionError("creator must not run for a cached library")
+
+    cache.get_lib("libc.a", never)  # type: ignore[attr-defined]
+
+    assert flock.events == []  # type: ignore[attr-defined]
+
+
+def test_non_library_reasons_keep_global_lock(tmp_path: Path, monkeypatch: pytest.MonkeyPatch) -> None:
+    monkeypatch.setenv("CTC_EMCC_CACHE_LOCK", "library")
+    install_dir = _make_fake_install(tmp_path / "emsdk")
+    _installer._apply_cache_lock_patch(install_dir)
+    cache, flock = _load_cache(install_dir, tmp_path / "cache")
+
+    cache.get("sysroot_install.stamp", _write)  # type: ignore[attr-defined]
+    with cache.lock("unpack port"):  # type: ignore[attr-defined]
+        pass
+
+    assert [name for name, _ in flock.events] == ["cache.lock"] * 4  # type: ignore[attr-defined]
+
+
+def test_global_request_nested_in_library_lock_takes_cache_lock(
+    tmp_path: Path, monkeypatch: pytest.MonkeyPatch
+) -> None:
+    """A library build that needs the system headers (or a port) must wait for
+    the real cache.lock, not piggyback on the library lock's acquired_count."""
+    monkeypatch.setenv("CTC_EMCC_CACHE_LOCK", "library")
+    install_dir = _make_fake_install(tmp_path / "emsdk")
+    _installer._apply_cache_lock_patch(install_dir)
+    cache, flock = _load_cache(install_dir, tmp_path / "cache")
+
+    def creator(path: str) -> None:
+        cache.get("sysroot_install.stamp", _write)  # type: ignore[attr-defined]
+        with cache.lock("unpack port"):  # type: ignore[attr-defined]
+            assert "EM_CACHE_IS_LOCKED" in os.environ
+        _write(path)
+
+    cache.get_lib("libc++.a", creator)  # type: ignore[attr-defined]
+
+    lib = "sysroot_lib_wasm32-emscripten_libc++.a.lock"
+    assert flock.events == [  # type: ignore[attr-defined]
+        (lib, "acquire"),
+        ("cache.lock", "acquire"),
+        ("cache.lock", "release"),
+        ("cache.lock", "acquire"),
+        ("cache.lock", "release"),
+        (lib, "release"),
+    ]
+    assert cache.acquired_count == 0  # type: ignore[attr-defined]
+    assert "EM_CACHE_IS_LOCKED" not in os.environ
+
+
+def test_nested_global_request_restarts_build_when_cache_lock_busy(
+    tmp_path: Path, monkeypatch: pytest.MonkeyPatch
+) -> None:
+    """Waiting for cache.lock while holding a library lock could deadlock with
+    a cache.lock holder waiting for that library, so the build unwinds and is
+    restarted with cache.lock taken first."""
+    monkeypatch.setenv("CTC_EMCC_CACHE_LOCK", "library")
+    install_dir = _make_fake_install(tmp_path / "emsdk")
+    _installer._apply_cache_lock_patch(install_dir)
+    cache, flock = _load_cache(install_dir, tmp_path / "cache")
+    flock.busy.add("cache.lock")  # type: ignore[attr-defined]
+    runs = []
+
+    def creator(path: str) -> None:
+        runs.append(path)
+        try:
+            cache.get("sysroot_install.stamp", _write)  # type: ignore[attr-defined]
+        except Exception:  # noqa: BLE001 - the restart must not be swallowed
+            raise AssertionError("restart caught as an ordinary exception") from None
+        _write(path)
+
+    path = cache.get_lib("libc.a", creator)  # type: ignore[attr-defined]
+
+    lib = "sysroot_lib_wasm32-emscripten_libc.a.lock"
+    assert flock.events == [  # type: ignore[attr-defined]
+        (lib, "acquire"),
+        ("cache.lock", "busy"),
+        (lib, "release"),
+        ("cache.lock", "acquire"),
+        (lib, "acquire"),
+        (lib, "release"),
+        ("cache.lock", "release"),
+    ]
+    assert len(runs) == 2
+    assert Path(path).read_text(encoding="utf-8") == "built"
+    assert cache.acquired_count == 0  # type: ignore[attr-defined]
+    assert "EM_CACHE_IS_LOCKED" not in os.environ
+
+
+def test_library_built_under_global_lock_takes_library_lock(
+    tmp_path: Path, monkeypatch: pytest.MonkeyPatch
+) -> None:
+    """Lock order is global -> library: a cache.lock holder still takes the
+    library's lock, so it never builds a library another worker is building."""
+    monkeypatch.setenv("CTC_EMCC_CACHE_LOCK", "library")
+    install_dir = _make_fake_install(tmp_path / "emsdk")
+    _installer._apply_cache_lock_patch(install_dir)
+    cache, flock = _load_cache(install_dir, tmp_path / "cache")
+
+    def creator(path: str) -> None:
+        cache.get_lib("libc.a", _write)  # type: ignore[attr-defined]
+        _write(path)
+
+    cache.get("sysroot_install.stamp", creator)  # type: ignore[attr-defined]
+
+    lib = "sysroot_lib_wasm32-emscripten_libc.a.lock"
+    assert flock.events == [  # type: ignore[attr-defined]
+        ("cache.lock", "acquire"),
+        (lib, "acquire"),
+        (lib, "release"),
+        ("cache.lock", "release"),
+    ]
+    assert (tmp_path / "cache" / "sysroot" / "lib" / "wasm32-emscripten" / "libc.a").exists()
+    assert cache.acquired_count == 0  # type: ignore[attr-defined]
+
+
+def test_older_patch_block_is_replaced(tmp_path: Path) -> None:
+    install_dir = _make_fake_install(tmp_path / "emsdk")
+    cache_py = install_dir / "emscripten" / "tools" / "cache.py"
+    cache_py.write_text(
+        CACHE_PY_TEMPLATE + "\n\n# CTC_EMCC_CACHE_LOCK_PATCH: per-library cache locks\nOLD_BLOCK = 1\n",
+        encoding="utf-8",
+    )
+
+    _installer._apply_cache_lock_patch(install_dir)
+
+    content = cache_py.read_text(encoding="utf-8")
+    assert "OLD_BLOCK" not in content
+    assert content.count(EmscriptenInstaller._CACHE_LOCK_PATCH_MARKER) == 1
+    assert f"{EmscriptenInstaller._CACHE_LOCK_PATCH_MARKER} {EmscriptenInstaller._CACHE_LOCK_PATCH_VERSION}:" in content
+
+
+def test_debug_reports_lock_wait(
+    tmp_path: Path, monkeypatch: pytest.MonkeyPatch, capsys: pytest.CaptureFixture[str]
+) -> None:
+    monkeypatch.setenv("CTC_EMCC_CACHE_LOCK", "library")
+    monkeypatch.setenv("CTC_DEBUG", "1")
+    install_dir = _make_fake_install(tmp_path / "emsdk")
+    _installer._apply_cache_lock_patch(install_dir)
+    cache, _ = _load_cache(install_dir, tmp_path / "cache")
+
+    cache.get_lib("libc.a", _write)  # type: ignore[attr-defined]
+
+    err = capsys.readouterr().err
+    assert "[ctc-emcc-debug] cache lock sysroot/lib/wasm32-emscripten/libc.a: waited" in err
+
+
+# fcntl-based lock with the API of the filelock module emscripten vendors
+# (acquire(timeout, poll_intervall), Timeout, re-entrant per object).
+FCNTL_FILELOCK = """import fcntl
+import os
+import time
+
+
+class Timeout(Exception):
+    pass
+
+
+class FileLock:
+    def __init__(self, path):
+        self.path = str(path)
+        self.fd = None
+        self.count = 0
+
+    def acquire(self, timeout=None, poll_intervall=0.01):
+        if self.fd is not None:
+            self.count += 1
+            return
+        fd = os.open(self.path, os.O_RDWR | os.O_CREAT)
+        start = time.monotonic()
+        while True:
+            try:
+                fcntl.flock(fd, fcntl.LOCK_EX | fcntl.LOCK_NB)
+                break
+            except BlockingIOError:
+                if timeout is not None and time.monotonic() - start >= timeout:
+                    os.close(fd)
+                    raise Timeout(self.path) from None
+                time.sleep(poll_intervall)
+        self.fd = fd
+        self.count = 1
+
+    def release(self):
+        self.count -= 1
+        if self.count == 0:
+            fcntl.flock(self.fd, fcntl.LOCK_UN)
+            os.close(self.fd)
+            self.fd = None
+"""
+
+# One worker process. "library" builds libc.a, and its build needs the system
+# headers (a nested global request) once the other worker holds cache.lock.
+# "global" holds cache.lock (as a port build would) and then needs libc.a
+# while the first worker is building it.
+CACHE_WORKER = """import importlib.util
+import os
+import sys
+import time
+from pathlib import Path
+
+tools, cache_dir, log, role = sys.argv[1:5]
+sys.path.insert(0, tools)
+spec = importlib.util.spec_from_file_location('cache', os.path.join(tools, 'cache.py'))
+cache = importlib.util.module_from_spec(spec)
+spec.loader.exec_module(cache)
+cache.setup(cache_dir)
+
+
+def note(what):
+    with open(log, 'a') as f:
+        f.write(role + ' ' + what + '\\n')
+
+
+def wait_for(what):
+    while what not in Path(log).read_text():
+        time.sleep(0.01)
+
+
+def build(path):
+    note('build-start')
+    if role == 'library':
+        wait_for('global held')
+        cache.get('sysroot_install.stamp', lambda p: Path(p).write_text('headers'))
+    time.sleep(0.3)
+    Path(path).write_text('built by ' + role)
+    note('build-end')
+
+
+if role == 'library':
+    cache.get_lib('libc.a', build)
+else:
+    with cache.lock('unpack port'):
+        note('global held')
+        wait_for('library build-start')
+        cache.get_lib('libc.a', build)
+note('done')
+"""
+
+
+@pytest.mark.skipif(sys.platform == "win32", reason="worker lock uses fcntl")
+def test_concurrent_workers_never_build_one_library_twice(tmp_path: Path) -> None:
+    install_dir = _make_fake_install(tmp_path / "emsdk")
+    tools_dir = install_dir / "emscripten" / "tools"
+    (tools_dir / "filelock.py").write_text(FCNTL_FILELOCK, encoding="utf-8")
+    _installer._apply_cache_lock_patch(install_dir)
+    worker = tmp_path / "worker.py"
+    worker.write_text(CACHE_WORKER, encoding="utf-8")
+    log = tmp_path / "log"
+    log.write_text("", encoding="utf-8")
+    env = dict(os.environ, CTC_EMCC_CACHE_LOCK="library")
+    env.pop("EM_CACHE_IS_LOCKED", None)
+
+    def start(role: str) -> subprocess.Popen[str]:
+        cmd = [sys.executable, str(worker), str(tools_dir), str(tmp_path / "cache"), str(log), role]
+        return subprocess.Popen(cmd, env=env, stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True)
+
+    library = start("library")
+    while "library build-start" not in log.read_text(encoding="utf-8"):
+        assert library.poll() is None, library.communicate()
+        time.sleep(0.01)
+    held = start("global")
+    for proc in (library, held):
+        _, err = proc.communicate(timeout=30)  # a lock-order deadlock would hang here
+        assert proc.returncode == 0, err
+
+    lines = log.read_text(encoding="utf-8").splitlines()
+    # The library worker's build was abandoned when it found cache.lock taken;
+    # the global worker built libc.a alone and the library worker then found it.
+    assert lines.count("global build-start") == 1
+    assert lines.count("global build-end") == 1
+    assert "library build-end" not in lines
+    lib = tmp_path / "cache" / "sysroot" / "lib" / "wasm32-emscripten" / "libc.a"
+    assert lib.read_text(encoding="utf-8") == "built by global"
+    assert {"library done", "global done"} <= set(lines)
+
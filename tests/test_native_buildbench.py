@@ -0,0 +1,267 @@
+"""Tests for ctc-buildbench, the end-to-end build throughput benchmark.
+
+ctc-buildbench generates a synthetic C++ project (TUs over a header graph,
+explicit template instantiations, executables linking a fan-in of objects) and
+builds it once per launcher mode, reporting TUs/s, link times and the
+launcher's share of each invocation from CTC_TIMING_LOG. The compiler here is
+a stand-in that logs argv and its mode environment and appends a timing
+record the way ctc-clang does.
+
+Tests cover:
+  - --generate-only layout, directive lines and determinism for a seed
+  - Every compile and link per mode and run, with plain/deploy/directives
+    flags and CLANG_TOOL_CHAIN_NO_DIRECTIVES set where expected
+  - Launcher share and per-call time computed from the timing log
+  - zccache reported as skipped when its entry point is missing
+  - Compile failures exit non-zero; unknown modes exit 2
+  - A compiler that can't be exec'd is named on stderr even without -v
+  - The generated project builds and runs with a real C++ compiler
+"""
+
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import unittest
+from pathlib import Path
+
+IS_WINDOWS = sys.platform == "win32"
+IS_LINUX = sys.platform.startswith("linux")
+
+
+# ------------------------------------------------------------------
+# Module-level compilation: build native tools once for all tests
+# ------------------------------------------------------------------
+
+_build_dir: str | None = None
+_build_ok: bool = False
+
+
+def _ensure_built() -> bool:
+    """Compile native tools into a temp directory (runs once per session)."""
+    global _build_dir, _build_ok  # noqa: PLW0603
+    if _build_dir is not None:
+        return _build_ok
+
+    import importlib.resources as resources
+
+    ref = resources.files("clang_tool_chain.native_tools").joinpath("launcher_buildbench.cpp")
+    if not (hasattr(ref, "is_file") and ref.is_file()):  # type: ignore[union-attr]
+        _build_dir = ""
+        return False
+
+    _build_dir = tempfile.mkdtemp(prefix="ctc_buildbench_test_")
+
+    try:
+        from clang_tool_chain.commands.compile_native import compile_native
+
+        rc = compile_native(_build_dir)
+        _build_ok = rc == 0
+    except Exception:
+        _build_ok = False
+
+    if not _build_ok:
+        print(
+            f"WARNING: native tool compilation failed (dir={_build_dir})",
+            file=sys.stderr,
+        )
+
+    import atexit
+
+    def _cleanup() -> None:
+        if _build_dir and os.path.isdir(_build_dir):
+            shutil.rmtree(_build_dir, ignore_errors=True)
+
+    atexit.register(_cleanup)
+    return _build_ok
+
+
+def _exe(name: str) -> str:
+    _ensure_built()
+    suffix = ".exe" if IS_WINDOWS else ""
+    return str(Path(_build_dir or "") / f"{name}{suffix}")
+
+
+SKIP_REASON = "Native tool compilation failed"
+
+
+# Compiler stand-in: logs mode env + argv, writes its -o output, and appends a
+# v1 timing record with 2 ms of launcher time around 8 ms of "compiler".
+_FAKE_CXX = r"""#!/usr/bin/env python3
+import os, sys, time
+args = sys.argv[1:]
+here = os.path.dirname(os.path.abspath(__file__))
+mode = "nodirectives" if os.environ.get("CLANG_TOOL_CHAIN_NO_DIRECTIVES") == "1" else "directives"
+with open(os.path.join(here, "cxx.log"), "a") as f:
+    f.write(mode + " " + " ".join(args) + "\n")
+out = args[args.index("-o") + 1]
+if "-c" in args and "tu_0.cpp" in args[args.index("-c") + 1] and os.environ.get("FAKE_FAIL"):
+    sys.exit(1)
+open(out, "w").write("built")
+log = os.environ.get("CTC_TIMING_LOG")
+if log:
+    t = int(time.time() * 1e6)
+    with open(log, "a") as f:
+        f.write("v1\t%d\tclang++\t%d\t%d\t%d\t%d\t0\t0\t0\t0\t%s\t%s\n"
+                % (os.getpid(), t, t + 1000, t + 9000, t + 10000, os.getcwd(), out))
+"""
+
+
+def _run(*args: str, env: dict[str, str] | None = None) -> subprocess.CompletedProcess[str]:
+    return subprocess.run(
+        [_exe("ctc-buildbench"), *args], capture_output=True, text=True, timeout=300, env=env
+    )
+
+
+@unittest.skipUnless(IS_LINUX, "fake compiler is a POSIX script")
+@unittest.skipUnless(_ensure_built(), SKIP_REASON)
+class TestBuildbench(unittest.TestCase):
+    def setUp(self) -> None:
+        self.root = Path(tempfile.mkdtemp(prefix="ctc_buildbench_"))
+        self.cxx = self.root / "tools" / "c++"
+        self.cxx.parent.mkdir()
+        self.cxx.write_text(_FAKE_CXX)
+        self.cxx.chmod(0o755)
+        self.small = ["--tus", "6", "--depth", "3", "--width", "4", "--templates", "2", "--functions", "3"]
+
+    def tearDown(self) -> None:
+        shutil.rmtree(self.root, ignore_errors=True)
+
+    def _log(self) -> list[str]:
+        return (self.root / "tools" / "cxx.log").read_text().splitlines()
+
+    def test_generate_only_layout(self) -> None:
+        out = self.root / "gen"
+        r = _run("--generate-only", "--out", str(out), "--links", "3", *self.small)
+        self.assertEqual(r.returncode, 0, r.stderr)
+        src = out / "src"
+        self.assertEqual(r.stdout.strip(), str(src))
+        self.assertEqual(len(list(src.glob("tu_*.cpp"))), 6)
+        self.assertEqual(len(list(src.glob("main_*.cpp"))), 3)
+        self.assertEqual(len(list((src / "include").glob("h_*.h"))), 12)
+        tu = (src / "tu_0.cpp").read_text()
+        self.assertIn("// @std: c++17", tu)
+        self.assertIn("// @cflags: -DCTC_BENCH=1", tu)
+        self.assertEqual(tu.count("template struct h0_"), 2)
+        self.assertIn("<", (src / "include" / "h_2_0.h").read_text().split("#include ")[-1])
+        # Same seed, same project; another seed differs
+        again = self.root / "again"
+        _run("--generate-only", "--out", str(again), "--links", "3", *self.small)
+        self.assertEqual(tu, (again / "src" / "tu_0.cpp").read_text())
+        other = self.root / "other"
+        _run("--generate-only", "--out", str(other), "--links", "3", "--seed", "7", *self.small)
+        self.assertNotEqual(tu, (other / "src" / "tu_0.cpp").read_text())
+
+    def test_modes_commands_and_json(self) -> None:
+        r = _run(
+            "--clang", str(self.cxx), "--modes", "plain,deploy,directives", "--runs", "2",
+            "--links", "2", "--fan-in", "4", "--flag", "-O1", "--json", *self.small,
+        )
+        self.assertEqual(r.returncode, 0, r.stderr)
+        report = json.loads(r.stdout)
+        self.assertEqual(report["config"]["tus"], 6)
+        self.assertEqual(report["config"]["fan_in"], 4)
+        self.assertEqual([m["name"] for m in report["modes"]], ["plain", "deploy", "directives"])
+        for m in report["modes"]:
+            self.assertTrue(m["available"])
+            self.assertEqual(len(m["runs"]), 2)
+            run = m["runs"][0]
+            self.assertEqual(len(run["link_wall_s"]), 2)
+            self.assertGreater(run["tus_per_s"], 0)
+            self.assertAlmostEqual(run["launcher_share"], 0.2, places=2)
+            self.assertAlmostEqual(run["launcher_ms"], 2.0, places=2)
+            self.assertAlmostEqual(m["median"]["launcher_share"], 0.2, places=2)
+
+        lines = self._log()
+        # (6 TUs + 2 mains + 2 links) x 2 runs x 3 modes
+        self.assertEqual(len(lines), 60)
+        compiles = [line for line in lines if " -c " in line]
+        links = [line for line in lines if " -c " not in line]
+        plain = [line for line in compiles if line.startswith("nodirectives")]
+        self.assertEqual(len(plain), 32)
+        for line in plain:
+            self.assertIn("-std=c++17 -DCTC_BENCH=1 -O1", line)
+        for line in compiles[32:]:
+            self.assertTrue(line.startswith("directives "), line)
+            self.assertNotIn("-std=", line)
+            self.assertIn("-O1", line)
+        self.assertEqual(sum("--deploy-dependencies" in line for line in links), 4)
+        # Fan-in 4: main + 4 objects per link
+        self.assertEqual(links[0].count(".o"), 5)
+
+    def test_text_report_and_no_timing_log(self) -> None:
+        r = _run("--clang", str(self.cxx), "--modes", "plain", "--runs", "1", *self.small)
+        self.assertEqual(r.returncode, 0, r.stderr)
+        self.assertIn("TUs/s", r.stdout)
+        self.assertIn("20.0%", r.stdout)
+        r = _run("--clang", str(self.cxx), "--modes", "plain", "--runs", "1", "--no-timing-log", "--json", *self.small)
+        self.assertEqual(r.returncode, 0, r.stderr)
+        self.assertIsNone(json.loads(r.stdout)["modes"][0]["runs"][0]["launcher_share"])
+
+    def test_zccache_unavailable(self) -> None:
+        r = _run(
+            "--clang", str(self.cxx), "--modes", "zccache", "--zccache", str(self.root / "missing"),
+            "--json", *self.small,
+        )
+        self.assertEqual(r.returncode, 0, r.stderr)
+        mode = json.loads(r.stdout)["modes"][0]
+        self.assertFalse(mode["available"])
+        self.assertIn("not found", mode["note"])
+        self.assertEqual(mode["runs"], [])
+
+    def test_zccache_cold_then_warm(self) -> None:
+        # --clang is only needed by the other modes
+        out = self.root / "out"
+        r = _run(
+            "--clang", str(self.root / "missing"), "--modes", "zccache", "--zccache", str(self.cxx),
+            "--runs", "2", "--out", str(out), "--json", *self.small,
+        )
+        self.assertEqual(r.returncode, 0, r.stderr)
+        self.assertEqual(len(json.loads(r.stdout)["modes"][0]["runs"]), 2)
+        self.assertTrue((out / "zccache" / "bin" / "app_0").is_file())
+
+    def test_compile_failure(self) -> None:
+        env = dict(os.environ, FAKE_FAIL="1")
+        r = _run("--clang", str(self.cxx), "--modes", "plain", "--runs", "1", *self.small, env=env)
+        self.assertEqual(r.returncode, 1)
+        self.assertIn("compile 0 failed", r.stderr)
+        self.assertIn("build failed", r.stdout)
+
+    def test_unrunnable_compiler_reported(self) -> None:
+        self.cxx.write_text("#!/nonexistent/interpreter\n")
+        r = _run("--clang", str(self.cxx), "--modes", "plain", "--runs", "1", *self.small)
+        self.assertEqual(r.returncode, 1)
+        self.assertIn(f"[ctc-buildbench] cannot run {self.cxx}", r.stderr)
+
+    def test_unknown_mode(self) -> None:
+        r = _run("--clang", str(self.cxx), "--modes", "plain,bogus")
+        self.assertEqual(r.returncode, 2)
+        self.assertIn("Unknown mode", r.stderr)
+
+
+@unittest.skipUnless(IS_LINUX, "POSIX build")
+@unittest.skipUnless(shutil.which("g++"), "needs a host C++ compiler")
+@unittest.skipUnless(_ensure_built(), SKIP_REASON)
+class TestBuildbenchRealCompiler(unittest.TestCase):
+    def test_generated_project_builds_and_runs(self) -> None:
+        root = Path(tempfile.mkdtemp(prefix="ctc_buildbench_real_"))
+        try:
+            r = _run(
+                "--clang", shutil.which("g++") or "g++", "--modes", "plain", "--runs", "1",
+                "--tus", "4", "--templates", "3", "--functions", "4", "--links", "2", "--fan-in", "3",
+                "--no-timing-log", "--out", str(root),
+            )
+            self.assertEqual(r.returncode, 0, r.stderr)
+            for e in range(2):
+                app = root / "plain" / "bin" / f"app_{e}"
+                run = subprocess.run([str(app)], capture_output=True, text=True, timeout=30)
+                self.assertEqual(run.returncode, 0)
+                int(run.stdout.strip())
+        finally:
+            shutil.rmtree(root, ignore_errors=True)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,273 @@
+"""Tests for ctc-critical-path and the CTC_TIMING_LOG records it reads.
+
+ctc-critical-path reconstructs a build timeline from .ninja_log (last run
+only) and/or the per-invocation records ctc-clang appends under
+CTC_TIMING_LOG, then reports the critical path, parallelism over time and
+launcher vs. compiler time, optionally as a Perfetto trace.
+
+Tests cover:
+  - ctc-clang under CTC_TIMING_LOG: one record per invocation, target/cwd,
+    exit status propagated and recorded
+  - .ninja_log: older runs dropped, multi-output edges folded into one job
+  - Critical path and gaps, mean parallelism
+  - Timing records joined by absolute output path; latest record wins
+  - Make mode (timing log only)
+  - Trace-event JSON: lanes, critical-path track, launcher/compiler spans,
+    parallelism counter
+"""
+
+import json
+import os
+import platform
+import shutil
+import subprocess
+import sys
+import tempfile
+import unittest
+from pathlib import Path
+
+IS_WINDOWS = sys.platform == "win32"
+IS_LINUX = sys.platform.startswith("linux")
+
+
+# ------------------------------------------------------------------
+# Module-level compilation: build native tools once for all tests
+# ------------------------------------------------------------------
+
+_build_dir: str | None = None
+_build_ok: bool = False
+
+
+def _ensure_built() -> bool:
+    """Compile native tools into a temp directory (runs once per session)."""
+    global _build_dir, _build_ok  # noqa: PLW0603
+    if _build_dir is not None:
+        return _build_ok
+
+    import importlib.resources as resources
+
+    ref = resources.files("clang_tool_chain.native_tools").joinpath("launcher_critical_path.cpp")
+    if not (hasattr(ref, "is_file") and ref.is_file()):  # type: ignore[union-attr]
+        _build_dir = ""
+        return False
+
+    _build_dir = tempfile.mkdtemp(prefix="ctc_critical_path_test_")
+
+    try:
+        from clang_tool_chain.commands.compile_native import compile_native
+
+        rc = compile_native(_build_dir)
+        _build_ok = rc == 0
+    except Exception:
+        _build_ok = False
+
+    if not _build_ok:
+        print(
+            f"WARNING: native tool compilation failed (dir={_build_dir})",
+            file=sys.stderr,
+        )
+
+    import atexit
+
+    def _cleanup() -> None:
+        if _build_dir and os.path.isdir(_build_dir):
+            shutil.rmtree(_build_dir, ignore_errors=True)
+
+    atexit.register(_cleanup)
+    return _build_ok
+
+
+def _exe(name: str) -> str:
+    _ensure_built()
+    suffix = ".exe" if IS_WINDOWS else ""
+    return str(Path(_build_dir or "") / f"{name}{suffix}")
+
+
+def _run(args: list[str], env: dict[str, str] | None = None, cwd: str | None = None) -> subprocess.CompletedProcess:
+    return subprocess.run(
+        args, capture_output=True, text=True, encoding="utf-8", errors="replace", timeout=60, env=env, cwd=cwd
+    )
+
+
+SKIP_REASON = "Native tool compilation failed"
+
+BASE_US = 1_700_000_000_000_000
+
+# Older run (end times drop at the next run), then: a.o, c.o and b.o in
+# parallel, lib.a after b.o (10 ms gap), app + app.map from one edge.
+NINJA_LOG = """# ninja log v5
+0\t1000\t0\told.o\t1111
+0\t100\t0\ta.o\taaaa
+5\t120\t0\tc.o\tcccc
+0\t300\t0\tb.o\tbbbb
+310\t400\t0\tlib.a\tllll
+400\t450\t0\tapp\tpppp
+400\t450\t0\tapp.map\tpppp
+"""
+
+
+def _record(
+    start_ms: float, spawn_ms: float, exit_ms: float, done_ms: float, cwd: str, target: str, rc: int = 0
+) -> str:
+    us = [BASE_US + int(t * 1000) for t in (start_ms, spawn_ms, exit_ms, done_ms)]
+    fields = ["v1", "4242", "clang++", *map(str, us), "80000", "20000", "51200", str(rc), cwd, target]
+    return "\t".join(fields) + "\n"
+
+
+@unittest.skipUnless(_ensure_built(), SKIP_REASON)
+class TestCriticalPath(unittest.TestCase):
+    def setUp(self) -> None:
+        self.root = Path(tempfile.mkdtemp(prefix="ctc_cp_"))
+        self.build = self.root / "build"
+        (self.build / "sub").mkdir(parents=True)
+        (self.build / ".ninja_log").write_text(NINJA_LOG)
+        self.timing = self.root / "timing.log"
+        b = str(self.build)
+        self.timing.write_text(
+            _record(-3_600_000, -3_599_990, -3_599_000, -3_599_000, b, "b.o")  # previous build
+            + _record(2, 5, 299, 299.5, b, "b.o")
+            + _record(311, 312, 390, 399, b, str(self.build / "lib.a"))
+            + _record(401, 402, 449, 449.5, str(self.build / "sub"), "../app")
+            + _record(50, 51, 60, 61, b, "unrelated.o")
+        )
+        self.env = dict(os.environ)
+        self.env.pop("CTC_TIMING_LOG", None)
+
+    def tearDown(self) -> None:
+        shutil.rmtree(self.root, ignore_errors=True)
+
+    def _cp(self, *args: str) -> subprocess.CompletedProcess:
+        result = _run([_exe("ctc-critical-path"), *args], env=self.env)
+        self.assertEqual(result.returncode, 0, result.stderr)
+        return result
+
+    def _section(self, out: str, title: str) -> list[str]:
+        lines = out.splitlines()
+        start = next(i for i, line in enumerate(lines) if line.startswith(title))
+        body = []
+        for line in lines[start + 1 :]:
+            if not line.strip():
+                break
+            body.append(line)
+        return body
+
+    def test_ninja_timeline(self) -> None:
+        out = self._cp(str(self.build)).stdout
+        self.assertIn("5 jobs over 0.45 s", out)
+        self.assertNotIn("old.o", out)
+        path = [line.split()[-1] for line in self._section(out, "Critical path:")[1:]]
+        self.assertEqual(path, ["b.o", "lib.a", "app"])
+        self.assertIn("Critical path: 3 jobs, 0.44 s busy + 0.01 s gaps", out)
+        # busy 100 + 115 + 300 + 90 + 50 = 655 ms over 450 ms
+        self.assertIn("Parallelism: mean 1.46, peak 3", out)
+
+    def test_timing_records_joined(self) -> None:
+        out = self._cp(str(self.build), "--timing-log", str(self.timing)).stdout
+        self.assertIn("3/5 matched", out)
+        crit = self._section(out, "Critical path:")
+        b_row = next(line for line in crit if line.split()[3] == "b.o")
+        # the latest b.o record, not the one from an hour earlier
+        self.assertIn("[setup 3.0 ms, compiler 294.0 ms]", b_row)
+        attribution = self._section(out, "Launcher attribution")
+        self.assertTrue(attribution[0].lstrip().startswith("all jobs"))
+        self.assertIn("3 jobs", attribution[0])
+        self.assertIn("peak RSS 50 MB", out)
+
+    def test_timing_log_from_env(self) -> None:
+        self.env["CTC_TIMING_LOG"] = str(self.timing)
+        self.assertIn("3/5 matched", self._cp(str(self.build)).stdout)
+
+    def test_make_mode(self) -> None:
+        (self.build / ".ninja_log").unlink()
+        self.timing.write_text(
+            _record(0, 2, 100, 100, "/w", "a.o")
+            + _record(1, 3, 200, 201, "/w", "b.o")
+            + _record(205, 206, 300, 320, "/w", "app")
+        )
+        out = self._cp(str(self.build), "--timing-log", str(self.timing)).stdout
+        self.assertIn("3 jobs over 0.32 s", out)
+        path = [line.split()[3] for line in self._section(out, "Critical path:")[1:]]
+        self.assertEqual(path, ["b.o", "app"])
+
+    def test_trace(self) -> None:
+        trace = self.root / "trace.json"
+        self._cp(str(self.build), "--timing-log", str(self.timing), "--trace", str(trace))
+        events = json.loads(trace.read_text())["traceEvents"]
+        spans = [e for e in events if e["ph"] == "X"]
+        critical = [e["name"] for e in spans if e["tid"] == 0]
+        self.assertEqual(critical, ["b.o", "lib.a", "app"])
+        self.assertEqual(len([e for e in spans if e["name"] == "compiler"]), 3)
+        app = next(e for e in spans if e["name"] == "app" and e["tid"] != 0)
+        self.assertEqual(app["args"]["outputs"], 2)
+        self.assertIn("critical", app["cat"])
+        lanes = {e["tid"] for e in spans if e["cat"].startswith("job")}
+        self.assertEqual(lanes, {1, 2, 3})
+        counters = [e["args"]["jobs"] for e in events if e["ph"] == "C"]
+        self.assertEqual(max(counters), 3)
+        self.assertEqual(counters[-1], 0)
+
+    def test_no_inputs(self) -> None:
+        result = _run([_exe("ctc-critical-path"), str(self.root / "empty")], env=self.env)
+        self.assertEqual(result.returncode, 1)
+        self.assertIn("No jobs", result.stderr)
+
+
+# clang stand-in: fails with 3 for bad.cpp, otherwise succeeds.
+_FAKE_CLANG = """#!/bin/sh
+for a in "$@"; do [ "$a" = bad.cpp ] && exit 3; done
+exit 0
+"""
+
+
+@unittest.skipUnless(IS_LINUX, "fake toolchain layout is Linux only")
+@unittest.skipUnless(_ensure_built(), SKIP_REASON)
+class TestTimingLog(unittest.TestCase):
+    def setUp(self) -> None:
+        self.root = Path(tempfile.mkdtemp(prefix="ctc_timing_"))
+        arch = "arm64" if platform.machine().lower() in ("aarch64", "arm64") else "x86_64"
+        install = self.root / "clang" / "linux" / arch
+        (install / "bin").mkdir(parents=True)
+        (install / "lib" / "clang" / "19" / "include").mkdir(parents=True)
+        (install / "done.txt").write_text("ok\n")
+        (install / "bin" / "clang").write_text(_FAKE_CLANG)
+        (install / "bin" / "clang").chmod(0o755)
+        (install / "bin" / "clang++").symlink_to("clang")
+        self.log = self.root / "timing.log"
+        self.env = dict(os.environ)
+        self.env["CLANG_TOOL_CHAIN_DOWNLOAD_PATH"] = str(self.root)
+        self.env["CTC_TIMING_LOG"] = str(self.log)
+        self.env["CLANG_TOOL_CHAIN_NO_NOTE"] = "1"
+        for key in ("CLANG_TOOL_CHAIN_NO_AUTO", "CLANG_TOOL_CHAIN_ZYGOTE", "CTC_DEBUG"):
+            self.env.pop(key, None)
+
+    def tearDown(self) -> None:
+        shutil.rmtree(self.root, ignore_errors=True)
+
+    def _records(self) -> list[list[str]]:
+        return [line.split("\t") for line in self.log.read_text().splitlines()]
+
+    def test_records_per_invocation(self) -> None:
+        ok = _run([_exe("ctc-clang++"), "-c", "main.cpp", "-o", "obj/main.o"], env=self.env, cwd=str(self.root))
+        self.assertEqual(ok.returncode, 0, ok.stderr)
+        bad = _run([_exe("ctc-clang"), "-c", "bad.cpp", "-o", "bad.o"], env=self.env, cwd=str(self.root))
+        self.assertEqual(bad.returncode, 3)
+
+        records = self._records()
+        self.assertEqual(len(records), 2)
+        first, second = records
+        self.assertEqual(first[0], "v1")
+        self.assertEqual(first[2], "clang++")
+        start, spawn, exit_, done = map(int, first[3:7])
+        self.assertTrue(start <= spawn <= exit_ <= done)
+        self.assertEqual(first[10], "0")
+        self.assertEqual(Path(first[11]).resolve(), self.root.resolve())
+        self.assertEqual(first[12], "obj/main.o")
+        self.assertEqual((second[2], second[10], second[12]), ("clang", "3", "bad.o"))
+
+    def test_dry_run_not_recorded(self) -> None:
+        _run([_exe("ctc-clang++"), "--dry-run", "-c", "main.cpp"], env=self.env, cwd=str(self.root))
+        self.assertFalse(self.log.exists())
+
+
+if __name__ == "__main__":
+    unittest.main()
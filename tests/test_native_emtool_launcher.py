@@ -10,6 +10,9 @@ Tests cover:
   - --ctc-help renders with the correct tool name per binary
   - argv[0] dispatch (unknown name should fail loudly)
   - Cached-path dry-run round-trip (no Emscripten install needed)
+  - CTC_EMCC_CACHE_LOCK defaults to library
+  - Native discovery on a cache miss (no Python discovery script), honoring
+    CLANG_TOOL_CHAIN_DOWNLOAD_PATH
 
 Tests requiring an actual Emscripten install are skipped if unavailable.
 """
@@ -358,6 +361,50 @@ class TestDryRunWithSeededCache(unittest.TestCase):
         tokens = result.stdout.split()
         self.assertNotIn("--dry-run", tokens)
 
+    def test_cache_lock_default(self) -> None:
+        """Like ctc-emcc, the emtool roles default CTC_EMCC_CACHE_LOCK to library."""
+        self._seed_cache("emar")
+        Path(self.fake_scripts["emar"]).write_text("import os\nprint(os.environ.get('CTC_EMCC_CACHE_LOCK'))\n")
+        env = {k: v for k, v in os.environ.items() if k != "CTC_EMCC_CACHE_LOCK"}
+        env.update(self._home_env())
+        result = subprocess.run([_exe("ctc-emar")], capture_output=True, text=True, env=env, timeout=30)
+        self.assertEqual(result.returncode, 0, result.stderr)
+        self.assertEqual(result.stdout.strip(), "library")
+        env["CTC_EMCC_CACHE_LOCK"] = "global"
+        result = subprocess.run([_exe("ctc-emar")], capture_output=True, text=True, env=env, timeout=30)
+        self.assertEqual(result.stdout.strip(), "global")
+
+    def test_cache_miss_discovers_natively(self) -> None:
+        """With no cache, the install layout alone is enough — no Python discovery."""
+        (self.install_dir / "done.txt").write_text("installed\n")
+        (self.install_dir / "bin").mkdir()
+        bin_dir = (self.install_dir / "bin").as_posix()
+        (self.install_dir / ".emscripten").write_text(f"LLVM_ROOT = '{bin_dir}'\nNODE_JS = 'node'\n")
+        result = _run(
+            [_exe("ctc-emar"), "--dry-run", "rcs", "libfoo.a"],
+            env_override=self._home_env(),
+        )
+        self.assertEqual(result.returncode, 0, result.stderr)
+        self.assertNotIn("via Python", result.stderr)
+        self.assertIn(self.fake_scripts["emar"], result.stdout)
+        cache = (self.install_dir / ".ctc-emar-cache").read_text()
+        self.assertIn(f"tool_script={self.fake_scripts['emar']}\n", cache)
+        self.assertIn(f"config_path={self.install_dir / '.emscripten'}\n", cache)
+
+    def test_cache_miss_honors_download_path(self) -> None:
+        """A relocated CLANG_TOOL_CHAIN_DOWNLOAD_PATH is searched instead of HOME."""
+        (self.install_dir / "done.txt").write_text("installed\n")
+        (self.install_dir / "bin").mkdir()
+        bin_dir = (self.install_dir / "bin").as_posix()
+        (self.install_dir / ".emscripten").write_text(f"LLVM_ROOT = '{bin_dir}'\n")
+        env = {"CLANG_TOOL_CHAIN_DOWNLOAD_PATH": str(self.tmp_path / ".clang-tool-chain")}
+        env.update({k: str(self.tmp_path / "elsewhere") for k in self._home_env()})
+        result = _run([_exe("ctc-emar"), "--dry-run", "rcs", "libfoo.a"], env_override=env)
+        self.assertEqual(result.returncode, 0, result.stderr)
+        self.assertNotIn("via Python", result.stderr)
+        self.assertIn(self.fake_scripts["emar"], result.stdout)
+        self.assertTrue((self.install_dir / ".ctc-emar-cache").is_file())
+
 
 # ==========================================================================
 # Multi-role launcher (issue #25): one binary, 17 hardlinks
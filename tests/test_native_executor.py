@@ -0,0 +1,255 @@
+"""Tests for the work-stealing executor in Section 13 of ``ctc_common.h``.
+
+The Executor and parallel_for back ``--ctc-translate``, pre-link scans, large
+file digests and the benchmark tools. A small harness that includes the
+header is built with the host C++ compiler and drives the pool directly.
+
+Tests cover:
+  - parallel_for runs every index exactly once, inline or pooled
+  - Own-queue tasks run LIFO; a lone task runs inline without a thread
+  - Tasks submitted by tasks are awaited; width stays within max_threads/CTC_JOBS
+  - A throwing task doesn't stop the others; wait() rethrows it once
+  - Make jobserver tokens are borrowed per extra thread and returned
+"""
+
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import unittest
+from pathlib import Path
+
+IS_LINUX = sys.platform.startswith("linux")
+HOST_CXX = shutil.which("c++") or shutil.which("g++")
+
+
+# ------------------------------------------------------------------
+# Module-level compilation: build the harness once for all tests
+# ------------------------------------------------------------------
+
+_HARNESS = r"""
+#include "ctc_common.h"
+
+#include <stdexcept>
+
+using namespace ctc;
+
+// Sleeping tasks overlap whenever the pool runs them on separate threads.
+static void width(Executor& ex, size_t tasks) {
+    std::atomic<int> running{0}, peak{0};
+    for (size_t i = 0; i < tasks; i++) {
+        ex.submit([&] {
+            int now = ++running;
+            for (int p = peak.load(); now > p && !peak.compare_exchange_weak(p, now);) {
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            --running;
+        });
+    }
+    ex.wait();
+    printf("threads=%zu peak=%d\n", ex.threads_started(), peak.load());
+}
+
+int main(int argc, char** argv) {
+    std::string mode = argv[1];
+    if (mode == "once") {
+        size_t n = (size_t)atol(argv[2]);
+        unsigned threads = (unsigned)atoi(argv[3]);
+        std::vector<std::atomic<int>> hits(n);
+        parallel_for(n, [&](size_t i) { hits[i]++; }, threads);
+        size_t once = 0;
+        for (auto& h : hits) once += h == 1;
+        printf("%zu\n", once);
+    } else if (mode == "lifo") {
+        Executor ex(1);
+        for (int i = 0; i < 5; i++) ex.submit([i] { printf("%d", i); });
+        ex.wait();
+        printf("\n");
+    } else if (mode == "inline") {
+        Executor ex(4);
+        std::thread::id ran;
+        ex.submit([&] { ran = std::this_thread::get_id(); });
+        ex.wait();
+        printf("threads=%zu caller=%d\n", ex.threads_started(), ran == std::this_thread::get_id());
+    } else if (mode == "nested") {
+        Executor ex(4);
+        std::atomic<int> done{0};
+        for (int i = 0; i < 4; i++) {
+            ex.submit([&] {
+                for (int j = 0; j < 4; j++) ex.submit([&] { done++; });
+                done++;
+            });
+        }
+        ex.wait();
+        printf("%d\n", done.load());
+    } else if (mode == "width") {
+        Executor ex((unsigned)atoi(argv[2]));  // 0 = CTC_JOBS / hardware
+        width(ex, 16);
+    } else if (mode == "throw") {
+        size_t n = (size_t)atol(argv[2]);
+        unsigned threads = (unsigned)atoi(argv[3]);
+        std::atomic<int> ran{0};
+        try {
+            parallel_for(n, [&](size_t i) {
+                ran++;
+                if (i == 3) throw std::runtime_error("task 3");
+            }, threads);
+            printf("no exception\n");
+        } catch (const std::exception& e) {
+            printf("caught %s\n", e.what());
+        }
+        printf("ran=%d\n", ran.load());
+        // The pool is usable again and the exception was consumed.
+        Executor ex(threads);
+        ex.submit([] { throw std::logic_error("first"); });
+        ex.submit([] {});
+        try { ex.wait(); } catch (const std::exception& e) { printf("caught %s\n", e.what()); }
+        ex.submit([] {});
+        ex.wait();
+        printf("reused\n");
+    }
+    return 0;
+}
+"""
+
+_build_dir: str | None = None
+_build_ok: bool = False
+
+
+def _ensure_built() -> bool:
+    """Compile the executor harness into a temp directory (runs once per session)."""
+    global _build_dir, _build_ok  # noqa: PLW0603
+    if _build_dir is not None:
+        return _build_ok
+
+    import importlib.resources as resources
+
+    ref = resources.files("clang_tool_chain.native_tools").joinpath("ctc_common.h")
+    if not (hasattr(ref, "is_file") and ref.is_file()) or not HOST_CXX or not IS_LINUX:  # type: ignore[union-attr]
+        _build_dir = ""
+        return False
+
+    _build_dir = tempfile.mkdtemp(prefix="ctc_executor_test_")
+    src = Path(_build_dir) / "harness.cpp"
+    src.write_text(_HARNESS)
+    result = subprocess.run(
+        [HOST_CXX, "-std=c++17", "-O1", f"-I{Path(str(ref)).parent}", "-o", "harness", str(src), "-lpthread"],
+        capture_output=True,
+        text=True,
+        cwd=_build_dir,
+    )
+    _build_ok = result.returncode == 0
+
+    if not _build_ok:
+        print(f"WARNING: executor harness compilation failed:\n{result.stderr}", file=sys.stderr)
+
+    import atexit
+
+    def _cleanup() -> None:
+        if _build_dir and os.path.isdir(_build_dir):
+            shutil.rmtree(_build_dir, ignore_errors=True)
+
+    atexit.register(_cleanup)
+    return _build_ok
+
+
+def _harness(*args: str, env: dict[str, str] | None = None) -> str:
+    _ensure_built()
+    base = {k: v for k, v in os.environ.items() if k not in ("CTC_JOBS", "MAKEFLAGS")}
+    result = subprocess.run(
+        [str(Path(_build_dir or "") / "harness"), *args],
+        capture_output=True,
+        text=True,
+        env={**base, **(env or {})},
+        timeout=60,
+    )
+    assert result.returncode == 0, result.stderr
+    return result.stdout
+
+
+def _counts(line: str) -> dict[str, int]:
+    return {k: int(v) for k, v in (field.split("=") for field in line.split())}
+
+
+SKIP_REASON = "needs Linux and a host C++ compiler"
+
+
+@unittest.skipUnless(_ensure_built(), SKIP_REASON)
+class TestScheduling(unittest.TestCase):
+    def test_every_index_runs_once(self) -> None:
+        for n, threads in ((1, 0), (7, 1), (1000, 4), (1000, 0)):
+            self.assertEqual(_harness("once", str(n), str(threads)).strip(), str(n), (n, threads))
+
+    def test_own_queue_is_lifo(self) -> None:
+        self.assertEqual(_harness("lifo").strip(), "43210")
+
+    def test_lone_task_runs_inline(self) -> None:
+        self.assertEqual(_counts(_harness("inline")), {"threads": 0, "caller": 1})
+
+    def test_nested_submissions_are_awaited(self) -> None:
+        self.assertEqual(_harness("nested").strip(), "20")
+
+    def test_width_bounded_by_max_threads(self) -> None:
+        counts = _counts(_harness("width", "3"))
+        self.assertLessEqual(counts["threads"], 2)
+        self.assertLessEqual(counts["peak"], 3)
+        self.assertGreaterEqual(counts["peak"], 2)
+
+    def test_ctc_jobs_sets_default_width(self) -> None:
+        self.assertEqual(_counts(_harness("width", "0", env={"CTC_JOBS": "1"})), {"threads": 0, "peak": 1})
+        self.assertLessEqual(_counts(_harness("width", "0", env={"CTC_JOBS": "2"}))["peak"], 2)
+
+
+@unittest.skipUnless(_ensure_built(), SKIP_REASON)
+class TestExceptions(unittest.TestCase):
+    def _check(self, threads: str) -> None:
+        lines = _harness("throw", "64", threads).splitlines()
+        self.assertEqual(lines, ["caught task 3", "ran=64", "caught first", "reused"])
+
+    def test_pooled(self) -> None:
+        self._check("4")
+
+    def test_inline(self) -> None:
+        self._check("1")
+
+
+@unittest.skipUnless(_ensure_built(), SKIP_REASON)
+class TestJobserver(unittest.TestCase):
+    """Each thread beyond the caller's holds one make jobserver token."""
+
+    def _with_tokens(self, tokens: bytes) -> tuple[dict[str, int], bytes]:
+        tmp = Path(tempfile.mkdtemp(prefix="ctc_executor_js_"))
+        try:
+            fifo = tmp / "jobserver"
+            os.mkfifo(fifo)
+            fd = os.open(fifo, os.O_RDWR | os.O_NONBLOCK)
+            try:
+                if tokens:
+                    os.write(fd, tokens)
+                env = {"MAKEFLAGS": f"-j3 --jobserver-auth=fifo:{fifo}"}
+                counts = _counts(_harness("width", "8", env=env))
+                try:
+                    left = os.read(fd, 16)
+                except BlockingIOError:
+                    left = b""
+                return counts, left
+            finally:
+                os.close(fd)
+        finally:
+            shutil.rmtree(tmp, ignore_errors=True)
+
+    def test_tokens_taken_and_returned(self) -> None:
+        counts, left = self._with_tokens(b"++")
+        self.assertLessEqual(counts["threads"], 2)
+        self.assertGreaterEqual(counts["peak"], 2)
+        self.assertEqual(left, b"++")  # every token came back
+
+    def test_no_tokens_stays_serial(self) -> None:
+        counts, left = self._with_tokens(b"")
+        self.assertEqual(counts, {"threads": 0, "peak": 1})
+        self.assertEqual(left, b"")
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,193 @@
+"""Tests for ctc-flagbench, the compiler-flag A/B benchmark.
+
+ctc-flagbench builds the sources once per flag profile (compiles in parallel,
+one directory per profile), records compile CPU time, peak RSS and binary
+size, then runs the benchmark interleaved across profiles and reports means
+with 95% confidence intervals against the first profile. The compiler here is
+a stand-in whose "binary" sleeps less under -O3.
+
+Tests cover:
+  - Every (profile, source) compile and one link per profile, with the
+    profile's flags, --flag and --link-flag in place
+  - -O3 reported faster than -O0 with an interval that excludes zero
+  - {bin} substitution vs. arguments for the binary
+  - JSON output fields, --build-only, --out keeps the build
+  - Compile failures and failing benchmarks exit non-zero
+"""
+
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import unittest
+from pathlib import Path
+
+IS_WINDOWS = sys.platform == "win32"
+IS_LINUX = sys.platform.startswith("linux")
+
+
+# ------------------------------------------------------------------
+# Module-level compilation: build native tools once for all tests
+# ------------------------------------------------------------------
+
+_build_dir: str | None = None
+_build_ok: bool = False
+
+
+def _ensure_built() -> bool:
+    """Compile native tools into a temp directory (runs once per session)."""
+    global _build_dir, _build_ok  # noqa: PLW0603
+    if _build_dir is not None:
+        return _build_ok
+
+    import importlib.resources as resources
+
+    ref = resources.files("clang_tool_chain.native_tools").joinpath("launcher_flagbench.cpp")
+    if not (hasattr(ref, "is_file") and ref.is_file()):  # type: ignore[union-attr]
+        _build_dir = ""
+        return False
+
+    _build_dir = tempfile.mkdtemp(prefix="ctc_flagbench_test_")
+
+    try:
+        from clang_tool_chain.commands.compile_native import compile_native
+
+        rc = compile_native(_build_dir)
+        _build_ok = rc == 0
+    except Exception:
+        _build_ok = False
+
+    if not _build_ok:
+        print(
+            f"WARNING: native tool compilation failed (dir={_build_dir})",
+            file=sys.stderr,
+        )
+
+    import atexit
+
+    def _cleanup() -> None:
+        if _build_dir and os.path.isdir(_build_dir):
+            shutil.rmtree(_build_dir, ignore_errors=True)
+
+    atexit.register(_cleanup)
+    return _build_ok
+
+
+def _exe(name: str) -> str:
+    _ensure_built()
+    suffix = ".exe" if IS_WINDOWS else ""
+    return str(Path(_build_dir or "") / f"{name}{suffix}")
+
+
+SKIP_REASON = "Native tool compilation failed"
+
+
+# Compiler stand-in: logs argv; -c writes an object, otherwise "links" a shell
+# script that records its arguments and sleeps 30 ms (-O0) or 5 ms (-O3).
+_FAKE_CXX = r"""#!/usr/bin/env python3
+import os, sys
+args = sys.argv[1:]
+with open(os.path.join(os.path.dirname(os.path.abspath(__file__)), "cxx.log"), "a") as f:
+    f.write(" ".join(args) + "\n")
+out = args[args.index("-o") + 1]
+if "-c" in args:
+    src = args[args.index("-c") + 1]
+    if "BROKEN" in open(src).read():
+        sys.exit(1)
+    open(out, "w").write("object " + " ".join(args))
+    sys.exit(0)
+delay = "0.005" if "-O3" in args else "0.03"
+pad = "#" * (4096 if "-O3" in args else 0)
+log = os.path.join(os.path.dirname(out), "runs.log")
+open(out, "w").write('#!/bin/sh\necho "$@" >> %s\nsleep %s\n%s\n' % (log, delay, pad))
+os.chmod(out, 0o755)
+"""
+
+
+@unittest.skipUnless(IS_LINUX, "fake compiler is a POSIX script")
+@unittest.skipUnless(_ensure_built(), SKIP_REASON)
+class TestFlagbench(unittest.TestCase):
+    def setUp(self) -> None:
+        self.root = Path(tempfile.mkdtemp(prefix="ctc_flagbench_"))
+        self.cxx = self.root / "tools" / "c++"
+        self.cxx.parent.mkdir()
+        self.cxx.write_text(_FAKE_CXX)
+        self.cxx.chmod(0o755)
+        (self.root / "a.cpp").write_text("int f();\n")
+        (self.root / "main.cpp").write_text("int main() {}\n")
+        self.out = self.root / "out"
+
+    def tearDown(self) -> None:
+        shutil.rmtree(self.root, ignore_errors=True)
+
+    def _bench(self, *args: str, sources: tuple[str, ...] = ("a.cpp", "main.cpp")) -> subprocess.CompletedProcess:
+        cmd = [_exe("ctc-flagbench"), "--clang", str(self.cxx), "-P", "o0=-O0", "-P", "o3=-O3 -DFAST"]
+        return subprocess.run(
+            [*cmd, *sources, *args], capture_output=True, text=True, cwd=self.root, timeout=120
+        )
+
+    def _log(self) -> list[str]:
+        return (self.cxx.parent / "cxx.log").read_text().splitlines()
+
+    def test_builds_and_compares(self) -> None:
+        result = self._bench("--runs", "6", "--warmup", "1", "--flag", "-Iinc", "--link-flag", "-lm")
+        self.assertEqual(result.returncode, 0, result.stderr)
+        log = self._log()
+        compiles = [line for line in log if " -c " in line]
+        links = [line for line in log if " -c " not in line]
+        self.assertEqual(len(compiles), 4)
+        self.assertEqual(len(links), 2)
+        self.assertTrue(all("-Iinc" in line for line in log))
+        self.assertTrue(all("-lm" in line for line in links))
+        self.assertIn("-O3 -DFAST -Iinc -c a.cpp", " ".join(compiles))
+
+        out = result.stdout
+        self.assertIn("2 profiles, 2 source(s), 6 runs each (1 warmup)", out)
+        o3 = next(line for line in out.splitlines() if line.strip().startswith("o3") and "%" in line)
+        self.assertIn("faster", o3)
+        o0 = next(line for line in out.splitlines() if line.strip().startswith("o0") and "baseline" in line)
+        self.assertIn("ms", o0)
+
+    def test_json_and_out_dir(self) -> None:
+        result = self._bench("--runs", "3", "--warmup", "0", "--json", "--out", str(self.out))
+        self.assertEqual(result.returncode, 0, result.stderr)
+        data = json.loads(result.stdout)
+        self.assertEqual(data["runs"], 3)
+        o0, o3 = data["profiles"]
+        self.assertEqual((o0["name"], o3["name"]), ("o0", "o3"))
+        self.assertEqual(o3["flags"], "-O3 -DFAST")
+        self.assertGreater(o3["binary_size"], o0["binary_size"])
+        self.assertLess(o3["run_mean_s"], o0["run_mean_s"])
+        self.assertLess(o3["change_vs_base"], 0)
+        self.assertGreater(o0["compile_cpu_s"], 0)
+        self.assertTrue((self.out / "o3" / "bench").is_file())
+        self.assertEqual(len((self.out / "o0" / "runs.log").read_text().splitlines()), 3)
+
+    def test_bench_command(self) -> None:
+        self._bench("--runs", "1", "--warmup", "0", "--out", str(self.out), "--", "sh", "{bin}", "x")
+        self.assertEqual((self.out / "o0" / "runs.log").read_text().split(), ["x"])
+        shutil.rmtree(self.out)
+        self._bench("--runs", "1", "--warmup", "0", "--out", str(self.out), "--", "--size", "3")
+        self.assertEqual((self.out / "o3" / "runs.log").read_text().split(), ["--size", "3"])
+
+    def test_build_only(self) -> None:
+        result = self._bench("--build-only")
+        self.assertEqual(result.returncode, 0, result.stderr)
+        self.assertIn("Build:", result.stdout)
+        self.assertNotIn("Run (wall time", result.stdout)
+
+    def test_failures(self) -> None:
+        (self.root / "bad.cpp").write_text("BROKEN\n")
+        result = self._bench(sources=("bad.cpp",))
+        self.assertEqual(result.returncode, 1)
+        self.assertIn("o0: compiling bad.cpp failed", result.stderr)
+
+        result = self._bench("--runs", "1", "--", "sh", "-c", "exit 1", "{bin}")
+        self.assertEqual(result.returncode, 1)
+        self.assertIn("benchmark exited with 1", result.stderr)
+
+
+if __name__ == "__main__":
+    unittest.main()
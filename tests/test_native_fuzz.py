@@ -0,0 +1,405 @@
+"""Tests for ctc-fuzz and the launcher's -fsanitize=fuzzer handling.
+
+ctc-fuzz builds libFuzzer targets through ctc-clang++ (fuzzer plus ASAN/UBSAN,
+runtime deployed next to the binary) and runs campaigns as rounds of parallel
+workers on a shared corpus, each round ending in a -merge=1 minimization that
+replaces the corpus. The fuzz target here is a stand-in that speaks enough of
+libFuzzer's command line and output: workers add one input and print
+progress and final stats, -merge=1 keeps one file per distinct content.
+
+Tests cover:
+  - build: sanitizer flags, fatal UBSAN, --deploy-dependencies, C sources,
+    compiler failures
+  - run: rounds, per-worker exec/s and coverage, seeds folded into the
+    corpus, merge minimization, JSON summary
+  - Merges get the limit and artifact flags by name, not coverage flags
+  - Crash artifacts with their SUMMARY line stop the campaign (exit 1)
+    unless --keep-going
+  - Ctrl-C stops the workers but the final merge still runs
+  - merge subcommand
+  - ctc-clang adds -shared-libasan for -fsanitize=fuzzer,address
+  - Fuzzer targets without ASAN get ASAN_ and UBSAN_SYMBOLIZER_PATH
+"""
+
+import json
+import os
+import platform
+import shutil
+import signal
+import subprocess
+import sys
+import tempfile
+import time
+import unittest
+from pathlib import Path
+
+IS_WINDOWS = sys.platform == "win32"
+IS_LINUX = sys.platform.startswith("linux")
+
+
+# ------------------------------------------------------------------
+# Module-level compilation: build native tools once for all tests
+# ------------------------------------------------------------------
+
+_build_dir: str | None = None
+_build_ok: bool = False
+
+
+def _ensure_built() -> bool:
+    """Compile native tools into a temp directory (runs once per session)."""
+    global _build_dir, _build_ok  # noqa: PLW0603
+    if _build_dir is not None:
+        return _build_ok
+
+    import importlib.resources as resources
+
+    ref = resources.files("clang_tool_chain.native_tools").joinpath("launcher_fuzz.cpp")
+    if not (hasattr(ref, "is_file") and ref.is_file()):  # type: ignore[union-attr]
+        _build_dir = ""
+        return False
+
+    _build_dir = tempfile.mkdtemp(prefix="ctc_fuzz_test_")
+
+    try:
+        from clang_tool_chain.commands.compile_native import compile_native
+
+        rc = compile_native(_build_dir)
+        _build_ok = rc == 0
+    except Exception:
+        _build_ok = False
+
+    if not _build_ok:
+        print(
+            f"WARNING: native tool compilation failed (dir={_build_dir})",
+            file=sys.stderr,
+        )
+
+    import atexit
+
+    def _cleanup() -> None:
+        if _build_dir and os.path.isdir(_build_dir):
+            shutil.rmtree(_build_dir, ignore_errors=True)
+
+    atexit.register(_cleanup)
+    return _build_ok
+
+
+def _exe(name: str) -> str:
+    _ensure_built()
+    suffix = ".exe" if IS_WINDOWS else ""
+    return str(Path(_build_dir or "") / f"{name}{suffix}")
+
+
+SKIP_REASON = "Native tool compilation failed"
+
+
+# libFuzzer stand-in. Worker: writes one input derived from -seed into the
+# first corpus dir, prints progress + final stats; FAKE_CRASH=1 makes every
+# worker write a crash artifact and exit 1 (or carry on under -fork). -merge=1: copies one file per
+# distinct content from the other dirs into the first and prints MERGE-OUTER.
+_FAKE_FUZZER = r"""#!/usr/bin/env python3
+import hashlib, os, sys, time
+flags = {}
+dirs = []
+for a in sys.argv[1:]:
+    if a.startswith("-") and "=" in a:
+        k, v = a[1:].split("=", 1)
+        flags[k] = v
+    else:
+        dirs.append(a)
+with open(os.path.join(os.path.dirname(os.path.abspath(__file__)), "fuzzer.log"), "a") as f:
+    f.write(" ".join(sys.argv[1:]) + "\n")
+if flags.get("merge") == "1":
+    seen = set()
+    for d in dirs[1:]:
+        for name in sorted(os.listdir(d)):
+            data = open(os.path.join(d, name), "rb").read()
+            h = hashlib.sha1(data).hexdigest()
+            if h not in seen:
+                seen.add(h)
+                open(os.path.join(dirs[0], h), "wb").write(data)
+    print("MERGE-OUTER: %d new files with %d new features added; %d new coverage edges"
+          % (len(seen), len(seen) * 10, len(seen) * 3), file=sys.stderr)
+    sys.exit(0)
+seed = int(flags["seed"])
+data = b"input-%d" % (seed % 1000)
+open(os.path.join(dirs[0], hashlib.sha1(data).hexdigest()), "wb").write(data)
+open(os.path.join(dirs[0], "dup"), "wb").write(b"same")
+print("#2\tINITED cov: 5 ft: 7 corp: 1/1b exec/s: 0 rss: 30Mb", file=sys.stderr)
+print("#5000\tNEW    cov: %d ft: 40 corp: 2/2b exec/s: 2500 rss: 31Mb" % (10 + seed % 1000), file=sys.stderr)
+if os.environ.get("FAKE_CRASH"):
+    art = flags["artifact_prefix"] + "crash-%d" % (seed % 1000)
+    open(art, "wb").write(data)
+    print("==1==ERROR: AddressSanitizer: heap-buffer-overflow on address 0x1", file=sys.stderr)
+    print("SUMMARY: AddressSanitizer: heap-buffer-overflow fuzz.cpp:7 in LLVMFuzzerTestOneInput", file=sys.stderr)
+    print("artifact_prefix='%s'; Test unit written to %s" % (flags["artifact_prefix"], art), file=sys.stderr)
+    if "fork" not in flags:
+        sys.exit(1)
+time.sleep(int(flags["max_total_time"]))
+print("Done 6000 runs in 2 second(s)", file=sys.stderr)
+print("stat::number_of_executed_units: 6000", file=sys.stderr)
+print("stat::average_exec_per_sec:     3000", file=sys.stderr)
+print("stat::peak_rss_mb:              31", file=sys.stderr)
+"""
+
+
+def _fuzz(*args: str, env: dict[str, str] | None = None, cwd: Path | None = None) -> subprocess.CompletedProcess[str]:
+    return subprocess.run(
+        [_exe("ctc-fuzz"), *args], capture_output=True, text=True, timeout=120, env=env, cwd=cwd
+    )
+
+
+@unittest.skipUnless(IS_LINUX, "fake tools are POSIX scripts")
+@unittest.skipUnless(_ensure_built(), SKIP_REASON)
+class TestFuzzBuild(unittest.TestCase):
+    def setUp(self) -> None:
+        self.root = Path(tempfile.mkdtemp(prefix="ctc_fuzz_build_"))
+
+    def tearDown(self) -> None:
+        shutil.rmtree(self.root, ignore_errors=True)
+
+    def test_default_flags(self) -> None:
+        r = _fuzz("build", "--dry-run", "fuzz_parser.cpp", "parser.cpp", "--", "-Iinclude")
+        self.assertEqual(r.returncode, 0, r.stderr)
+        cmd = r.stdout.split()
+        self.assertTrue(cmd[0].endswith("/ctc-clang++"))
+        for flag in ("-g", "-O1", "-fno-omit-frame-pointer", "-fsanitize=fuzzer,address,undefined",
+                     "-fno-sanitize-recover=undefined", "--deploy-dependencies", "-Iinclude"):
+            self.assertIn(flag, cmd)
+        self.assertEqual(cmd[-2:], ["-o", "fuzz_parser"])
+
+    def test_sanitizer_choice_and_c_sources(self) -> None:
+        cmd = _fuzz("build", "--dry-run", "--sanitize", "none", "--no-deploy", "-o", "f", "f.c").stdout.split()
+        self.assertTrue(cmd[0].endswith("/ctc-clang"))
+        self.assertIn("-fsanitize=fuzzer", cmd)
+        self.assertNotIn("-fno-sanitize-recover=undefined", cmd)
+        self.assertNotIn("--deploy-dependencies", cmd)
+        cmd = _fuzz("build", "--dry-run", "--sanitize", "memory", "f.cpp").stdout.split()
+        self.assertIn("-fsanitize=fuzzer,memory", cmd)
+
+    def test_compiler_result(self) -> None:
+        cxx = self.root / "cxx"
+        cxx.write_text('#!/bin/sh\nfor a; do last="$a"; done\necho "$@" > "$last"\n')
+        cxx.chmod(0o755)
+        r = _fuzz("build", "--clang", str(cxx), "f.cpp", "-o", str(self.root / "f"))
+        self.assertEqual(r.returncode, 0, r.stderr)
+        self.assertIn("-fsanitize=fuzzer", (self.root / "f").read_text())
+        cxx.write_text("#!/bin/sh\nexit 3\n")
+        r = _fuzz("build", "--clang", str(cxx), "f.cpp")
+        self.assertEqual(r.returncode, 1)
+        self.assertIn("build failed (exit 3)", r.stderr)
+
+    def test_usage_errors(self) -> None:
+        self.assertEqual(_fuzz("build").returncode, 2)
+        self.assertEqual(_fuzz("build", "-O2", "f.cpp").returncode, 2)
+        self.assertEqual(_fuzz("bogus").returncode, 2)
+        self.assertEqual(_fuzz("run", "only-binary").returncode, 2)
+
+
+@unittest.skipUnless(IS_LINUX, "fake tools are POSIX scripts")
+@unittest.skipUnless(_ensure_built(), SKIP_REASON)
+class TestFuzzRun(unittest.TestCase):
+    def setUp(self) -> None:
+        self.root = Path(tempfile.mkdtemp(prefix="ctc_fuzz_run_"))
+        self.target = self.root / "tools" / "fuzz_target"
+        self.target.parent.mkdir()
+        self.target.write_text(_FAKE_FUZZER)
+        self.target.chmod(0o755)
+        self.corpus = self.root / "corpus"
+        self.seeds = self.root / "seeds"
+        self.seeds.mkdir()
+        (self.seeds / "a").write_bytes(b"seed")
+        (self.seeds / "b").write_bytes(b"seed")
+        self.env = dict(os.environ)
+        self.env.pop("FAKE_CRASH", None)
+
+    def tearDown(self) -> None:
+        shutil.rmtree(self.root, ignore_errors=True)
+
+    def _calls(self) -> list[str]:
+        return (self.root / "tools" / "fuzzer.log").read_text().splitlines()
+
+    def test_rounds_merge_and_json(self) -> None:
+        r = _fuzz(
+            "run", str(self.target), str(self.corpus), str(self.seeds), "-w", "2", "--time", "2",
+            "--merge-every", "1", "--rss-limit-mb", "64", "--max-len", "128", "--json", "--", "-use_value_profile=1",
+            env=self.env,
+        )
+        self.assertEqual(r.returncode, 0, r.stderr)
+        report = json.loads(r.stdout)
+        self.assertEqual(report["workers"], 2)
+        self.assertEqual(len(report["rounds"]), 2)
+        first = report["rounds"][0]
+        self.assertEqual(len(first["workers"]), 2)
+        for w in first["workers"]:
+            self.assertEqual(w["execs"], 6000)
+            self.assertEqual(w["exec_per_s"], 3000)
+            self.assertGreaterEqual(w["cov"], 10)
+            self.assertEqual(w["peak_rss_mb"], 31)
+        self.assertTrue(first["merge_ok"])
+        # 2 worker inputs + "dup" + the seed content, one file each
+        self.assertEqual(first["corpus_after"], 4)
+        self.assertEqual(first["edges"], 12)
+        self.assertEqual(report["findings"], [])
+        self.assertFalse((self.root / "corpus.old").exists())
+        self.assertFalse((self.root / "corpus.merge").exists())
+
+        calls = self._calls()
+        workers = [c for c in calls if "-merge=1" not in c]
+        merges = [c for c in calls if "-merge=1" in c]
+        self.assertEqual(len(workers), 4)
+        self.assertEqual(len(merges), 2)
+        for c in workers:
+            self.assertIn("-max_total_time=1", c)
+            self.assertIn("-rss_limit_mb=64", c)
+            self.assertIn("-max_len=128", c)
+            self.assertIn("-use_value_profile=1", c)
+            self.assertIn(f"-artifact_prefix={self.corpus}-artifacts/", c)
+        # Seeds only in round 1 (workers and merge)
+        self.assertEqual(sum(str(self.seeds) in c for c in workers), 2)
+        self.assertIn(str(self.seeds), merges[0])
+        self.assertNotIn(str(self.seeds), merges[1])
+        self.assertTrue((self.corpus.parent / "corpus-artifacts" / "logs" / "round1-worker0.log").is_file())
+
+    def test_merge_flags_selected_by_name(self) -> None:
+        r = _fuzz(
+            "run", str(self.target), str(self.corpus), "-w", "1", "--time", "1", "--merge-every", "1",
+            "--max-len", "128", "--dict", str(self.seeds / "a"), "--timeout", "5", "--keep-going",
+            "--", "-use_value_profile=1", "-malloc_limit_mb=32",
+            env=self.env,
+        )
+        self.assertEqual(r.returncode, 0, r.stderr)
+        merges = [c.split() for c in self._calls() if "-merge=1" in c]
+        self.assertEqual(len(merges), 1)
+        for flag in ("-rss_limit_mb=2048", f"-artifact_prefix={self.corpus}-artifacts/", "-timeout=5",
+                     "-malloc_limit_mb=32"):
+            self.assertIn(flag, merges[0])
+        for prefix in ("-max_len=", "-dict=", "-use_value_profile=", "-fork=", "-ignore_crashes="):
+            self.assertFalse(any(f.startswith(prefix) for f in merges[0]), prefix)
+
+    def test_text_report(self) -> None:
+        r = _fuzz("run", str(self.target), str(self.corpus), "-w", "2", "--time", "1", env=self.env)
+        self.assertEqual(r.returncode, 0, r.stderr)
+        self.assertIn("round 1:", r.stderr)
+        self.assertIn("exec/s per worker: 3000 3000", r.stderr)
+        self.assertIn("1 round(s)", r.stderr)
+
+    def test_crash_stops_campaign(self) -> None:
+        self.env["FAKE_CRASH"] = "1"
+        r = _fuzz(
+            "run", str(self.target), str(self.corpus), "-w", "2", "--time", "5", "--merge-every", "1",
+            "--json", env=self.env,
+        )
+        self.assertEqual(r.returncode, 1, r.stderr)
+        report = json.loads(r.stdout)
+        self.assertEqual(len(report["rounds"]), 1)
+        self.assertEqual(len(report["findings"]), 2)
+        finding = report["findings"][0]
+        self.assertEqual(finding["kind"], "crash")
+        self.assertTrue(Path(finding["artifact"]).is_file())
+        self.assertIn("SUMMARY: AddressSanitizer: heap-buffer-overflow", finding["summary"])
+
+        r = _fuzz(
+            "run", str(self.target), str(self.corpus), "-w", "1", "--time", "2", "--merge-every", "1",
+            "--keep-going", env=self.env,
+        )
+        self.assertEqual(r.returncode, 1)
+        self.assertIn("2 round(s)", r.stderr)
+        self.assertIn("crash (worker 0):", r.stderr)
+        self.assertIn("-fork=1 -ignore_crashes=1", self._calls()[-2])
+
+    def test_interrupt_still_merges(self) -> None:
+        proc = subprocess.Popen(
+            [_exe("ctc-fuzz"), "run", str(self.target), str(self.corpus), "-w", "2", "--time", "30", "--json"],
+            stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True, env=self.env,
+        )
+        # Both workers have logged their call once they are up
+        for _ in range(100):
+            log = self.root / "tools" / "fuzzer.log"
+            if log.is_file() and len(log.read_text().splitlines()) == 2:
+                break
+            time.sleep(0.05)
+        time.sleep(0.2)
+        proc.send_signal(signal.SIGINT)
+        out, err = proc.communicate(timeout=60)
+        self.assertEqual(proc.returncode, 0, err)
+        self.assertNotIn("merge failed", err)
+        report = json.loads(out)
+        self.assertTrue(report["interrupted"])
+        self.assertEqual(len(report["rounds"]), 1)
+        self.assertTrue(report["rounds"][0]["merge_ok"])
+        self.assertEqual(sum("-merge=1" in c for c in self._calls()), 1)
+        self.assertEqual(len(list(self.corpus.iterdir())), 3)
+
+    def test_merge_subcommand(self) -> None:
+        self.corpus.mkdir()
+        (self.corpus / "x").write_bytes(b"seed")
+        (self.corpus / "y").write_bytes(b"other")
+        r = _fuzz("merge", str(self.target), str(self.corpus), str(self.seeds), env=self.env)
+        self.assertEqual(r.returncode, 0, r.stderr)
+        self.assertIn("4 input(s) -> 2 file(s), 20 features, 6 edges", r.stdout)
+        self.assertEqual(len(list(self.corpus.iterdir())), 2)
+
+
+@unittest.skipUnless(IS_LINUX, "shared ASAN injection is tested on Linux")
+@unittest.skipUnless(_ensure_built(), SKIP_REASON)
+class TestFuzzerLauncherFlags(unittest.TestCase):
+    def setUp(self) -> None:
+        self.root = Path(tempfile.mkdtemp(prefix="ctc_fuzz_flags_"))
+        arch = "arm64" if platform.machine().lower() in ("aarch64", "arm64") else "x86_64"
+        install = self.root / "clang" / "linux" / arch
+        (install / "bin").mkdir(parents=True)
+        (install / "lib" / "clang" / "19" / "include").mkdir(parents=True)
+        (install / "done.txt").write_text("ok\n")
+        shutil.copy("/bin/echo", install / "bin" / "clang")
+        (install / "bin" / "clang++").symlink_to("clang")
+        self.env = dict(os.environ)
+        self.env["CLANG_TOOL_CHAIN_DOWNLOAD_PATH"] = str(self.root)
+        for key in ("CLANG_TOOL_CHAIN_NO_SHARED_ASAN", "CLANG_TOOL_CHAIN_RUNTIME", "CLANG_TOOL_CHAIN_NO_AUTO"):
+            self.env.pop(key, None)
+
+    def tearDown(self) -> None:
+        shutil.rmtree(self.root, ignore_errors=True)
+
+    def _args(self, *args: str) -> list[str]:
+        result = subprocess.run(
+            [_exe("ctc-clang++"), "--dry-run", *args],
+            capture_output=True,
+            text=True,
+            env=self.env,
+            cwd=self.root,
+            timeout=60,
+        )
+        self.assertEqual(result.returncode, 0, result.stderr)
+        return result.stdout.split()
+
+    def test_fuzzer_with_address(self) -> None:
+        self.assertIn("-shared-libasan", self._args("-fsanitize=fuzzer,address", "f.cpp", "-o", "f"))
+        self.assertIn("-shared-libasan", self._args("-fsanitize=address", "f.cpp", "-o", "f"))
+
+    def test_fuzzer_without_address(self) -> None:
+        self.assertNotIn("-shared-libasan", self._args("-fsanitize=fuzzer,undefined", "f.cpp", "-o", "f"))
+        self.assertNotIn("-shared-libasan", self._args("-fsanitize=kernel-address", "f.cpp", "-o", "f"))
+
+    def test_symbolizer_env_without_address(self) -> None:
+        bin_dir = next((self.root / "clang" / "linux").iterdir()) / "bin"
+        (bin_dir / "llvm-symbolizer").write_text("")
+        (bin_dir / "clang").unlink()
+        (bin_dir / "clang").write_text('#!/bin/sh\necho "$ASAN_SYMBOLIZER_PATH" "$UBSAN_SYMBOLIZER_PATH"\n')
+        (bin_dir / "clang").chmod(0o755)
+        for key in ("ASAN_SYMBOLIZER_PATH", "UBSAN_SYMBOLIZER_PATH", "CLANG_TOOL_CHAIN_NO_SANITIZER_ENV"):
+            self.env.pop(key, None)
+        result = subprocess.run(
+            [_exe("ctc-clang++"), "-fsanitize=fuzzer,undefined", "-c", "f.cpp"],
+            capture_output=True,
+            text=True,
+            env=self.env,
+            cwd=self.root,
+            timeout=60,
+        )
+        self.assertEqual(result.returncode, 0, result.stderr)
+        self.assertEqual(result.stdout.split(), [str(bin_dir / "llvm-symbolizer")] * 2)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,186 @@
+"""Tests for the native header impact analyzer (ctc-include-impact).
+
+The analyzer walks a build directory for Make-style ``.d`` files (plus
+optional ``clang -H`` traces saved as ``<object>.includes``), builds the
+header -> TU graph, and ranks headers by the compile time of every TU that
+would rebuild if the header were touched.
+
+Tests cover:
+  - Registry & resource presence
+  - Fan-out ranking from .d files alone (every TU weighs 1)
+  - .ninja_log weighting, escaped spaces, -MP phony rules
+  - One header spelled with "./", "//" or "dir/.." counted once
+  - Include-trace depth attribution and JSON output
+"""
+
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import unittest
+from pathlib import Path
+
+IS_WINDOWS = sys.platform == "win32"
+
+
+# ------------------------------------------------------------------
+# Module-level compilation: build native tools once for all tests
+# ------------------------------------------------------------------
+
+_build_dir: str | None = None
+_build_ok: bool = False
+
+
+def _ensure_built() -> bool:
+    """Compile native tools into a temp directory (runs once per session)."""
+    global _build_dir, _build_ok  # noqa: PLW0603
+    if _build_dir is not None:
+        return _build_ok
+
+    import importlib.resources as resources
+
+    ref = resources.files("clang_tool_chain.native_tools").joinpath("launcher_include_impact.cpp")
+    if not (hasattr(ref, "is_file") and ref.is_file()):  # type: ignore[union-attr]
+        _build_dir = ""
+        return False
+
+    _build_dir = tempfile.mkdtemp(prefix="ctc_include_impact_test_")
+
+    try:
+        from clang_tool_chain.commands.compile_native import compile_native
+
+        rc = compile_native(_build_dir)
+        _build_ok = rc == 0
+    except Exception:
+        _build_ok = False
+
+    if not _build_ok:
+        print(
+            f"WARNING: native tool compilation failed (dir={_build_dir})",
+            file=sys.stderr,
+        )
+
+    import atexit
+
+    def _cleanup() -> None:
+        if _build_dir and os.path.isdir(_build_dir):
+            shutil.rmtree(_build_dir, ignore_errors=True)
+
+    atexit.register(_cleanup)
+    return _build_ok
+
+
+def _exe(name: str) -> str:
+    _ensure_built()
+    suffix = ".exe" if IS_WINDOWS else ""
+    return str(Path(_build_dir or "") / f"{name}{suffix}")
+
+
+def _run(args: list[str]) -> subprocess.CompletedProcess:
+    return subprocess.run(args, capture_output=True, text=True, encoding="utf-8", errors="replace", timeout=60)
+
+
+SKIP_REASON = "Native tool compilation failed"
+
+
+def _write_build_tree(root: Path) -> None:
+    """Three TUs: core.h in all of them, util.h in two, rare h in one."""
+    obj = root / "obj"
+    obj.mkdir()
+    (obj / "a.o.d").write_text("obj/a.o: ../src/a.cpp ../inc/core.h \\\n  ../inc/util.h\n../inc/core.h:\n")
+    (obj / "b.o.d").write_text("obj/b.o: ../src/b.cpp ../inc/core.h ../inc/util.h\n")
+    (obj / "c.o.d").write_text("obj/c.o: ../src/c.cpp ./../inc/core.h ../inc/with\\ space.h\n")
+
+
+# ==========================================================================
+# Resource & Registry
+# ==========================================================================
+
+
+class TestIncludeImpactResource(unittest.TestCase):
+    """Verify launcher_include_impact.cpp is accessible and registered."""
+
+    def test_registry_has_include_impact(self) -> None:
+        from clang_tool_chain.native_tools import TOOL_REGISTRY
+
+        self.assertIn("include_impact", TOOL_REGISTRY)
+        tool = TOOL_REGISTRY["include_impact"]
+        self.assertEqual(tool.source, "launcher_include_impact.cpp")
+        self.assertEqual(tool.output, "ctc-include-impact")
+
+
+# ==========================================================================
+# Ranking
+# ==========================================================================
+
+
+@unittest.skipUnless(_ensure_built(), SKIP_REASON)
+class TestRanking(unittest.TestCase):
+    def setUp(self) -> None:
+        self.tmp = Path(tempfile.mkdtemp(prefix="ctc_ii_"))
+        _write_build_tree(self.tmp)
+
+    def tearDown(self) -> None:
+        shutil.rmtree(self.tmp, ignore_errors=True)
+
+    def _json(self, *extra: str) -> dict:
+        result = _run([_exe("ctc-include-impact"), "--json", *extra, str(self.tmp)])
+        self.assertEqual(result.returncode, 0, result.stderr)
+        return json.loads(result.stdout)
+
+    def test_fan_out_without_ninja_log(self) -> None:
+        data = self._json()
+        self.assertEqual(data["tus"], 3)
+        self.assertEqual(data["cost_unit"], "tus")
+        ranking = {r["header"]: r for r in data["ranking"]}
+        self.assertEqual(ranking["../inc/core.h"]["tus"], 3)
+        self.assertEqual(ranking["../inc/util.h"]["tus"], 2)
+        self.assertIn("../inc/with space.h", ranking)
+        self.assertEqual(data["ranking"][0]["header"], "../inc/core.h")
+
+    def test_ninja_log_weights_cost(self) -> None:
+        (self.tmp / ".ninja_log").write_text(
+            "# ninja log v5\n0\t1000\t0\tobj/a.o\tx\n0\t500\t0\tobj/b.o\tx\n0\t9000\t0\tobj/c.o\tx\n"
+        )
+        data = self._json()
+        self.assertEqual(data["cost_unit"], "seconds")
+        ranking = {r["header"]: r for r in data["ranking"]}
+        self.assertAlmostEqual(ranking["../inc/core.h"]["cost"], 10.5, places=2)
+        # with space.h only lives in the slow TU, so it outranks util.h
+        self.assertAlmostEqual(ranking["../inc/with space.h"]["cost"], 9.0, places=2)
+        self.assertAlmostEqual(ranking["../inc/util.h"]["cost"], 1.5, places=2)
+
+    def test_spellings_of_one_header_merge(self) -> None:
+        (self.tmp / "obj" / "b.o.d").write_text("obj/b.o: ../src/b.cpp ../inc/sub/../core.h ..//inc/./util.h\n")
+        data = self._json()
+        ranking = {r["header"]: r for r in data["ranking"]}
+        self.assertEqual(ranking["../inc/core.h"]["tus"], 3)
+        self.assertEqual(ranking["../inc/util.h"]["tus"], 2)
+        self.assertEqual(len(ranking), 3)
+
+    def test_exclude_prefix(self) -> None:
+        data = self._json("--exclude", "../inc/u")
+        self.assertNotIn("../inc/util.h", [r["header"] for r in data["ranking"]])
+
+    def test_trace_depth(self) -> None:
+        (self.tmp / "obj" / "a.o.includes").write_text(
+            ". ../inc/core.h\n.. ../inc/util.h\nMultiple include guards may be useful for:\n../inc/x.h\n"
+        )
+        data = self._json("--sort", "depth")
+        self.assertEqual(data["tus"], 3)  # trace TU already counted via its .d file
+        self.assertEqual(data["ranking"][0]["header"], "../inc/util.h")
+        self.assertAlmostEqual(data["ranking"][0]["mean_depth"], 2.0)
+
+    def test_empty_dir_fails(self) -> None:
+        empty = Path(tempfile.mkdtemp(prefix="ctc_ii_empty_"))
+        try:
+            result = _run([_exe("ctc-include-impact"), str(empty)])
+            self.assertNotEqual(result.returncode, 0)
+        finally:
+            shutil.rmtree(empty, ignore_errors=True)
+
+
+if __name__ == "__main__":
+    unittest.main()
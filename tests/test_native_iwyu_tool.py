@@ -0,0 +1,256 @@
+"""Tests for ctc-iwyu-tool, the parallel include-what-you-use driver.
+
+ctc-iwyu-tool runs IWYU for every compilation-database entry on the shared
+executor, caches each TU's output next to its `-M` dependency closure, and
+merges the outputs into one report. IWYU and the compiler are stand-ins: the
+fake IWYU prints a block for the source and for every quoted include, and logs
+each invocation; the fake compiler answers -M with the quoted includes.
+
+Tests cover:
+  - Shared headers reported by several TUs appear once in the merged report
+  - Second run is fully cached; header edits re-run only the TUs including it
+  - Touching a header without editing it keeps the cache
+  - Mapping-file contents are part of the cache key
+  - Compile errors are reported, exit 1 and are not cached
+  - Source filters and -o
+"""
+
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import unittest
+from pathlib import Path
+
+IS_WINDOWS = sys.platform == "win32"
+IS_LINUX = sys.platform.startswith("linux")
+
+
+# ------------------------------------------------------------------
+# Module-level compilation: build native tools once for all tests
+# ------------------------------------------------------------------
+
+_build_dir: str | None = None
+_build_ok: bool = False
+
+
+def _ensure_built() -> bool:
+    """Compile native tools into a temp directory (runs once per session)."""
+    global _build_dir, _build_ok  # noqa: PLW0603
+    if _build_dir is not None:
+        return _build_ok
+
+    import importlib.resources as resources
+
+    ref = resources.files("clang_tool_chain.native_tools").joinpath("launcher_iwyu_tool.cpp")
+    if not (hasattr(ref, "is_file") and ref.is_file()):  # type: ignore[union-attr]
+        _build_dir = ""
+        return False
+
+    _build_dir = tempfile.mkdtemp(prefix="ctc_iwyu_tool_test_")
+
+    try:
+        from clang_tool_chain.commands.compile_native import compile_native
+
+        rc = compile_native(_build_dir)
+        _build_ok = rc == 0
+    except Exception:
+        _build_ok = False
+
+    if not _build_ok:
+        print(
+            f"WARNING: native tool compilation failed (dir={_build_dir})",
+            file=sys.stderr,
+        )
+
+    import atexit
+
+    def _cleanup() -> None:
+        if _build_dir and os.path.isdir(_build_dir):
+            shutil.rmtree(_build_dir, ignore_errors=True)
+
+    atexit.register(_cleanup)
+    return _build_ok
+
+
+def _exe(name: str) -> str:
+    _ensure_built()
+    suffix = ".exe" if IS_WINDOWS else ""
+    return str(Path(_build_dir or "") / f"{name}{suffix}")
+
+
+SKIP_REASON = "Native tool compilation failed"
+
+
+# IWYU stand-in: one block per file (source first, then quoted includes); the
+# suggestion echoes the file's first line so edits change the report. A file
+# containing ERROR makes it fail like a compile error.
+_FAKE_IWYU = r"""#!/usr/bin/env python3
+import os, re, sys
+args = sys.argv[1:]
+root = os.path.dirname(os.path.abspath(__file__))
+src = next(a for a in args if a.endswith(".cpp"))
+with open(os.path.join(root, "iwyu.log"), "a") as f:
+    f.write(src + "\n")
+text = open(src).read()
+files = [src] + re.findall(r'#include "([^"]+)"', text)
+rc = 0
+for name in files:
+    body = open(name).read()
+    if "ERROR" in body:
+        print("%s:1:1: error: broken" % name)
+        rc = 1
+        continue
+    if "CLEAN" in body:
+        print("(%s has correct #includes/fwd-decls)" % name)
+        continue
+    mapping = "+map" if any(a.startswith("--mapping_file=") for a in args) else ""
+    print("%s should add these lines:" % name)
+    print("#include <%s>%s" % (body.splitlines()[-1], mapping))
+    print("")
+    print("%s should remove these lines:" % name)
+    print("")
+    print("The full include-list for %s:" % name)
+    print("---")
+print("")
+sys.exit(rc)
+"""
+
+# Compiler stand-in: -M -MF writes the source and its quoted includes.
+_FAKE_CC = r"""#!/usr/bin/env python3
+import re, sys
+args = sys.argv[1:]
+if "-M" not in args:
+    sys.exit(1)
+src = next(a for a in args if a.endswith(".cpp"))
+deps = [src] + re.findall(r'#include "([^"]+)"', open(src).read())
+open(args[args.index("-MF") + 1], "w").write("x.o: " + " \\\n ".join(deps) + "\n")
+"""
+
+
+@unittest.skipUnless(IS_LINUX, "fake tools are POSIX scripts")
+@unittest.skipUnless(_ensure_built(), SKIP_REASON)
+class TestIwyuTool(unittest.TestCase):
+    def setUp(self) -> None:
+        self.root = Path(tempfile.mkdtemp(prefix="ctc_iwyu_tool_"))
+        self.tools = self.root / "tools"
+        self.tools.mkdir()
+        self.iwyu = self.tools / "include-what-you-use"
+        self.iwyu.write_text(_FAKE_IWYU)
+        self.iwyu.chmod(0o755)
+        cc = self.tools / "c++"
+        cc.write_text(_FAKE_CC)
+        cc.chmod(0o755)
+        self.src = self.root / "src"
+        self.src.mkdir()
+        self._write("common.h", "vector\n")
+        self._write("a.cpp", '#include "common.h"\nstring\n')
+        self._write("b.cpp", '#include "common.h"\nmap\n')
+        self._write("c.cpp", "CLEAN\n")
+        db = [
+            {"directory": str(self.src), "file": name, "arguments": [str(cc), "-c", name, "-o", name + ".o"]}
+            for name in ("a.cpp", "b.cpp", "c.cpp")
+        ]
+        (self.root / "compile_commands.json").write_text(json.dumps(db))
+        self.cache = self.root / "cache"
+        self.env = dict(os.environ)
+        self.env.pop("CLANG_TOOL_CHAIN_IWYU_CACHE", None)
+
+    def tearDown(self) -> None:
+        shutil.rmtree(self.root, ignore_errors=True)
+
+    def _write(self, name: str, text: str) -> Path:
+        path = self.src / name
+        path.write_text(text)
+        return path
+
+    def _tool(self, *args: str) -> subprocess.CompletedProcess:
+        cmd = [_exe("ctc-iwyu-tool"), "-p", str(self.root), "--iwyu", str(self.iwyu), "--cache-dir", str(self.cache)]
+        return subprocess.run([*cmd, *args], capture_output=True, text=True, env=self.env, timeout=60)
+
+    def _runs(self) -> list[str]:
+        log = self.tools / "iwyu.log"
+        runs = log.read_text().splitlines() if log.exists() else []
+        log.unlink(missing_ok=True)
+        return sorted(runs)
+
+    def test_merged_report(self) -> None:
+        result = self._tool("-j", "3")
+        self.assertEqual(result.returncode, 0, result.stderr)
+        out = result.stdout
+        self.assertEqual(out.count("common.h should add these lines:"), 1)
+        self.assertEqual(out.count("---"), 3)
+        self.assertIn("#include <string>", out)
+        self.assertIn("(c.cpp has correct #includes/fwd-decls)", out)
+        self.assertLess(out.index("a.cpp should add"), out.index("common.h should add"))
+        self.assertIn("3 TUs: 0 cached, 3 run, 0 failed", result.stderr)
+        self.assertIn("1 duplicate reports merged", result.stderr)
+
+    def test_cache_and_header_edit(self) -> None:
+        first = self._tool()
+        self.assertEqual(self._runs(), ["a.cpp", "b.cpp", "c.cpp"])
+        second = self._tool()
+        self.assertEqual(second.stdout, first.stdout)
+        self.assertEqual(self._runs(), [])
+        self.assertIn("3 cached", second.stderr)
+
+        common = self.src / "common.h"
+        st = common.stat()
+        os.utime(common, ns=(st.st_atime_ns, st.st_mtime_ns + 5_000_000_000))
+        self._tool()
+        self.assertEqual(self._runs(), [], "touch without edit must not re-run")
+
+        common.write_text("memory\n")
+        third = self._tool()
+        self.assertEqual(self._runs(), ["a.cpp", "b.cpp"])
+        self.assertIn("#include <memory>", third.stdout)
+        self.assertNotIn("#include <vector>", third.stdout)
+
+    def test_mapping_is_part_of_key(self) -> None:
+        mapping = self.root / "project.imp"
+        mapping.write_text("[]\n")
+        self._tool("--mapping", str(mapping))
+        self._runs()
+        self._tool("--mapping", str(mapping))
+        self.assertEqual(self._runs(), [])
+        mapping.write_text('[{ include: ["<a>", private, "<b>", public] }]\n')
+        result = self._tool("--mapping", str(mapping))
+        self.assertEqual(self._runs(), ["a.cpp", "b.cpp", "c.cpp"])
+        self.assertIn("#include <vector>+map", result.stdout)
+
+    def test_failure_not_cached(self) -> None:
+        self._write("b.cpp", "ERROR\n")
+        result = self._tool()
+        self.assertEqual(result.returncode, 1)
+        self.assertIn("IWYU failed for b.cpp", result.stderr)
+        self.assertIn("b.cpp:1:1: error: broken", result.stderr)
+        self.assertIn("common.h should add", result.stdout)
+        self._runs()
+        self._tool()
+        self.assertEqual(self._runs(), ["b.cpp"])
+
+    def test_source_filter_and_output(self) -> None:
+        report = self.root / "iwyu.out"
+        result = self._tool("b.cpp", "-o", str(report), "--no-cache")
+        self.assertEqual(result.returncode, 0, result.stderr)
+        self.assertEqual(result.stdout, "")
+        self.assertEqual(self._runs(), ["b.cpp"])
+        self.assertIn("b.cpp should add these lines:", report.read_text())
+        self.assertFalse(self.cache.exists())
+
+    def test_missing_iwyu(self) -> None:
+        result = subprocess.run(
+            [_exe("ctc-iwyu-tool"), "-p", str(self.root), "--iwyu", str(self.root / "nope")],
+            capture_output=True,
+            text=True,
+            env=self.env,
+            timeout=60,
+        )
+        self.assertEqual(result.returncode, 1)
+        self.assertIn("include-what-you-use not found", result.stderr)
+
+
+if __name__ == "__main__":
+    unittest.main()
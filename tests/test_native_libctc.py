@@ -0,0 +1,288 @@
+"""Tests for libctc, the embeddable C API over ctc-clang's command computation.
+
+libctc.h exposes an opaque context (toolchain path cache loaded once) and
+ctc_compute_command(), which returns the command ctc-clang would exec. The
+tests drive the shared library through ctypes.
+
+Tests cover:
+  - Registry entry and API version
+  - Missing toolchain reports CTC_ERR_NOT_INSTALLED
+  - Computed commands equal ctc-clang / ctc-clang++ --dry-run, including
+    directives resolved against the `directory` argument
+  - Invalid arguments
+  - Thousands of concurrent computations on one context
+"""
+
+import ctypes
+import os
+import platform
+import shutil
+import subprocess
+import sys
+import tempfile
+import unittest
+from concurrent.futures import ThreadPoolExecutor
+from pathlib import Path
+from unittest import mock
+
+IS_WINDOWS = sys.platform == "win32"
+
+CTC_OK = 0
+CTC_ERR_INVALID_ARGUMENT = 1
+CTC_ERR_NOT_INSTALLED = 2
+
+
+# ------------------------------------------------------------------
+# Module-level compilation: build native tools once for all tests
+# ------------------------------------------------------------------
+
+_build_dir: str | None = None
+_build_ok: bool = False
+
+
+def _ensure_built() -> bool:
+    """Compile native tools into a temp directory (runs once per session)."""
+    global _build_dir, _build_ok  # noqa: PLW0603
+    if _build_dir is not None:
+        return _build_ok
+
+    import importlib.resources as resources
+
+    ref = resources.files("clang_tool_chain.native_tools").joinpath("libctc.cpp")
+    if not (hasattr(ref, "is_file") and ref.is_file()):  # type: ignore[union-attr]
+        _build_dir = ""
+        return False
+
+    _build_dir = tempfile.mkdtemp(prefix="ctc_libctc_test_")
+
+    try:
+        from clang_tool_chain.commands.compile_native import compile_native
+
+        rc = compile_native(_build_dir)
+        _build_ok = rc == 0
+    except Exception:
+        _build_ok = False
+
+    if not _build_ok:
+        print(
+            f"WARNING: native tool compilation failed (dir={_build_dir})",
+            file=sys.stderr,
+        )
+
+    import atexit
+
+    def _cleanup() -> None:
+        if _build_dir and os.path.isdir(_build_dir):
+            shutil.rmtree(_build_dir, ignore_errors=True)
+
+    atexit.register(_cleanup)
+    return _build_ok
+
+
+def _exe(name: str) -> str:
+    _ensure_built()
+    suffix = ".exe" if IS_WINDOWS else ""
+    return str(Path(_build_dir or "") / f"{name}{suffix}")
+
+
+def _run(args: list[str], env: dict[str, str], cwd: str | None = None) -> subprocess.CompletedProcess:
+    return subprocess.run(
+        args, capture_output=True, text=True, encoding="utf-8", errors="replace", timeout=60, env=env, cwd=cwd
+    )
+
+
+SKIP_REASON = "Native tool compilation failed"
+
+
+def _lib_path() -> str:
+    suffix = {"win32": ".dll", "darwin": ".dylib"}.get(sys.platform, ".so")
+    return str(Path(_build_dir or "") / f"libctc{suffix}")
+
+
+def _fake_home(root: Path) -> None:
+    """Toolchain home with placeholder clang binaries (never executed)."""
+    plat = "darwin" if sys.platform == "darwin" else "linux"
+    arch = "arm64" if platform.machine().lower() in ("aarch64", "arm64") else "x86_64"
+    bin_dir = root / "clang" / plat / arch / "bin"
+    bin_dir.mkdir(parents=True)
+    (bin_dir.parent / "done.txt").write_text("ok\n")
+    for name in ("clang", "clang++"):
+        tool = bin_dir / name
+        tool.write_text("#!/bin/sh\nexit 0\n")
+        tool.chmod(0o755)
+
+
+class Libctc:
+    """Minimal ctypes binding, mirroring how an embedding build tool would use it."""
+
+    def __init__(self, path: str) -> None:
+        lib = ctypes.CDLL(path)
+        lib.ctc_api_version.restype = ctypes.c_int
+        lib.ctc_context_new.argtypes = [ctypes.c_char_p, ctypes.POINTER(ctypes.c_void_p)]
+        lib.ctc_context_free.argtypes = [ctypes.c_void_p]
+        lib.ctc_context_clang_path.argtypes = [ctypes.c_void_p, ctypes.c_int]
+        lib.ctc_context_clang_path.restype = ctypes.c_char_p
+        lib.ctc_compute_command.argtypes = [
+            ctypes.c_void_p,
+            ctypes.c_int,
+            ctypes.POINTER(ctypes.c_char_p),
+            ctypes.c_char_p,
+            ctypes.POINTER(ctypes.c_void_p),
+        ]
+        lib.ctc_command_argc.argtypes = [ctypes.c_void_p]
+        lib.ctc_command_argc.restype = ctypes.c_size_t
+        lib.ctc_command_argv.argtypes = [ctypes.c_void_p]
+        lib.ctc_command_argv.restype = ctypes.POINTER(ctypes.c_char_p)
+        lib.ctc_command_free.argtypes = [ctypes.c_void_p]
+        self.lib = lib
+
+    def context(self, install_dir: str | None = None) -> tuple[int, ctypes.c_void_p]:
+        ctx = ctypes.c_void_p()
+        rc = self.lib.ctc_context_new(install_dir.encode() if install_dir else None, ctypes.byref(ctx))
+        return rc, ctx
+
+    def compute(self, ctx: ctypes.c_void_p, args: list[str], directory: str | None = None) -> tuple[int, list[str]]:
+        argv = (ctypes.c_char_p * len(args))(*[a.encode() for a in args])
+        cmd = ctypes.c_void_p()
+        rc = self.lib.ctc_compute_command(
+            ctx, len(args), argv, directory.encode() if directory else None, ctypes.byref(cmd)
+        )
+        if rc != CTC_OK:
+            return rc, []
+        n = self.lib.ctc_command_argc(cmd)
+        out_argv = self.lib.ctc_command_argv(cmd)
+        result = [out_argv[i].decode() for i in range(n)]
+        if out_argv[n] is not None:
+            raise AssertionError("ctc_command_argv() is not NULL-terminated")
+        self.lib.ctc_command_free(cmd)
+        return rc, result
+
+
+class TestLibctcResource(unittest.TestCase):
+    def test_registry_has_libctc(self) -> None:
+        from clang_tool_chain.native_tools import TOOL_REGISTRY
+
+        self.assertIn("libctc", TOOL_REGISTRY)
+        tool = TOOL_REGISTRY["libctc"]
+        self.assertEqual(tool.source, "libctc.cpp")
+        self.assertEqual(tool.output, "libctc")
+        self.assertTrue(tool.shared)
+
+    def test_header_present(self) -> None:
+        import importlib.resources as resources
+
+        ref = resources.files("clang_tool_chain.native_tools").joinpath("libctc.h")
+        self.assertTrue(hasattr(ref, "is_file") and ref.is_file())  # type: ignore[union-attr]
+
+
+@unittest.skipUnless(_ensure_built(), SKIP_REASON)
+@unittest.skipIf(IS_WINDOWS, "fake toolchain uses shell scripts")
+class TestLibctc(unittest.TestCase):
+    def setUp(self) -> None:
+        self.root = Path(tempfile.mkdtemp(prefix="ctc_libctc_"))
+        self.home = self.root / "home"
+        _fake_home(self.home)
+        self.proj = self.root / "proj"
+        self.proj.mkdir()
+        (self.proj / "main.cpp").write_text("// @std: c++20\n// @link: m\nint main() {}\n")
+        self._saved_env = os.environ.get("CLANG_TOOL_CHAIN_DOWNLOAD_PATH")
+        os.environ["CLANG_TOOL_CHAIN_DOWNLOAD_PATH"] = str(self.home)
+        self.api = Libctc(_lib_path())
+        rc, self.ctx = self.api.context()
+        self.assertEqual(rc, CTC_OK)
+
+    def tearDown(self) -> None:
+        self.api.lib.ctc_context_free(self.ctx)
+        if self._saved_env is None:
+            os.environ.pop("CLANG_TOOL_CHAIN_DOWNLOAD_PATH", None)
+        else:
+            os.environ["CLANG_TOOL_CHAIN_DOWNLOAD_PATH"] = self._saved_env
+        shutil.rmtree(self.root, ignore_errors=True)
+
+    def _dry_run(self, tool: str, args: list[str]) -> list[str]:
+        result = subprocess.run(
+            [_exe(tool), "--dry-run", *args],
+            capture_output=True,
+            text=True,
+            cwd=self.proj,
+            env=dict(os.environ),
+            timeout=60,
+        )
+        self.assertEqual(result.returncode, 0, result.stderr)
+        return result.stdout.split()
+
+    def test_api_version(self) -> None:
+        self.assertEqual(self.api.lib.ctc_api_version(), 1)
+
+    def test_not_installed(self) -> None:
+        rc, ctx = self.api.context(str(self.root / "missing"))
+        self.assertEqual(rc, CTC_ERR_NOT_INSTALLED)
+        self.assertFalse(ctx.value)
+
+    def test_clang_paths(self) -> None:
+        c = self.api.lib.ctc_context_clang_path(self.ctx, 0).decode()
+        cxx = self.api.lib.ctc_context_clang_path(self.ctx, 1).decode()
+        self.assertTrue(c.endswith("clang"))
+        self.assertTrue(cxx.endswith("clang++"))
+
+    def test_matches_dry_run(self) -> None:
+        for tool, args in (
+            ("ctc-clang++", ["-O2", "-c", "main.cpp", "-o", "main.o"]),
+            ("ctc-clang++", ["main.cpp", "-o", "app"]),
+            ("ctc-clang", ["-c", "other.c"]),
+        ):
+            rc, cmd = self.api.compute(self.ctx, [tool, *args], str(self.proj))
+            self.assertEqual(rc, CTC_OK)
+            self.assertEqual(cmd, self._dry_run(tool, args), f"{tool} {args}")
+        _, cmd = self.api.compute(self.ctx, ["c++", "-c", "main.cpp"], str(self.proj))
+        self.assertIn("-std=c++20", cmd)
+
+    def test_launcher_flags_dropped(self) -> None:
+        rc, cmd = self.api.compute(self.ctx, ["clang", "--dry-run", "-c", "x.c"])
+        self.assertEqual(rc, CTC_OK)
+        self.assertNotIn("--dry-run", cmd)
+
+    def test_invalid_arguments(self) -> None:
+        rc, _ = self.api.compute(self.ctx, [])
+        self.assertEqual(rc, CTC_ERR_INVALID_ARGUMENT)
+        cmd = ctypes.c_void_p()
+        rc = self.api.lib.ctc_compute_command(None, 0, None, None, ctypes.byref(cmd))
+        self.assertEqual(rc, CTC_ERR_INVALID_ARGUMENT)
+
+    def test_concurrent_calls(self) -> None:
+        def one(i: int) -> list[str]:
+            rc, cmd = self.api.compute(self.ctx, ["clang++", "-c", f"f{i}.cpp", "-o", f"f{i}.o"])
+            self.assertEqual(rc, CTC_OK)
+            return cmd
+
+        with ThreadPoolExecutor(max_workers=8) as pool:
+            results = list(pool.map(one, range(2000)))
+        for i, cmd in enumerate(results):
+            self.assertEqual(cmd[-3:], [f"f{i}.cpp", "-o", f"f{i}.o"])
+
+    def test_concurrent_pkg_config(self) -> None:
+        pc_dir = self.root / "pc"
+        pc_dir.mkdir()
+        (pc_dir / "zz.pc").write_text("prefix=/opt/zz\nCflags: -I${prefix}/include\nLibs: -L${prefix}/lib -lzz\n")
+        (self.proj / "pkg.cpp").write_text("// @pkg-config: zz\nint main() {}\n")
+        env = mock.patch.dict(os.environ, {"PKG_CONFIG_PATH": str(pc_dir), "PKG_CONFIG_LIBDIR": str(self.root / "none")})
+        env.start()
+        self.addCleanup(env.stop)
+
+        def one(_: int) -> list[str]:
+            rc, cmd = self.api.compute(self.ctx, ["clang++", "pkg.cpp", "-o", "app"], str(self.proj))
+            self.assertEqual(rc, CTC_OK)
+            return cmd
+
+        # Every first call misses and writes the same cache entry
+        with ThreadPoolExecutor(max_workers=8) as pool:
+            results = list(pool.map(one, range(64)))
+        for cmd in results:
+            self.assertIn("-I/opt/zz/include", cmd)
+            self.assertEqual(cmd[-2:], ["-L/opt/zz/lib", "-lzz"])
+        entries = list((self.home / "pkg-config-cache").iterdir())
+        self.assertEqual([e.suffix for e in entries], [""], entries)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,329 @@
+"""Tests for ctc-opt-report and the launcher's optimization-record mode.
+
+With CLANG_TOOL_CHAIN_OPT_RECORD=yaml|bitstream, ctc-clang adds
+-fsave-optimization-record to compiles (optionally into
+CLANG_TOOL_CHAIN_OPT_RECORD_DIR, plus hotness for PGO builds). ctc-opt-report
+parses every record under a build tree in parallel, merges the same remark
+reached from several TUs and ranks them by hotness, --weights or count.
+
+Tests cover:
+  - Launcher flags: compile-only, per-output record file, PGO hotness,
+    user-provided record flags left alone, links untouched
+  - YAML parsing: kinds, quoted scalars, wrapped DebugLoc, Args messages
+    with demangled callees
+  - Duplicate remarks across TUs merged; per-pass table
+  - Ranking by hotness and by a perf-style --weights file; filters
+  - Bitstream records through llvm-remarkutil; JSON output
+"""
+
+import json
+import os
+import platform
+import shutil
+import subprocess
+import sys
+import tempfile
+import unittest
+from pathlib import Path
+
+IS_WINDOWS = sys.platform == "win32"
+IS_LINUX = sys.platform.startswith("linux")
+
+
+# ------------------------------------------------------------------
+# Module-level compilation: build native tools once for all tests
+# ------------------------------------------------------------------
+
+_build_dir: str | None = None
+_build_ok: bool = False
+
+
+def _ensure_built() -> bool:
+    """Compile native tools into a temp directory (runs once per session)."""
+    global _build_dir, _build_ok  # noqa: PLW0603
+    if _build_dir is not None:
+        return _build_ok
+
+    import importlib.resources as resources
+
+    ref = resources.files("clang_tool_chain.native_tools").joinpath("launcher_opt_report.cpp")
+    if not (hasattr(ref, "is_file") and ref.is_file()):  # type: ignore[union-attr]
+        _build_dir = ""
+        return False
+
+    _build_dir = tempfile.mkdtemp(prefix="ctc_opt_report_test_")
+
+    try:
+        from clang_tool_chain.commands.compile_native import compile_native
+
+        rc = compile_native(_build_dir)
+        _build_ok = rc == 0
+    except Exception:
+        _build_ok = False
+
+    if not _build_ok:
+        print(
+            f"WARNING: native tool compilation failed (dir={_build_dir})",
+            file=sys.stderr,
+        )
+
+    import atexit
+
+    def _cleanup() -> None:
+        if _build_dir and os.path.isdir(_build_dir):
+            shutil.rmtree(_build_dir, ignore_errors=True)
+
+    atexit.register(_cleanup)
+    return _build_ok
+
+
+def _exe(name: str) -> str:
+    _ensure_built()
+    suffix = ".exe" if IS_WINDOWS else ""
+    return str(Path(_build_dir or "") / f"{name}{suffix}")
+
+
+SKIP_REASON = "Native tool compilation failed"
+
+
+# Two TUs: both inline the header function _Z6helperv (same remark twice).
+A_YAML = """--- !Missed
+Pass:            loop-vectorize
+Name:            MissedDetails
+DebugLoc:        { File: 'src/very/long/directory/name/that/wraps/the/flow/map/a.cpp',
+                   Line: 12, Column: 3 }
+Function:        _Z4hotsPfi
+Args:
+  - String:          'loop not vectorized: '
+  - String:          'cannot prove it''s safe'
+...
+--- !Missed
+Pass:            inline
+Name:            NoDefinition
+DebugLoc:        { File: include/util.h, Line: 4, Column: 10 }
+Function:        _Z6helperv
+Args:
+  - Callee:          _Z8externalv
+    DebugLoc:        { File: include/util.h, Line: 2, Column: 0 }
+  - String:          ' will not be inlined into '
+  - Caller:          _Z6helperv
+    DebugLoc:        { File: include/util.h, Line: 3, Column: 0 }
+  - String:          ' because its definition is unavailable'
+...
+--- !Passed
+Pass:            inline
+Name:            Inlined
+DebugLoc:        { File: src/a.cpp, Line: 20, Column: 5 }
+Function:        main
+Args:
+  - String:          inlined
+...
+"""
+
+B_YAML = """--- !Missed
+Pass:            inline
+Name:            NoDefinition
+DebugLoc:        { File: include/util.h, Line: 4, Column: 10 }
+Function:        _Z6helperv
+Args:
+  - Callee:          _Z8externalv
+    DebugLoc:        { File: include/util.h, Line: 2, Column: 0 }
+  - String:          ' will not be inlined into '
+  - Caller:          _Z6helperv
+    DebugLoc:        { File: include/util.h, Line: 3, Column: 0 }
+  - String:          ' because its definition is unavailable'
+...
+--- !Analysis
+Pass:            loop-vectorize
+Name:            CantVectorizeLibcall
+DebugLoc:        { File: src/b.cpp, Line: 7, Column: 9 }
+Function:        _Z4coldv
+Args:
+  - String:          'call instruction cannot be vectorized'
+...
+--- !Missed
+Pass:            loop-vectorize
+Name:            MissedDetails
+DebugLoc:        { File: src/b.cpp, Line: 7, Column: 3 }
+Function:        _Z4coldv
+Args:
+  - String:          'loop not vectorized'
+...
+"""
+
+HOT_YAML = """--- !Missed
+Pass:            slp-vectorizer
+Name:            NotBeneficial
+DebugLoc:        { File: src/c.cpp, Line: 1, Column: 1 }
+Function:        _Z3lowv
+Hotness:         5
+Args:
+  - String:          'not beneficial'
+...
+--- !Missed
+Pass:            slp-vectorizer
+Name:            NotBeneficial
+DebugLoc:        { File: src/c.cpp, Line: 9, Column: 1 }
+Function:        _Z4highv
+Hotness:         90000
+Args:
+  - String:          'not beneficial'
+...
+"""
+
+
+@unittest.skipUnless(_ensure_built(), SKIP_REASON)
+class TestOptReport(unittest.TestCase):
+    def setUp(self) -> None:
+        self.root = Path(tempfile.mkdtemp(prefix="ctc_opt_report_"))
+        (self.root / "build" / "a").mkdir(parents=True)
+        (self.root / "build" / "a" / "a.cpp.opt.yaml").write_text(A_YAML)
+        (self.root / "build" / "b.cpp.opt.yaml").write_text(B_YAML)
+
+    def tearDown(self) -> None:
+        shutil.rmtree(self.root, ignore_errors=True)
+
+    def _report(self, *args: str) -> subprocess.CompletedProcess:
+        result = subprocess.run(
+            [_exe("ctc-opt-report"), *args], capture_output=True, text=True, cwd=self.root, timeout=60
+        )
+        return result
+
+    def _json(self, *args: str) -> dict:
+        result = self._report("--json", *args)
+        self.assertEqual(result.returncode, 0, result.stderr)
+        return json.loads(result.stdout)
+
+    def test_parse_and_merge(self) -> None:
+        data = self._json("build")
+        self.assertEqual(data["records"], 2)
+        self.assertEqual(data["remarks"], 6)
+        self.assertEqual(data["ranked_by"], "count")
+        ranked = data["remarks_ranked"]
+        self.assertEqual(len(ranked), 3, "duplicate header remark not merged")
+        top = ranked[0]
+        self.assertEqual((top["function"], top["count"], top["pass"]), ("helper()", 2, "inline"))
+        self.assertEqual(
+            top["message"], "external() will not be inlined into helper() because its definition is unavailable"
+        )
+        wrapped = next(r for r in ranked if r["function"] == "hots(float*, int)")
+        self.assertEqual(wrapped["line"], 12)
+        self.assertTrue(wrapped["file"].endswith("/flow/map/a.cpp"))
+        self.assertEqual(wrapped["message"], "loop not vectorized: cannot prove it's safe")
+        passes = {p["pass"]: p for p in data["passes"]}
+        self.assertEqual((passes["inline"]["missed"], passes["inline"]["passed"]), (2, 1))
+        self.assertEqual(passes["loop-vectorize"]["analysis"], 1)
+
+    def test_filters(self) -> None:
+        data = self._json("build", "--pass", "loop-vectorize")
+        self.assertEqual({r["function"] for r in data["remarks_ranked"]}, {"hots(float*, int)", "cold()"})
+        data = self._json("build", "--kind", "all", "--file", "b.cpp")
+        self.assertEqual({r["kind"] for r in data["remarks_ranked"]}, {"missed", "analysis"})
+        data = self._json("build", "--function", "cold")
+        self.assertEqual(len(data["remarks_ranked"]), 1)
+
+    def test_hotness_ranking(self) -> None:
+        (self.root / "build" / "c.opt.yaml").write_text(HOT_YAML)
+        data = self._json(str(self.root / "build" / "c.opt.yaml"))
+        self.assertEqual(data["ranked_by"], "hotness")
+        self.assertEqual([r["function"] for r in data["remarks_ranked"]], ["high()", "low()"])
+
+    def test_weights(self) -> None:
+        weights = self.root / "perf.txt"
+        weights.write_text("# perf report --stdio\n    61.00%  [.] cold()\n     3.50%  [.] _Z6helperv\n")
+        data = self._json("build", "--weights", str(weights))
+        self.assertEqual(data["ranked_by"], "weight")
+        self.assertEqual(data["remarks_ranked"][0]["function"], "cold()")
+        self.assertEqual(data["functions"][0]["function"], "cold()")
+        self.assertEqual(data["functions"][-1]["score"], 0)
+
+    def test_text_report(self) -> None:
+        result = self._report("build")
+        self.assertEqual(result.returncode, 0, result.stderr)
+        self.assertIn("6 remarks from 2 record file(s)", result.stdout)
+        self.assertIn("Top missed remarks (3 distinct, ranked by count)", result.stdout)
+        self.assertIn("include/util.h:4:10  [inline]  in helper()", result.stdout)
+        self.assertIn("(x2)", result.stdout)
+
+    @unittest.skipUnless(IS_LINUX, "fake llvm-remarkutil is a POSIX script")
+    def test_bitstream(self) -> None:
+        tool = self.root / "remarkutil"
+        tool.write_text('#!/bin/sh\n[ "$1" = bitstream2yaml ] || exit 2\ncp "$2.src" "$4"\n')
+        tool.chmod(0o755)
+        bits = self.root / "bits" / "c.opt.bitstream"
+        bits.parent.mkdir()
+        bits.write_bytes(b"RMRK")
+        Path(str(bits) + ".src").write_text(HOT_YAML)
+        data = self._json("bits", "--remarkutil", str(tool))
+        self.assertEqual(data["remarks"], 2)
+        self.assertEqual(sorted(p.name for p in bits.parent.iterdir()), ["c.opt.bitstream", "c.opt.bitstream.src"])
+
+    def test_no_records(self) -> None:
+        (self.root / "empty").mkdir()
+        result = self._report("empty")
+        self.assertEqual(result.returncode, 1)
+        self.assertIn("CLANG_TOOL_CHAIN_OPT_RECORD=yaml", result.stderr)
+
+
+@unittest.skipUnless(IS_LINUX, "fake toolchain layout is Linux only")
+@unittest.skipUnless(_ensure_built(), SKIP_REASON)
+class TestOptRecordFlags(unittest.TestCase):
+    def setUp(self) -> None:
+        self.root = Path(tempfile.mkdtemp(prefix="ctc_opt_record_"))
+        arch = "arm64" if platform.machine().lower() in ("aarch64", "arm64") else "x86_64"
+        install = self.root / "clang" / "linux" / arch
+        (install / "bin").mkdir(parents=True)
+        (install / "lib" / "clang" / "19" / "include").mkdir(parents=True)
+        (install / "done.txt").write_text("ok\n")
+        shutil.copy("/bin/echo", install / "bin" / "clang")
+        (install / "bin" / "clang++").symlink_to("clang")
+        self.env = dict(os.environ)
+        self.env["CLANG_TOOL_CHAIN_DOWNLOAD_PATH"] = str(self.root)
+        self.env["CLANG_TOOL_CHAIN_OPT_RECORD"] = "yaml"
+        self.env["CLANG_TOOL_CHAIN_NO_NOTE"] = "1"
+        for key in ("CLANG_TOOL_CHAIN_OPT_RECORD_DIR", "CLANG_TOOL_CHAIN_NO_AUTO", "CTC_DEBUG"):
+            self.env.pop(key, None)
+
+    def tearDown(self) -> None:
+        shutil.rmtree(self.root, ignore_errors=True)
+
+    def _args(self, *args: str) -> list[str]:
+        result = subprocess.run(
+            [_exe("ctc-clang++"), "--dry-run", *args],
+            capture_output=True,
+            text=True,
+            env=self.env,
+            cwd=self.root,
+            timeout=60,
+        )
+        self.assertEqual(result.returncode, 0, result.stderr)
+        return result.stdout.split()
+
+    def test_compile_gets_record(self) -> None:
+        args = self._args("-c", "a.cpp", "-o", "obj/a.o")
+        self.assertIn("-fsave-optimization-record=yaml", args)
+        self.assertFalse(any(a.startswith("-foptimization-record-file") for a in args))
+        self.assertNotIn("-fdiagnostics-show-hotness", args)
+
+    def test_not_on_links_or_preprocessing(self) -> None:
+        self.assertFalse(any("optimization-record" in a for a in self._args("a.o", "-o", "app")))
+        self.assertFalse(any("optimization-record" in a for a in self._args("-E", "a.cpp")))
+        self.env["CLANG_TOOL_CHAIN_OPT_RECORD"] = "0"
+        self.assertFalse(any("optimization-record" in a for a in self._args("-c", "a.cpp")))
+
+    def test_record_dir_bitstream_and_pgo(self) -> None:
+        self.env["CLANG_TOOL_CHAIN_OPT_RECORD"] = "bitstream"
+        self.env["CLANG_TOOL_CHAIN_OPT_RECORD_DIR"] = str(self.root / "remarks")
+        args = self._args("-c", "src/a.cpp", "-o", "obj/a.o", "-fprofile-use=app.profdata")
+        self.assertIn("-fsave-optimization-record=bitstream", args)
+        self.assertIn(f"-foptimization-record-file={self.root / 'remarks' / 'obj_a.o.opt.bitstream'}", args)
+        self.assertIn("-fdiagnostics-show-hotness", args)
+        self.assertTrue((self.root / "remarks").is_dir())
+
+    def test_user_record_flags_win(self) -> None:
+        args = self._args("-c", "a.cpp", "-fsave-optimization-record=yaml", "-foptimization-record-passes=inline")
+        self.assertEqual(sum(1 for a in args if a.startswith("-fsave-optimization-record")), 1)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,319 @@
+"""Tests for the @pkg-config directive in the native launcher.
+
+ctc-clang resolves `// @pkg-config: [a, b]` by reading .pc files itself
+(variables, Requires closure) or, for packages it can't find, with one
+pkg-config run, and caches the flags in <ctc_home>/pkg-config-cache until a
+.pc file or search directory changes. The toolchain's clang is /bin/echo,
+so --dry-run shows the final command.
+
+Tests cover:
+  - Cflags before the user args, Libs at the end, Requires order and dedupe
+  - Two-token flags (-framework X, -isystem D, -Xlinker X) kept whole
+  - A package reached via Requires.private, then publicly, adds Cflags once
+  - ${var} / ${pcfiledir} expansion, system -I/-L dropped, PKG_CONFIG_SYSROOT_DIR
+  - Cache hits with no .pc parse, invalidation by an edited .pc and by a new
+    .pc shadowing it earlier in PKG_CONFIG_PATH
+  - pkg-config fallback run once then cached, unknown and invalid packages
+  - Misses cached too, until a .pc file appears or PATH changes
+"""
+
+import os
+import platform
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+import unittest
+from pathlib import Path
+
+IS_WINDOWS = sys.platform == "win32"
+IS_LINUX = sys.platform.startswith("linux")
+
+
+# ------------------------------------------------------------------
+# Module-level compilation: build native tools once for all tests
+# ------------------------------------------------------------------
+
+_build_dir: str | None = None
+_build_ok: bool = False
+
+
+def _ensure_built() -> bool:
+    """Compile native tools into a temp directory (runs once per session)."""
+    global _build_dir, _build_ok  # noqa: PLW0603
+    if _build_dir is not None:
+        return _build_ok
+
+    import importlib.resources as resources
+
+    ref = resources.files("clang_tool_chain.native_tools").joinpath("clang_launcher.cpp")
+    if not (hasattr(ref, "is_file") and ref.is_file()):  # type: ignore[union-attr]
+        _build_dir = ""
+        return False
+
+    _build_dir = tempfile.mkdtemp(prefix="ctc_pkg_config_test_")
+
+    try:
+        from clang_tool_chain.commands.compile_native import compile_native
+
+        rc = compile_native(_build_dir)
+        _build_ok = rc == 0
+    except Exception:
+        _build_ok = False
+
+    if not _build_ok:
+        print(
+            f"WARNING: native tool compilation failed (dir={_build_dir})",
+            file=sys.stderr,
+        )
+
+    import atexit
+
+    def _cleanup() -> None:
+        if _build_dir and os.path.isdir(_build_dir):
+            shutil.rmtree(_build_dir, ignore_errors=True)
+
+    atexit.register(_cleanup)
+    return _build_ok
+
+
+def _exe(name: str) -> str:
+    _ensure_built()
+    suffix = ".exe" if IS_WINDOWS else ""
+    return str(Path(_build_dir or "") / f"{name}{suffix}")
+
+
+def _run(args: list[str], env: dict[str, str], cwd: str | None = None) -> subprocess.CompletedProcess:
+    return subprocess.run(
+        args, capture_output=True, text=True, encoding="utf-8", errors="replace", timeout=60, env=env, cwd=cwd
+    )
+
+
+SKIP_REASON = "Native tool compilation failed"
+
+
+_LIBSSL_PC = """prefix=/opt/ssl
+libdir=${prefix}/lib
+includedir=${prefix}/include
+
+Name: libssl
+Version: 3.0.2
+Requires.private: libcrypto
+Cflags: -I${includedir} -I/usr/include
+Libs: -L${libdir} -L/usr/lib -lssl
+"""
+
+_LIBCRYPTO_PC = """Name: libcrypto
+Version: 3.0.2
+Cflags: -DCRYPTO_LOCAL=1 -I${pcfiledir}/include  # relocatable
+Libs: -lcrypto -ldl
+"""
+
+_OPENSSL_PC = """Name: OpenSSL
+Version: 3.0.2
+Requires: libssl >= 3.0, libcrypto
+"""
+
+# Logs each run, answers for "fakepkg" only.
+_FAKE_PKG_CONFIG = """#!/bin/sh
+echo "$@" >> "$(dirname "$0")/pkg-config.log"
+case "$*" in
+  *nosuch*) exit 1 ;;
+  *--cflags*) echo "-DFAKEPKG=1" ;;
+  *--libs*) echo "-lfakepkg" ;;
+esac
+"""
+
+
+@unittest.skipUnless(IS_LINUX, "fake toolchain layout is the Linux one")
+@unittest.skipUnless(_ensure_built(), SKIP_REASON)
+class TestPkgConfigDirective(unittest.TestCase):
+    def setUp(self) -> None:
+        self.root = Path(tempfile.mkdtemp(prefix="ctc_pkg_config_"))
+        arch = "arm64" if platform.machine().lower() in ("aarch64", "arm64") else "x86_64"
+        install = self.root / "clang" / "linux" / arch
+        (install / "bin").mkdir(parents=True)
+        (install / "lib" / "clang" / "19" / "include").mkdir(parents=True)
+        (install / "done.txt").write_text("ok\n")
+        shutil.copy("/bin/echo", install / "bin" / "clang")
+        (install / "bin" / "clang++").symlink_to("clang")
+
+        self.pc_dir = self.root / "pc"
+        self.pc_dir.mkdir()
+        (self.pc_dir / "libssl.pc").write_text(_LIBSSL_PC)
+        (self.pc_dir / "libcrypto.pc").write_text(_LIBCRYPTO_PC)
+        (self.pc_dir / "openssl.pc").write_text(_OPENSSL_PC)
+        self.fake_bin = self.root / "fakebin"
+        self.fake_bin.mkdir()
+        (self.root / "empty").mkdir()
+        (self.root / "main.cpp").write_text("// @pkg-config: [openssl]\nint main() { return 0; }\n")
+
+        self.env = dict(os.environ)
+        self.env.update(
+            {
+                "CLANG_TOOL_CHAIN_DOWNLOAD_PATH": str(self.root),
+                "CLANG_TOOL_CHAIN_NO_NOTE": "1",
+                "CLANG_TOOL_CHAIN_DIRECTIVE_VERBOSE": "1",
+                "PKG_CONFIG_PATH": str(self.pc_dir),
+                "PKG_CONFIG_LIBDIR": str(self.root / "empty"),
+                "PATH": f"{self.fake_bin}:/usr/bin:/bin",
+            }
+        )
+        for key in ("PKG_CONFIG_SYSROOT_DIR", "PKG_CONFIG_ALLOW_SYSTEM_CFLAGS", "PKG_CONFIG_ALLOW_SYSTEM_LIBS"):
+            self.env.pop(key, None)
+
+    def tearDown(self) -> None:
+        shutil.rmtree(self.root, ignore_errors=True)
+
+    def _dry_run(self, *args: str, env: dict[str, str] | None = None) -> tuple[list[str], str]:
+        result = _run([_exe("ctc-clang++"), "--dry-run", *args], env=env or self.env, cwd=str(self.root))
+        self.assertEqual(result.returncode, 0, result.stderr)
+        return result.stdout.split(), result.stderr
+
+    def _write_source(self, packages: str) -> None:
+        (self.root / "main.cpp").write_text(f"// @pkg-config: {packages}\nint main() {{ return 0; }}\n")
+
+    def test_pc_files_resolved(self) -> None:
+        args, stderr = self._dry_run("main.cpp", "-o", "app")
+        self.assertIn("@pkg-config openssl: read .pc files", stderr)
+        self.assertIn("-I/opt/ssl/include", args)
+        self.assertIn("-DCRYPTO_LOCAL=1", args)
+        self.assertIn(f"-I{self.pc_dir}/include", args)
+        self.assertLess(args.index("-I/opt/ssl/include"), args.index("main.cpp"))
+        # Libs follow the user args; -lcrypto once, after -lssl
+        self.assertEqual(args[-4:], ["-L/opt/ssl/lib", "-lssl", "-lcrypto", "-ldl"])
+        self.assertNotIn("-I/usr/include", args)
+        self.assertNotIn("-L/usr/lib", args)
+
+    def test_requires_private_adds_cflags_only(self) -> None:
+        self._write_source("libssl")
+        args, _ = self._dry_run("main.cpp", "-o", "app")
+        self.assertIn("-DCRYPTO_LOCAL=1", args)
+        self.assertNotIn("-lcrypto", args)
+        self.assertEqual(args[-2:], ["-L/opt/ssl/lib", "-lssl"])
+
+    def test_two_token_flags_kept_whole(self) -> None:
+        (self.pc_dir / "corefoo.pc").write_text(
+            "Name: corefoo\n"
+            "Requires: libcrypto\n"
+            "Cflags: -isystem /opt/corefoo/include -DCF=1 -DCF=1 -isystem /opt/corefoo/include\n"
+            "Libs: -framework CoreFoundation -framework Security -Xlinker -dead_strip -Xlinker -x -lcrypto\n"
+        )
+        self._write_source("corefoo")
+        args, _ = self._dry_run("main.cpp", "-o", "app")
+        # -lcrypto moves behind the Requires'd package; the pairs stay intact
+        libs = ["-framework", "CoreFoundation", "-framework", "Security", "-Xlinker", "-dead_strip"]
+        self.assertEqual(args[-10:], libs + ["-Xlinker", "-x", "-lcrypto", "-ldl"])
+        self.assertEqual(args.count("-DCF=1"), 1)
+        self.assertEqual(args.count("-isystem"), 2)
+        self.assertEqual(args[args.index("-isystem") + 1], "/opt/corefoo/include")
+
+    def test_private_then_public_cflags_once(self) -> None:
+        (self.pc_dir / "libz.pc").write_text("Name: libz\nCflags: -pthread -isystem /opt/z/include\nLibs: -lz\n")
+        (self.pc_dir / "top.pc").write_text("Name: top\nRequires.private: libz\nLibs: -ltop\n")
+        self._write_source("[top, libz]")
+        args, _ = self._dry_run("main.cpp", "-o", "app")
+        self.assertEqual(args.count("-pthread"), 1)
+        self.assertEqual(args.count("-isystem"), 1)
+        self.assertEqual(args[-2:], ["-ltop", "-lz"])
+
+    def test_sysroot_and_system_dirs(self) -> None:
+        env = dict(self.env, PKG_CONFIG_SYSROOT_DIR="/sysroot", PKG_CONFIG_ALLOW_SYSTEM_CFLAGS="1")
+        args, _ = self._dry_run("-c", "main.cpp", env=env)
+        self.assertIn("-I/sysroot/opt/ssl/include", args)
+        self.assertIn("-I/sysroot/usr/include", args)
+
+    def test_cache_hit_and_invalidation(self) -> None:
+        first, _ = self._dry_run("main.cpp", "-o", "app")
+        cache = list((self.root / "pkg-config-cache").iterdir())
+        self.assertEqual(len(cache), 1)
+        self.assertIn("stamp.0=", cache[0].read_text())
+
+        second, stderr = self._dry_run("main.cpp", "-o", "app")
+        self.assertIn("@pkg-config openssl: cached", stderr)
+        self.assertEqual(first, second)
+
+        # An edited .pc is read again
+        crypto = self.pc_dir / "libcrypto.pc"
+        crypto.write_text(_LIBCRYPTO_PC.replace("-ldl", "-ldl -lz"))
+        st = crypto.stat()
+        os.utime(crypto, ns=(st.st_atime_ns, st.st_mtime_ns + 10**9))
+        args, stderr = self._dry_run("main.cpp", "-o", "app")
+        self.assertIn("read .pc files", stderr)
+        self.assertEqual(args[-1], "-lz")
+
+    def test_shadowing_pc_invalidates(self) -> None:
+        override = self.root / "override"
+        override.mkdir()
+        env = dict(self.env, PKG_CONFIG_PATH=f"{override}:{self.pc_dir}")
+        self._dry_run("main.cpp", "-o", "app", env=env)
+        _, stderr = self._dry_run("main.cpp", "-o", "app", env=env)
+        self.assertIn("cached", stderr)
+        time.sleep(0.01)
+        (override / "libcrypto.pc").write_text("Name: libcrypto\nLibs: -lcrypto-custom\n")
+        args, stderr = self._dry_run("main.cpp", "-o", "app", env=env)
+        self.assertIn("read .pc files", stderr)
+        self.assertIn("-lcrypto-custom", args)
+        self.assertNotIn("-DCRYPTO_LOCAL=1", args)
+
+    def test_pkg_config_fallback_runs_once(self) -> None:
+        tool = self.fake_bin / "pkg-config"
+        tool.write_text(_FAKE_PKG_CONFIG)
+        tool.chmod(0o755)
+        self._write_source("[openssl, fakepkg]")
+        args, stderr = self._dry_run("main.cpp", "-o", "app")
+        self.assertIn("@pkg-config openssl fakepkg: pkg-config", stderr)
+        self.assertIn("-DFAKEPKG=1", args)
+        self.assertEqual(args[-1], "-lfakepkg")
+        _, stderr = self._dry_run("main.cpp", "-o", "app")
+        self.assertIn("cached", stderr)
+        self.assertEqual(len((self.fake_bin / "pkg-config.log").read_text().splitlines()), 2)
+
+    def test_unknown_and_invalid_packages(self) -> None:
+        self.env.pop("CLANG_TOOL_CHAIN_NO_NOTE")
+        tool = self.fake_bin / "pkg-config"
+        tool.write_text(_FAKE_PKG_CONFIG)
+        tool.chmod(0o755)
+        self._write_source("[nosuch, bad;name]")
+        args, stderr = self._dry_run("main.cpp", "-o", "app")
+        self.assertIn("invalid package name 'bad;name'", stderr)
+        self.assertIn("package 'nosuch' not found", stderr)
+        self.assertEqual(args[-2:], ["-o", "app"])
+        # Reported as a note, so the usual note switches silence it
+        _, stderr = self._dry_run("main.cpp", "-o", "app", env=dict(self.env, CLANG_TOOL_CHAIN_NO_PKG_CONFIG_NOTE="1"))
+        self.assertNotIn("@pkg-config", stderr)
+
+    def test_miss_cached_until_pc_appears(self) -> None:
+        self.env.pop("CLANG_TOOL_CHAIN_NO_NOTE")
+        tool = self.fake_bin / "pkg-config"
+        tool.write_text(_FAKE_PKG_CONFIG)
+        tool.chmod(0o755)
+        log = self.fake_bin / "pkg-config.log"
+        self._write_source("[nosuch]")
+        _, stderr = self._dry_run("main.cpp", "-o", "app")
+        self.assertIn("package 'nosuch' not found", stderr)
+        runs = len(log.read_text().splitlines())
+        self.assertGreater(runs, 0)
+
+        # Still reported, but pkg-config isn't run again
+        args, stderr = self._dry_run("main.cpp", "-o", "app")
+        self.assertIn("package 'nosuch' not found", stderr)
+        self.assertEqual(args[-2:], ["-o", "app"])
+        self.assertEqual(len(log.read_text().splitlines()), runs)
+
+        # A different PATH may hold another pkg-config
+        other = dict(self.env, PATH=f"{self.fake_bin}:/bin")
+        self._dry_run("main.cpp", "-o", "app", env=other)
+        self.assertEqual(len(log.read_text().splitlines()), 2 * runs)
+
+        # A new .pc in a search directory is picked up
+        time.sleep(0.01)
+        (self.pc_dir / "nosuch.pc").write_text("Name: nosuch\nCflags: -DNOSUCH=1\n")
+        args, stderr = self._dry_run("main.cpp", "-o", "app")
+        self.assertNotIn("not found", stderr)
+        self.assertIn("-DNOSUCH=1", args)
+
+
+if __name__ == "__main__":
+    unittest.main()
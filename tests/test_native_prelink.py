@@ -0,0 +1,245 @@
+"""Tests for hierarchical pre-linking in ctc-clang (CLANG_TOOL_CHAIN_PRELINK).
+
+Under CLANG_TOOL_CHAIN_PRELINK=1 a Linux link groups its .o inputs by
+directory. A group that was unchanged since the previous link of the same
+output is replaced by one `ld.lld -r` blob cached in <output>.ctc-prelink/.
+The stand-ins log their argv: clang (response files expanded) and an ld.lld
+that concatenates its inputs.
+
+Tests cover:
+  - First link passes objects through; the second builds the blob; the third
+    reuses it without running ld.lld
+  - Small groups, non-ELF (bitcode) members and -flto links stay untouched
+  - Editing a member drops its group to loose objects, rebuilds it on the
+    next link and removes the stale blob
+  - Response-file inputs are rewritten into a new response file
+  - Off without CLANG_TOOL_CHAIN_PRELINK
+"""
+
+import json
+import os
+import platform
+import shutil
+import subprocess
+import sys
+import tempfile
+import unittest
+from pathlib import Path
+
+IS_WINDOWS = sys.platform == "win32"
+IS_LINUX = sys.platform.startswith("linux")
+
+
+# ------------------------------------------------------------------
+# Module-level compilation: build native tools once for all tests
+# ------------------------------------------------------------------
+
+_build_dir: str | None = None
+_build_ok: bool = False
+
+
+def _ensure_built() -> bool:
+    """Compile native tools into a temp directory (runs once per session)."""
+    global _build_dir, _build_ok  # noqa: PLW0603
+    if _build_dir is not None:
+        return _build_ok
+
+    import importlib.resources as resources
+
+    ref = resources.files("clang_tool_chain.native_tools").joinpath("clang_launcher.cpp")
+    if not (hasattr(ref, "is_file") and ref.is_file()):  # type: ignore[union-attr]
+        _build_dir = ""
+        return False
+
+    _build_dir = tempfile.mkdtemp(prefix="ctc_prelink_test_")
+
+    try:
+        from clang_tool_chain.commands.compile_native import compile_native
+
+        rc = compile_native(_build_dir)
+        _build_ok = rc == 0
+    except Exception:
+        _build_ok = False
+
+    if not _build_ok:
+        print(
+            f"WARNING: native tool compilation failed (dir={_build_dir})",
+            file=sys.stderr,
+        )
+
+    import atexit
+
+    def _cleanup() -> None:
+        if _build_dir and os.path.isdir(_build_dir):
+            shutil.rmtree(_build_dir, ignore_errors=True)
+
+    atexit.register(_cleanup)
+    return _build_ok
+
+
+def _exe(name: str) -> str:
+    _ensure_built()
+    suffix = ".exe" if IS_WINDOWS else ""
+    return str(Path(_build_dir or "") / f"{name}{suffix}")
+
+
+SKIP_REASON = "Native tool compilation failed"
+
+
+# clang stand-in: logs its argv with response files expanded.
+_FAKE_CLANG = r"""#!/usr/bin/env python3
+import json, os, shlex, sys
+args = []
+for a in sys.argv[1:]:
+    if a.startswith("@"):
+        args += shlex.split(open(a[1:]).read())
+    else:
+        args.append(a)
+root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+with open(os.path.join(root, "clang.log"), "a") as f:
+    f.write(json.dumps(args) + "\n")
+"""
+
+# ld.lld stand-in: `-r -o OUT @RSP` writes an ELF-looking blob naming its inputs.
+_FAKE_LLD = r"""#!/usr/bin/env python3
+import os, shlex, sys
+args = sys.argv[1:]
+assert args[0] == "-r", args
+inputs = shlex.split(open(args[3][1:]).read())
+root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+with open(os.path.join(root, "lld.log"), "a") as f:
+    f.write(" ".join(inputs) + "\n")
+with open(args[2], "wb") as f:
+    f.write(b"\x7fELF" + "\n".join(inputs).encode())
+"""
+
+
+@unittest.skipUnless(IS_LINUX, "pre-linking is Linux only")
+@unittest.skipUnless(_ensure_built(), SKIP_REASON)
+class TestPrelink(unittest.TestCase):
+    def setUp(self) -> None:
+        self.root = Path(tempfile.mkdtemp(prefix="ctc_prelink_"))
+        arch = "arm64" if platform.machine().lower() in ("aarch64", "arm64") else "x86_64"
+        self.install = self.root / "clang" / "linux" / arch
+        (self.install / "bin").mkdir(parents=True)
+        (self.install / "lib" / "clang" / "19" / "include").mkdir(parents=True)
+        (self.install / "done.txt").write_text("ok\n")
+        for name, text in (("clang", _FAKE_CLANG), ("ld.lld", _FAKE_LLD)):
+            (self.install / "bin" / name).write_text(text)
+            (self.install / "bin" / name).chmod(0o755)
+        (self.install / "bin" / "clang++").symlink_to("clang")
+
+        self.work = self.root / "work"
+        self.objs = [self._obj(f"lib/o{i}.o") for i in range(10)]
+        self._obj("main.o")
+        self.env = dict(os.environ)
+        self.env["CLANG_TOOL_CHAIN_DOWNLOAD_PATH"] = str(self.root)
+        self.env["CLANG_TOOL_CHAIN_PRELINK"] = "1"
+        self.env["CLANG_TOOL_CHAIN_NO_NOTE"] = "1"
+        for key in ("CLANG_TOOL_CHAIN_PRELINK_MIN", "CLANG_TOOL_CHAIN_NO_AUTO", "CTC_TIMING_LOG", "CTC_DEBUG"):
+            self.env.pop(key, None)
+
+    def tearDown(self) -> None:
+        shutil.rmtree(self.root, ignore_errors=True)
+
+    def _obj(self, name: str, body: bytes = b"\x7fELF code") -> Path:
+        path = self.work / name
+        path.parent.mkdir(parents=True, exist_ok=True)
+        path.write_bytes(body + name.encode())
+        return path
+
+    def _link(self, *extra: str, inputs: list[str] | None = None) -> list[str]:
+        if inputs is None:
+            inputs = ["main.o", *(f"lib/o{i}.o" for i in range(10))]
+        result = subprocess.run(
+            [_exe("ctc-clang++"), *inputs, "-o", "app", *extra],
+            capture_output=True,
+            text=True,
+            env=self.env,
+            cwd=self.work,
+            timeout=60,
+        )
+        self.assertEqual(result.returncode, 0, result.stderr)
+        return json.loads((self.install / "clang.log").read_text().splitlines()[-1])
+
+    def _lld_runs(self) -> int:
+        log = self.install / "lld.log"
+        return len(log.read_text().splitlines()) if log.exists() else 0
+
+    def _blobs(self) -> list[str]:
+        state = self.work / "app.ctc-prelink"
+        return sorted(p.name for p in state.glob("*.o")) if state.is_dir() else []
+
+    def test_stable_group_is_prelinked(self) -> None:
+        first = self._link()
+        self.assertIn("lib/o3.o", first)
+        self.assertEqual(self._lld_runs(), 0)
+
+        second = self._link()
+        self.assertEqual(self._lld_runs(), 1)
+        self.assertEqual((self.install / "lld.log").read_text().split(), [f"lib/o{i}.o" for i in range(10)])
+        blobs = [a for a in second if a.endswith(".o") and "ctc-prelink" in a]
+        self.assertEqual(len(blobs), 1)
+        self.assertFalse(any(a.startswith("lib/") for a in second))
+        self.assertEqual(second.index(blobs[0]), first.index("lib/o0.o"))
+        self.assertIn("main.o", second)
+
+        self.assertEqual(self._link(), second)
+        self.assertEqual(self._lld_runs(), 1)
+
+    def test_member_edit(self) -> None:
+        self._link()
+        self._link()
+        old_blobs = self._blobs()
+        self.assertEqual(len(old_blobs), 1)
+
+        self._obj("lib/o4.o", b"\x7fELF changed ")
+        loose = self._link()
+        self.assertIn("lib/o4.o", loose)
+        self.assertEqual(self._blobs(), [], "stale blob kept")
+
+        self._link()
+        self.assertEqual(self._lld_runs(), 2)
+        self.assertEqual(len(self._blobs()), 1)
+        self.assertNotEqual(self._blobs(), old_blobs)
+
+    def test_touch_keeps_blob(self) -> None:
+        self._link()
+        self._link()
+        st = self.objs[2].stat()
+        os.utime(self.objs[2], ns=(st.st_atime_ns, st.st_mtime_ns + 5_000_000_000))
+        args = self._link()
+        self.assertNotIn("lib/o2.o", args)
+        self.assertEqual(self._lld_runs(), 1)
+
+    def test_ineligible_links(self) -> None:
+        self.env["CLANG_TOOL_CHAIN_PRELINK_MIN"] = "11"
+        for _ in range(2):
+            self.assertIn("lib/o0.o", self._link())
+        self.env.pop("CLANG_TOOL_CHAIN_PRELINK_MIN")
+        for _ in range(2):
+            self.assertIn("lib/o0.o", self._link("-flto=thin"))
+        self._obj("lib/o5.o", b"BC\xc0\xde bitcode ")
+        for _ in range(2):
+            self.assertIn("lib/o0.o", self._link())
+        self.assertEqual(self._lld_runs(), 0)
+
+    def test_response_file(self) -> None:
+        rsp = self.work / "objects.rsp"
+        rsp.write_text(" ".join(f"lib/o{i}.o" for i in range(10)) + "\n")
+        self._link(inputs=["main.o", "@objects.rsp"])
+        args = self._link(inputs=["main.o", "@objects.rsp"])
+        self.assertEqual(self._lld_runs(), 1)
+        blob = args[args.index("main.o") + 1]
+        self.assertTrue(blob.endswith(".o") and "app.ctc-prelink" in blob, args)
+        self.assertFalse(any(a.startswith("lib/") for a in args))
+
+    def test_disabled_by_default(self) -> None:
+        self.env.pop("CLANG_TOOL_CHAIN_PRELINK")
+        self._link()
+        self.assertIn("lib/o0.o", self._link())
+        self.assertFalse((self.work / "app.ctc-prelink").exists())
+
+
+if __name__ == "__main__":
+    unittest.main()
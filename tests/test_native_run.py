@@ -0,0 +1,268 @@
+"""Tests for ctc-run, the native compile-once runner for single-file programs.
+
+ctc-run hashes the source, its directives, the flags and the toolchain into a
+cache key, execs <cache>/<key>/<stem> when every header recorded from the
+last compile's -MD output is unchanged, and otherwise compiles through
+ctc-clang's own dispatch. The toolchain here is a fake clang that writes a
+shell script as the "binary" and a depfile listing the quoted includes.
+
+Tests cover:
+  - First run compiles, second run execs the cached binary
+  - Arguments after SOURCE reach the program verbatim (including "--")
+  - Header edits recompile; touching a header without editing it does not
+  - Flag changes and binary-affecting env vars get their own cache entry
+  - Editing the source evicts the entry it supersedes; other variants stay
+  - Shebang scripts: first line blanked to a comment, directives honored
+  - --ctc-which / --ctc-rebuild, compile failures leave no cache entry
+"""
+
+import os
+import platform
+import shutil
+import subprocess
+import sys
+import tempfile
+import unittest
+from pathlib import Path
+
+IS_WINDOWS = sys.platform == "win32"
+IS_LINUX = sys.platform.startswith("linux")
+
+
+# ------------------------------------------------------------------
+# Module-level compilation: build native tools once for all tests
+# ------------------------------------------------------------------
+
+_build_dir: str | None = None
+_build_ok: bool = False
+
+
+def _ensure_built() -> bool:
+    """Compile native tools into a temp directory (runs once per session)."""
+    global _build_dir, _build_ok  # noqa: PLW0603
+    if _build_dir is not None:
+        return _build_ok
+
+    import importlib.resources as resources
+
+    ref = resources.files("clang_tool_chain.native_tools").joinpath("launcher_run.cpp")
+    if not (hasattr(ref, "is_file") and ref.is_file()):  # type: ignore[union-attr]
+        _build_dir = ""
+        return False
+
+    _build_dir = tempfile.mkdtemp(prefix="ctc_run_test_")
+
+    try:
+        from clang_tool_chain.commands.compile_native import compile_native
+
+        rc = compile_native(_build_dir)
+        _build_ok = rc == 0
+    except Exception:
+        _build_ok = False
+
+    if not _build_ok:
+        print(
+            f"WARNING: native tool compilation failed (dir={_build_dir})",
+            file=sys.stderr,
+        )
+
+    import atexit
+
+    def _cleanup() -> None:
+        if _build_dir and os.path.isdir(_build_dir):
+            shutil.rmtree(_build_dir, ignore_errors=True)
+
+    atexit.register(_cleanup)
+    return _build_ok
+
+
+def _exe(name: str) -> str:
+    _ensure_built()
+    suffix = ".exe" if IS_WINDOWS else ""
+    return str(Path(_build_dir or "") / f"{name}{suffix}")
+
+
+SKIP_REASON = "Native tool compilation failed"
+
+
+# clang stand-in: logs argv and the compiled source's first line, "links" a
+# shell script that echoes its arguments, and writes a depfile of the quoted
+# includes. A source containing FAIL fails to compile.
+_FAKE_CLANG = r"""#!/usr/bin/env python3
+import os, re, sys
+args = sys.argv[1:]
+root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+out = args[args.index("-o") + 1]
+dep = args[args.index("-MF") + 1] if "-MF" in args else None
+src = next(a for a in args if a.endswith((".cpp", ".c")) and not a.startswith("-"))
+text = open(src).read()
+with open(os.path.join(root, "argv.log"), "a") as f:
+    f.write(" ".join(args) + "\n" + "first: " + text.splitlines()[0] + "\n")
+if "FAIL" in text:
+    sys.stderr.write("error: FAIL\n")
+    sys.exit(1)
+headers = [os.path.join(os.path.dirname(src), h) for h in re.findall(r'#include "([^"]+)"', text)]
+body = "".join(open(h).read() for h in headers).strip().replace("'", "")
+with open(out, "w") as f:
+    f.write("#!/bin/sh\necho 'built %s [%s]' \"$@\"\n" % (os.path.basename(src), body))
+os.chmod(out, 0o755)
+if dep:
+    with open(dep, "w") as f:
+        f.write(out + ": " + " \\\n  ".join([src] + headers) + "\n")
+"""
+
+
+def _fake_toolchain(root: Path) -> Path:
+    arch = "arm64" if platform.machine().lower() in ("aarch64", "arm64") else "x86_64"
+    install = root / "clang" / "linux" / arch
+    (install / "bin").mkdir(parents=True)
+    (install / "lib" / "clang" / "19" / "include").mkdir(parents=True)
+    (install / "done.txt").write_text("ok\n")
+    clang = install / "bin" / "clang"
+    clang.write_text(_FAKE_CLANG)
+    clang.chmod(0o755)
+    (install / "bin" / "clang++").symlink_to("clang")
+    return install
+
+
+@unittest.skipUnless(IS_LINUX, "fake toolchain layout is Linux only")
+@unittest.skipUnless(_ensure_built(), SKIP_REASON)
+class TestCtcRun(unittest.TestCase):
+    def setUp(self) -> None:
+        self.root = Path(tempfile.mkdtemp(prefix="ctc_run_"))
+        self.install = _fake_toolchain(self.root)
+        self.cache = self.root / "run-cache"
+        self.src_dir = self.root / "src"
+        self.src_dir.mkdir()
+        self.env = dict(os.environ)
+        self.env["CLANG_TOOL_CHAIN_DOWNLOAD_PATH"] = str(self.root)
+        self.env["CLANG_TOOL_CHAIN_RUN_CACHE"] = str(self.cache)
+        self.env["CLANG_TOOL_CHAIN_NO_NOTE"] = "1"
+        for key in ("CLANG_TOOL_CHAIN_RUNTIME", "CLANG_TOOL_CHAIN_NO_AUTO", "CTC_DEBUG"):
+            self.env.pop(key, None)
+
+    def tearDown(self) -> None:
+        shutil.rmtree(self.root, ignore_errors=True)
+
+    def _write(self, name: str, text: str) -> Path:
+        path = self.src_dir / name
+        path.write_text(text)
+        return path
+
+    def _run(self, *args: str) -> subprocess.CompletedProcess:
+        return subprocess.run(
+            [_exe("ctc-run"), *args], capture_output=True, text=True, env=self.env, cwd=self.src_dir, timeout=60
+        )
+
+    def _compiles(self) -> int:
+        log = self.install / "argv.log"
+        return sum(1 for line in log.read_text().splitlines() if not line.startswith("first: ")) if log.exists() else 0
+
+    def test_second_run_uses_cache(self) -> None:
+        self._write("hello.cpp", "int main() {}\n")
+        first = self._run("hello.cpp", "a")
+        self.assertEqual(first.returncode, 0, first.stderr)
+        self.assertEqual(first.stdout.strip(), "built hello.cpp [] a")
+        second = self._run("hello.cpp", "b")
+        self.assertEqual(second.stdout.strip(), "built hello.cpp [] b")
+        self.assertEqual(self._compiles(), 1)
+        entries = list(self.cache.iterdir())
+        self.assertEqual(len(entries), 1)
+        self.assertEqual(sorted(p.name for p in entries[0].iterdir()), ["deps", "hello"])
+
+    def test_program_args_are_verbatim(self) -> None:
+        self._write("args.cpp", "int main() {}\n")
+        result = self._run("-O2", "args.cpp", "-v", "--", "--ctc-rebuild", "x")
+        self.assertEqual(result.stdout.strip(), "built args.cpp [] -v -- --ctc-rebuild x")
+        log = (self.install / "argv.log").read_text()
+        self.assertIn("-O2", log)
+        self.assertNotIn("-v", log.split())
+
+    def test_header_edit_recompiles(self) -> None:
+        header = self._write("config.h", "ONE\n")
+        self._write("main.cpp", '#include "config.h"\nint main() {}\n')
+        self.assertEqual(self._run("main.cpp").stdout.strip(), "built main.cpp [ONE]")
+        deps = next(self.cache.iterdir()) / "deps"
+        self.assertIn(str(header), deps.read_text())
+
+        st = header.stat()
+        os.utime(header, ns=(st.st_atime_ns, st.st_mtime_ns + 5_000_000_000))
+        self.assertEqual(self._run("main.cpp").stdout.strip(), "built main.cpp [ONE]")
+        self.assertEqual(self._compiles(), 1, "touch without edit must not recompile")
+
+        header.write_text("TWO\n")
+        self.assertEqual(self._run("main.cpp").stdout.strip(), "built main.cpp [TWO]")
+        self.assertEqual(self._compiles(), 2)
+
+    def test_flags_are_part_of_the_key(self) -> None:
+        self._write("flags.cpp", "int main() {}\n")
+        self._run("-O0", "flags.cpp")
+        self._run("-O2", "flags.cpp")
+        self._run("-O0", "flags.cpp")
+        self.assertEqual(self._compiles(), 2)
+        self.assertEqual(len(list(self.cache.iterdir())), 2)
+
+    def test_env_is_part_of_the_key(self) -> None:
+        self._write("env.cpp", "int main() {}\n")
+        self._run("env.cpp")
+        for var in ("CLANG_TOOL_CHAIN_OPT_RECORD", "CLANG_TOOL_CHAIN_PRELINK"):
+            self.env[var] = "1"
+            self._run("env.cpp")
+        self._run("env.cpp")
+        self.assertEqual(self._compiles(), 3)
+        self.assertEqual(len(list(self.cache.iterdir())), 3)
+
+    def test_edit_evicts_superseded_entry(self) -> None:
+        src = self._write("edit.cpp", "int main() {}\n")
+        self._write("other.cpp", "int main() {}\n")
+        self._run("other.cpp")
+        self._run("-O2", "edit.cpp")
+        first = self._run("--ctc-which", "edit.cpp").stdout.strip()
+        src.write_text("int main() { return 0; }\n")
+        second = self._run("--ctc-which", "edit.cpp").stdout.strip()
+        self.assertNotEqual(Path(first).parent, Path(second).parent)
+        self.assertFalse(Path(first).parent.exists(), "superseded entry left behind")
+        self.assertTrue(Path(second).is_file())
+        # other.cpp and the -O2 build of the old content are other variants
+        self.assertEqual(len(list(self.cache.iterdir())), 3)
+        self.assertEqual(self._compiles(), 4)
+
+    def test_shebang_script(self) -> None:
+        script = self._write(
+            "tool.cpp", "#!/usr/bin/env -S ctc-run -O2\n// @std: c++20\nint main() {}\n"
+        )
+        result = self._run(str(script), "x")
+        self.assertEqual(result.returncode, 0, result.stderr)
+        self.assertIn("built .tool.ctc-run.", result.stdout)
+        log = (self.install / "argv.log").read_text()
+        self.assertIn("-std=c++20", log)
+        self.assertIn("first: //#!/usr/bin/env -S ctc-run -O2", log)
+        self.assertEqual(sorted(p.name for p in self.src_dir.iterdir()), ["tool.cpp"], "temp copy left behind")
+
+    def test_which_and_rebuild(self) -> None:
+        self._write("w.c", "int main(void) { return 0; }\n")
+        which = self._run("--ctc-which", "w.c")
+        self.assertEqual(which.returncode, 0, which.stderr)
+        binary = Path(which.stdout.strip())
+        self.assertEqual(binary.parent.parent, self.cache)
+        self.assertTrue(binary.is_file())
+        self.assertIn("-o", (self.install / "argv.log").read_text())
+        self._run("--ctc-rebuild", "w.c")
+        self.assertEqual(self._compiles(), 2)
+
+    def test_compile_failure(self) -> None:
+        self._write("bad.cpp", "FAIL\n")
+        result = self._run("bad.cpp")
+        self.assertNotEqual(result.returncode, 0)
+        self.assertIn("error: FAIL", result.stderr)
+        binaries = [p for p in self.cache.rglob("*") if p.is_file()]
+        self.assertEqual(binaries, [])
+
+    def test_missing_source(self) -> None:
+        result = self._run("nope.cpp")
+        self.assertEqual(result.returncode, 1)
+        self.assertIn("Source file not found", result.stderr)
+
+
+if __name__ == "__main__":
+    unittest.main()
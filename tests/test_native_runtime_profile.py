@@ -0,0 +1,365 @@
+"""Tests for the ctc-clang runtime profiles (CLANG_TOOL_CHAIN_RUNTIME).
+
+runtime-dir (Linux): toolchain runtimes are published once into
+<ctc_home>/runtime/<platform>-<arch>-<fingerprint>/ and every link gets an
+rpath to that directory followed by $ORIGIN, so --deploy-dependencies copies
+nothing per output.
+
+static (Linux): libc++/libc++abi/libunwind and sanitizer runtimes are linked
+statically and nothing is deployed. ctc-startbench compares start latency.
+
+Tests cover:
+  - Default profile: no runtime-dir rpath
+  - rpath order (runtime dir, then $ORIGIN) on links, none on compiles
+  - Published set: libc++/libunwind/sanitizer .so's, soname symlinks kept,
+    static archives and unrelated toolchain libraries left out
+  - A second link does not republish; a changed clang gets a new directory
+  - Concurrent first links leave exactly one complete directory
+  - A runtime that can't be published, no runtimes at all or an uncreatable
+    base leave no directory behind and warn (copy deployment takes over)
+  - static: -static-libstdc++/-static-libgcc, no rpath, no -shared-libasan,
+    -static-libsan with sanitizers, explicit -lunwind pinned to the archive,
+    no deployment
+  - ctc-startbench: timing existing binaries, probe builds per profile
+"""
+
+import json
+
+import os
+import platform
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+import unittest
+from pathlib import Path
+
+IS_WINDOWS = sys.platform == "win32"
+IS_LINUX = sys.platform.startswith("linux")
+
+
+# ------------------------------------------------------------------
+# Module-level compilation: build native tools once for all tests
+# ------------------------------------------------------------------
+
+_build_dir: str | None = None
+_build_ok: bool = False
+
+
+def _ensure_built() -> bool:
+    """Compile native tools into a temp directory (runs once per session)."""
+    global _build_dir, _build_ok  # noqa: PLW0603
+    if _build_dir is not None:
+        return _build_ok
+
+    import importlib.resources as resources
+
+    ref = resources.files("clang_tool_chain.native_tools").joinpath("clang_launcher.cpp")
+    if not (hasattr(ref, "is_file") and ref.is_file()):  # type: ignore[union-attr]
+        _build_dir = ""
+        return False
+
+    _build_dir = tempfile.mkdtemp(prefix="ctc_runtime_test_")
+
+    try:
+        from clang_tool_chain.commands.compile_native import compile_native
+
+        rc = compile_native(_build_dir)
+        _build_ok = rc == 0
+    except Exception:
+        _build_ok = False
+
+    if not _build_ok:
+        print(
+            f"WARNING: native tool compilation failed (dir={_build_dir})",
+            file=sys.stderr,
+        )
+
+    import atexit
+
+    def _cleanup() -> None:
+        if _build_dir and os.path.isdir(_build_dir):
+            shutil.rmtree(_build_dir, ignore_errors=True)
+
+    atexit.register(_cleanup)
+    return _build_ok
+
+
+def _exe(name: str) -> str:
+    _ensure_built()
+    suffix = ".exe" if IS_WINDOWS else ""
+    return str(Path(_build_dir or "") / f"{name}{suffix}")
+
+
+def _run(args: list[str], env: dict[str, str], cwd: str | None = None) -> subprocess.CompletedProcess:
+    return subprocess.run(
+        args, capture_output=True, text=True, encoding="utf-8", errors="replace", timeout=60, env=env, cwd=cwd
+    )
+
+
+SKIP_REASON = "Native tool compilation failed"
+
+
+def _fake_toolchain(root: Path) -> Path:
+    """Install dir whose clang is /bin/echo (links just print their argv)."""
+    arch = "arm64" if platform.machine().lower() in ("aarch64", "arm64") else "x86_64"
+    install = root / "clang" / "linux" / arch
+    triple = "x86_64-unknown-linux-gnu" if arch == "x86_64" else "aarch64-unknown-linux-gnu"
+    rt = install / "lib" / "clang" / "19" / "lib" / triple
+    (install / "bin").mkdir(parents=True)
+    rt.mkdir(parents=True)
+    (install / "lib" / "clang" / "19" / "include").mkdir()
+    (install / "done.txt").write_text("ok\n")
+    shutil.copy("/bin/echo", install / "bin" / "clang")
+    (install / "bin" / "clang++").symlink_to("clang")
+    (install / "lib" / "libc++.so.1.0").write_text("libc++")
+    (install / "lib" / "libc++.so.1").symlink_to("libc++.so.1.0")
+    (install / "lib" / "libunwind.so.1").write_text("libunwind")
+    (install / "lib" / "libLLVM.so").write_text("not a runtime")
+    (rt / "libclang_rt.asan.so").write_text("asan")
+    (rt / "libclang_rt.asan.a").write_text("static asan")
+    (install / "lib" / "libunwind.a").write_text("static libunwind")
+    return install
+
+
+# clang stand-in for probe builds: logs its argv and "links" /bin/true to -o.
+_FAKE_LINKER = """#!/bin/sh
+echo "$@" >> "$(dirname "$0")/../argv.log"
+out=
+while [ $# -gt 0 ]; do
+  if [ "$1" = "-o" ]; then out=$2; fi
+  shift
+done
+[ -n "$out" ] && cp /bin/true "$out"
+exit 0
+"""
+
+
+@unittest.skipUnless(IS_LINUX, "runtime-dir profile is Linux only")
+@unittest.skipUnless(_ensure_built(), SKIP_REASON)
+class TestRuntimeDir(unittest.TestCase):
+    def setUp(self) -> None:
+        self.root = Path(tempfile.mkdtemp(prefix="ctc_runtime_"))
+        self.install = _fake_toolchain(self.root)
+        self.env = dict(os.environ)
+        self.env["CLANG_TOOL_CHAIN_DOWNLOAD_PATH"] = str(self.root)
+        self.env["CLANG_TOOL_CHAIN_RUNTIME"] = "runtime-dir"
+        self.env["CLANG_TOOL_CHAIN_NO_NOTE"] = "1"
+        for key in ("CLANG_TOOL_CHAIN_RUNTIME_DIR", "CLANG_TOOL_CHAIN_NO_AUTO", "CTC_DEBUG"):
+            self.env.pop(key, None)
+
+    def tearDown(self) -> None:
+        shutil.rmtree(self.root, ignore_errors=True)
+
+    def _clang(self, *args: str, env: dict[str, str] | None = None) -> subprocess.CompletedProcess:
+        return subprocess.run(
+            [_exe("ctc-clang++"), *args],
+            capture_output=True,
+            text=True,
+            env=env or self.env,
+            cwd=self.root,
+            timeout=60,
+        )
+
+    def _runtime_dirs(self) -> list[Path]:
+        base = self.root / "runtime"
+        return sorted(base.iterdir()) if base.is_dir() else []
+
+    def test_default_profile_has_no_runtime_rpath(self) -> None:
+        env = dict(self.env)
+        env.pop("CLANG_TOOL_CHAIN_RUNTIME")
+        out = self._clang("--dry-run", "main.cpp", "-o", "app", env=env).stdout
+        self.assertNotIn("-rpath", out)
+
+    def test_rpath_order(self) -> None:
+        args = self._clang("--dry-run", "main.cpp", "-o", "app").stdout.split()
+        rpaths = [a for a in args if a.startswith("-Wl,-rpath,")]
+        self.assertEqual(len(rpaths), 2, args)
+        self.assertIn(str(self.root / "runtime" / "linux-"), rpaths[0])
+        self.assertEqual(rpaths[1], "-Wl,-rpath,$ORIGIN")
+        compile_args = self._clang("--dry-run", "-c", "main.cpp").stdout
+        self.assertNotIn("-rpath", compile_args)
+
+    def test_publish_once(self) -> None:
+        result = self._clang("main.cpp", "-o", "app", "--deploy-dependencies")
+        self.assertEqual(result.returncode, 0, result.stderr)
+        dirs = self._runtime_dirs()
+        self.assertEqual(len(dirs), 1)
+        published = dirs[0]
+        names = sorted(p.name for p in published.iterdir())
+        self.assertEqual(names, ["libc++.so.1", "libc++.so.1.0", "libclang_rt.asan.so", "libunwind.so.1"])
+        self.assertTrue((published / "libc++.so.1").is_symlink())
+        self.assertEqual((published / "libc++.so.1").read_text(), "libc++")
+        self.assertFalse((self.root / "libc++.so.1").exists(), "copy-mode deployment ran")
+        # rpath in the link points at the published directory
+        self.assertIn(f"-Wl,-rpath,{published}", result.stdout)
+
+        stamp = published.stat().st_mtime_ns
+        inode = (published / "libunwind.so.1").stat().st_ino
+        time.sleep(0.05)
+        self.assertEqual(self._clang("main.cpp", "-o", "app2").returncode, 0)
+        self.assertEqual(self._runtime_dirs(), [published])
+        self.assertEqual(published.stat().st_mtime_ns, stamp)
+        self.assertEqual((published / "libunwind.so.1").stat().st_ino, inode)
+
+    def test_compile_does_not_publish(self) -> None:
+        self.assertEqual(self._clang("-c", "main.cpp").returncode, 0)
+        self.assertEqual(self._runtime_dirs(), [])
+
+    def test_new_toolchain_new_directory(self) -> None:
+        self._clang("main.cpp", "-o", "app")
+        clang = self.install / "bin" / "clang"
+        st = clang.stat()
+        os.utime(clang, ns=(st.st_atime_ns, st.st_mtime_ns + 10**9))
+        self._clang("main.cpp", "-o", "app")
+        self.assertEqual(len(self._runtime_dirs()), 2)
+
+    def test_concurrent_first_links(self) -> None:
+        procs = [
+            subprocess.Popen(
+                [_exe("ctc-clang++"), "main.cpp", "-o", f"app{i}"],
+                stdout=subprocess.DEVNULL,
+                stderr=subprocess.DEVNULL,
+                env=self.env,
+                cwd=self.root,
+            )
+            for i in range(8)
+        ]
+        for p in procs:
+            self.assertEqual(p.wait(timeout=60), 0)
+        dirs = self._runtime_dirs()
+        self.assertEqual(len(dirs), 1, dirs)
+        self.assertEqual(len(list(dirs[0].iterdir())), 4)
+
+    def test_incomplete_publish_leaves_no_directory(self) -> None:
+        (self.install / "lib" / "libc++abi.so.1").mkdir()  # neither linkable nor copyable
+        result = self._clang("main.cpp", "-o", "app", "--deploy-dependencies")
+        self.assertEqual(result.returncode, 0, result.stderr)
+        self.assertIn("not published (cannot copy", result.stderr)
+        self.assertEqual(self._runtime_dirs(), [])
+        # Nothing sticks: once the toolchain is fixed the next link publishes it
+        (self.install / "lib" / "libc++abi.so.1").rmdir()
+        result = self._clang("main.cpp", "-o", "app")
+        self.assertNotIn("Warning", result.stderr)
+        (published,) = self._runtime_dirs()
+        self.assertEqual(len(list(published.iterdir())), 4)
+
+    def test_no_runtimes_leaves_no_directory(self) -> None:
+        for p in (self.install / "lib").rglob("*.so*"):
+            p.unlink()
+        result = self._clang("main.cpp", "-o", "app")
+        self.assertEqual(result.returncode, 0, result.stderr)
+        self.assertIn("not published (no runtimes found)", result.stderr)
+        self.assertEqual(self._runtime_dirs(), [])
+
+    def test_uncreatable_base_warns(self) -> None:
+        (self.root / "file").write_text("")
+        env = dict(self.env, CLANG_TOOL_CHAIN_RUNTIME_DIR=str(self.root / "file" / "runtime"))
+        result = self._clang("main.cpp", "-o", "app", env=env)
+        self.assertEqual(result.returncode, 0, result.stderr)
+        self.assertIn("cannot create runtime dir", result.stderr)
+
+    def test_runtime_dir_override(self) -> None:
+        env = dict(self.env, CLANG_TOOL_CHAIN_RUNTIME_DIR=str(self.root / "custom"))
+        self._clang("main.cpp", "-o", "app", env=env)
+        self.assertEqual(len(list((self.root / "custom").iterdir())), 1)
+
+
+@unittest.skipUnless(IS_LINUX, "static profile is Linux only")
+@unittest.skipUnless(_ensure_built(), SKIP_REASON)
+class TestStaticProfile(unittest.TestCase):
+    def setUp(self) -> None:
+        self.root = Path(tempfile.mkdtemp(prefix="ctc_static_"))
+        self.install = _fake_toolchain(self.root)
+        self.env = dict(os.environ)
+        self.env["CLANG_TOOL_CHAIN_DOWNLOAD_PATH"] = str(self.root)
+        self.env["CLANG_TOOL_CHAIN_RUNTIME"] = "static"
+        self.env["CLANG_TOOL_CHAIN_NO_NOTE"] = "1"
+        for key in ("CLANG_TOOL_CHAIN_RUNTIME_DIR", "CLANG_TOOL_CHAIN_NO_AUTO", "CTC_DEBUG"):
+            self.env.pop(key, None)
+
+    def tearDown(self) -> None:
+        shutil.rmtree(self.root, ignore_errors=True)
+
+    def _dry_run(self, *args: str) -> list[str]:
+        result = _run([_exe("ctc-clang++"), "--dry-run", *args], env=self.env, cwd=str(self.root))
+        self.assertEqual(result.returncode, 0, result.stderr)
+        return result.stdout.split()
+
+    def test_link_flags(self) -> None:
+        args = self._dry_run("-stdlib=libc++", "main.cpp", "-o", "app")
+        self.assertIn("-static-libstdc++", args)
+        self.assertIn("-static-libgcc", args)
+        self.assertFalse([a for a in args if "-rpath" in a], args)
+
+    def test_compile_only_unchanged(self) -> None:
+        args = self._dry_run("-c", "main.cpp")
+        self.assertNotIn("-static-libstdc++", args)
+
+    def test_sanitizer_runtime_static(self) -> None:
+        args = self._dry_run("-fsanitize=address", "main.cpp", "-o", "app")
+        self.assertNotIn("-shared-libasan", args)
+        self.assertIn("-static-libsan", args)
+        # an explicit user choice wins
+        args = self._dry_run("-fsanitize=address", "-shared-libsan", "main.cpp", "-o", "app")
+        self.assertNotIn("-static-libsan", args)
+
+    def test_explicit_lunwind_pinned_to_archive(self) -> None:
+        args = self._dry_run("main.cpp", "-o", "app", "-lunwind", "-lc++")
+        self.assertIn(str(self.install / "lib" / "libunwind.a"), args)
+        self.assertNotIn("-lunwind", args)
+        self.assertIn("-lc++", args)  # no libc++.a in this install: left alone
+
+    def test_no_deployment(self) -> None:
+        result = _run(
+            [_exe("ctc-clang++"), "main.cpp", "-o", "app", "--deploy-dependencies"], env=self.env, cwd=str(self.root)
+        )
+        self.assertEqual(result.returncode, 0, result.stderr)
+        self.assertFalse(list(self.root.glob("lib*.so*")))
+        self.assertFalse((self.root / "runtime").exists())
+
+
+@unittest.skipUnless(IS_LINUX, "ctc-startbench is Linux only")
+@unittest.skipUnless(_ensure_built(), SKIP_REASON)
+class TestStartBench(unittest.TestCase):
+    def test_existing_binaries(self) -> None:
+        cmd = [_exe("ctc-startbench"), "--runs", "5", "--warmup", "1", "--json", "/bin/true"]
+        result = _run(cmd, env=dict(os.environ))
+        self.assertEqual(result.returncode, 0, result.stderr)
+        data = json.loads(result.stdout)
+        self.assertEqual(data["runs"], 5)
+        (entry,) = data["results"]
+        self.assertEqual(entry["path"], "/bin/true")
+        self.assertGreater(entry["median_us"], 0)
+        self.assertLessEqual(entry["min_us"], entry["median_us"])
+        self.assertLessEqual(entry["median_us"], entry["p90_us"])
+
+    def test_failing_binary(self) -> None:
+        result = _run([_exe("ctc-startbench"), "--runs", "2", "/bin/false"], env=dict(os.environ))
+        self.assertEqual(result.returncode, 1)
+        self.assertIn("exited with 1", result.stderr)
+
+    def test_probe_builds_per_profile(self) -> None:
+        root = Path(tempfile.mkdtemp(prefix="ctc_startbench_"))
+        self.addCleanup(shutil.rmtree, root, True)
+        install = _fake_toolchain(root)
+        clang = install / "bin" / "clang"
+        clang.write_text(_FAKE_LINKER)
+        clang.chmod(0o755)
+        env = dict(os.environ, CLANG_TOOL_CHAIN_DOWNLOAD_PATH=str(root), CLANG_TOOL_CHAIN_NO_NOTE="1", TMPDIR=str(root))
+        result = _run(
+            [_exe("ctc-startbench"), "--runs", "3", "--warmup", "0", "--json", "--clang", _exe("ctc-clang++")], env=env
+        )
+        self.assertEqual(result.returncode, 0, result.stderr)
+        names = [r["name"] for r in json.loads(result.stdout)["results"]]
+        self.assertEqual(names, ["copy", "static"])
+        links = (install / "argv.log").read_text().splitlines()
+        self.assertEqual(len(links), 2)
+        self.assertNotIn("-static-libstdc++", links[0])
+        self.assertIn("-static-libstdc++", links[1])
+        self.assertFalse(list(root.glob("ctc-startbench.*")), "probe directory left behind")
+
+
+if __name__ == "__main__":
+    unittest.main()
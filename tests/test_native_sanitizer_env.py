@@ -0,0 +1,197 @@
+"""Tests for ctc-sanitizer-env, the cached sanitizer runtime environment.
+
+ctc-sanitizer-env resolves the runtime library directories and bundled
+llvm-symbolizer once per toolchain fingerprint, stores them in the launcher
+cache (.ctc-cache) and prints ASAN/LSAN/UBSAN options plus those paths for
+test harnesses to load once. The toolchain here is a fake install tree.
+
+Tests cover:
+  - sh / env / json output, user values winning over defaults
+  - Runtime dirs and symbolizer persisted in .ctc-cache with the fingerprint
+  - The cached result reused until the clang binary changes (or --refresh)
+  - CTC_SANITIZER_ENV preventing a second prepend of the runtime dirs
+  - --suppressions, missing toolchain and usage errors
+"""
+
+import json
+import os
+import platform
+import shutil
+import subprocess
+import sys
+import tempfile
+import unittest
+from pathlib import Path
+
+IS_WINDOWS = sys.platform == "win32"
+IS_LINUX = sys.platform.startswith("linux")
+
+
+# ------------------------------------------------------------------
+# Module-level compilation: build native tools once for all tests
+# ------------------------------------------------------------------
+
+_build_dir: str | None = None
+_build_ok: bool = False
+
+
+def _ensure_built() -> bool:
+    """Compile native tools into a temp directory (runs once per session)."""
+    global _build_dir, _build_ok  # noqa: PLW0603
+    if _build_dir is not None:
+        return _build_ok
+
+    import importlib.resources as resources
+
+    ref = resources.files("clang_tool_chain.native_tools").joinpath("launcher_sanitizer_env.cpp")
+    if not (hasattr(ref, "is_file") and ref.is_file()):  # type: ignore[union-attr]
+        _build_dir = ""
+        return False
+
+    _build_dir = tempfile.mkdtemp(prefix="ctc_sanitizer_env_test_")
+
+    try:
+        from clang_tool_chain.commands.compile_native import compile_native
+
+        rc = compile_native(_build_dir)
+        _build_ok = rc == 0
+    except Exception:
+        _build_ok = False
+
+    if not _build_ok:
+        print(
+            f"WARNING: native tool compilation failed (dir={_build_dir})",
+            file=sys.stderr,
+        )
+
+    import atexit
+
+    def _cleanup() -> None:
+        if _build_dir and os.path.isdir(_build_dir):
+            shutil.rmtree(_build_dir, ignore_errors=True)
+
+    atexit.register(_cleanup)
+    return _build_ok
+
+
+def _exe(name: str) -> str:
+    _ensure_built()
+    suffix = ".exe" if IS_WINDOWS else ""
+    return str(Path(_build_dir or "") / f"{name}{suffix}")
+
+
+SKIP_REASON = "Native tool compilation failed"
+
+
+@unittest.skipUnless(IS_LINUX, "fake toolchain layout is the Linux one")
+@unittest.skipUnless(_ensure_built(), SKIP_REASON)
+class TestSanitizerEnv(unittest.TestCase):
+    def setUp(self) -> None:
+        self.root = Path(tempfile.mkdtemp(prefix="ctc_sanitizer_env_"))
+        arch = "aarch64" if platform.machine().lower() in ("aarch64", "arm64") else "x86_64"
+        self.install = self.root / "clang" / "linux" / ("arm64" if arch == "aarch64" else "x86_64")
+        (self.install / "bin").mkdir(parents=True)
+        self.rt_dir = self.install / "lib" / "clang" / "19" / "lib" / f"{arch}-unknown-linux-gnu"
+        self.rt_dir.mkdir(parents=True)
+        (self.install / "lib" / "clang" / "19" / "include").mkdir()
+        (self.install / "done.txt").write_text("ok\n")
+        shutil.copy("/bin/echo", self.install / "bin" / "clang")
+        (self.install / "bin" / "clang++").symlink_to("clang")
+        self.symbolizer = self.install / "bin" / "llvm-symbolizer"
+        self.symbolizer.write_text("#!/bin/sh\n")
+        self.symbolizer.chmod(0o755)
+        self.env = {"PATH": os.environ.get("PATH", "/usr/bin:/bin"), "CLANG_TOOL_CHAIN_DOWNLOAD_PATH": str(self.root)}
+
+    def tearDown(self) -> None:
+        shutil.rmtree(self.root, ignore_errors=True)
+
+    def _run(self, *args: str, env: dict[str, str] | None = None) -> subprocess.CompletedProcess[str]:
+        return subprocess.run(
+            [_exe("ctc-sanitizer-env"), *args], capture_output=True, text=True, env=env or self.env, timeout=60
+        )
+
+    def _json(self, *args: str, env: dict[str, str] | None = None) -> dict[str, str]:
+        result = self._run("--format", "json", *args, env=env)
+        self.assertEqual(result.returncode, 0, result.stderr)
+        return json.loads(result.stdout)
+
+    def _cache(self) -> dict[str, str]:
+        lines = (self.install / ".ctc-cache").read_text().splitlines()
+        return dict(line.split("=", 1) for line in lines if "=" in line)
+
+    def test_defaults_and_cache(self) -> None:
+        out = self._json()
+        self.assertEqual(out["ASAN_OPTIONS"], "fast_unwind_on_malloc=0:symbolize=1:detect_leaks=1")
+        self.assertEqual(out["LSAN_OPTIONS"], "fast_unwind_on_malloc=0:symbolize=1")
+        self.assertEqual(out["UBSAN_OPTIONS"], "print_stacktrace=1:symbolize=1")
+        self.assertEqual(out["ASAN_SYMBOLIZER_PATH"], str(self.symbolizer))
+        self.assertEqual(out["UBSAN_SYMBOLIZER_PATH"], str(self.symbolizer))
+        self.assertEqual(out["LD_LIBRARY_PATH"].split(":"), [str(self.rt_dir), str(self.install / "lib")])
+        self.assertRegex(out["CTC_SANITIZER_ENV"], r"^[0-9a-f]{16}$")
+
+        cache = self._cache()
+        self.assertEqual(cache["sanitizer_fingerprint"], out["CTC_SANITIZER_ENV"])
+        self.assertEqual(cache["sanitizer_lib_path"], out["LD_LIBRARY_PATH"])
+        self.assertEqual(cache["sanitizer_symbolizer"], str(self.symbolizer))
+
+    def test_cached_until_toolchain_changes(self) -> None:
+        first = self._json()
+        # Removing the symbolizer alone doesn't invalidate the cached result...
+        self.symbolizer.unlink()
+        self.assertEqual(self._json()["ASAN_SYMBOLIZER_PATH"], str(self.symbolizer))
+        # ...--refresh does
+        self.assertNotIn("ASAN_SYMBOLIZER_PATH", self._json("--refresh"))
+        # and so does a changed clang binary (new fingerprint)
+        self.symbolizer.write_text("#!/bin/sh\n")
+        clang = self.install / "bin" / "clang"
+        clang.write_bytes(clang.read_bytes() + b"\0")
+        second = self._json()
+        self.assertNotEqual(first["CTC_SANITIZER_ENV"], second["CTC_SANITIZER_ENV"])
+        self.assertEqual(second["ASAN_SYMBOLIZER_PATH"], str(self.symbolizer))
+
+    def test_user_values_and_marker(self) -> None:
+        env = dict(self.env, ASAN_OPTIONS="detect_leaks=0", LD_LIBRARY_PATH="/opt/lib")
+        out = self._json(env=env)
+        self.assertEqual(out["ASAN_OPTIONS"], "detect_leaks=0")
+        self.assertTrue(out["LD_LIBRARY_PATH"].endswith(":/opt/lib"))
+        # Loading the output and running again doesn't prepend twice
+        again = self._json(env=dict(env, **out))
+        self.assertEqual(again["LD_LIBRARY_PATH"], out["LD_LIBRARY_PATH"])
+
+    def test_sh_output_evaluates(self) -> None:
+        supp = self.root / "lsan it's.supp"
+        supp.write_text("leak:libfoo\n")
+        script = self._run("--suppressions", str(supp)).stdout
+        self.assertIn("export ASAN_OPTIONS=", script)
+        shell = subprocess.run(
+            ["sh", "-c", script + 'printf "%s\\n" "$LSAN_OPTIONS" "$ASAN_SYMBOLIZER_PATH"'],
+            capture_output=True,
+            text=True,
+            env=self.env,
+            timeout=30,
+        )
+        lsan, symbolizer = shell.stdout.splitlines()
+        self.assertEqual(lsan, f"fast_unwind_on_malloc=0:symbolize=1:suppressions={supp}")
+        self.assertEqual(symbolizer, str(self.symbolizer))
+
+    def test_env_format(self) -> None:
+        lines = self._run("--format", "env").stdout.splitlines()
+        keys = [line.split("=", 1)[0] for line in lines]
+        self.assertEqual(
+            keys,
+            ["ASAN_OPTIONS", "LSAN_OPTIONS", "UBSAN_OPTIONS", "ASAN_SYMBOLIZER_PATH", "UBSAN_SYMBOLIZER_PATH",
+             "LD_LIBRARY_PATH", "CTC_SANITIZER_ENV"],
+        )
+
+    def test_errors(self) -> None:
+        self.assertEqual(self._run("--format", "xml").returncode, 2)
+        self.assertEqual(self._run("--bogus").returncode, 2)
+        self.assertEqual(self._run("--suppressions", str(self.root / "missing")).returncode, 1)
+        (self.install / "done.txt").unlink()
+        result = self._run()
+        self.assertEqual(result.returncode, 1)
+        self.assertIn("not installed", result.stderr)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,223 @@
+"""Tests for the live build dashboard (ctc-top) and launcher slot registration.
+
+Launchers claim a slot in the shared-memory table at <ctc_home>/.ctc-top
+before exec'ing the real tool; ctc-top maps the same file and reports the
+in-flight invocations, reaping slots whose process has exited.
+
+Tests cover:
+  - Registry & resource presence
+  - Empty / missing table
+  - A running fast-path tool (ctc-llvm-ar) shows up with role and target,
+    and is counted as finished once it exits, reaped or not
+  - Launchers only create the table with CLANG_TOOL_CHAIN_TOP=1 but use an
+    existing one; CLANG_TOOL_CHAIN_NO_TOP=1 opt-out
+"""
+
+import json
+import os
+import platform
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+import unittest
+from pathlib import Path
+
+IS_WINDOWS = sys.platform == "win32"
+
+
+# ------------------------------------------------------------------
+# Module-level compilation: build native tools once for all tests
+# ------------------------------------------------------------------
+
+_build_dir: str | None = None
+_build_ok: bool = False
+
+
+def _ensure_built() -> bool:
+    """Compile native tools into a temp directory (runs once per session)."""
+    global _build_dir, _build_ok  # noqa: PLW0603
+    if _build_dir is not None:
+        return _build_ok
+
+    import importlib.resources as resources
+
+    ref = resources.files("clang_tool_chain.native_tools").joinpath("launcher_top.cpp")
+    if not (hasattr(ref, "is_file") and ref.is_file()):  # type: ignore[union-attr]
+        _build_dir = ""
+        return False
+
+    _build_dir = tempfile.mkdtemp(prefix="ctc_top_test_")
+
+    try:
+        from clang_tool_chain.commands.compile_native import compile_native
+
+        rc = compile_native(_build_dir)
+        _build_ok = rc == 0
+    except Exception:
+        _build_ok = False
+
+    if not _build_ok:
+        print(
+            f"WARNING: native tool compilation failed (dir={_build_dir})",
+            file=sys.stderr,
+        )
+
+    import atexit
+
+    def _cleanup() -> None:
+        if _build_dir and os.path.isdir(_build_dir):
+            shutil.rmtree(_build_dir, ignore_errors=True)
+
+    atexit.register(_cleanup)
+    return _build_ok
+
+
+def _exe(name: str) -> str:
+    _ensure_built()
+    suffix = ".exe" if IS_WINDOWS else ""
+    return str(Path(_build_dir or "") / f"{name}{suffix}")
+
+
+def _run(args: list[str], env: dict[str, str]) -> subprocess.CompletedProcess:
+    return subprocess.run(
+        args, capture_output=True, text=True, encoding="utf-8", errors="replace", timeout=60, env=env
+    )
+
+
+SKIP_REASON = "Native tool compilation failed"
+
+
+
+
+def _fake_home(root: Path) -> dict[str, str]:
+    """Toolchain home whose llvm-ar just sleeps, so the invocation stays in flight."""
+    plat = "darwin" if sys.platform == "darwin" else "linux"
+    arch = "arm64" if platform.machine().lower() in ("aarch64", "arm64") else "x86_64"
+    bin_dir = root / "clang" / plat / arch / "bin"
+    bin_dir.mkdir(parents=True)
+    tool = bin_dir / "llvm-ar"
+    tool.write_text("#!/bin/sh\nsleep 3\n")
+    tool.chmod(0o755)
+    env = dict(os.environ)
+    env["CLANG_TOOL_CHAIN_DOWNLOAD_PATH"] = str(root)
+    env["CLANG_TOOL_CHAIN_TOP"] = "1"
+    env.pop("CLANG_TOOL_CHAIN_NO_TOP", None)
+    return env
+
+
+# ==========================================================================
+# Resource & Registry
+# ==========================================================================
+
+
+class TestTopResource(unittest.TestCase):
+    """Verify launcher_top.cpp is accessible and registered."""
+
+    def test_registry_has_top(self) -> None:
+        from clang_tool_chain.native_tools import TOOL_REGISTRY
+
+        self.assertIn("top", TOOL_REGISTRY)
+        tool = TOOL_REGISTRY["top"]
+        self.assertEqual(tool.source, "launcher_top.cpp")
+        self.assertEqual(tool.output, "ctc-top")
+
+
+# ==========================================================================
+# Live table
+# ==========================================================================
+
+
+@unittest.skipUnless(_ensure_built(), SKIP_REASON)
+@unittest.skipIf(IS_WINDOWS, "fake tool is a shell script")
+class TestLiveTable(unittest.TestCase):
+    def setUp(self) -> None:
+        self.tmp = Path(tempfile.mkdtemp(prefix="ctc_top_"))
+        self.env = _fake_home(self.tmp)
+
+    def tearDown(self) -> None:
+        shutil.rmtree(self.tmp, ignore_errors=True)
+
+    def _snapshot(self) -> dict:
+        result = _run([_exe("ctc-top"), "--json"], self.env)
+        self.assertEqual(result.returncode, 0, result.stderr)
+        return json.loads(result.stdout)
+
+    def test_no_table_is_empty(self) -> None:
+        data = self._snapshot()
+        self.assertEqual(data["running"], 0)
+        self.assertEqual(data["invocations"], [])
+
+    def test_running_tool_is_listed_then_reaped(self) -> None:
+        proc = subprocess.Popen([_exe("ctc-llvm-ar"), "rcs", "out/libfoo.a", "a.o"], env=self.env)
+        try:
+            data = {}
+            for _ in range(50):
+                data = self._snapshot()
+                if data["running"]:
+                    break
+                time.sleep(0.05)
+            self.assertEqual(data["running"], 1)
+            inv = data["invocations"][0]
+            self.assertEqual(inv["pid"], proc.pid)  # slot follows the pid through exec
+            self.assertEqual(inv["role"], "llvm-ar")
+            self.assertEqual(inv["target"], "out/libfoo.a")
+        finally:
+            proc.wait(timeout=30)
+
+        data = self._snapshot()
+        self.assertEqual(data["running"], 0)
+        self.assertEqual(data["started"], 1)
+        self.assertEqual(data["finished"], 1)
+
+    def test_exit_counts_before_reaping(self) -> None:
+        subprocess.run([_exe("ctc-llvm-ar"), "rcs", "out/libfoo.a"], env=self.env, timeout=30)
+        table = (self.tmp / ".ctc-top").read_bytes()
+        started, finished = struct.unpack_from("<QQ", table, 24)
+        self.assertEqual((started, finished), (1, 0))  # exec'd: nobody has reaped the slot
+        data = self._snapshot()
+        self.assertEqual((data["started"], data["finished"], data["running"]), (1, 1, 0))
+
+    def test_table_created_only_on_opt_in(self) -> None:
+        env = dict(self.env)
+        env.pop("CLANG_TOOL_CHAIN_TOP")
+        subprocess.run([_exe("ctc-llvm-ar"), "rcs", "out/libfoo.a"], env=env, timeout=30)
+        self.assertFalse((self.tmp / ".ctc-top").exists())
+        self.assertIn("CLANG_TOOL_CHAIN_TOP=1", _run([_exe("ctc-top"), "--once"], env).stdout)
+        self.assertFalse((self.tmp / ".ctc-top").exists(), "--once must not create the table")
+
+        # Once the table exists (ctc-top's live view or an opted-in launcher
+        # made it), every launcher registers.
+        subprocess.run([_exe("ctc-llvm-ar"), "rcs", "out/libfoo.a"], env=self.env, timeout=30)
+        subprocess.run([_exe("ctc-llvm-ar"), "rcs", "out/libfoo.a"], env=env, timeout=30)
+        self.assertEqual(self._snapshot()["started"], 2)
+
+    def test_live_view_creates_table(self) -> None:
+        env = dict(self.env)
+        env.pop("CLANG_TOOL_CHAIN_TOP")
+        proc = subprocess.Popen([_exe("ctc-top"), "--interval", "0.1"], env=env, stdout=subprocess.DEVNULL)
+        try:
+            for _ in range(100):
+                if (self.tmp / ".ctc-top").exists():
+                    break
+                time.sleep(0.05)
+            self.assertTrue((self.tmp / ".ctc-top").exists())
+        finally:
+            proc.terminate()
+            proc.wait(timeout=30)
+
+    def test_opt_out(self) -> None:
+        env = dict(self.env, CLANG_TOOL_CHAIN_NO_TOP="1")
+        proc = subprocess.Popen([_exe("ctc-llvm-ar"), "rcs", "out/libfoo.a"], env=env)
+        try:
+            time.sleep(0.3)
+            self.assertEqual(self._snapshot()["running"], 0)
+        finally:
+            proc.wait(timeout=30)
+        self.assertFalse((self.tmp / ".ctc-top").exists())
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,207 @@
+"""Tests for ctc-clang --ctc-translate (batch compilation-database translation).
+
+`ctc-clang --ctc-translate compile_commands.json` runs every entry through the
+same argument parsing, directive and platform-flag injection as `--dry-run`
+and writes the resulting database ("arguments" form) in input order.
+
+Tests cover:
+  - Each translated entry equals the per-file --dry-run command
+  - "command" (shell string) and "arguments" entries, unknown keys skipped,
+    JSON escapes (including \\u) decoded and re-encoded
+  - Directives are read relative to the entry's "directory"
+  - -o writes a file; default output is stdout
+  - Malformed database is an error
+"""
+
+import json
+import os
+import platform
+import shutil
+import subprocess
+import sys
+import tempfile
+import unittest
+from pathlib import Path
+
+IS_WINDOWS = sys.platform == "win32"
+
+
+# ------------------------------------------------------------------
+# Module-level compilation: build native tools once for all tests
+# ------------------------------------------------------------------
+
+_build_dir: str | None = None
+_build_ok: bool = False
+
+
+def _ensure_built() -> bool:
+    """Compile native tools into a temp directory (runs once per session)."""
+    global _build_dir, _build_ok  # noqa: PLW0603
+    if _build_dir is not None:
+        return _build_ok
+
+    import importlib.resources as resources
+
+    ref = resources.files("clang_tool_chain.native_tools").joinpath("clang_launcher.cpp")
+    if not (hasattr(ref, "is_file") and ref.is_file()):  # type: ignore[union-attr]
+        _build_dir = ""
+        return False
+
+    _build_dir = tempfile.mkdtemp(prefix="ctc_translate_test_")
+
+    try:
+        from clang_tool_chain.commands.compile_native import compile_native
+
+        rc = compile_native(_build_dir)
+        _build_ok = rc == 0
+    except Exception:
+        _build_ok = False
+
+    if not _build_ok:
+        print(
+            f"WARNING: native tool compilation failed (dir={_build_dir})",
+            file=sys.stderr,
+        )
+
+    import atexit
+
+    def _cleanup() -> None:
+        if _build_dir and os.path.isdir(_build_dir):
+            shutil.rmtree(_build_dir, ignore_errors=True)
+
+    atexit.register(_cleanup)
+    return _build_ok
+
+
+def _exe(name: str) -> str:
+    _ensure_built()
+    suffix = ".exe" if IS_WINDOWS else ""
+    return str(Path(_build_dir or "") / f"{name}{suffix}")
+
+
+def _run(args: list[str], env: dict[str, str], cwd: str | None = None) -> subprocess.CompletedProcess:
+    return subprocess.run(
+        args, capture_output=True, text=True, encoding="utf-8", errors="replace", timeout=60, env=env, cwd=cwd
+    )
+
+
+SKIP_REASON = "Native tool compilation failed"
+
+
+def _fake_home(root: Path) -> dict[str, str]:
+    """Toolchain home with placeholder clang binaries (translation never runs them)."""
+    plat = "darwin" if sys.platform == "darwin" else "linux"
+    arch = "arm64" if platform.machine().lower() in ("aarch64", "arm64") else "x86_64"
+    bin_dir = root / "clang" / plat / arch / "bin"
+    bin_dir.mkdir(parents=True)
+    (bin_dir.parent / "done.txt").write_text("ok\n")
+    for name in ("clang", "clang++"):
+        tool = bin_dir / name
+        tool.write_text("#!/bin/sh\nexit 0\n")
+        tool.chmod(0o755)
+    env = dict(os.environ)
+    env["CLANG_TOOL_CHAIN_DOWNLOAD_PATH"] = str(root)
+    for key in ("CTC_DEBUG", "CLANG_TOOL_CHAIN_NO_AUTO", "CLANG_TOOL_CHAIN_NO_DIRECTIVES"):
+        env.pop(key, None)
+    return env
+
+
+@unittest.skipUnless(_ensure_built(), SKIP_REASON)
+@unittest.skipIf(IS_WINDOWS, "fake toolchain uses shell scripts")
+class TestTranslate(unittest.TestCase):
+    def setUp(self) -> None:
+        self.root = Path(tempfile.mkdtemp(prefix="ctc_translate_"))
+        self.env = _fake_home(self.root / "home")
+        self.proj = self.root / "proj"
+        (self.proj / "src").mkdir(parents=True)
+        (self.proj / "src" / "a.cpp").write_text("// @std: c++20\n// @include: third_party\nint a;\n")
+        (self.proj / "src" / "b.c").write_text("int b;\n")
+        self.db = self.proj / "compile_commands.json"
+        self.entries = [
+            {
+                "directory": str(self.proj),
+                "file": "src/a.cpp",
+                "output": "a.o",
+                "arguments": ["clang++", "-O2", "-DMSG=\"hi there\"", "-c", "src/a.cpp", "-o", "a.o"],
+            },
+            {
+                "directory": str(self.proj),
+                "command": "/usr/bin/cc -O1 -I'inc dir' -c src/b.c -o b.o",
+                "file": "src/b.c",
+                "extra": {"nested": [1, 2.5, True, None, {"k": "]}"}]},
+            },
+        ]
+        self.db.write_text(json.dumps(self.entries, indent=2))
+
+    def tearDown(self) -> None:
+        shutil.rmtree(self.root, ignore_errors=True)
+
+    def _translate(self, *extra: str) -> subprocess.CompletedProcess:
+        return _run([_exe("ctc-clang"), "--ctc-translate", str(self.db), *extra], self.env)
+
+    def _dry_run(self, tool: str, args: list[str]) -> list[str]:
+        result = _run([_exe(tool), "--dry-run", *args], self.env, cwd=str(self.proj))
+        self.assertEqual(result.returncode, 0, result.stderr)
+        return result.stdout.split()
+
+    def test_matches_dry_run(self) -> None:
+        result = self._translate()
+        self.assertEqual(result.returncode, 0, result.stderr)
+        out = json.loads(result.stdout)
+        self.assertEqual(len(out), 2)
+
+        a = out[0]
+        self.assertEqual(a["file"], "src/a.cpp")
+        self.assertEqual(a["output"], "a.o")
+        self.assertEqual(a["directory"], str(self.proj))
+        self.assertTrue(a["arguments"][0].endswith("clang++"))
+        self.assertIn("-std=c++20", a["arguments"])
+        self.assertIn("-Ithird_party", a["arguments"])
+        self.assertIn('-DMSG="hi there"', a["arguments"])
+        self.assertEqual(a["arguments"][-2:], ["-o", "a.o"])
+
+        b = out[1]
+        self.assertNotIn("output", b)
+        self.assertTrue(b["arguments"][0].endswith("clang"))
+        self.assertIn("-Iinc dir", b["arguments"])
+        self.assertNotIn("-std=c++20", b["arguments"])
+
+        # Same flags as a per-file --dry-run from the entry's directory (args
+        # with spaces are swapped out: --dry-run output is not shell-quoted)
+        dry = self._dry_run("ctc-clang", ["-O1", "-Iincdir", "-c", "src/b.c", "-o", "b.o"])
+        self.assertEqual(b["arguments"][0], dry[0])
+        self.assertEqual(
+            [x for x in b["arguments"] if x != "-Iinc dir"], [x for x in dry if x != "-Iincdir"]
+        )
+        dry_a = self._dry_run("ctc-clang++", ["-O2", "-c", "src/a.cpp", "-o", "a.o"])
+        self.assertEqual([x for x in a["arguments"] if not x.startswith("-DMSG")], dry_a)
+
+    def test_output_file_and_escapes(self) -> None:
+        self.entries[1]["file"] = "src/bé.c"
+        self.db.write_text(json.dumps(self.entries))  # ensure_ascii: emits é
+        out_path = self.root / "translated.json"
+        result = self._translate("-o", str(out_path))
+        self.assertEqual(result.returncode, 0, result.stderr)
+        self.assertEqual(result.stdout, "")
+        out = json.loads(out_path.read_text(encoding="utf-8"))
+        self.assertEqual(out[1]["file"], "src/bé.c")
+
+    def test_empty_database(self) -> None:
+        self.db.write_text("[]\n")
+        result = self._translate()
+        self.assertEqual(result.returncode, 0, result.stderr)
+        self.assertEqual(json.loads(result.stdout), [])
+
+    def test_malformed_database(self) -> None:
+        self.db.write_text('[{"directory": "/x", "file": "a.c", "arguments": ["cc", ')
+        result = self._translate()
+        self.assertEqual(result.returncode, 1)
+        self.assertIn("compile_commands.json", result.stderr)
+
+    def test_missing_database(self) -> None:
+        result = _run([_exe("ctc-clang"), "--ctc-translate", str(self.root / "nope.json")], self.env)
+        self.assertEqual(result.returncode, 1)
+
+
+if __name__ == "__main__":
+    unittest.main()
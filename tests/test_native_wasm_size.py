@@ -0,0 +1,381 @@
+"""Tests for the native WebAssembly size analyzer (ctc-wasm-size).
+
+The modules are assembled here byte by byte (no wasm toolchain needed): a
+name section, active and passive data segments, imports from two modules,
+and DWARF in both the v4 (inline strings, .debug_ranges) and v5 (strx /
+addrx / rnglistx through their *_base tables) encodings.
+
+Tests cover:
+  - Registry & resource presence
+  - Section table, function sizes from the name section, func[N] fallback
+  - Function sizes add up to the code section (minus its count LEB)
+  - Compile-unit attribution for DWARF v4 and v5, unattributed bodies
+  - Data segments (names, passive/active, offsets) and import counts
+  - --diff: per-function / per-section / per-CU deltas, new and removed
+  - Malformed input fails cleanly
+"""
+
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import unittest
+from pathlib import Path
+
+IS_WINDOWS = sys.platform == "win32"
+
+
+# ------------------------------------------------------------------
+# Module-level compilation: build native tools once for all tests
+# ------------------------------------------------------------------
+
+_build_dir: str | None = None
+_build_ok: bool = False
+
+
+def _ensure_built() -> bool:
+    """Compile native tools into a temp directory (runs once per session)."""
+    global _build_dir, _build_ok  # noqa: PLW0603
+    if _build_dir is not None:
+        return _build_ok
+
+    import importlib.resources as resources
+
+    ref = resources.files("clang_tool_chain.native_tools").joinpath("launcher_wasm_size.cpp")
+    if not (hasattr(ref, "is_file") and ref.is_file()):  # type: ignore[union-attr]
+        _build_dir = ""
+        return False
+
+    _build_dir = tempfile.mkdtemp(prefix="ctc_wasm_size_test_")
+
+    try:
+        from clang_tool_chain.commands.compile_native import compile_native
+
+        rc = compile_native(_build_dir)
+        _build_ok = rc == 0
+    except Exception:
+        _build_ok = False
+
+    if not _build_ok:
+        print(
+            f"WARNING: native tool compilation failed (dir={_build_dir})",
+            file=sys.stderr,
+        )
+
+    import atexit
+
+    def _cleanup() -> None:
+        if _build_dir and os.path.isdir(_build_dir):
+            shutil.rmtree(_build_dir, ignore_errors=True)
+
+    atexit.register(_cleanup)
+    return _build_ok
+
+
+def _exe(name: str) -> str:
+    _ensure_built()
+    suffix = ".exe" if IS_WINDOWS else ""
+    return str(Path(_build_dir or "") / f"{name}{suffix}")
+
+
+def _run(args: list[str], stdin: bytes | None = None) -> subprocess.CompletedProcess:
+    return subprocess.run(args, capture_output=True, input=stdin, timeout=120)
+
+
+SKIP_REASON = "Native tool compilation failed"
+
+
+# ==========================================================================
+# Module builder
+# ==========================================================================
+
+
+def _uleb(n: int) -> bytes:
+    out = bytearray()
+    while True:
+        b = n & 0x7F
+        n >>= 7
+        out.append(b | (0x80 if n else 0))
+        if not n:
+            return bytes(out)
+
+
+def _name(s: str) -> bytes:
+    b = s.encode()
+    return _uleb(len(b)) + b
+
+
+def _vec(items: list[bytes]) -> bytes:
+    return _uleb(len(items)) + b"".join(items)
+
+
+def _section(sid: int, payload: bytes) -> bytes:
+    return bytes([sid]) + _uleb(len(payload)) + payload
+
+
+def _custom(name: str, payload: bytes) -> bytes:
+    return _section(0, _name(name) + payload)
+
+
+def _u16(n: int) -> bytes:
+    return n.to_bytes(2, "little")
+
+
+def _u32(n: int) -> bytes:
+    return n.to_bytes(4, "little")
+
+
+IMPORTS = [("env", "log", 0), ("wasi_snapshot_preview1", "fd_write", 0), ("env", "memory", 2)]
+
+
+def _build(
+    bodies: dict[str, int],
+    imports: list[tuple[str, str, int]] = IMPORTS,
+    dwarf: str | None = None,
+    data: tuple[int, int] = (300, 40),
+) -> tuple[bytes, dict[str, tuple[int, int]]]:
+    """Module with one function per (name, instruction count) in *bodies*.
+
+    Returns the module and {name: (code offset of body start, body length)},
+    the values the DWARF ranges are built from. *dwarf* is None, "v4" or
+    "v5"; CU "a.cpp" covers the first function, "b.cpp" the second and third,
+    later functions have no CU.
+    """
+    func_imports = sum(1 for _, _, kind in imports if kind == 0)
+    types = _section(1, _vec([b"\x60\x00\x00"]))
+    entries = []
+    for module, field, kind in imports:
+        desc = b"\x00" if kind == 0 else b"\x00\x01"  # type 0 / memory limits {min 1}
+        entries.append(_name(module) + _name(field) + bytes([kind]) + desc)
+    imp = _section(2, _vec(entries))
+    funcs = _section(3, _vec([b"\x00"] * len(bodies)))
+
+    code_payload = bytearray(_uleb(len(bodies)))
+    layout: dict[str, tuple[int, int]] = {}
+    for fname, n in bodies.items():
+        body = b"\x00" + b"\x01" * n + b"\x0b"  # no locals, n x nop, end
+        code_payload += _uleb(len(body))
+        layout[fname] = (len(code_payload), len(body))
+        code_payload += body
+    code = _section(10, bytes(code_payload))
+
+    active = b"\x00\x41" + _uleb(1024) + b"\x0b" + _uleb(data[0]) + b"r" * data[0]
+    passive = b"\x01" + _uleb(data[1]) + b"d" * data[1]
+    data_sec = _section(11, _vec([active, passive]))
+
+    fn_names = [_uleb(i) + _name(f"import{i}") for i in range(func_imports)]
+    fn_names += [_uleb(func_imports + i) + _name(n) for i, n in enumerate(bodies) if not n.startswith("anon")]
+    data_names = [_uleb(0) + _name(".rodata"), _uleb(1) + _name(".data")]
+    names = _custom(
+        "name", b"\x01" + _uleb(len(_vec(fn_names))) + _vec(fn_names) + b"\x09" + _uleb(len(_vec(data_names)))
+        + _vec(data_names)
+    )
+
+    module = b"\x00asm\x01\x00\x00\x00" + types + imp + funcs + code + data_sec + names
+    fnames = list(bodies)
+    if dwarf == "v4":
+        module += _dwarf_v4(layout[fnames[0]], layout[fnames[1]], layout[fnames[2]])
+    elif dwarf == "v5":
+        module += _dwarf_v5(layout[fnames[0]], layout[fnames[1]], layout[fnames[2]])
+    return module, layout
+
+
+def _unit(version_header: bytes, die: bytes) -> bytes:
+    body = version_header + die
+    return _u32(len(body)) + body
+
+
+def _dwarf_v4(a: tuple[int, int], b1: tuple[int, int], b2: tuple[int, int]) -> bytes:
+    abbrev = (
+        # 1: compile_unit, no children: name/string, low_pc/addr, high_pc/data4
+        _uleb(1) + _uleb(0x11) + b"\x00" + b"\x03\x08\x11\x01\x12\x06\x00\x00"
+        # 2: compile_unit: name/strp, low_pc/addr, ranges/sec_offset
+        + _uleb(2) + _uleb(0x11) + b"\x00" + b"\x03\x0e\x11\x01\x55\x17\x00\x00"
+        + b"\x00"
+    )
+    strs = b"unused\x00b.cpp\x00"
+    cu1 = _unit(_u16(4) + _u32(0) + b"\x04", _uleb(1) + b"a.cpp\x00" + _u32(a[0]) + _u32(a[1]))
+    cu2 = _unit(_u16(4) + _u32(0) + b"\x04", _uleb(2) + _u32(7) + _u32(0) + _u32(0))
+    ranges = _u32(b1[0]) + _u32(b1[0] + b1[1]) + _u32(b2[0]) + _u32(b2[0] + b2[1]) + _u32(0) + _u32(0)
+    return (
+        _custom(".debug_abbrev", abbrev)
+        + _custom(".debug_info", cu1 + cu2)
+        + _custom(".debug_str", strs)
+        + _custom(".debug_ranges", ranges)
+    )
+
+
+def _dwarf_v5(a: tuple[int, int], b1: tuple[int, int], b2: tuple[int, int]) -> bytes:
+    abbrev = (
+        # 1: name/strx1, str_offsets_base, addr_base, low_pc/addrx, high_pc/data4
+        _uleb(1) + _uleb(0x11) + b"\x00"
+        + b"\x03\x25\x72\x17\x73\x17\x11\x1b\x12\x06\x00\x00"
+        # 2: name/line_strp, low_pc/addr, rnglists_base, ranges/rnglistx
+        + _uleb(2) + _uleb(0x11) + b"\x00" + b"\x03\x1f\x11\x01\x74\x17\x55\x23\x00\x00"
+        + b"\x00"
+    )
+    strs = b"x\x00a.cpp\x00"
+    str_offsets = _u32(4 + 4) + _u16(5) + _u16(0) + _u32(0) + _u32(2)  # index 1 -> "a.cpp"
+    addr = _u32(4 + 4 + 4) + _u16(5) + b"\x04\x00" + _u32(0xDEAD) + _u32(0) + _u32(a[0])  # index 2
+    line_str = b"b.cpp\x00"
+    lists = (
+        b"\x04" + _uleb(b1[0]) + _uleb(b1[0] + b1[1])  # offset_pair
+        + b"\x07" + _u32(b2[0]) + _uleb(b2[1])  # start_length
+        + b"\x00"
+    )
+    rng_body = _u16(5) + b"\x04\x00" + _u32(1) + _u32(4) + lists  # one offset entry -> lists at base+4
+    rnglists = _u32(len(rng_body)) + rng_body
+    hdr = _u16(5) + b"\x01\x04" + _u32(0)
+    cu1 = _unit(hdr, _uleb(1) + b"\x01" + _u32(8) + _u32(8) + _uleb(2) + _u32(a[1]))
+    cu2 = _unit(hdr, _uleb(2) + _u32(0) + _u32(0) + _u32(12) + _uleb(0))
+    return (
+        _custom(".debug_abbrev", abbrev)
+        + _custom(".debug_info", cu1 + cu2)
+        + _custom(".debug_str", strs)
+        + _custom(".debug_str_offsets", str_offsets)
+        + _custom(".debug_addr", addr)
+        + _custom(".debug_line_str", line_str)
+        + _custom(".debug_rnglists", rnglists)
+    )
+
+
+BODIES = {"big": 500, "small": 10, "medium": 120, "orphan": 30, "anon": 7}
+
+
+# ==========================================================================
+# Resource & Registry
+# ==========================================================================
+
+
+class TestWasmSizeResource(unittest.TestCase):
+    """Verify launcher_wasm_size.cpp is accessible and registered."""
+
+    def test_registry_has_wasm_size(self) -> None:
+        from clang_tool_chain.native_tools import TOOL_REGISTRY
+
+        self.assertIn("wasm_size", TOOL_REGISTRY)
+        tool = TOOL_REGISTRY["wasm_size"]
+        self.assertEqual(tool.source, "launcher_wasm_size.cpp")
+        self.assertEqual(tool.output, "ctc-wasm-size")
+
+
+# ==========================================================================
+# Analysis
+# ==========================================================================
+
+
+@unittest.skipUnless(_ensure_built(), SKIP_REASON)
+class TestAnalyze(unittest.TestCase):
+    def setUp(self) -> None:
+        self.tmp = Path(tempfile.mkdtemp(prefix="ctc_wasm_size_"))
+
+    def tearDown(self) -> None:
+        shutil.rmtree(self.tmp, ignore_errors=True)
+
+    def _write(self, name: str, data: bytes) -> Path:
+        path = self.tmp / name
+        path.write_bytes(data)
+        return path
+
+    def _json(self, *args: str) -> dict:
+        result = _run([_exe("ctc-wasm-size"), "--json", "--top", "0", *args])
+        self.assertEqual(result.returncode, 0, result.stderr.decode())
+        return json.loads(result.stdout)
+
+    def test_sections_and_functions(self) -> None:
+        module, layout = _build(BODIES)
+        report = self._json(str(self._write("m.wasm", module)))
+        self.assertEqual(report["size"], len(module))
+        self.assertEqual(report["functions_defined"], 5)
+        self.assertEqual(report["functions_imported"], 2)
+        self.assertFalse(report["dwarf"])
+        sizes = {f["name"]: f["size"] for f in report["functions"]}
+        # body + its size LEB (1 byte below 128, 2 above)
+        self.assertEqual(sizes["big"], 502 + 2)
+        self.assertEqual(sizes["small"], 12 + 1)
+        self.assertEqual(sizes["func[6]"], 9 + 1)  # unnamed: index after 2 imports
+        self.assertEqual([f["name"] for f in report["functions"]][0], "big")
+        sections = {s["name"]: s["size"] for s in report["sections"]}
+        self.assertEqual(sum(sections.values()) + 8, len(module))
+        # function sizes + count LEB + section header == code section
+        self.assertEqual(report["code_size"] + 1 + 3, sections["code"])
+        self.assertIn("name", sections)
+
+    def test_data_and_imports(self) -> None:
+        module, _ = _build(BODIES)
+        report = self._json(str(self._write("m.wasm", module)))
+        segs = report["data_segments"]
+        self.assertEqual([s["name"] for s in segs], [".rodata", ".data"])
+        self.assertEqual(segs[0]["offset"], 1024)
+        self.assertFalse(segs[0]["passive"])
+        self.assertTrue(segs[1]["passive"])
+        self.assertEqual(report["data_size"], 340)
+        kinds = [(i["module"], i["name"], i["kind"]) for i in report["imports"]]
+        self.assertEqual(kinds[2], ("env", "memory", "memory"))
+
+    def _check_units(self, version: str) -> None:
+        module, _ = _build(BODIES, dwarf=version)
+        report = self._json(str(self._write(f"{version}.wasm", module)))
+        self.assertTrue(report["dwarf"])
+        units = {u["name"]: u["size"] for u in report["compile_units"]}
+        fn = {f["name"]: f["size"] for f in report["functions"]}
+        self.assertEqual(units["a.cpp"], fn["big"])
+        self.assertEqual(units["b.cpp"], fn["small"] + fn["medium"])
+        self.assertEqual(units["<no debug info>"], fn["orphan"] + fn["func[6]"])
+
+    def test_dwarf_v4_units(self) -> None:
+        self._check_units("v4")
+
+    def test_dwarf_v5_units(self) -> None:
+        self._check_units("v5")
+
+    def test_text_report(self) -> None:
+        module, _ = _build(BODIES, dwarf="v4")
+        result = _run([_exe("ctc-wasm-size"), "--top", "2", str(self._write("m.wasm", module))])
+        self.assertEqual(result.returncode, 0, result.stderr.decode())
+        out = result.stdout.decode()
+        self.assertIn("5 functions (+2 imported), 2 compile units", out)
+        self.assertIn("(3 more)", out)
+        self.assertIn("a.cpp", out)
+        self.assertIn(".rodata", out)
+        self.assertIn("wasi_snapshot_preview1", out)
+
+    def test_diff(self) -> None:
+        old, _ = _build(BODIES, dwarf="v4")
+        new, _ = _build(
+            {"big": 900, "medium": 120, "added": 50, "orphan": 30, "anon": 7},
+            imports=IMPORTS[:1] + IMPORTS[2:],
+            dwarf="v4",
+            data=(300, 100),
+        )
+        report = self._json("--diff", str(self._write("old.wasm", old)), str(self._write("new.wasm", new)))
+        self.assertEqual(report["delta"], len(new) - len(old))
+        fn = {f["name"]: f for f in report["functions"]}
+        self.assertEqual(fn["big"]["delta"], 400)  # size LEB stays 2 bytes
+        self.assertEqual(fn["small"]["after"], 0)
+        self.assertEqual(fn["added"]["before"], 0)
+        self.assertNotIn("orphan", fn)  # unchanged rows are dropped
+        self.assertEqual(report["functions"][0]["name"], "big")
+        segs = {s["name"]: s["delta"] for s in report["data_segments"]}
+        self.assertEqual(segs, {".data": 60})
+        imports = {i["name"]: i["delta"] for i in report["imports"]}
+        self.assertEqual(imports, {"wasi_snapshot_preview1.fd_write (func)": -1})
+
+    def test_bad_input(self) -> None:
+        bad = self._write("bad.wasm", b"\x7fELF\x02\x01\x01\x00")
+        result = _run([_exe("ctc-wasm-size"), str(bad)])
+        self.assertEqual(result.returncode, 1)
+        self.assertIn(b"bad magic", result.stderr)
+        module, _ = _build(BODIES)
+        truncated = self._write("trunc.wasm", module[: len(module) // 2])
+        result = _run([_exe("ctc-wasm-size"), str(truncated)])
+        self.assertEqual(result.returncode, 1)
+        self.assertIn(b"truncated", result.stderr)
+        result = _run([_exe("ctc-wasm-size"), str(self.tmp / "missing.wasm")])
+        self.assertEqual(result.returncode, 1)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,274 @@
+"""Tests for ctc-xray and the launcher's XRay tracing mode.
+
+With CLANG_TOOL_CHAIN_XRAY=1, ctc-clang adds -fxray-instrument to compiles and,
+when the toolchain ships the XRay runtime, to links. ctc-xray streams the
+basic-mode logs an instrumented program writes and reports per-function
+latency, optionally writing Chrome trace-event JSON.
+
+Tests cover:
+  - Launcher flags: compile, threshold, link with and without the runtime,
+    explicit -fno-xray-instrument left alone
+  - Inclusive/self time, unmatched exits and unfinished calls
+  - Percentiles over a log larger than one read block
+  - Trace-event JSON
+  - Function names from the binary's xray_instr_map (demangled), including
+    the binary guessed from the xray-log.<program>.* name
+  - FDR-mode logs rejected
+"""
+
+import json
+import os
+import platform
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+import unittest
+from pathlib import Path
+
+IS_WINDOWS = sys.platform == "win32"
+IS_LINUX = sys.platform.startswith("linux")
+
+
+# ------------------------------------------------------------------
+# Module-level compilation: build native tools once for all tests
+# ------------------------------------------------------------------
+
+_build_dir: str | None = None
+_build_ok: bool = False
+
+
+def _ensure_built() -> bool:
+    """Compile native tools into a temp directory (runs once per session)."""
+    global _build_dir, _build_ok  # noqa: PLW0603
+    if _build_dir is not None:
+        return _build_ok
+
+    import importlib.resources as resources
+
+    ref = resources.files("clang_tool_chain.native_tools").joinpath("launcher_xray.cpp")
+    if not (hasattr(ref, "is_file") and ref.is_file()):  # type: ignore[union-attr]
+        _build_dir = ""
+        return False
+
+    _build_dir = tempfile.mkdtemp(prefix="ctc_xray_test_")
+
+    try:
+        from clang_tool_chain.commands.compile_native import compile_native
+
+        rc = compile_native(_build_dir)
+        _build_ok = rc == 0
+    except Exception:
+        _build_ok = False
+
+    if not _build_ok:
+        print(
+            f"WARNING: native tool compilation failed (dir={_build_dir})",
+            file=sys.stderr,
+        )
+
+    import atexit
+
+    def _cleanup() -> None:
+        if _build_dir and os.path.isdir(_build_dir):
+            shutil.rmtree(_build_dir, ignore_errors=True)
+
+    atexit.register(_cleanup)
+    return _build_ok
+
+
+def _exe(name: str) -> str:
+    _ensure_built()
+    suffix = ".exe" if IS_WINDOWS else ""
+    return str(Path(_build_dir or "") / f"{name}{suffix}")
+
+
+SKIP_REASON = "Native tool compilation failed"
+
+
+ENTRY, EXIT, TAIL_EXIT = 0, 1, 2
+
+
+def _write_log(path: Path, records: list[tuple[int, int, int, int, int]], log_type: int = 0) -> None:
+    """records: (entry_type, function id, tsc, tid, pid); 1 tick = 1 ns."""
+    with open(path, "wb") as f:
+        f.write(struct.pack("<HHIQ16x", 3, log_type, 3, 1_000_000_000))
+        for entry_type, fn, tsc, tid, pid in records:
+            f.write(struct.pack("<HBBiQII8x", 0, 0, entry_type, fn, tsc, tid, pid))
+
+
+# A binary whose xray_instr_map has version-2 sleds for two C++ functions,
+# laid out the way clang emits them (entry-relative addresses).
+INSTR_MAP_SOURCE = r"""
+__attribute__((noinline, used)) int alpha(int x) { return x * 3; }
+namespace ns { __attribute__((noinline, used)) void beta() {} }
+asm(".pushsection xray_instr_map,\"a\"\n"
+    "1: .quad _Z5alphai - 1b\n .quad _Z5alphai - 1b - 8\n .byte 0, 0, 2\n .zero 13\n"
+    "2: .quad _Z5alphai - 2b\n .quad _Z5alphai - 2b - 8\n .byte 1, 0, 2\n .zero 13\n"
+    "3: .quad _ZN2ns4betaEv - 3b\n .quad _ZN2ns4betaEv - 3b - 8\n .byte 0, 0, 2\n .zero 13\n"
+    ".popsection\n");
+int main() { ns::beta(); return alpha(1) - 3; }
+"""
+
+
+@unittest.skipUnless(_ensure_built(), SKIP_REASON)
+class TestXRayConverter(unittest.TestCase):
+    def setUp(self) -> None:
+        self.root = Path(tempfile.mkdtemp(prefix="ctc_xray_"))
+
+    def tearDown(self) -> None:
+        shutil.rmtree(self.root, ignore_errors=True)
+
+    def _xray(self, *args: str) -> subprocess.CompletedProcess:
+        return subprocess.run(
+            [_exe("ctc-xray"), *args], capture_output=True, text=True, cwd=self.root, timeout=120
+        )
+
+    def _json(self, *args: str) -> dict:
+        result = self._xray("--json", *args)
+        self.assertEqual(result.returncode, 0, result.stderr)
+        return json.loads(result.stdout)
+
+    def test_inclusive_and_self_time(self) -> None:
+        log = self.root / "calls.xray"
+        _write_log(
+            log,
+            [
+                (EXIT, 9, 500, 1, 7),  # entered before patching
+                (ENTRY, 1, 1000, 1, 7),
+                (ENTRY, 2, 2000, 1, 7),
+                (EXIT, 2, 5000, 1, 7),
+                (ENTRY, 3, 6000, 1, 7),
+                (TAIL_EXIT, 3, 8000, 1, 7),
+                (EXIT, 1, 11000, 1, 7),
+                (ENTRY, 4, 12000, 2, 7),  # still running at exit
+            ],
+        )
+        data = self._json(str(log))
+        self.assertEqual((data["records"], data["threads"]), (8, 2))
+        self.assertEqual((data["unmatched_exits"], data["unfinished_calls"]), (1, 1))
+        fns = {f["function"]: f for f in data["functions"]}
+        self.assertEqual(list(fns), ["#1", "#2", "#3"])
+        self.assertEqual((fns["#1"]["total_us"], fns["#1"]["self_us"]), (10.0, 5.0))
+        self.assertEqual((fns["#2"]["total_us"], fns["#3"]["total_us"]), (3.0, 2.0))
+        data = self._json(str(log), "--sort", "self", "--function", "#1")
+        self.assertEqual([f["id"] for f in data["functions"]], [1])
+
+    def test_percentiles_across_blocks(self) -> None:
+        # 150k calls (300k records, more than one 4 MiB read): 1..1000 us each.
+        records = []
+        tsc = 0
+        for i in range(150_000):
+            dur = (i % 1000 + 1) * 1000
+            records.append((ENTRY, 5, tsc, 3, 1))
+            records.append((EXIT, 5, tsc + dur, 3, 1))
+            tsc += dur + 10
+        log = self.root / "many.xray"
+        _write_log(log, records)
+        fn = self._json(str(log))["functions"][0]
+        self.assertEqual(fn["calls"], 150_000)
+        self.assertEqual((fn["min_us"], fn["max_us"]), (1.0, 1000.0))
+        self.assertAlmostEqual(fn["mean_us"], 500.5, places=3)
+        for key, exact in (("p50_us", 500), ("p90_us", 900), ("p99_us", 990)):
+            self.assertLess(abs(fn[key] - exact) / exact, 0.07, (key, fn[key]))
+        self.assertEqual(sum(b["count"] for b in fn["histogram"]), 150_000)
+        result = self._xray(str(log), "--histogram")
+        self.assertEqual(result.returncode, 0, result.stderr)
+        self.assertIn("#5 (150000 calls)", result.stdout)
+
+    def test_trace_events(self) -> None:
+        log = self.root / "t.xray"
+        _write_log(log, [(ENTRY, 1, 3000, 4, 9), (ENTRY, 2, 4000, 4, 9), (EXIT, 2, 4500, 4, 9), (EXIT, 1, 6000, 4, 9)])
+        result = self._xray(str(log), "--trace", "out.json")
+        self.assertEqual(result.returncode, 0, result.stderr)
+        events = json.loads((self.root / "out.json").read_text())["traceEvents"]
+        self.assertEqual(
+            [(e["name"], e["ts"], e["dur"], e["pid"], e["tid"]) for e in events],
+            [("#2", 4.0, 0.5, 9, 4), ("#1", 3.0, 3.0, 9, 4)],
+        )
+
+    @unittest.skipUnless(IS_LINUX and (shutil.which("c++") or shutil.which("g++")), "needs a host C++ compiler")
+    def test_names_from_instr_map(self) -> None:
+        (self.root / "app.cpp").write_text(INSTR_MAP_SOURCE)
+        cxx = shutil.which("c++") or shutil.which("g++")
+        build = subprocess.run([cxx, "-O1", "-o", "app", "app.cpp"], capture_output=True, text=True, cwd=self.root)
+        self.assertEqual(build.returncode, 0, build.stderr)
+        log = self.root / "xray-log.app.Ab12Cd"
+        _write_log(log, [(ENTRY, 1, 0, 1, 1), (EXIT, 1, 2000, 1, 1), (ENTRY, 2, 3000, 1, 1), (EXIT, 2, 4000, 1, 1)])
+        # Binary guessed from the log name, then given explicitly
+        for args in ((str(log),), ("--binary", "app", str(log))):
+            names = [f["function"] for f in self._json(*args)["functions"]]
+            self.assertEqual(names, ["alpha(int)", "ns::beta()"])
+        result = self._xray("--binary", "app.cpp", str(log))
+        self.assertEqual(result.returncode, 0)
+        self.assertIn("not a 64-bit little-endian ELF", result.stderr)
+        self.assertIn("#1", result.stdout)
+
+    def test_fdr_log_rejected(self) -> None:
+        log = self.root / "fdr.xray"
+        _write_log(log, [], log_type=1)
+        result = self._xray(str(log))
+        self.assertEqual(result.returncode, 1)
+        self.assertIn("xray_mode=xray-basic", result.stderr)
+
+
+@unittest.skipUnless(IS_LINUX, "XRay mode is Linux only")
+@unittest.skipUnless(_ensure_built(), SKIP_REASON)
+class TestXRayLauncherFlags(unittest.TestCase):
+    def setUp(self) -> None:
+        self.root = Path(tempfile.mkdtemp(prefix="ctc_xray_flags_"))
+        arch = "aarch64" if platform.machine().lower() in ("aarch64", "arm64") else "x86_64"
+        install = self.root / "clang" / "linux" / ("arm64" if arch == "aarch64" else "x86_64")
+        (install / "bin").mkdir(parents=True)
+        self.rt_dir = install / "lib" / "clang" / "19" / "lib" / f"{arch}-unknown-linux-gnu"
+        self.rt_dir.mkdir(parents=True)
+        (install / "lib" / "clang" / "19" / "include").mkdir()
+        (install / "done.txt").write_text("ok\n")
+        shutil.copy("/bin/echo", install / "bin" / "clang")
+        (install / "bin" / "clang++").symlink_to("clang")
+        self.env = dict(os.environ)
+        self.env["CLANG_TOOL_CHAIN_DOWNLOAD_PATH"] = str(self.root)
+        self.env["CLANG_TOOL_CHAIN_XRAY"] = "1"
+        for key in ("CLANG_TOOL_CHAIN_XRAY_THRESHOLD", "CLANG_TOOL_CHAIN_NO_AUTO", "CLANG_TOOL_CHAIN_NO_NOTE"):
+            self.env.pop(key, None)
+
+    def tearDown(self) -> None:
+        shutil.rmtree(self.root, ignore_errors=True)
+
+    def _run(self, *args: str) -> subprocess.CompletedProcess:
+        result = subprocess.run(
+            [_exe("ctc-clang++"), "--dry-run", *args],
+            capture_output=True,
+            text=True,
+            env=self.env,
+            cwd=self.root,
+            timeout=60,
+        )
+        self.assertEqual(result.returncode, 0, result.stderr)
+        return result
+
+    def test_compile_and_threshold(self) -> None:
+        self.env["CLANG_TOOL_CHAIN_XRAY_THRESHOLD"] = "1"
+        args = self._run("-c", "a.cpp", "-o", "a.o").stdout.split()
+        self.assertIn("-fxray-instrument", args)
+        self.assertIn("-fxray-instruction-threshold=1", args)
+
+    def test_link_needs_runtime(self) -> None:
+        result = self._run("a.o", "-o", "app")
+        self.assertNotIn("-fxray-instrument", result.stdout.split())
+        self.assertIn("XRay runtime (libclang_rt.xray) not found", result.stderr)
+        (self.rt_dir / "libclang_rt.xray.a").write_bytes(b"!<arch>\n")
+        args = self._run("a.o", "-o", "app").stdout.split()
+        self.assertIn("-fxray-instrument", args)
+        self.assertFalse(any(a.startswith("-fxray-instruction-threshold") for a in args))
+
+    def test_user_flag_wins(self) -> None:
+        args = self._run("-c", "a.cpp", "-fno-xray-instrument").stdout.split()
+        self.assertNotIn("-fxray-instrument", args)
+        self.env["CLANG_TOOL_CHAIN_XRAY"] = "0"
+        self.assertNotIn("-fxray-instrument", self._run("-c", "a.cpp").stdout.split())
+
+
+if __name__ == "__main__":
+    unittest.main()
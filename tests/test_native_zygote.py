@@ -0,0 +1,243 @@
+"""Tests for the clang zygote (libctc_zygote.so + ctc-clang CLANG_TOOL_CHAIN_ZYGOTE=1).
+
+The shim is LD_PRELOADed into the bundled clang and turns it into a fork
+server; ctc-clang hands compiles to it over a Unix socket and exits with the
+forked child's status. The tests stand a copy of /bin/sh in for clang: the
+shim only needs an ELF with a main(), and `sh -c` makes exit codes, stdio,
+cwd and environment easy to observe.
+
+Tests cover:
+  - Registry entry (shared library, Linux only) and produced .so
+  - Without the opt-in, ctc-clang execs clang as before
+  - First opt-in compile execs and starts the zygote; later compiles are
+    forked by it (different pid) with the caller's stdin/stdout, cwd, env
+    and exit code
+  - A compile killed by a signal is reported as such
+  - A zygote that hangs up on a request unread makes ctc-clang fall back to
+    exec instead of dying of SIGPIPE
+  - Idle zygote exits and removes its socket
+"""
+
+import os
+import platform
+import shutil
+import socket
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+import unittest
+from pathlib import Path
+
+IS_LINUX = sys.platform.startswith("linux")
+
+
+# ------------------------------------------------------------------
+# Module-level compilation: build native tools once for all tests
+# ------------------------------------------------------------------
+
+_build_dir: str | None = None
+_build_ok: bool = False
+
+
+def _ensure_built() -> bool:
+    """Compile native tools into a temp directory (runs once per session)."""
+    global _build_dir, _build_ok  # noqa: PLW0603
+    if _build_dir is not None:
+        return _build_ok
+
+    import importlib.resources as resources
+
+    ref = resources.files("clang_tool_chain.native_tools").joinpath("ctc_zygote.cpp")
+    if not (hasattr(ref, "is_file") and ref.is_file()):  # type: ignore[union-attr]
+        _build_dir = ""
+        return False
+
+    _build_dir = tempfile.mkdtemp(prefix="ctc_zygote_test_")
+
+    try:
+        from clang_tool_chain.commands.compile_native import compile_native
+
+        rc = compile_native(_build_dir)
+        _build_ok = rc == 0
+    except Exception:
+        _build_ok = False
+
+    if not _build_ok:
+        print(
+            f"WARNING: native tool compilation failed (dir={_build_dir})",
+            file=sys.stderr,
+        )
+
+    import atexit
+
+    def _cleanup() -> None:
+        if _build_dir and os.path.isdir(_build_dir):
+            shutil.rmtree(_build_dir, ignore_errors=True)
+
+    atexit.register(_cleanup)
+    return _build_ok
+
+
+def _exe(name: str) -> str:
+    _ensure_built()
+    return str(Path(_build_dir or "") / name)
+
+
+SKIP_REASON = "Native tool compilation failed"
+
+
+def _fake_env(root: Path) -> dict[str, str]:
+    """Toolchain home whose clang is a copy of /bin/sh, plus a private socket dir."""
+    arch = "arm64" if platform.machine().lower() in ("aarch64", "arm64") else "x86_64"
+    install = root / "clang" / "linux" / arch
+    (install / "bin").mkdir(parents=True)
+    (install / "done.txt").write_text("ok\n")
+    shutil.copy("/bin/sh", install / "bin" / "clang")
+    runtime = root / "run"
+    runtime.mkdir(mode=0o700)
+    env = dict(os.environ)
+    env["CLANG_TOOL_CHAIN_DOWNLOAD_PATH"] = str(root)
+    env["XDG_RUNTIME_DIR"] = str(runtime)
+    env["CTC_ZYGOTE_IDLE"] = "2"
+    for key in ("CLANG_TOOL_CHAIN_ZYGOTE", "CTC_DEBUG", "CLANG_TOOL_CHAIN_NO_AUTO"):
+        env.pop(key, None)
+    return env
+
+
+def _sh(script: str, env: dict[str, str], stdin: str = "") -> tuple[int, str, int]:
+    """Run `ctc-clang -c SCRIPT`; returns (returncode, stdout, launcher pid)."""
+    proc = subprocess.Popen(
+        [_exe("ctc-clang"), "-c", script],
+        stdin=subprocess.PIPE,
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+        text=True,
+        env=env,
+    )
+    out, _ = proc.communicate(stdin, timeout=30)
+    return proc.returncode, out, proc.pid
+
+
+def _wait_for(pred, timeout: float = 5.0) -> bool:
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        if pred():
+            return True
+        time.sleep(0.05)
+    return False
+
+
+# ==========================================================================
+# Registry
+# ==========================================================================
+
+
+class TestZygoteResource(unittest.TestCase):
+    def test_registry_has_zygote(self) -> None:
+        from clang_tool_chain.native_tools import TOOL_REGISTRY
+
+        self.assertIn("zygote", TOOL_REGISTRY)
+        tool = TOOL_REGISTRY["zygote"]
+        self.assertEqual(tool.source, "ctc_zygote.cpp")
+        self.assertEqual(tool.output, "libctc_zygote")
+        self.assertTrue(tool.shared)
+        self.assertEqual(tool.platforms, ("linux",))
+
+
+# ==========================================================================
+# Fork server
+# ==========================================================================
+
+
+@unittest.skipUnless(IS_LINUX, "zygote is Linux only")
+@unittest.skipUnless(_ensure_built(), SKIP_REASON)
+class TestZygote(unittest.TestCase):
+    def setUp(self) -> None:
+        self.root = Path(tempfile.mkdtemp(prefix="ctcz", dir="/tmp"))
+        self.env = _fake_env(self.root)
+        self.sock_dir = self.root / "run"
+
+    def tearDown(self) -> None:
+        _wait_for(lambda: not list(self.sock_dir.glob("*.sock")), timeout=6)
+        shutil.rmtree(self.root, ignore_errors=True)
+
+    def _start_zygote(self) -> dict[str, str]:
+        env = dict(self.env, CLANG_TOOL_CHAIN_ZYGOTE="1")
+        rc, out, pid = _sh("echo $$", env)
+        self.assertEqual(rc, 0)
+        self.assertEqual(out.strip(), str(pid), "first compile should exec clang directly")
+        self.assertTrue(_wait_for(lambda: list(self.sock_dir.glob("*.sock"))), "zygote did not start")
+        return env
+
+    def test_library_built(self) -> None:
+        self.assertTrue(os.path.isfile(_exe("libctc_zygote.so")))
+
+    def test_disabled_by_default(self) -> None:
+        rc, out, pid = _sh("echo $$; exit 4", self.env)
+        self.assertEqual(rc, 4)
+        self.assertEqual(out.strip(), str(pid))
+        self.assertEqual(list(self.sock_dir.glob("*.sock")), [])
+
+    def test_compile_is_forked_by_zygote(self) -> None:
+        env = self._start_zygote()
+        work = self.root / "work"
+        work.mkdir()
+        proc = subprocess.Popen(
+            [_exe("ctc-clang"), "-c", 'read x; echo "$$ $x $CTC_Z_PROBE $(pwd)"; exit 7'],
+            stdin=subprocess.PIPE,
+            stdout=subprocess.PIPE,
+            text=True,
+            cwd=work,
+            env=dict(env, CTC_Z_PROBE="probe"),
+        )
+        out, _ = proc.communicate("from-stdin\n", timeout=30)
+        self.assertEqual(proc.returncode, 7)
+        child_pid, line, probe, cwd = out.split()
+        self.assertNotEqual(int(child_pid), proc.pid, "compile was not forked by the zygote")
+        self.assertEqual(line, "from-stdin")
+        self.assertEqual(probe, "probe")
+        self.assertEqual(os.path.realpath(cwd), os.path.realpath(work))
+
+    def test_signal_status_is_propagated(self) -> None:
+        env = self._start_zygote()
+        rc, _, _ = _sh("kill -TERM $$", env)
+        self.assertEqual(rc, -15)
+
+    def test_refused_request_falls_back_to_exec(self) -> None:
+        env = self._start_zygote()
+        sock_path = str(next(self.sock_dir.glob("*.sock")))
+        self.assertTrue(_wait_for(lambda: not os.path.exists(sock_path), timeout=6))
+        # Stand-in zygote on the same socket: reads the length prefix, then
+        # hangs up with the body unread, as the real one does when its client
+        # table is full or a request is malformed.
+        server = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        server.bind(sock_path)
+        server.listen(1)
+
+        def refuse() -> None:
+            conn, _ = server.accept()
+            conn.recv(4)
+            conn.close()
+
+        thread = threading.Thread(target=refuse)
+        thread.start()
+        try:
+            # Far larger than the socket buffer, so the body write sees the hangup
+            big = {f"CTC_Z_PAD{i}": "x" * 100_000 for i in range(12)}
+            rc, out, pid = _sh("echo $$; exit 5", dict(env, **big))
+        finally:
+            thread.join(timeout=30)
+            server.close()
+            os.unlink(sock_path)
+        self.assertEqual(rc, 5, "ctc-clang should fall back to exec, not die of SIGPIPE")
+        self.assertEqual(out.strip(), str(pid))
+
+    def test_idle_zygote_exits(self) -> None:
+        self._start_zygote()
+        self.assertTrue(_wait_for(lambda: not list(self.sock_dir.glob("*.sock")), timeout=6))
+
+
+if __name__ == "__main__":
+    unittest.main()